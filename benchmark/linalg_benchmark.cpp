@@ -0,0 +1,328 @@
+#include <benchmark/benchmark.h>
+#include <atrix/matrix.h>
+#include <atrix/vector.h>
+#include <atrix/distributions.h>
+#include <atrix/linalg/decompositions.h>
+#include <atrix/linalg/algorithms.h>
+#include <atrix/linalg/utils.h>
+#include <atrix/linalg/batched.h>
+
+#include <vector>
+
+// The FLOPS counters use the textbook operation counts of the algorithms
+// as they are implemented here, so that the rates are comparable across
+// the shapes. The bytes processed count the input and the outputs once,
+// which is the lower bound of the traffic and gives the effective bandwidth.
+
+// the well conditioned square matrix, the pivots never vanish
+static Matrix::Matrix<double> diagonally_dominant(int n) {
+    Matrix::Matrix<double> A(n, n);
+    Matrix::uniform(A, -1.0, 1.0);
+
+    for (int i = 0; i < n; i++)
+        A(i, i) += n;
+
+    return A;
+}
+
+// the symmetric positive definite matrix for cholesky
+static Matrix::Matrix<double> symmetric_positive_definite(int n) {
+    Matrix::Matrix<double> A = diagonally_dominant(n);
+
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < i; j++)
+            A(j, i) = A(i, j);
+
+    return A;
+}
+
+// batch independent diagonally dominant slices with the shape (batch, n, n)
+static Matrix::Matrix<double> batched_diagonally_dominant(int batch, int n) {
+    Matrix::Matrix<double> A(batch, n, n);
+    Matrix::uniform(A, -1.0, 1.0);
+
+    double* a = A.data();
+    for (int b = 0; b < batch; b++)
+        for (int i = 0; i < n; i++)
+            a[(long)b * n * n + i * n + i] += n;
+
+    return A;
+}
+
+static Matrix::Matrix<double> tall_skinny(int m, int n) {
+    Matrix::Matrix<double> A(m, n);
+    Matrix::uniform(A, -1.0, 1.0);
+
+    return A;
+}
+
+//------------------------------------
+
+static void CustomArgumentsOfLinalgSquare(benchmark::internal::Benchmark* b) {
+    for (int n = 256; n <= 2048; n <<= 1)
+        b->Args({n});
+}
+
+// inv and cholesky run the unblocked triple loops, one 2048 matrix takes
+// minutes, so they stop at 1024 to keep the whole suite interactive
+static void CustomArgumentsOfLinalgSquareUnblocked(benchmark::internal::Benchmark* b) {
+    for (int n = 128; n <= 1024; n <<= 1)
+        b->Args({n});
+}
+
+static void BM_LinalgLUP(benchmark::State& state) {
+    const int n = state.range(0);
+    Matrix::Matrix<double> A = diagonally_dominant(n);
+
+    for (auto _ : state) {
+        auto lup = Matrix::LUP(A);
+        benchmark::DoNotOptimize(lup[1].data());
+    }
+
+    state.counters["FLOPS"] = benchmark::Counter(2.0 / 3.0 * n * n * n,
+        benchmark::Counter::kIsIterationInvariantRate);
+    // A in, L, U and P out
+    state.SetBytesProcessed(state.iterations() * 4 * (int64_t)n * n * sizeof(double));
+}
+
+BENCHMARK(BM_LinalgLUP)
+->Apply(CustomArgumentsOfLinalgSquare)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_LinalgCholesky(benchmark::State& state) {
+    const int n = state.range(0);
+    Matrix::Matrix<double> A = symmetric_positive_definite(n);
+
+    for (auto _ : state) {
+        auto llt = Matrix::cholesky(A);
+        benchmark::DoNotOptimize(llt[0].data());
+    }
+
+    state.counters["FLOPS"] = benchmark::Counter(1.0 / 3.0 * n * n * n,
+        benchmark::Counter::kIsIterationInvariantRate);
+    // A in, L and L^T out
+    state.SetBytesProcessed(state.iterations() * 3 * (int64_t)n * n * sizeof(double));
+}
+
+BENCHMARK(BM_LinalgCholesky)
+->Apply(CustomArgumentsOfLinalgSquareUnblocked)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_LinalgInv(benchmark::State& state) {
+    const int n = state.range(0);
+    Matrix::Matrix<double> A = diagonally_dominant(n);
+
+    for (auto _ : state) {
+        Matrix::Matrix<double> B = Matrix::inv(A);
+        benchmark::DoNotOptimize(B.data());
+    }
+
+    state.counters["FLOPS"] = benchmark::Counter(2.0 * n * n * n,
+        benchmark::Counter::kIsIterationInvariantRate);
+    state.SetBytesProcessed(state.iterations() * 2 * (int64_t)n * n * sizeof(double));
+}
+
+BENCHMARK(BM_LinalgInv)
+->Apply(CustomArgumentsOfLinalgSquareUnblocked)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_LinalgDet(benchmark::State& state) {
+    const int n = state.range(0);
+    Matrix::Matrix<double> A = diagonally_dominant(n);
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(Matrix::det(A));
+
+    state.counters["FLOPS"] = benchmark::Counter(2.0 / 3.0 * n * n * n,
+        benchmark::Counter::kIsIterationInvariantRate);
+    state.SetBytesProcessed(state.iterations() * (int64_t)n * n * sizeof(double));
+}
+
+BENCHMARK(BM_LinalgDet)
+->Apply(CustomArgumentsOfLinalgSquare)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+//------------------------------------
+
+static void CustomArgumentsOfLinalgTallSkinny(benchmark::internal::Benchmark* b) {
+    b->Args({256, 256});
+    b->Args({512, 512});
+    b->Args({4096, 64});
+    b->Args({8192, 32});
+    b->Args({16384, 16});
+}
+
+// the classical Gram-Schmidt, 2mn^2 for the projections and the updates
+static void BM_LinalgGramSchmidt(benchmark::State& state) {
+    const int m = state.range(0);
+    const int n = state.range(1);
+    std::vector<Matrix::Vector<double>> v = Matrix::to_column_vectors(tall_skinny(m, n));
+
+    for (auto _ : state) {
+        auto q = Matrix::gram_schmidt(v);
+        benchmark::DoNotOptimize(q.data());
+    }
+
+    state.counters["FLOPS"] = benchmark::Counter(2.0 * m * n * n,
+        benchmark::Counter::kIsIterationInvariantRate);
+    state.SetBytesProcessed(state.iterations() * 2 * (int64_t)m * n * sizeof(double));
+}
+
+BENCHMARK(BM_LinalgGramSchmidt)
+->Apply(CustomArgumentsOfLinalgTallSkinny)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Gram-Schmidt plus mn^2 for the dot products of R
+static void BM_LinalgQR(benchmark::State& state) {
+    const int m = state.range(0);
+    const int n = state.range(1);
+    Matrix::Matrix<double> A = tall_skinny(m, n);
+
+    for (auto _ : state) {
+        auto qr = Matrix::QR(A);
+        benchmark::DoNotOptimize(qr[1].data());
+    }
+
+    state.counters["FLOPS"] = benchmark::Counter(3.0 * m * n * n,
+        benchmark::Counter::kIsIterationInvariantRate);
+    // A in, Q and R out
+    state.SetBytesProcessed(state.iterations() * (2 * (int64_t)m * n + (int64_t)n * n) * sizeof(double));
+}
+
+BENCHMARK(BM_LinalgQR)
+->Apply(CustomArgumentsOfLinalgTallSkinny)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+//------------------------------------
+
+static void CustomArgumentsOfLinalgBatched(benchmark::internal::Benchmark* b) {
+    b->Args({100000, 2});
+    b->Args({100000, 4});
+    b->Args({10000, 8});
+    b->Args({1000, 32});
+    b->Args({100, 128});
+}
+
+static void BM_LinalgBatchedInv(benchmark::State& state) {
+    const int batch = state.range(0);
+    const int n = state.range(1);
+    Matrix::Matrix<double> A = batched_diagonally_dominant(batch, n);
+    std::vector<bool> singular;
+
+    for (auto _ : state) {
+        Matrix::Matrix<double> B = Matrix::batched_inv(A, singular);
+        benchmark::DoNotOptimize(B.data());
+    }
+
+    state.counters["FLOPS"] = benchmark::Counter(2.0 * batch * n * n * n,
+        benchmark::Counter::kIsIterationInvariantRate);
+    state.SetBytesProcessed(state.iterations() * 2 * (int64_t)batch * n * n * sizeof(double));
+}
+
+BENCHMARK(BM_LinalgBatchedInv)
+->Apply(CustomArgumentsOfLinalgBatched)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_LinalgBatchedDet(benchmark::State& state) {
+    const int batch = state.range(0);
+    const int n = state.range(1);
+    Matrix::Matrix<double> A = batched_diagonally_dominant(batch, n);
+
+    for (auto _ : state) {
+        Matrix::Matrix<double> D = Matrix::batched_det(A);
+        benchmark::DoNotOptimize(D.data());
+    }
+
+    state.counters["FLOPS"] = benchmark::Counter(2.0 / 3.0 * batch * n * n * n,
+        benchmark::Counter::kIsIterationInvariantRate);
+    state.SetBytesProcessed(state.iterations() * (int64_t)batch * n * n * sizeof(double));
+}
+
+BENCHMARK(BM_LinalgBatchedDet)
+->Apply(CustomArgumentsOfLinalgBatched)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_LinalgBatchedSolve(benchmark::State& state) {
+    const int batch = state.range(0);
+    const int n = state.range(1);
+    Matrix::Matrix<double> A = batched_diagonally_dominant(batch, n);
+    Matrix::Matrix<double> B(batch, n);
+    std::vector<bool> singular;
+
+    for (auto _ : state) {
+        Matrix::Matrix<double> X = Matrix::batched_solve(A, B, singular);
+        benchmark::DoNotOptimize(X.data());
+    }
+
+    state.counters["FLOPS"] = benchmark::Counter(2.0 / 3.0 * batch * n * n * n + 2.0 * batch * n * n,
+        benchmark::Counter::kIsIterationInvariantRate);
+    state.SetBytesProcessed(state.iterations() * ((int64_t)batch * n * n + 2 * (int64_t)batch * n) * sizeof(double));
+}
+
+BENCHMARK(BM_LinalgBatchedSolve)
+->Apply(CustomArgumentsOfLinalgBatched)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+//------------------------------------
+
+static void CustomArgumentsOfLinalgVector(benchmark::internal::Benchmark* b) {
+    for (int n = 1 << 12; n <= 1 << 22; n <<= 5)
+        b->Args({n});
+}
+
+static void BM_LinalgVectorDot(benchmark::State& state) {
+    const int n = state.range(0);
+    Matrix::Vector<double> u(n, 1);
+    Matrix::Vector<double> v(n, 1);
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(Matrix::vector_dot(u, v));
+
+    state.counters["FLOPS"] = benchmark::Counter(2.0 * n,
+        benchmark::Counter::kIsIterationInvariantRate);
+    state.SetBytesProcessed(state.iterations() * 2 * (int64_t)n * sizeof(double));
+}
+
+BENCHMARK(BM_LinalgVectorDot)
+->Apply(CustomArgumentsOfLinalgVector)->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+static void CustomArgumentsOfLinalgColumnVectors(benchmark::internal::Benchmark* b) {
+    b->Args({1024, 1024});
+    b->Args({4096, 64});
+    b->Args({64, 4096});
+}
+
+static void BM_LinalgToColumnVectors(benchmark::State& state) {
+    Matrix::Matrix<double> A(state.range(0), state.range(1));
+
+    for (auto _ : state) {
+        auto v = Matrix::to_column_vectors(A);
+        benchmark::DoNotOptimize(v.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * 2 * state.range(0) * state.range(1) * sizeof(double));
+}
+
+BENCHMARK(BM_LinalgToColumnVectors)
+->Apply(CustomArgumentsOfLinalgColumnVectors)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_LinalgFromColumnVectors(benchmark::State& state) {
+    auto v = Matrix::to_column_vectors(Matrix::Matrix<double>(state.range(0), state.range(1)));
+
+    for (auto _ : state) {
+        Matrix::Matrix<double> A = Matrix::from_column_vectors(v);
+        benchmark::DoNotOptimize(A.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * 2 * state.range(0) * state.range(1) * sizeof(double));
+}
+
+BENCHMARK(BM_LinalgFromColumnVectors)
+->Apply(CustomArgumentsOfLinalgColumnVectors)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_LinalgToRowVectors(benchmark::State& state) {
+    Matrix::Matrix<double> A(state.range(0), state.range(1));
+
+    for (auto _ : state) {
+        auto v = Matrix::to_row_vectors(A);
+        benchmark::DoNotOptimize(v.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * 2 * state.range(0) * state.range(1) * sizeof(double));
+}
+
+BENCHMARK(BM_LinalgToRowVectors)
+->Apply(CustomArgumentsOfLinalgColumnVectors)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -1,5 +1,26 @@
 #include <benchmark/benchmark.h>
 #include <atrix/matrix.h>
+#include <atrix/reductions.h>
+#include <atrix/distributions.h>
+#include <atrix/half.h>
+#include <atrix/quantize.h>
+#include <atrix/packed.h>
+#include <atrix/epilogue.h>
+#include <atrix/softmax.h>
+#include <atrix/npy.h>
+#include <atrix/mapped.h>
+#include <atrix/outofcore.h>
+#include <atrix/csv.h>
+#include <atrix/tracing.h>
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
 
 static void CustomArgumentsOfMatrixCreate(benchmark::internal::Benchmark* b) {
     for (int i = 1; i < 10; i <<= 2)
@@ -148,6 +169,32 @@ BENCHMARK(BM_MatrixOperatorPlusByMatrix)
 
 //------------------------------------
 
+static void CustomArgumentsOfMatrixOperatorPlusByBroadcast(benchmark::internal::Benchmark* b) {
+    for (int i = 1; i <= 4096; i <<= 4)
+        for (int j = 1; j <= 4096; j <<= 4)
+            for (int row = 0; row < 2; row++)
+                b->Args({i, j, row});
+}
+
+// adds the row vector (1, M) or the column vector (N, 1) to every line of the (N, M) matrix
+static void BM_MatrixOperatorPlusByBroadcast(benchmark::State& state) {
+    Matrix::Matrix<double> A(state.range(0), state.range(1));
+    Matrix::Matrix<double> v = state.range(2) ? Matrix::Matrix<double>(1, state.range(1))
+                                              : Matrix::Matrix<double>(state.range(0), 1);
+
+    for (auto _ : state) {
+        A += v;
+        benchmark::DoNotOptimize(A.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * 2 * A.get_matrix_size() * sizeof(double));
+}
+
+BENCHMARK(BM_MatrixOperatorPlusByBroadcast)
+->Apply(CustomArgumentsOfMatrixOperatorPlusByBroadcast);
+
+//------------------------------------
+
 static void CustomArgumentsOfMatrixOperatorMinusByElement(benchmark::internal::Benchmark* b) {
     for (int i = 1; i < 10; i <<= 2)
         for (int j = 1; j < 10; j <<= 2)
@@ -269,6 +316,774 @@ BENCHMARK(BM_MatrixDot)
 
 //------------------------------------
 
+static void CustomArgumentsOfMatrixGemv(benchmark::internal::Benchmark* b) {
+    for (int i = 64; i <= 8192; i <<= 2)
+        for (int j = 64; j <= 8192; j <<= 2)
+            for (int t = 0; t < 2; t++)
+                b->Args({i, j, t});
+}
+
+static void BM_MatrixGemv(benchmark::State& state) {
+    Matrix::Matrix<double> A(state.range(0), state.range(1));
+    bool transpose = state.range(2);
+
+    Matrix::Matrix<double> x = Matrix::ones<double>(transpose ? state.range(0) : state.range(1), 1);
+    Matrix::Matrix<double> y = Matrix::zeros<double>(transpose ? state.range(1) : state.range(0), 1);
+
+    for (auto _ : state) {
+        Matrix::gemv(1.0, A, x, 0.0, y, transpose);
+        benchmark::DoNotOptimize(y.data());
+    }
+
+    // the matrix dominates the memory traffic
+    state.SetBytesProcessed(state.iterations() * A.get_matrix_size() * sizeof(double));
+}
+
+BENCHMARK(BM_MatrixGemv)
+->Apply(CustomArgumentsOfMatrixGemv);
+
+//------------------------------------
+
+static void CustomArgumentsOfMatrixGramMatrix(benchmark::internal::Benchmark* b) {
+    for (int i = 64; i <= 1024; i <<= 2)
+        for (int j = 64; j <= 1024; j <<= 2)
+            b->Args({i, j});
+}
+
+// X^T X by materializing the transpose
+static void BM_MatrixGramMatrixTranspoze(benchmark::State& state) {
+    Matrix::Matrix<double> X(state.range(0), state.range(1));
+
+    for (auto _ : state) {
+        Matrix::Matrix<double> G = Matrix::dot(Matrix::transpoze(X), X);
+        benchmark::DoNotOptimize(G.data());
+    }
+
+    state.counters["FLOPS"] = benchmark::Counter(2.0 * state.range(0) * state.range(1) * state.range(1),
+        benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK(BM_MatrixGramMatrixTranspoze)
+->Apply(CustomArgumentsOfMatrixGramMatrix);
+
+// X^T X by the transpose flag of gemm into a preallocated output
+static void BM_MatrixGramMatrixGemm(benchmark::State& state) {
+    Matrix::Matrix<double> X(state.range(0), state.range(1));
+    Matrix::Matrix<double> G(state.range(1), state.range(1));
+
+    for (auto _ : state) {
+        Matrix::gemm(1.0, X, X, 0.0, G, true, false);
+        benchmark::DoNotOptimize(G.data());
+    }
+
+    state.counters["FLOPS"] = benchmark::Counter(2.0 * state.range(0) * state.range(1) * state.range(1),
+        benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK(BM_MatrixGramMatrixGemm)
+->Apply(CustomArgumentsOfMatrixGramMatrix);
+
+// X^T X by computing only the lower triangle and mirroring it
+static void BM_MatrixGramMatrixSyrk(benchmark::State& state) {
+    Matrix::Matrix<double> X(state.range(0), state.range(1));
+    Matrix::Matrix<double> G(state.range(1), state.range(1));
+
+    for (auto _ : state) {
+        Matrix::syrk(1.0, X, 0.0, G, true);
+        benchmark::DoNotOptimize(G.data());
+    }
+
+    // the same rate as gemm means the half of the time
+    state.counters["FLOPS"] = benchmark::Counter(2.0 * state.range(0) * state.range(1) * state.range(1),
+        benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK(BM_MatrixGramMatrixSyrk)
+->Apply(CustomArgumentsOfMatrixGramMatrix);
+
+//------------------------------------
+
+static void CustomArgumentsOfMatrixDotMixedPrecision(benchmark::internal::Benchmark* b) {
+    for (int i = 64; i <= 1024; i <<= 2)
+        b->Args({i});
+}
+
+// the square product of the random matrices in double, the reference of the 16 bit ones
+static void BM_MatrixDotDouble(benchmark::State& state) {
+    const int N = state.range(0);
+    Matrix::Generator gen(1);
+    Matrix::Matrix<double> A(N, N);
+    Matrix::Matrix<double> B(N, N);
+    Matrix::uniform(A, -1.0, 1.0, gen);
+    Matrix::uniform(B, -1.0, 1.0, gen);
+
+    for (auto _ : state) {
+        Matrix::Matrix<double> C = Matrix::dot(A, B);
+        benchmark::DoNotOptimize(C.data());
+    }
+
+    state.counters["FLOPS"] = benchmark::Counter(2.0 * N * N * N,
+        benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK(BM_MatrixDotDouble)
+->Apply(CustomArgumentsOfMatrixDotMixedPrecision);
+
+// the same product stored in 16 bits and accumulated in float, max_error is
+// the largest absolute difference from the double product
+template <typename Half>
+static void MatrixDotHalf(benchmark::State& state) {
+    const int N = state.range(0);
+    Matrix::Generator gen(1);
+    Matrix::Matrix<double> A(N, N);
+    Matrix::Matrix<double> B(N, N);
+    Matrix::uniform(A, -1.0, 1.0, gen);
+    Matrix::uniform(B, -1.0, 1.0, gen);
+
+    Matrix::Matrix<Half> A16 = Matrix::astype<Half>(A);
+    Matrix::Matrix<Half> B16 = Matrix::astype<Half>(B);
+
+    for (auto _ : state) {
+        Matrix::Matrix<float> C = Matrix::dot(A16, B16);
+        benchmark::DoNotOptimize(C.data());
+    }
+
+    Matrix::Matrix<double> error = Matrix::astype<double>(Matrix::dot(A16, B16)) - Matrix::dot(A, B);
+    state.counters["max_error"] = Matrix::norm(error, INFINITY);
+    state.counters["FLOPS"] = benchmark::Counter(2.0 * N * N * N,
+        benchmark::Counter::kIsIterationInvariantRate);
+}
+
+static void BM_MatrixDotFloat16(benchmark::State& state) {
+    MatrixDotHalf<Matrix::float16>(state);
+}
+
+BENCHMARK(BM_MatrixDotFloat16)
+->Apply(CustomArgumentsOfMatrixDotMixedPrecision);
+
+static void BM_MatrixDotBFloat16(benchmark::State& state) {
+    MatrixDotHalf<Matrix::bfloat16>(state);
+}
+
+BENCHMARK(BM_MatrixDotBFloat16)
+->Apply(CustomArgumentsOfMatrixDotMixedPrecision);
+
+static void BM_MatrixAstypeFloat16(benchmark::State& state) {
+    Matrix::Matrix<float> A(state.range(0), state.range(0));
+
+    for (auto _ : state) {
+        Matrix::Matrix<Matrix::float16> H = Matrix::astype<Matrix::float16>(A);
+        benchmark::DoNotOptimize(H.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * A.get_matrix_size());
+}
+
+BENCHMARK(BM_MatrixAstypeFloat16)
+->Apply(CustomArgumentsOfMatrixDotMixedPrecision);
+
+// the float product of the weights W with the activations X, the reference of the int8 ones
+static void BM_MatrixDotFloat(benchmark::State& state) {
+    const int N = state.range(0);
+    Matrix::Generator gen(1);
+    Matrix::Matrix<float> X(N, N);
+    Matrix::Matrix<float> W(N, N);
+    Matrix::uniform(X, 0.0f, 1.0f, gen);
+    Matrix::normal(W, 0.0f, 1.0f, gen);
+
+    for (auto _ : state) {
+        Matrix::Matrix<float> C = Matrix::dot(X, W);
+        benchmark::DoNotOptimize(C.data());
+    }
+
+    state.counters["FLOPS"] = benchmark::Counter(2.0 * N * N * N,
+        benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK(BM_MatrixDotFloat)
+->Apply(CustomArgumentsOfMatrixDotMixedPrecision);
+
+// the same product with the int8 weights (a scale for every column) and the int8
+// activations (a scale and a zero point for every row), max_error is the largest
+// absolute difference from the float product; the dynamic one quantizes X in
+// every iteration
+static void MatrixDotInt8(benchmark::State& state, const bool dynamic) {
+    const int N = state.range(0);
+    Matrix::Generator gen(1);
+    Matrix::Matrix<float> X(N, N);
+    Matrix::Matrix<float> W(N, N);
+    Matrix::uniform(X, 0.0f, 1.0f, gen);
+    Matrix::normal(W, 0.0f, 1.0f, gen);
+
+    Matrix::QuantizedMatrix QX = Matrix::quantize(X, 0, false);
+    Matrix::QuantizedMatrix QW = Matrix::quantize(W, 1);
+
+    for (auto _ : state) {
+        Matrix::Matrix<float> C = dynamic ? Matrix::dot(X, QW) : Matrix::dot(QX, QW);
+        benchmark::DoNotOptimize(C.data());
+    }
+
+    Matrix::Matrix<float> error = Matrix::dot(QX, QW) - Matrix::dot(X, W);
+    state.counters["max_error"] = Matrix::norm(error, INFINITY);
+    state.counters["FLOPS"] = benchmark::Counter(2.0 * N * N * N,
+        benchmark::Counter::kIsIterationInvariantRate);
+}
+
+static void BM_MatrixDotInt8(benchmark::State& state) {
+    MatrixDotInt8(state, false);
+}
+
+BENCHMARK(BM_MatrixDotInt8)
+->Apply(CustomArgumentsOfMatrixDotMixedPrecision);
+
+static void BM_MatrixDotInt8Dynamic(benchmark::State& state) {
+    MatrixDotInt8(state, true);
+}
+
+BENCHMARK(BM_MatrixDotInt8Dynamic)
+->Apply(CustomArgumentsOfMatrixDotMixedPrecision);
+
+static void BM_MatrixQuantize(benchmark::State& state) {
+    Matrix::Matrix<float> A(state.range(0), state.range(0));
+
+    for (auto _ : state) {
+        Matrix::QuantizedMatrix Q = Matrix::quantize(A, 1);
+        benchmark::DoNotOptimize(Q.values.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * A.get_matrix_size());
+}
+
+BENCHMARK(BM_MatrixQuantize)
+->Apply(CustomArgumentsOfMatrixDotMixedPrecision);
+
+//------------------------------------
+
+// the batch of the activations, and the size of the square weights
+static void CustomArgumentsOfMatrixDotPacked(benchmark::internal::Benchmark* b) {
+    for (int batch = 1; batch <= 32; batch <<= 1)
+        b->Args({batch, 1024});
+}
+
+// the skinny activations X times the same large weights W, W is packed in every call
+static void BM_MatrixDotWeights(benchmark::State& state) {
+    Matrix::Matrix<float> X(state.range(0), state.range(1));
+    Matrix::Matrix<float> W(state.range(1), state.range(1));
+
+    for (auto _ : state) {
+        Matrix::Matrix<float> Y = Matrix::dot(X, W);
+        benchmark::DoNotOptimize(Y.data());
+    }
+
+    state.counters["FLOPS"] = benchmark::Counter(2.0 * X.get_matrix_size() * state.range(1),
+        benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK(BM_MatrixDotWeights)
+->Apply(CustomArgumentsOfMatrixDotPacked);
+
+// the same product with W packed once before the loop
+static void BM_MatrixDotPackedWeights(benchmark::State& state) {
+    Matrix::Matrix<float> X(state.range(0), state.range(1));
+    Matrix::Matrix<float> W(state.range(1), state.range(1));
+    Matrix::PackedMatrix<float> PW(W);
+
+    for (auto _ : state) {
+        Matrix::Matrix<float> Y = Matrix::dot(X, PW);
+        benchmark::DoNotOptimize(Y.data());
+    }
+
+    state.counters["FLOPS"] = benchmark::Counter(2.0 * X.get_matrix_size() * state.range(1),
+        benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK(BM_MatrixDotPackedWeights)
+->Apply(CustomArgumentsOfMatrixDotPacked);
+
+//------------------------------------
+
+// the batch of the inputs and the width of the square layer
+static void CustomArgumentsOfMatrixDense(benchmark::internal::Benchmark* b) {
+    for (int width = 1024; width <= 4096; width <<= 1)
+        b->Args({256, width});
+}
+
+// sigmoid(X W + b) in three passes with two temporary matrices
+static void BM_MatrixDenseUnfused(benchmark::State& state) {
+    Matrix::Matrix<double> X(state.range(0), state.range(1));
+    Matrix::Matrix<double> W(state.range(1), state.range(1));
+    Matrix::Matrix<double> b(1, state.range(1));
+
+    for (auto _ : state) {
+        Matrix::Matrix<double> Y = Matrix::sigmoid(Matrix::dot(X, W) + b);
+        benchmark::DoNotOptimize(Y.data());
+    }
+
+    state.counters["FLOPS"] = benchmark::Counter(2.0 * X.get_matrix_size() * state.range(1),
+        benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK(BM_MatrixDenseUnfused)
+->Apply(CustomArgumentsOfMatrixDense)
+->Unit(benchmark::kMillisecond);
+
+// the same layer with the bias and the sigmoid in the epilogue of gemm
+static void BM_MatrixDenseFused(benchmark::State& state) {
+    Matrix::Matrix<double> X(state.range(0), state.range(1));
+    Matrix::Matrix<double> W(state.range(1), state.range(1));
+    Matrix::Matrix<double> b(1, state.range(1));
+
+    for (auto _ : state) {
+        Matrix::Matrix<double> Y = Matrix::dense(X, W, b, Matrix::Activation::SIGMOID);
+        benchmark::DoNotOptimize(Y.data());
+    }
+
+    state.counters["FLOPS"] = benchmark::Counter(2.0 * X.get_matrix_size() * state.range(1),
+        benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK(BM_MatrixDenseFused)
+->Apply(CustomArgumentsOfMatrixDense)
+->Unit(benchmark::kMillisecond);
+
+//------------------------------------
+
+// the rows and the length of the rows of the logits
+static void CustomArgumentsOfMatrixSoftmax(benchmark::internal::Benchmark* b) {
+    b->Args({4096, 64});
+    b->Args({1024, 1024});
+    b->Args({64, 16384});
+    b->Args({1, 1 << 20});
+}
+
+// softmax composed from exp, the row sums and the division of the rows, it
+// overflows for the logits above about 709
+static void BM_MatrixSoftmaxComposed(benchmark::State& state) {
+    const int rows = state.range(0);
+    const int length = state.range(1);
+    Matrix::Matrix<double> A(rows, length);
+    Matrix::normal(A, 0.0, 1.0);
+
+    for (auto _ : state) {
+        Matrix::Matrix<double> E = Matrix::exp(A);
+        Matrix::Matrix<double> S = Matrix::sum(E, 1, true);
+
+        double* e = E.data();
+        for (int i = 0; i < rows; i++)
+            for (int j = 0; j < length; j++)
+                e[static_cast<long>(i) * length + j] /= S(i, 0);
+
+        benchmark::DoNotOptimize(E.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * A.get_matrix_size());
+}
+
+BENCHMARK(BM_MatrixSoftmaxComposed)
+->Apply(CustomArgumentsOfMatrixSoftmax);
+
+static void BM_MatrixSoftmax(benchmark::State& state) {
+    Matrix::Matrix<double> A(state.range(0), state.range(1));
+    Matrix::normal(A, 0.0, 1.0);
+
+    for (auto _ : state) {
+        Matrix::Matrix<double> P = Matrix::softmax(A);
+        benchmark::DoNotOptimize(P.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * A.get_matrix_size());
+}
+
+BENCHMARK(BM_MatrixSoftmax)
+->Apply(CustomArgumentsOfMatrixSoftmax);
+
+// the softmax along the columns, the rows of the blocks are strided
+static void BM_MatrixSoftmaxAxis0(benchmark::State& state) {
+    Matrix::Matrix<double> A(state.range(1), state.range(0));
+    Matrix::normal(A, 0.0, 1.0);
+
+    for (auto _ : state) {
+        Matrix::Matrix<double> P = Matrix::softmax(A, 0);
+        benchmark::DoNotOptimize(P.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * A.get_matrix_size());
+}
+
+BENCHMARK(BM_MatrixSoftmaxAxis0)
+->Apply(CustomArgumentsOfMatrixSoftmax);
+
+static void BM_MatrixLogSoftmax(benchmark::State& state) {
+    Matrix::Matrix<double> A(state.range(0), state.range(1));
+    Matrix::normal(A, 0.0, 1.0);
+
+    for (auto _ : state) {
+        Matrix::Matrix<double> L = Matrix::log_softmax(A);
+        benchmark::DoNotOptimize(L.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * A.get_matrix_size());
+}
+
+BENCHMARK(BM_MatrixLogSoftmax)
+->Apply(CustomArgumentsOfMatrixSoftmax);
+
+static void BM_MatrixLogSumExp(benchmark::State& state) {
+    Matrix::Matrix<double> A(state.range(0), state.range(1));
+    Matrix::normal(A, 0.0, 1.0);
+
+    for (auto _ : state) {
+        Matrix::Matrix<double> L = Matrix::logsumexp(A, 1);
+        benchmark::DoNotOptimize(L.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * A.get_matrix_size());
+}
+
+BENCHMARK(BM_MatrixLogSumExp)
+->Apply(CustomArgumentsOfMatrixSoftmax);
+
+//------------------------------------
+
+// the files of 1 MB, 16 MB and 256 MB, the last one is larger than the caches
+static void CustomArgumentsOfMatrixLoad(benchmark::internal::Benchmark* b) {
+    for (long megabytes : {1, 16, 256})
+        b->Args({megabytes << 20});
+}
+
+static std::string npy_benchmark_file(const long bytes) {
+    const std::string path = "/tmp/matrix_benchmark_" + std::to_string(bytes) + ".npy";
+
+    Matrix::Matrix<float> A(bytes / sizeof(float));
+    Matrix::save(path, A);
+    return path;
+}
+
+// drops the file from the page cache, so that the next read is from the disk
+static void evict_page_cache(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+// the raw read of the file into the new buffer, the bandwidth that load can reach
+static void BM_FileRead(benchmark::State& state) {
+    const std::string path = npy_benchmark_file(state.range(0));
+
+    for (auto _ : state) {
+        std::unique_ptr<char[]> buffer(new char[state.range(0) + 4096]);
+        std::ifstream in(path, std::ios::binary);
+        in.read(buffer.get(), state.range(0) + 4096);
+        benchmark::DoNotOptimize(buffer.get());
+    }
+
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+    std::remove(path.c_str());
+}
+
+BENCHMARK(BM_FileRead)
+->Apply(CustomArgumentsOfMatrixLoad)
+->Unit(benchmark::kMillisecond)
+->UseRealTime();
+
+static void BM_MatrixLoadNpy(benchmark::State& state) {
+    const std::string path = npy_benchmark_file(state.range(0));
+
+    for (auto _ : state) {
+        Matrix::Matrix<float> A = Matrix::load<float>(path);
+        benchmark::DoNotOptimize(A.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+    std::remove(path.c_str());
+}
+
+BENCHMARK(BM_MatrixLoadNpy)
+->Apply(CustomArgumentsOfMatrixLoad)
+->Unit(benchmark::kMillisecond)
+->UseRealTime();
+
+static void BM_MatrixLoadNpyCold(benchmark::State& state) {
+    const std::string path = npy_benchmark_file(state.range(0));
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        evict_page_cache(path);
+        state.ResumeTiming();
+
+        Matrix::Matrix<float> A = Matrix::load<float>(path);
+        benchmark::DoNotOptimize(A.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+    std::remove(path.c_str());
+}
+
+BENCHMARK(BM_MatrixLoadNpyCold)
+->Apply(CustomArgumentsOfMatrixLoad)
+->Unit(benchmark::kMillisecond)
+->UseRealTime();
+
+// opening the file without reading it, the startup latency
+static void BM_MatrixOpenMapped(benchmark::State& state) {
+    const std::string path = npy_benchmark_file(state.range(0));
+
+    for (auto _ : state) {
+        Matrix::Matrix<float> A = Matrix::open_mapped<float>(path, Matrix::Mapping::READ_ONLY);
+        benchmark::DoNotOptimize(A.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+    std::remove(path.c_str());
+}
+
+BENCHMARK(BM_MatrixOpenMapped)
+->Apply(CustomArgumentsOfMatrixLoad)
+->Unit(benchmark::kMillisecond)
+->UseRealTime();
+
+// opening the file and touching every page of it once
+static void BM_MatrixOpenMappedSum(benchmark::State& state) {
+    const std::string path = npy_benchmark_file(state.range(0));
+
+    for (auto _ : state) {
+        Matrix::Matrix<float> A = Matrix::open_mapped<float>(path, Matrix::Mapping::READ_ONLY,
+                                                            Matrix::Advice::SEQUENTIAL);
+        benchmark::DoNotOptimize(Matrix::sum(A));
+    }
+
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+    std::remove(path.c_str());
+}
+
+BENCHMARK(BM_MatrixOpenMappedSum)
+->Apply(CustomArgumentsOfMatrixLoad)
+->Unit(benchmark::kMillisecond)
+->UseRealTime();
+
+//------------------------------------
+
+// every matrix of the out-of-core benchmarks is 4 times the memory budget
+static void CustomArgumentsOfMatrixOutOfCore(benchmark::internal::Benchmark* b) {
+    b->Args({1024});
+    b->Args({2048});
+}
+
+static void BM_MatrixDotInMemory(benchmark::State& state) {
+    const int N = state.range(0);
+    Matrix::Matrix<float> A(N, N);
+    Matrix::Matrix<float> B(N, N);
+    Matrix::uniform(A, -1.0f, 1.0f);
+    Matrix::uniform(B, -1.0f, 1.0f);
+
+    for (auto _ : state) {
+        Matrix::Matrix<float> C = Matrix::dot(A, B);
+        benchmark::DoNotOptimize(C.data());
+    }
+
+    state.counters["FLOPS"] = benchmark::Counter(2.0 * N * N * N,
+        benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK(BM_MatrixDotInMemory)
+->Apply(CustomArgumentsOfMatrixOutOfCore)
+->Unit(benchmark::kMillisecond)
+->UseRealTime();
+
+static void BM_MatrixDotOutOfCore(benchmark::State& state) {
+    const int N = state.range(0);
+    const std::string a_path = "/tmp/matrix_benchmark_A.npy";
+    const std::string b_path = "/tmp/matrix_benchmark_B.npy";
+    const std::string c_path = "/tmp/matrix_benchmark_C.npy";
+    {
+        Matrix::Matrix<float> A(N, N);
+        Matrix::uniform(A, -1.0f, 1.0f);
+        Matrix::save(a_path, A);
+        Matrix::save(b_path, A);
+    }
+
+    const std::size_t budget = Matrix::get_memory_budget();
+    Matrix::set_memory_budget(std::size_t(N) * N * sizeof(float) / 4);
+
+    Matrix::FileMatrix<float> A(a_path);
+    Matrix::FileMatrix<float> B(b_path);
+    Matrix::FileMatrix<float> C(c_path, {N, N});
+
+    for (auto _ : state)
+        Matrix::dot(A, B, C);
+
+    state.counters["FLOPS"] = benchmark::Counter(2.0 * N * N * N,
+        benchmark::Counter::kIsIterationInvariantRate);
+
+    Matrix::set_memory_budget(budget);
+    for (auto path : {a_path, b_path, c_path})
+        std::remove(path.c_str());
+}
+
+BENCHMARK(BM_MatrixDotOutOfCore)
+->Apply(CustomArgumentsOfMatrixOutOfCore)
+->Unit(benchmark::kMillisecond)
+->UseRealTime();
+
+static void BM_MatrixSumOutOfCore(benchmark::State& state) {
+    const int N = state.range(0);
+    const std::string path = "/tmp/matrix_benchmark_sum.npy";
+    {
+        Matrix::Matrix<float> A(N, N);
+        Matrix::save(path, A);
+    }
+
+    const std::size_t budget = Matrix::get_memory_budget();
+    Matrix::set_memory_budget(std::size_t(N) * N * sizeof(float) / 4);
+    Matrix::FileMatrix<float> A(path);
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(Matrix::sum(A, 0));
+
+    state.SetBytesProcessed(state.iterations() * N * N * sizeof(float));
+
+    Matrix::set_memory_budget(budget);
+    std::remove(path.c_str());
+}
+
+BENCHMARK(BM_MatrixSumOutOfCore)
+->Apply(CustomArgumentsOfMatrixOutOfCore)
+->Unit(benchmark::kMillisecond)
+->UseRealTime();
+
+//------------------------------------
+
+// the CSV file of rows x 16 random numbers with 8 digits, written once
+static std::string csv_benchmark_file(const int rows) {
+    const std::string path = "/tmp/matrix_benchmark_" + std::to_string(rows) + ".csv";
+
+    std::ifstream exists(path);
+    if (exists)
+        return path;
+
+    Matrix::Matrix<double> A(rows, 16);
+    Matrix::uniform(A, -1000.0, 1000.0);
+
+    std::ofstream out(path);
+    out.precision(8);
+    for (int i = 0; i < rows; i++)
+        for (int j = 0; j < 16; j++)
+            out << A(i, j) << ((j < 15) ? ',' : '\n');
+
+    return path;
+}
+
+static long file_size(const std::string& path) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    return in.tellg();
+}
+
+static void CustomArgumentsOfMatrixLoadCsv(benchmark::internal::Benchmark* b) {
+    for (int threads : {1, 4})
+        b->Args({1 << 18, threads});
+}
+
+// the line by line iostream parsing into the matrix, the baseline
+static void BM_MatrixLoadCsvIostream(benchmark::State& state) {
+    const std::string path = csv_benchmark_file(state.range(0));
+
+    for (auto _ : state) {
+        Matrix::Matrix<double> A(state.range(0), 16);
+        std::ifstream in(path);
+        std::string line;
+
+        for (int i = 0; std::getline(in, line); i++) {
+            std::istringstream fields(line);
+            std::string field;
+            for (int j = 0; std::getline(fields, field, ','); j++)
+                A(i, j) = std::stod(field);
+        }
+
+        benchmark::DoNotOptimize(A.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * file_size(path));
+}
+
+BENCHMARK(BM_MatrixLoadCsvIostream)
+->Args({1 << 18, 1})
+->Unit(benchmark::kMillisecond)
+->UseRealTime();
+
+static void BM_MatrixLoadCsv(benchmark::State& state) {
+    const std::string path = csv_benchmark_file(state.range(0));
+    Matrix::set_num_threads(state.range(1));
+
+    for (auto _ : state) {
+        Matrix::Matrix<double> A = Matrix::load_csv<double>(path);
+        benchmark::DoNotOptimize(A.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * file_size(path));
+    Matrix::set_num_threads(1);
+}
+
+BENCHMARK(BM_MatrixLoadCsv)
+->Apply(CustomArgumentsOfMatrixLoadCsv)
+->Unit(benchmark::kMillisecond)
+->UseRealTime();
+
+static void BM_MatrixReadCsvBatches(benchmark::State& state) {
+    const std::string path = csv_benchmark_file(state.range(0));
+    Matrix::set_num_threads(state.range(1));
+
+    for (auto _ : state) {
+        Matrix::CsvReader<double> reader(path, 16384);
+        while (reader.has_next()) {
+            Matrix::Matrix<double> batch = reader.next();
+            benchmark::DoNotOptimize(batch.data());
+        }
+    }
+
+    state.SetBytesProcessed(state.iterations() * file_size(path));
+    Matrix::set_num_threads(1);
+}
+
+BENCHMARK(BM_MatrixReadCsvBatches)
+->Apply(CustomArgumentsOfMatrixLoadCsv)
+->Unit(benchmark::kMillisecond)
+->UseRealTime();
+
+static void BM_MatrixLoadText(benchmark::State& state) {
+    const std::string path = "/tmp/matrix_benchmark_" + std::to_string(state.range(0)) + ".txt";
+    const long count = state.range(0) / sizeof(float);
+
+    {
+        Matrix::Matrix<float> A(count);
+        std::ofstream out(path);
+        for (long i = 0; i < count; i++)
+            out << A(i) << '\n';
+    }
+
+    for (auto _ : state) {
+        Matrix::Matrix<float> A(count);
+        std::ifstream in(path);
+        for (long i = 0; i < count; i++)
+            in >> A(i);
+        benchmark::DoNotOptimize(A.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+    std::remove(path.c_str());
+}
+
+BENCHMARK(BM_MatrixLoadText)
+->Arg(1 << 20)
+->Arg(16 << 20)
+->Unit(benchmark::kMillisecond)
+->UseRealTime();
+
+//------------------------------------
+
 static void CustomArgumentsOfMatrixSigmoid(benchmark::internal::Benchmark* b) {
     for (int i = 1; i < 10; i <<= 2)
         for (int j = 1; j < 10; j <<= 2)
@@ -394,6 +1209,10 @@ static void CustomArgumentsOfMatrixRandom(benchmark::internal::Benchmark* b) {
         for (int j = 1; j < 10; j <<= 2)
             for (int k = 1; k < 1000; k <<= 3)
                 b->Args({i, j, k});
+
+    // 1M and 16M elements for the fill throughput
+    b->Args({1, 1024, 1024});
+    b->Args({16, 1024, 1024});
 }
 
 void MatrixRandom(Matrix::Matrix<double> A) {
@@ -406,11 +1225,74 @@ static void BM_MatrixRandom(benchmark::State& state) {
 
     for (auto _ : state)
         MatrixRandom(A);
+
+    state.SetItemsProcessed(state.iterations() * A.get_matrix_size());
 }
 
 BENCHMARK(BM_MatrixRandom)
 ->Apply(CustomArgumentsOfMatrixRandom);
 
+// the fills of the distributions with the same shapes as BM_MatrixRandom
+static void BM_MatrixUniform(benchmark::State& state) {
+    Matrix::Generator gen(42);
+    Matrix::Matrix<double> A(state.range(0), state.range(1), state.range(2));
+
+    for (auto _ : state) {
+        Matrix::uniform(A, -1.0, 1.0, gen);
+        benchmark::DoNotOptimize(A.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * A.get_matrix_size());
+}
+
+BENCHMARK(BM_MatrixUniform)
+->Apply(CustomArgumentsOfMatrixRandom);
+
+static void BM_MatrixNormal(benchmark::State& state) {
+    Matrix::Generator gen(42);
+    Matrix::Matrix<double> A(state.range(0), state.range(1), state.range(2));
+
+    for (auto _ : state) {
+        Matrix::normal(A, 0.0, 1.0, gen);
+        benchmark::DoNotOptimize(A.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * A.get_matrix_size());
+}
+
+BENCHMARK(BM_MatrixNormal)
+->Apply(CustomArgumentsOfMatrixRandom);
+
+static void BM_MatrixBernoulli(benchmark::State& state) {
+    Matrix::Generator gen(42);
+    Matrix::Matrix<double> A(state.range(0), state.range(1), state.range(2));
+
+    for (auto _ : state) {
+        Matrix::bernoulli(A, 0.5, gen);
+        benchmark::DoNotOptimize(A.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * A.get_matrix_size());
+}
+
+BENCHMARK(BM_MatrixBernoulli)
+->Apply(CustomArgumentsOfMatrixRandom);
+
+static void BM_MatrixTruncatedNormal(benchmark::State& state) {
+    Matrix::Generator gen(42);
+    Matrix::Matrix<double> A(state.range(0), state.range(1), state.range(2));
+
+    for (auto _ : state) {
+        Matrix::truncated_normal(A, 0.0, 1.0, 2.0, gen);
+        benchmark::DoNotOptimize(A.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * A.get_matrix_size());
+}
+
+BENCHMARK(BM_MatrixTruncatedNormal)
+->Apply(CustomArgumentsOfMatrixRandom);
+
 //------------------------------------
 
 static void CustomArgumentsOfMatrixReshape(benchmark::internal::Benchmark* b) {
@@ -488,9 +1370,13 @@ static void CustomArgumentsOfMatrixSwapRows(benchmark::internal::Benchmark* b) {
             for (int k = 1; k < i; k <<= 4)
                 for (int l = 1; l < i; l <<= 4)
                     b->Args({i, j, k, l});
+
+    // the rows of 1M elements
+    b->Args({2, 1 << 20, 0, 1});
+    b->Args({8, 1 << 20, 1, 6});
 }
 
-void MatrixSwapRows(Matrix::Matrix<double> A, int a, int b) {
+void MatrixSwapRows(Matrix::Matrix<double>& A, int a, int b) {
     Matrix::swap_rows(A, a, b);
 }
 
@@ -502,6 +1388,8 @@ static void BM_MatrixSwapRows(benchmark::State& state) {
     
     for (auto _ : state)
         MatrixSwapRows(A, a, b);
+
+    state.SetBytesProcessed(state.iterations() * 4 * state.range(1) * sizeof(double));
 }
 
 BENCHMARK(BM_MatrixSwapRows)
@@ -518,9 +1406,13 @@ static void CustomArgumentsOfMatrixReplaceRows(benchmark::internal::Benchmark* b
                     b->Args({i, j, k, l, 15});
                     //std::cout << "(dbg) : " << i << "|" << j << "|" << k << "|"  << l << std::endl;
                 }
+
+    // the rows of 1M elements
+    b->Args({2, 1 << 20, 0, 1, 15});
+    b->Args({8, 1 << 20, 1, 6, 15});
 }
 
-void MatrixReplaceRows(Matrix::Matrix<double> A, int a, int b, int scalar) {
+void MatrixReplaceRows(Matrix::Matrix<double>& A, int a, int b, int scalar) {
     Matrix::replace_rows(A, a, b, scalar);
 }
 
@@ -532,6 +1424,8 @@ static void BM_MatrixReplaceRows(benchmark::State& state) {
     int scalar = state.range(4);
     for (auto _ : state)
         MatrixReplaceRows(A, a, b, scalar);
+
+    state.SetBytesProcessed(state.iterations() * 3 * state.range(1) * sizeof(double));
 }
 
 BENCHMARK(BM_MatrixReplaceRows)
@@ -544,9 +1438,13 @@ static void CustomArgumentsOfMatrixScaleRow(benchmark::internal::Benchmark* b) {
         for (int j = 2; j < 300; j <<= 2)
             for (int k = 1; k < i; k <<= 4)
                 b->Args({i, j, k, 15});
+
+    // the rows of 1M elements
+    b->Args({2, 1 << 20, 1, 15});
+    b->Args({8, 1 << 20, 6, 15});
 }
 
-void MatrixScaleRow(Matrix::Matrix<double> A, int a, double b) {
+void MatrixScaleRow(Matrix::Matrix<double>& A, int a, double b) {
     Matrix::scale_row(A, a, b);
 }
 
@@ -558,6 +1456,8 @@ static void BM_MatrixScaleRow(benchmark::State& state) {
     
     for (auto _ : state)
         MatrixScaleRow(A, a, b);
+
+    state.SetBytesProcessed(state.iterations() * 2 * state.range(1) * sizeof(double));
 }
 
 BENCHMARK(BM_MatrixScaleRow)
@@ -565,25 +1465,323 @@ BENCHMARK(BM_MatrixScaleRow)
 
 //------------------------------------
 
+static void CustomArgumentsOfMatrixSwapColumns(benchmark::internal::Benchmark* b) {
+    for (int i = 16; i <= 4096; i <<= 2)
+        b->Args({i, i});
+}
+
+static void BM_MatrixSwapColumns(benchmark::State& state) {
+    Matrix::Matrix<double> A(state.range(0), state.range(1));
+    for (auto _ : state) {
+        Matrix::swap_columns(A, 0, state.range(1) - 1);
+        benchmark::DoNotOptimize(A.data());
+    }
+}
+
+BENCHMARK(BM_MatrixSwapColumns)
+->Apply(CustomArgumentsOfMatrixSwapColumns);
+
+// the trailing update of the first step of the elimination of the (N, N) matrix
+static void BM_MatrixRank1Update(benchmark::State& state) {
+    const int N = state.range(0);
+    Matrix::Matrix<double> A(N, N);
+    std::vector<double> x(N, 1e-9);
+
+    for (auto _ : state) {
+        Matrix::rank1_update(A, 1, 1, x.data(), A.data() + 1, -1.0);
+        benchmark::DoNotOptimize(A.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<long>(N - 1) * (N - 1));
+}
+
+BENCHMARK(BM_MatrixRank1Update)
+->Apply(CustomArgumentsOfMatrixSwapColumns);
+
+//------------------------------------
+
 static void CustomArgumentsOfMatrixTranspoze(benchmark::internal::Benchmark* b) {
     for (int i = 1; i < 300; i <<= 2)
         for (int j = 1; j < 300; j <<= 2)
             b->Args({i, j});
+
+    // the large matrices, 16384 x 16384 needs 4 GB for the matrix and its transpose
+    for (int i = 1024; i <= 16384; i <<= 1)
+        b->Args({i, i});
+
+    b->Args({4096, 16384});
 }
 
-void MatrixTranspoze(Matrix::Matrix<double> A) {
-    Matrix::transpoze(A);
+void MatrixTranspoze(const Matrix::Matrix<double>& A) {
+    Matrix::Matrix<double> B = Matrix::transpoze(A);
+    benchmark::DoNotOptimize(B.data());
 }
 
 static void BM_MatrixTranspoze(benchmark::State& state) {
-    // FIXME: Is it correct benchmarking? I am not sure.
     Matrix::Matrix<double> A(state.range(0), state.range(1));
     for (auto _ : state)
         MatrixTranspoze(A);
+
+    // every element is read once and written once
+    state.SetBytesProcessed(state.iterations() * 2 * A.get_matrix_size() * sizeof(double));
 }
 
 BENCHMARK(BM_MatrixTranspoze)
-->Apply(CustomArgumentsOfMatrixTranspoze);
+->Apply(CustomArgumentsOfMatrixTranspoze)
+->Unit(benchmark::kMillisecond);
+
+//------------------------------------
+
+static void CustomArgumentsOfMatrixTranspozeInplace(benchmark::internal::Benchmark* b) {
+    for (int i = 1024; i <= 16384; i <<= 1)
+        b->Args({i, i});
+
+    b->Args({1000, 3000});
+}
+
+static void BM_MatrixTranspozeInplace(benchmark::State& state) {
+    Matrix::Matrix<double> A(state.range(0), state.range(1));
+    for (auto _ : state) {
+        Matrix::transpoze_inplace(A);
+        benchmark::DoNotOptimize(A.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * 2 * A.get_matrix_size() * sizeof(double));
+}
+
+BENCHMARK(BM_MatrixTranspozeInplace)
+->Apply(CustomArgumentsOfMatrixTranspozeInplace)
+->Unit(benchmark::kMillisecond);
+
+
+//------------------------------------
+
+static void CustomArgumentsOfMatrixSum(benchmark::internal::Benchmark* b) {
+    for (int i = 64; i <= 4096; i <<= 2)
+        b->Args({i, i});
+}
+
+// the loop over operator() that was used before the reductions
+static void BM_MatrixSumNaive(benchmark::State& state) {
+    Matrix::Matrix<double> A(state.range(0), state.range(1));
+    for (auto _ : state) {
+        double s = 0;
+        for (int i = 0; i < state.range(0); i++)
+            for (int j = 0; j < state.range(1); j++)
+                s += A(i, j);
+        benchmark::DoNotOptimize(s);
+    }
+
+    state.SetBytesProcessed(state.iterations() * A.get_matrix_size() * sizeof(double));
+}
+
+BENCHMARK(BM_MatrixSumNaive)
+->Apply(CustomArgumentsOfMatrixSum);
+
+static void BM_MatrixSum(benchmark::State& state) {
+    Matrix::Matrix<double> A(state.range(0), state.range(1));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(Matrix::sum(A));
+
+    state.SetBytesProcessed(state.iterations() * A.get_matrix_size() * sizeof(double));
+}
+
+BENCHMARK(BM_MatrixSum)
+->Apply(CustomArgumentsOfMatrixSum);
+
+static void BM_MatrixMax(benchmark::State& state) {
+    Matrix::Matrix<double> A(state.range(0), state.range(1));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(Matrix::max(A));
+
+    state.SetBytesProcessed(state.iterations() * A.get_matrix_size() * sizeof(double));
+}
+
+BENCHMARK(BM_MatrixMax)
+->Apply(CustomArgumentsOfMatrixSum);
+
+// the column sums by the loop over operator()
+static void BM_MatrixSumAxis0Naive(benchmark::State& state) {
+    Matrix::Matrix<double> A(state.range(0), state.range(1));
+    Matrix::Matrix<double> S(state.range(1));
+    for (auto _ : state) {
+        for (int j = 0; j < state.range(1); j++) {
+            double s = 0;
+            for (int i = 0; i < state.range(0); i++)
+                s += A(i, j);
+            S(j) = s;
+        }
+        benchmark::DoNotOptimize(S.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * A.get_matrix_size() * sizeof(double));
+}
+
+BENCHMARK(BM_MatrixSumAxis0Naive)
+->Apply(CustomArgumentsOfMatrixSum);
+
+static void BM_MatrixSumAxis0(benchmark::State& state) {
+    Matrix::Matrix<double> A(state.range(0), state.range(1));
+    for (auto _ : state) {
+        Matrix::Matrix<double> S = Matrix::sum(A, 0);
+        benchmark::DoNotOptimize(S.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * A.get_matrix_size() * sizeof(double));
+}
+
+BENCHMARK(BM_MatrixSumAxis0)
+->Apply(CustomArgumentsOfMatrixSum);
+
+static void BM_MatrixSumAxis1(benchmark::State& state) {
+    Matrix::Matrix<double> A(state.range(0), state.range(1));
+    for (auto _ : state) {
+        Matrix::Matrix<double> S = Matrix::sum(A, 1);
+        benchmark::DoNotOptimize(S.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * A.get_matrix_size() * sizeof(double));
+}
+
+BENCHMARK(BM_MatrixSumAxis1)
+->Apply(CustomArgumentsOfMatrixSum);
+
+static void BM_MatrixVarianceAxis0(benchmark::State& state) {
+    Matrix::Matrix<double> A(state.range(0), state.range(1));
+    for (auto _ : state) {
+        Matrix::Matrix<double> V = Matrix::variance(A, 0);
+        benchmark::DoNotOptimize(V.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * A.get_matrix_size() * sizeof(double));
+}
+
+BENCHMARK(BM_MatrixVarianceAxis0)
+->Apply(CustomArgumentsOfMatrixSum);
+
+
+//------------------------------------
+
+// 16M doubles for the element-wise ops with 1 to 64 threads of the pool
+static void CustomArgumentsOfMatrixParallelElementwise(benchmark::internal::Benchmark* b) {
+    for (int threads = 1; threads <= 64; threads <<= 1)
+        b->Args({1 << 24, threads});
+}
+
+static void BM_MatrixParallelOperatorPlus(benchmark::State& state) {
+    Matrix::set_num_threads(state.range(1));
+    Matrix::Matrix<double> A(state.range(0));
+    Matrix::Matrix<double> B(state.range(0));
+
+    for (auto _ : state) {
+        Matrix::Matrix<double> C = A + B;
+        benchmark::DoNotOptimize(C.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * 3 * A.get_matrix_size() * sizeof(double));
+    Matrix::set_num_threads(1);
+}
+
+BENCHMARK(BM_MatrixParallelOperatorPlus)
+->Apply(CustomArgumentsOfMatrixParallelElementwise)
+->Unit(benchmark::kMillisecond)
+->UseRealTime();
+
+static void BM_MatrixParallelSigmoid(benchmark::State& state) {
+    Matrix::set_num_threads(state.range(1));
+    Matrix::Matrix<double> A(state.range(0));
+    A /= static_cast<double>(state.range(0));
+
+    for (auto _ : state) {
+        Matrix::Matrix<double> C = Matrix::sigmoid(A);
+        benchmark::DoNotOptimize(C.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * A.get_matrix_size());
+    Matrix::set_num_threads(1);
+}
+
+BENCHMARK(BM_MatrixParallelSigmoid)
+->Apply(CustomArgumentsOfMatrixParallelElementwise)
+->Unit(benchmark::kMillisecond)
+->UseRealTime();
+
+static void BM_MatrixParallelTanh(benchmark::State& state) {
+    Matrix::set_num_threads(state.range(1));
+    Matrix::Matrix<double> A(state.range(0));
+    A /= static_cast<double>(state.range(0));
+
+    for (auto _ : state) {
+        Matrix::Matrix<double> C = Matrix::tanh(A);
+        benchmark::DoNotOptimize(C.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * A.get_matrix_size());
+    Matrix::set_num_threads(1);
+}
+
+BENCHMARK(BM_MatrixParallelTanh)
+->Apply(CustomArgumentsOfMatrixParallelElementwise)
+->Unit(benchmark::kMillisecond)
+->UseRealTime();
+
+static void BM_MatrixParallelZeros(benchmark::State& state) {
+    Matrix::set_num_threads(state.range(1));
+
+    for (auto _ : state) {
+        Matrix::Matrix<double> C = Matrix::zeros<double>(state.range(0));
+        benchmark::DoNotOptimize(C.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(double));
+    Matrix::set_num_threads(1);
+}
+
+BENCHMARK(BM_MatrixParallelZeros)
+->Apply(CustomArgumentsOfMatrixParallelElementwise)
+->Unit(benchmark::kMillisecond)
+->UseRealTime();
+
+static void BM_MatrixParallelRandom(benchmark::State& state) {
+    Matrix::set_num_threads(state.range(1));
+
+    for (auto _ : state) {
+        Matrix::Matrix<double> C = Matrix::random<double>(state.range(0));
+        benchmark::DoNotOptimize(C.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    Matrix::set_num_threads(1);
+}
+
+BENCHMARK(BM_MatrixParallelRandom)
+->Apply(CustomArgumentsOfMatrixParallelElementwise)
+->Unit(benchmark::kMillisecond)
+->UseRealTime();
+
+//------------------------------------
+
+// the cost of the trace span of a small operation, off and on
+static void CustomArgumentsOfMatrixTracing(benchmark::internal::Benchmark* b) {
+    b->Args({0});
+    b->Args({1});
+}
+
+static void BM_MatrixTracing(benchmark::State& state) {
+    Matrix::Matrix<float> A(4, 4);
+    Matrix::set_tracing(state.range(0));
+
+    for (auto _ : state) {
+        Matrix::Matrix<float> B = A + 1.0f;
+        benchmark::DoNotOptimize(B.data());
+    }
+
+    Matrix::set_tracing(false);
+    Matrix::clear_trace();
+}
+
+BENCHMARK(BM_MatrixTracing)
+->Apply(CustomArgumentsOfMatrixTracing);
 
 
 BENCHMARK_MAIN();
\ No newline at end of file
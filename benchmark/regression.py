@@ -0,0 +1,305 @@
+#!/usr/bin/env python3
+#
+# MIT License
+#
+# Copyright (c) 2022 CihatAltiparmak
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+"""
+The regression harness around the benchmark executables
+
+The harness runs a benchmark executable with repetitions, summarizes every
+benchmark by the median and the median absolute deviation (MAD) of its
+repetitions and either stores the summary as the baseline or compares it
+against the stored baseline. It needs only the python standard library.
+
+Example:
+    $ ./regression.py record build/matrix_benchmark baseline.json --repetitions 10
+    $ ./regression.py compare build/matrix_benchmark baseline.json --filter Dot
+
+The benchmark counts as regressed when its median is slower than the baseline
+median by more than --threshold (relative) and by more than --noise times the
+combined MAD of both runs, so the noisy benchmarks need a larger difference.
+The arguments after -- are passed to the executable unchanged, for example
+-- --benchmark_min_time=0.1. The exit status of compare is 0 when nothing
+regressed, 1 when at least one benchmark regressed and 2 when the benchmark
+could not be run or read.
+"""
+
+import argparse
+import json
+import math
+import os
+import statistics
+import subprocess
+import sys
+import tempfile
+
+BASELINE_VERSION = 1
+
+# the scale of MAD to the standard deviation for the normal distribution
+MAD_TO_SIGMA = 1.4826
+
+TIME_UNITS = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+
+class HarnessError(Exception):
+    pass
+
+
+def run_benchmark(executable, repetitions, benchmark_filter, extra):
+    """
+    Runs the benchmark executable and returns its JSON output.
+
+    The aggregates are not reported by the executable, they are computed
+    here from the single repetitions.
+    """
+    if not os.access(executable, os.X_OK):
+        raise HarnessError("%s is not an executable" % executable)
+
+    fd, path = tempfile.mkstemp(suffix=".json")
+    os.close(fd)
+
+    command = [executable,
+               "--benchmark_repetitions=%d" % repetitions,
+               "--benchmark_out=%s" % path,
+               "--benchmark_out_format=json"]
+    if benchmark_filter:
+        command.append("--benchmark_filter=%s" % benchmark_filter)
+    command.extend(extra)
+
+    try:
+        # the console output of the executable is the progress of the run
+        status = subprocess.call(command, stdout=sys.stderr)
+        if status != 0:
+            raise HarnessError("%s exited with the status %d" % (executable, status))
+        return read_json(path)
+    finally:
+        os.remove(path)
+
+
+def read_json(path):
+    try:
+        with open(path) as f:
+            return json.load(f)
+    except (OSError, ValueError) as e:
+        raise HarnessError("%s could not be read: %s" % (path, e))
+
+
+def median_absolute_deviation(samples, median):
+    return statistics.median(abs(x - median) for x in samples)
+
+
+def summarize(results, metric):
+    """
+    Groups the repetitions of every benchmark and returns the median and
+    the MAD of the metric in nanoseconds for each of them.
+    """
+    samples = {}
+    for run in results.get("benchmarks", []):
+        if run.get("run_type", "iteration") != "iteration":
+            continue
+        if run.get("error_occurred"):
+            continue
+
+        name = run.get("run_name", run["name"])
+        scale = TIME_UNITS.get(run.get("time_unit", "ns"), 1.0)
+        samples.setdefault(name, []).append(run[metric] * scale)
+
+    summary = {}
+    for name, values in samples.items():
+        median = statistics.median(values)
+        summary[name] = {
+            "median": median,
+            "mad": median_absolute_deviation(values, median),
+            "repetitions": len(values),
+        }
+
+    return summary
+
+
+def compare(baseline, current, threshold, noise):
+    """
+    Returns the rows of the report and the names of the regressed benchmarks.
+    """
+    rows = []
+    regressed = []
+
+    for name in sorted(set(baseline) | set(current)):
+        if name not in current:
+            rows.append((name, baseline[name]["median"], None, None, "MISSING"))
+            continue
+        if name not in baseline:
+            rows.append((name, None, current[name]["median"], None, "NEW"))
+            continue
+
+        old = baseline[name]
+        new = current[name]
+        change = (new["median"] - old["median"]) / old["median"] if old["median"] > 0 else 0.0
+        spread = noise * MAD_TO_SIGMA * math.hypot(old["mad"], new["mad"])
+        difference = new["median"] - old["median"]
+
+        if change > threshold and difference > spread:
+            verdict = "REGRESSED"
+            regressed.append(name)
+        elif change < -threshold and -difference > spread:
+            verdict = "IMPROVED"
+        else:
+            verdict = "ok"
+
+        rows.append((name, old["median"], new["median"], change, verdict))
+
+    return rows, regressed
+
+
+def format_time(ns):
+    if ns is None:
+        return "-"
+    for unit, scale in (("s", 1e9), ("ms", 1e6), ("us", 1e3)):
+        if ns >= scale:
+            return "%.3f %s" % (ns / scale, unit)
+    return "%.1f ns" % ns
+
+
+def print_report(rows, regressed, threshold, noise):
+    width = max([len("Benchmark")] + [len(row[0]) for row in rows])
+    print("%-*s  %14s  %14s  %9s  %s" % (width, "Benchmark", "Baseline", "Current", "Change", "Verdict"))
+    print("-" * (width + 56))
+    for name, old, new, change, verdict in rows:
+        change = "-" if change is None else "%+.1f%%" % (100 * change)
+        print("%-*s  %14s  %14s  %9s  %s" % (width, name, format_time(old), format_time(new), change, verdict))
+    print()
+
+    if regressed:
+        print("%d of %d benchmarks regressed by more than %.1f%% and %.1f times the noise:" %
+              (len(regressed), len(rows), 100 * threshold, noise))
+        for name in regressed:
+            print("  " + name)
+    else:
+        print("No regressions in %d benchmarks." % len(rows))
+
+
+def load_results(args):
+    if args.input:
+        return read_json(args.input)
+    return run_benchmark(args.executable, args.repetitions, args.filter, args.extra)
+
+
+def record(args):
+    results = load_results(args)
+    summary = summarize(results, args.metric)
+    if not summary:
+        raise HarnessError("the benchmark reported no results")
+
+    baseline = {
+        "version": BASELINE_VERSION,
+        "metric": args.metric,
+        "context": results.get("context", {}),
+        "benchmarks": summary,
+    }
+
+    # a filtered run refreshes only its own entries of the baseline
+    if args.merge and os.path.exists(args.baseline):
+        previous = read_json(args.baseline)
+        if previous.get("metric") == args.metric:
+            previous["benchmarks"].update(summary)
+            baseline["benchmarks"] = previous["benchmarks"]
+
+    with open(args.baseline, "w") as f:
+        json.dump(baseline, f, indent=2, sort_keys=True)
+        f.write("\n")
+
+    print("Recorded %d benchmarks to %s." % (len(summary), args.baseline))
+    return 0
+
+
+def check(args):
+    baseline = read_json(args.baseline)
+    if baseline.get("version") != BASELINE_VERSION:
+        raise HarnessError("%s is not a baseline of this harness" % args.baseline)
+
+    results = load_results(args)
+    current = summarize(results, baseline["metric"])
+    if not current:
+        raise HarnessError("the benchmark reported no results")
+
+    expected = baseline["benchmarks"]
+    # the filtered run is compared only against the benchmarks it ran
+    if args.filter or args.input:
+        expected = {name: value for name, value in expected.items() if name in current}
+
+    rows, regressed = compare(expected, current, args.threshold, args.noise)
+    print_report(rows, regressed, args.threshold, args.noise)
+
+    return 1 if regressed else 0
+
+
+def parse_arguments(argv):
+    parser = argparse.ArgumentParser(
+        description="Records and compares the benchmark baselines.")
+    commands = parser.add_subparsers(dest="command")
+    commands.required = True
+
+    for name, function in (("record", record), ("compare", check)):
+        command = commands.add_parser(name)
+        command.set_defaults(function=function)
+        command.add_argument("executable", help="the benchmark executable, e.g. matrix_benchmark")
+        command.add_argument("baseline", help="the baseline JSON file")
+        command.add_argument("--repetitions", type=int, default=5,
+                             help="the repetitions of every benchmark (default: 5)")
+        command.add_argument("--filter", default="",
+                             help="the regex passed as --benchmark_filter")
+        command.add_argument("--input", default="",
+                             help="read the JSON output of an earlier run instead of running")
+
+        if name == "record":
+            command.add_argument("--metric", choices=("real_time", "cpu_time"), default="real_time",
+                                 help="the measured time (default: real_time)")
+            command.add_argument("--merge", action="store_true",
+                                 help="update the entries of an existing baseline")
+        else:
+            command.add_argument("--threshold", type=float, default=0.05,
+                                 help="the relative slowdown that is tolerated (default: 0.05)")
+            command.add_argument("--noise", type=float, default=3.0,
+                                 help="the slowdown must exceed this many standard deviations "
+                                      "estimated from the MAD (default: 3)")
+
+    # everything after -- is passed to the executable unchanged
+    extra = []
+    if "--" in argv:
+        extra = argv[argv.index("--") + 1:]
+        argv = argv[:argv.index("--")]
+
+    args = parser.parse_args(argv)
+    args.extra = extra
+    return args
+
+
+def main(argv):
+    args = parse_arguments(argv)
+    try:
+        return args.function(args)
+    except HarnessError as e:
+        print("error: %s" % e, file=sys.stderr)
+        return 2
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,251 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#ifndef _ACCOUNTING_CPP_
+#define _ACCOUNTING_CPP_
+
+#include "accounting.h"
+
+#include <algorithm>     // for std::max
+#include <iomanip>       // for std::setw
+#include <mutex>         // for std::mutex
+#include <unordered_map> // for std::unordered_map
+#include <utility>       // for std::pair
+
+namespace Matrix {
+
+inline AllocationStats::AllocationStats()
+: allocations(0), bytes_allocated(0), copies(0), bytes_copied(0),
+  live_bytes(0), peak_bytes(0)
+{
+}
+
+constexpr bool accounting_enabled() {
+#if defined(MATRIX_ACCOUNTING)
+    return true;
+#else
+    return false;
+#endif
+}
+
+namespace detail {
+
+#if defined(MATRIX_ACCOUNTING)
+
+struct AccountingRegistry {
+    std::mutex MUTEX;
+    std::map<std::string, AllocationStats> OPERATIONS;
+    AllocationStats TOTAL;
+
+    // the live storages with the stats of the operation that allocated them
+    std::unordered_map<const void*, std::pair<AllocationStats*, long>> LIVE;
+};
+
+// never destroyed, the static matrices can be freed after the exit of main
+inline AccountingRegistry& accounting_registry() {
+    static AccountingRegistry* registry = new AccountingRegistry();
+    return *registry;
+}
+
+// the operation of the outermost AccountingScope of the thread
+inline const char*& current_operation() {
+    thread_local const char* operation = nullptr;
+    return operation;
+}
+
+inline void add_allocation(AllocationStats& stats, const long bytes, const bool copy) {
+    stats.allocations++;
+    stats.bytes_allocated += bytes;
+    if (copy) {
+        stats.copies++;
+        stats.bytes_copied += bytes;
+    }
+    stats.live_bytes += bytes;
+    stats.peak_bytes = std::max(stats.peak_bytes, stats.live_bytes);
+}
+
+// the storage of bytes at data is allocated, copy tells whether it is a deep copy
+inline void account_allocation(const void* data, const long bytes, const bool copy) {
+    const char* operation = current_operation();
+    if (operation == nullptr)
+        operation = copy ? "copy" : "construct";
+
+    AccountingRegistry& registry = accounting_registry();
+    std::lock_guard<std::mutex> lock(registry.MUTEX);
+
+    AllocationStats& stats = registry.OPERATIONS[operation];
+    add_allocation(stats, bytes, copy);
+    add_allocation(registry.TOTAL, bytes, copy);
+
+    registry.LIVE[data] = {&stats, bytes};
+}
+
+// the storage at data is freed or released, the storages not allocated by the library are ignored
+inline void account_free(const void* data) {
+    AccountingRegistry& registry = accounting_registry();
+    std::lock_guard<std::mutex> lock(registry.MUTEX);
+
+    auto it = registry.LIVE.find(data);
+    if (it == registry.LIVE.end())
+        return;
+
+    it->second.first->live_bytes -= it->second.second;
+    registry.TOTAL.live_bytes -= it->second.second;
+    registry.LIVE.erase(it);
+}
+
+#else
+
+inline void account_allocation(const void*, const long, const bool) {}
+
+inline void account_free(const void*) {}
+
+#endif
+
+inline void reset_counters(AllocationStats& stats) {
+    long live_bytes = stats.live_bytes;
+    stats = AllocationStats();
+    stats.live_bytes = live_bytes;
+    stats.peak_bytes = live_bytes;
+}
+
+} // end of namespace detail
+
+#if defined(MATRIX_ACCOUNTING)
+
+inline AccountingScope::AccountingScope(const char* operation)
+: OUTERMOST(detail::current_operation() == nullptr)
+{
+    if (OUTERMOST)
+        detail::current_operation() = operation;
+}
+
+inline AccountingScope::~AccountingScope() {
+    if (OUTERMOST)
+        detail::current_operation() = nullptr;
+}
+
+#else
+
+inline AccountingScope::AccountingScope(const char*)
+: OUTERMOST(false)
+{
+}
+
+inline AccountingScope::~AccountingScope() {}
+
+#endif
+
+/*
+ * The function that returns the allocation stats of every operation
+ *
+ * The operations are the names given to AccountingScope, the library
+ * functions that allocate open their scopes by their names, e.g. "dot",
+ * "transpoze" or "inv". The map is empty if MATRIX_ACCOUNTING is not defined.
+ *
+ * #define MATRIX_ACCOUNTING
+ * #include <atrix/matrix.h>
+ *
+ * Matrix::Matrix<double> C = Matrix::dot(A, B);
+ * long copies = Matrix::get_allocation_stats()["dot"].copies;
+ *
+ * @retval the stats by the names of the operations
+ */
+inline std::map<std::string, AllocationStats> get_allocation_stats() {
+#if defined(MATRIX_ACCOUNTING)
+    detail::AccountingRegistry& registry = detail::accounting_registry();
+    std::lock_guard<std::mutex> lock(registry.MUTEX);
+
+    return registry.OPERATIONS;
+#else
+    return {};
+#endif
+}
+
+/*
+ * The function that returns the allocation stats summed over all operations,
+ * its peak_bytes is the peak of all live storages together.
+ */
+inline AllocationStats get_total_allocation_stats() {
+#if defined(MATRIX_ACCOUNTING)
+    detail::AccountingRegistry& registry = detail::accounting_registry();
+    std::lock_guard<std::mutex> lock(registry.MUTEX);
+
+    return registry.TOTAL;
+#else
+    return AllocationStats();
+#endif
+}
+
+/*
+ * The function that zeros the counters of all operations
+ *
+ * The live storages stay live, live_bytes is kept and peak_bytes starts
+ * again from it.
+ */
+inline void reset_allocation_stats() {
+#if defined(MATRIX_ACCOUNTING)
+    detail::AccountingRegistry& registry = detail::accounting_registry();
+    std::lock_guard<std::mutex> lock(registry.MUTEX);
+
+    for (auto& operation : registry.OPERATIONS)
+        detail::reset_counters(operation.second);
+    detail::reset_counters(registry.TOTAL);
+#endif
+}
+
+/*
+ * The function that prints the allocation stats of every operation and
+ * their total as the table.
+ *
+ * @param out the stream to print to, std::cout by default
+ * @retval None
+ */
+inline void print_allocation_stats(std::ostream& out) {
+    auto print_row = [&out](const std::string& name, const AllocationStats& stats) {
+        out << std::left << std::setw(20) << name << std::right
+            << std::setw(13) << stats.allocations
+            << std::setw(17) << stats.bytes_allocated
+            << std::setw(9) << stats.copies
+            << std::setw(17) << stats.bytes_copied
+            << std::setw(15) << stats.live_bytes
+            << std::setw(15) << stats.peak_bytes << "\n";
+    };
+
+    out << std::left << std::setw(20) << "operation" << std::right
+        << std::setw(13) << "allocations"
+        << std::setw(17) << "bytes allocated"
+        << std::setw(9) << "copies"
+        << std::setw(17) << "bytes copied"
+        << std::setw(15) << "live bytes"
+        << std::setw(15) << "peak bytes" << "\n";
+
+    for (auto& operation : get_allocation_stats())
+        print_row(operation.first, operation.second);
+    print_row("total", get_total_allocation_stats());
+}
+
+} // end of namespace Matrix
+
+#endif // end of _ACCOUNTING_CPP_
@@ -0,0 +1,103 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#ifndef _ACCOUNTING_H_
+#define _ACCOUNTING_H_
+
+#include <map>
+#include <string>
+#include <iostream>
+
+/*
+ * The allocation and copy accounting is compiled in only when MATRIX_ACCOUNTING
+ * is defined, for example by -DMATRIX_ACCOUNTING or the MATRIX_ACCOUNTING
+ * option of CMake. It must be defined the same way in every translation unit
+ * of the program. Without it the hooks are empty inline functions and the
+ * queries return zeros.
+ */
+#if defined(MATRIX_ACCOUNTING)
+#define MATRIX_ACCOUNTING_CONCAT_(a, b) a##b
+#define MATRIX_ACCOUNTING_CONCAT(a, b) MATRIX_ACCOUNTING_CONCAT_(a, b)
+#define MATRIX_ACCOUNT_SCOPE(operation) \
+    ::Matrix::AccountingScope MATRIX_ACCOUNTING_CONCAT(__accounting_scope_, __LINE__)(operation)
+#else
+#define MATRIX_ACCOUNT_SCOPE(operation) ((void)0)
+#endif
+
+namespace Matrix {
+
+/*
+ * The counters of the storages of the matrices
+ *
+ * allocations and bytes_allocated count the storages allocated by the
+ * library, copies and bytes_copied the deep copies among them. live_bytes
+ * are the bytes of the storages that are not freed yet and peak_bytes the
+ * largest live_bytes since the last reset.
+ */
+struct AllocationStats {
+    long allocations;
+    long bytes_allocated;
+    long copies;
+    long bytes_copied;
+    long live_bytes;
+    long peak_bytes;
+
+    AllocationStats();
+};
+
+/*
+ * The scope that charges the allocations and the copies of the current
+ * thread to the operation while it lives. The outermost scope wins, so an
+ * operation is charged for everything the operations it calls allocate.
+ * Outside of any scope the new matrices are charged to "construct" and the
+ * deep copies to "copy", the copies of the arguments passed by value are
+ * made by the caller and belong to the scope of the caller.
+ */
+class AccountingScope {
+public:
+    explicit AccountingScope(const char*);
+    ~AccountingScope();
+
+    AccountingScope(const AccountingScope&) = delete;
+    AccountingScope& operator=(const AccountingScope&) = delete;
+
+private:
+    bool OUTERMOST;
+};
+
+constexpr bool accounting_enabled();
+
+std::map<std::string, AllocationStats> get_allocation_stats();
+
+AllocationStats get_total_allocation_stats();
+
+void reset_allocation_stats();
+
+void print_allocation_stats(std::ostream& = std::cout);
+
+} // end of namespace Matrix
+
+#include "accounting.cpp"
+
+#endif // end of _ACCOUNTING_H_
@@ -0,0 +1,574 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#ifndef _CSV_CPP_
+#define _CSV_CPP_
+
+#include "matrix.h"
+#include "csv.h"
+#include "parallel.h"
+#include "errors.h"
+
+#include <algorithm>   // for std::max, std::min
+#include <atomic>      // for std::atomic
+#include <cmath>       // for NAN
+#include <cstdlib>     // for std::strtod, std::strtoll
+#include <cstring>     // for std::memchr
+#include <limits>      // for std::numeric_limits
+#include <type_traits> // for std::is_floating_point
+#include <fcntl.h>     // for open
+#include <sys/mman.h>  // for mmap
+#include <sys/stat.h>  // for fstat
+#include <unistd.h>    // for close
+
+#if __cplusplus >= 201703L && __has_include(<charconv>)
+#include <charconv>    // for std::from_chars
+#endif
+
+namespace Matrix {
+
+namespace detail {
+
+// the smallest part of the text that is parsed by one task of the thread pool
+constexpr std::size_t CSV_CHUNK = 1 << 20;
+
+// the first size of the buffer of CsvReader, it grows only for the longer batches
+constexpr std::size_t CSV_BUFFER = 1 << 22;
+
+inline bool csv_blank(const char c, const char delimiter) {
+    return c == ' ' || c == '\r' || (c == '\t' && delimiter != '\t');
+}
+
+// the '\n' that ends the line starting at p, or end for the last line
+inline const char* line_end(const char* p, const char* end) {
+    const char* n = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    return n ? n : end;
+}
+
+inline bool blank_line(const char* p, const char* e) {
+    for (; p < e; p++)
+        if (*p != ' ' && *p != '\t' && *p != '\r')
+            return false;
+    return true;
+}
+
+// the number of the lines in [begin, end) that are not blank
+inline long count_lines(const char* begin, const char* end) {
+    long count = 0;
+
+    for (const char* p = begin; p < end; ) {
+        const char* e = line_end(p, end);
+        count += !blank_line(p, e);
+        p = std::min(e + 1, end);
+    }
+
+    return count;
+}
+
+// the fields of the line [p, e) without the blanks and the quotes around them
+inline std::vector<std::string> split_fields(const char* p, const char* e, const char delimiter) {
+    std::vector<std::string> fields;
+
+    while (true) {
+        const char* f = static_cast<const char*>(std::memchr(p, delimiter, e - p));
+        const char* last = f ? f : e;
+
+        const char* a = p;
+        const char* b = last;
+        while (a < b && csv_blank(*a, delimiter))
+            a++;
+        while (b > a && csv_blank(b[-1], delimiter))
+            b--;
+        if (b - a >= 2 && *a == '"' && b[-1] == '"')
+            a++, b--;
+
+        fields.emplace_back(a, b);
+
+        if (!f)
+            return fields;
+        p = f + 1;
+    }
+}
+
+// the number in [p, e) that ends at the returned pointer
+template <typename DType>
+const char* parse_number(const char* p, const char* e, DType& value) {
+#if defined(__cpp_lib_to_chars)
+    auto result = std::from_chars(p, e, value);
+    if (result.ec != std::errc())
+        throw ParseError();
+    return result.ptr;
+#else
+    // strtod needs the terminating zero, the field is copied
+    char text[64];
+    const std::size_t length = std::min<std::size_t>(e - p, sizeof(text) - 1);
+    std::copy(p, p + length, text);
+    text[length] = '\0';
+
+    char* stop = text;
+    if (std::is_floating_point<DType>::value)
+        value = static_cast<DType>(std::strtod(text, &stop));
+    else
+        value = static_cast<DType>(std::strtoll(text, &stop, 10));
+
+    if (stop == text)
+        throw ParseError();
+    return p + (stop - text);
+#endif
+}
+
+/*
+ * Parses the field at p of the line that ends at e into the value and
+ * returns the delimiter after it or e. The blanks and the quotes around the
+ * number are skipped, the empty field is NaN for the floating point types.
+ */
+template <typename DType>
+const char* parse_field(const char* p, const char* e, const char delimiter, DType& value) {
+    bool quoted = false;
+
+    // the plain numbers are the most of the fields
+    if (p < e && ((*p >= '0' && *p <= '9') || *p == '-')) {
+        p = parse_number(p, e, value);
+        if (p == e || *p == delimiter)
+            return p;
+    } else {
+        while (p < e && csv_blank(*p, delimiter))
+            p++;
+
+        quoted = (p < e && *p == '"');
+        p += quoted;
+        p += (p < e && *p == '+');
+
+        if (p == e || *p == delimiter || (quoted && *p == '"')) {
+            if (!std::is_floating_point<DType>::value)
+                throw ParseError();
+            value = std::numeric_limits<DType>::quiet_NaN();
+        } else {
+            p = parse_number(p, e, value);
+        }
+    }
+
+    if (quoted) {
+        if (p == e || *p != '"')
+            throw ParseError();
+        p++;
+    }
+
+    while (p < e && csv_blank(*p, delimiter))
+        p++;
+
+    if (p < e && *p != delimiter)
+        throw ParseError();
+
+    return p;
+}
+
+/*
+ * The layout of the line: slots[f] is the column of the field f in the row
+ * or -1 if the field is skipped, the fields after slots are not read. If
+ * exact is true, the line must not have more fields than slots.
+ */
+struct CsvLayout {
+    std::vector<int> slots;
+    int columns;
+    bool exact;
+};
+
+template <typename DType>
+void parse_line(const char* p, const char* e, const char delimiter, const CsvLayout& layout, DType* row) {
+    const int fields = layout.slots.size();
+    bool more = true;
+
+    for (int field = 0; field < fields; field++) {
+        if (!more)
+            throw ParseError();
+
+        const int slot = layout.slots[field];
+        if (slot >= 0) {
+            p = parse_field(p, e, delimiter, row[slot]);
+        } else {
+            const char* f = static_cast<const char*>(std::memchr(p, delimiter, e - p));
+            p = f ? f : e;
+        }
+
+        more = (p < e);
+        p += more;
+    }
+
+    if (layout.exact && more)
+        throw ParseError();
+}
+
+/*
+ * The layout of the options, the header is the names of the header line and
+ * first is the first line of the data that gives the number of the columns
+ * if all of them are loaded.
+ */
+inline CsvLayout csv_layout(const CsvOptions& options, const std::vector<std::string>& header,
+                            const char* first, const char* first_end) {
+    assert((options.columns.empty() || options.names.empty()) &&
+        "The columns are selected by the indexes or by the names, not by both!");
+    assert((options.names.empty() || options.header) &&
+        "The columns can be selected by the names only if the file has the header!");
+
+    std::vector<int> columns = options.columns;
+    for (const std::string& name : options.names) {
+        auto found = std::find(header.begin(), header.end(), name);
+        if (found == header.end())
+            throw ParseError();
+        columns.push_back(found - header.begin());
+    }
+
+    CsvLayout layout;
+
+    if (columns.empty()) {
+        const int fields = split_fields(first, first_end, options.delimiter).size();
+        for (int f = 0; f < fields; f++)
+            layout.slots.push_back(f);
+        layout.columns = fields;
+        layout.exact = true;
+        return layout;
+    }
+
+    layout.slots.assign(*std::max_element(columns.begin(), columns.end()) + 1, -1);
+    for (std::size_t c = 0; c < columns.size(); c++) {
+        assert(columns[c] >= 0 && layout.slots[columns[c]] < 0 &&
+            "The columns must be nonnegative and different!");
+        layout.slots[columns[c]] = c;
+    }
+    layout.columns = columns.size();
+    layout.exact = false;
+
+    return layout;
+}
+
+/*
+ * Parses the lines of [begin, end) into the new matrix of (lines, columns).
+ * The text is cut into chunks at the bytes, every cut is moved to the next
+ * line; the chunks count their lines in parallel, which gives the first row
+ * of every chunk, and then they are parsed in parallel into their rows.
+ */
+template <typename DType>
+Matrix<DType> parse_lines(const char* begin, const char* end, const char delimiter, const CsvLayout& layout) {
+    const std::size_t bytes = end - begin;
+    const long chunks = std::max(1L, std::min<long>(4L * get_num_threads(), bytes / CSV_CHUNK));
+
+    std::vector<const char*> starts(chunks + 1, end);
+    starts[0] = begin;
+    for (long c = 1; c < chunks; c++) {
+        const char* cut = begin + bytes * c / chunks;
+        if (cut <= starts[c - 1]) {
+            starts[c] = starts[c - 1];
+            continue;
+        }
+
+        const char* n = static_cast<const char*>(std::memchr(cut - 1, '\n', end - (cut - 1)));
+        starts[c] = n ? n + 1 : end;
+    }
+
+    std::vector<long> first_row(chunks + 1, 0);
+    parallel_for(0, chunks, 1, [&](long first, long last) {
+        for (long c = first; c < last; c++)
+            first_row[c + 1] = count_lines(starts[c], starts[c + 1]);
+    });
+
+    for (long c = 0; c < chunks; c++)
+        first_row[c + 1] += first_row[c];
+
+    if (first_row[chunks] == 0 || layout.columns == 0)
+        throw ParseError();
+
+    Matrix<DType> RESULT = matrix_with_shape<DType>({static_cast<int>(first_row[chunks]), layout.columns});
+    DType* out = RESULT.data();
+    std::atomic<bool> failed(false);
+
+    parallel_for(0, chunks, 1, [&](long first, long last) {
+        try {
+            for (long c = first; c < last; c++) {
+                DType* row = out + first_row[c] * layout.columns;
+
+                for (const char* p = starts[c]; p < starts[c + 1]; ) {
+                    const char* e = line_end(p, starts[c + 1]);
+                    if (!blank_line(p, e)) {
+                        parse_line(p, e, delimiter, layout, row);
+                        row += layout.columns;
+                    }
+                    p = std::min(e + 1, starts[c + 1]);
+                }
+            }
+        } catch (...) {
+            failed = true;
+        }
+    });
+
+    if (failed)
+        throw ParseError();
+
+    return RESULT;
+}
+
+// the first line of [p, end) that is not blank, p is moved after it
+inline std::pair<const char*, const char*> first_line(const char*& p, const char* end) {
+    while (p < end) {
+        const char* e = line_end(p, end);
+        const char* line = p;
+        p = std::min(e + 1, end);
+        if (!blank_line(line, e))
+            return {line, e};
+    }
+    return {end, end};
+}
+
+} // end of namespace detail
+
+inline CsvOptions::CsvOptions(const char delimiter, const bool header)
+: delimiter(delimiter), header(header)
+{}
+
+/*
+ * The function that loads the numeric CSV file into the matrix
+ *
+ * The file is mapped into the memory and parsed in the chunks on the thread
+ * pool straight into the matrix of (lines, columns) that is allocated once.
+ * The numbers are parsed by std::from_chars (std::strtod before C++17), the
+ * blanks around them, the quotes around them and the blank lines are skipped,
+ * the empty fields are NaN for the floating point types. The quoted fields
+ * must not have the delimiters or the newlines in them.
+ *
+ * Matrix::CsvOptions options(',', true);
+ * options.names = {"age", "income"};
+ * Matrix::Matrix<float> X = Matrix::load_csv<float>("features.csv", options);
+ *
+ * @param path the path of the file
+ * @param options the delimiter, the header and the selected columns
+ * @retval the matrix of the lines of the file
+ * @throw ParseError if a field is not a number of DType, a line has too few or too many fields or there are no lines
+ */
+template <typename DType>
+Matrix<DType> load_csv(const std::string& path, const CsvOptions& options) {
+    detail::TraceSpan trace("load_csv");
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw SerializationError();
+
+    struct stat status;
+    if (fstat(fd, &status) != 0 || status.st_size == 0) {
+        close(fd);
+        throw ParseError();
+    }
+
+    const std::size_t size = status.st_size;
+    void* base = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (base == MAP_FAILED)
+        throw SerializationError();
+
+    madvise(base, size, MADV_SEQUENTIAL);
+
+    struct Unmap {
+        void* base;
+        std::size_t size;
+        ~Unmap() { munmap(base, size); }
+    } unmap = {base, size};
+
+    const char* p = static_cast<const char*>(base);
+    const char* end = p + size;
+
+    std::vector<std::string> header;
+    if (options.header) {
+        auto line = detail::first_line(p, end);
+        header = detail::split_fields(line.first, line.second, options.delimiter);
+    }
+
+    const char* body = p;
+    auto first = detail::first_line(p, end);
+    detail::CsvLayout layout = detail::csv_layout(options, header, first.first, first.second);
+
+    Matrix<DType> RESULT = detail::parse_lines<DType>(body, end, options.delimiter, layout);
+    trace.add(RESULT);
+    return RESULT;
+}
+
+/*
+ * The constructor that opens the CSV file and reads its header
+ *
+ * Matrix::CsvReader<float> reader("features.csv", 65536, Matrix::CsvOptions(',', true));
+ * while (reader.has_next()) {
+ *     Matrix::Matrix<float> X = reader.next();   // up to 65536 rows
+ *     ...
+ * }
+ *
+ * @param path the path of the file
+ * @param batch the largest number of the rows of a batch
+ * @param options the delimiter, the header and the selected columns like in load_csv
+ * @throw ParseError if the selected names are not in the header
+ */
+template <typename DType>
+CsvReader<DType>::CsvReader(const std::string& path, const int batch, const CsvOptions& options)
+: FILE(path, std::ios::binary), BUFFER(detail::CSV_BUFFER), BEGIN(0), END(0), FINISHED(false),
+  DELIMITER(options.delimiter), BATCH(batch), COLUMNS(0), EXACT(false)
+{
+    assert(batch > 0 && "The batch must have at least one row!");
+
+    if (!FILE)
+        throw SerializationError();
+
+    // the buffer has the header and the first line of the data, or the whole file
+    const int needed = options.header ? 2 : 1;
+    while (fill()) {
+        const char* p = BUFFER.data();
+        const char* end = p + END;
+
+        int complete = 0;
+        while (complete < needed && detail::first_line(p, end).second < end)
+            complete++;
+        if (complete == needed)
+            break;
+    }
+
+    const char* p = BUFFER.data();
+    const char* end = p + END;
+    std::pair<const char*, const char*> line;
+
+    if (options.header) {
+        line = detail::first_line(p, end);
+        HEADER = detail::split_fields(line.first, line.second, DELIMITER);
+        BEGIN = p - BUFFER.data();
+    }
+
+    line = detail::first_line(p, end);
+    detail::CsvLayout layout = detail::csv_layout(options, HEADER, line.first, line.second);
+    SLOTS = layout.slots;
+    COLUMNS = layout.columns;
+    EXACT = layout.exact;
+}
+
+// the names of the columns in the header, empty without the header
+template <typename DType>
+const std::vector<std::string>& CsvReader<DType>::get_header() const {
+    return HEADER;
+}
+
+// the number of the columns of the batches
+template <typename DType>
+int CsvReader<DType>::get_columns() const {
+    return COLUMNS;
+}
+
+// moves the lines that are not parsed to the front and reads more, false at the end of the file
+template <typename DType>
+bool CsvReader<DType>::fill() {
+    if (FINISHED)
+        return false;
+
+    std::copy(BUFFER.begin() + BEGIN, BUFFER.begin() + END, BUFFER.begin());
+    END -= BEGIN;
+    BEGIN = 0;
+
+    if (END == BUFFER.size())
+        BUFFER.resize(2 * BUFFER.size());
+
+    FILE.read(BUFFER.data() + END, BUFFER.size() - END);
+    END += FILE.gcount();
+    FINISHED = !FILE;
+
+    return true;
+}
+
+/*
+ * The method that tells whether there is one more batch
+ *
+ * @retval true if there are more lines that are not blank
+ */
+template <typename DType>
+bool CsvReader<DType>::has_next() {
+    while (true) {
+        const char* p = BUFFER.data() + BEGIN;
+        const char* end = BUFFER.data() + END;
+
+        auto line = detail::first_line(p, end);
+        if (line.first < end)
+            return true;
+
+        BEGIN = END;
+        if (!fill())
+            return false;
+    }
+}
+
+/*
+ * The method that parses the next batch of rows
+ *
+ * @retval the matrix of (up to batch, columns)
+ * @throw ParseError if a field is not a number of DType, a line has too few or too many fields or there are no more lines
+ */
+template <typename DType>
+Matrix<DType> CsvReader<DType>::next() {
+    detail::TraceSpan trace("CsvReader::next");
+
+    // the end of the batch lines, or the end of the lines in the buffer
+    std::size_t scanned = BEGIN;
+    long lines = 0;
+
+    while (lines < BATCH) {
+        const char* p = BUFFER.data() + scanned;
+        const char* end = BUFFER.data() + END;
+        const char* e = static_cast<const char*>(std::memchr(p, '\n', end - p));
+
+        if (e == nullptr) {
+            // the last line of the file has no newline
+            if (FINISHED) {
+                lines += !detail::blank_line(p, end);
+                scanned = END;
+                break;
+            }
+
+            const std::size_t offset = scanned - BEGIN;
+            fill();
+            scanned = BEGIN + offset;
+            continue;
+        }
+
+        lines += !detail::blank_line(p, e);
+        scanned = e + 1 - BUFFER.data();
+    }
+
+    detail::CsvLayout layout;
+    layout.slots = SLOTS;
+    layout.columns = COLUMNS;
+    layout.exact = EXACT;
+
+    const char* begin = BUFFER.data() + BEGIN;
+    BEGIN = scanned;
+
+    Matrix<DType> RESULT = detail::parse_lines<DType>(begin, BUFFER.data() + scanned, DELIMITER, layout);
+    trace.add(RESULT);
+    return RESULT;
+}
+
+} // end of namespace
+
+#endif // end of _CSV_CPP_
@@ -0,0 +1,97 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#ifndef _CSV_H_
+#define _CSV_H_
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "matrix.h"
+
+namespace Matrix {
+
+/*
+ * The format of the numeric CSV and TSV files.
+ *
+ * delimiter  the separator of the fields, ',' for CSV and '\t' for TSV
+ * header     the first line has the names of the columns
+ * columns    the indexes of the columns that are loaded in this order, all
+ *            columns if it is empty
+ * names      the names of the columns in the header that are loaded in this
+ *            order, instead of the indexes
+ */
+struct CsvOptions {
+    char delimiter;
+    bool header;
+    std::vector<int> columns;
+    std::vector<std::string> names;
+
+    CsvOptions(const char = ',', const bool = false);
+};
+
+template <typename DType>
+Matrix<DType> load_csv(const std::string&, const CsvOptions& = CsvOptions());
+
+/*
+ * The reader of the CSV file in the batches of rows.
+ *
+ * Only the current batch and the buffer of the lines that are not parsed
+ * yet are in the memory, so the files of any size are read with the bounded
+ * memory. The lines of every batch are parsed by the thread pool.
+ */
+template <typename DType>
+class CsvReader {
+public:
+
+    CsvReader(const std::string&, const int, const CsvOptions& = CsvOptions());
+
+    const std::vector<std::string>& get_header() const;
+    int get_columns() const;
+
+    bool has_next();
+    Matrix<DType> next();
+
+private:
+    bool fill();
+
+    std::ifstream FILE;
+    std::vector<char> BUFFER;
+    std::size_t BEGIN;
+    std::size_t END;
+    bool FINISHED;
+
+    char DELIMITER;
+    int BATCH;
+    std::vector<std::string> HEADER;
+    std::vector<int> SLOTS;
+    int COLUMNS;
+    bool EXACT;
+};
+
+} // end of namespace
+
+#include "csv.cpp"
+#endif // end of _CSV_H_
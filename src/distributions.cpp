@@ -0,0 +1,269 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#ifndef _DISTRIBUTIONS_CPP_
+#define _DISTRIBUTIONS_CPP_
+
+#include "matrix.h"
+#include "generator.h"
+#include "distributions.h"
+
+#include <cmath>       // for std::sqrt, std::log, std::cos, std::floor, std::nextafter
+#include <type_traits> // for std::is_same, std::is_integral
+#include <algorithm>   // for std::min
+#include <assert.h>    // for assert
+
+namespace Matrix {
+
+namespace detail {
+
+constexpr double TWO_PI = 6.283185307179586;
+
+// the uniform number in [0, 1) from the words of one block, 24 bits for float
+// so it can't be rounded up to 1, and 53 bits for the other types
+template <typename DType>
+inline double unit_uniform(const std::uint32_t w0, const std::uint32_t w1) {
+    if (std::is_same<DType, float>::value)
+        return (w0 >> 8) * (1.0 / 16777216.0);
+
+    std::uint64_t bits = (static_cast<std::uint64_t>(w0) << 32) | w1;
+    return (bits >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// low + width * u as DType in [low, high): the integers are rounded down, not
+// toward zero, and the floating point numbers that are rounded up to high
+// are moved below it
+template <typename DType>
+inline DType uniform_value(const DType low, const DType high, const double width, const double u) {
+    const double x = low + width * u;
+
+    if (std::is_integral<DType>::value)
+        return static_cast<DType>(std::min(std::floor(x), static_cast<double>(high) - 1));
+
+    const DType v = static_cast<DType>(x);
+    return (v < high) ? v : static_cast<DType>(std::nextafter(high, low));
+}
+
+// the pair of standard normal numbers from the 4 words of one block by
+// Box-Muller, the first uniform is moved to (0, 1] so the logarithm is finite
+inline void unit_normals(const std::uint32_t w[4], double z[2]) {
+    std::uint64_t bits = (static_cast<std::uint64_t>(w[0]) << 32) | w[1];
+    double u1 = ((bits >> 11) + 1) * (1.0 / 9007199254740992.0);
+    double u2 = unit_uniform<double>(w[2], w[3]);
+
+    double r = std::sqrt(-2 * std::log(u1));
+    z[0] = r * std::cos(TWO_PI * u2);
+    z[1] = r * std::sin(TWO_PI * u2);
+}
+
+/*
+ * The elements 2i and 2i + 1 of A from the block of the counter first + i,
+ * pair(counter, block, x) makes the two values x[0] and x[1] of the 4 words
+ * of the block.
+ *
+ * The blocks of SIMD_LANES pairs are made together (the last one may make
+ * a few unused blocks), the chunks of the pairs run on the thread pool.
+ * Every element has its own counter and half of the block, so the matrix
+ * is the same whatever the number of threads and the chunk boundaries are.
+ */
+template <typename DType, typename F>
+void fill_pairs(Matrix<DType>& A, const std::uint64_t key, const std::uint64_t first, F pair) {
+    constexpr int L = SIMD_LANES;
+
+    const long size = A.get_matrix_size();
+    DType* a = A.data();
+
+    elementwise_for((size + 1) / 2, [&](long begin, long end) {
+        std::uint32_t words[4][L];
+
+        for (long p = begin; p < end; p += L) {
+            const int n = std::min<long>(L, end - p);
+            philox_lanes<L>(key, first + p, 0, words);
+
+            for (int l = 0; l < n; l++) {
+                const std::uint32_t block[4] = {words[0][l], words[1][l], words[2][l], words[3][l]};
+                DType x[2];
+                pair(first + p + l, block, x);
+
+                const long e = 2 * (p + l);
+                a[e] = x[0];
+                if (e + 1 < size)
+                    a[e + 1] = x[1];
+            }
+        }
+    }, 2);
+}
+
+// the number of the counters that the fill of the matrix reserves
+template <typename DType>
+std::uint64_t pair_counters(const Matrix<DType>& A) {
+    return (static_cast<std::uint64_t>(A.get_matrix_size()) + 1) / 2;
+}
+
+} // end of namespace detail
+
+/*
+ * The function that fills the matrix with uniform random numbers in [low, high)
+ *
+ * Matrix::Generator gen(42);
+ * Matrix::Matrix<double> W(256, 128);
+ *
+ * Matrix::uniform(W, -0.1, 0.1, gen);   // the same W for the seed 42
+ * Matrix::uniform(W, -0.1, 0.1);        // with the default generator
+ *
+ * The numbers are made in double (float for float matrices) and converted
+ * to DType, so the integer matrices get the integers in [low, high), every
+ * one of them equally often.
+ *
+ * @param A the matrix that is filled
+ * @param low the lower bound
+ * @param high the upper bound, it is not included
+ * @param gen the generator, it is advanced by the size of the matrix
+ * @retval None
+ */
+template <typename DType>
+void uniform(Matrix<DType>& A, const DType low, const DType high, Generator& gen) {
+
+    assert((low < high) &&
+        "The lower bound must be smaller than the upper bound!");
+
+    const double width = static_cast<double>(high) - low;
+
+    detail::fill_pairs(A, gen.get_seed(), gen.advance(detail::pair_counters(A)),
+        [low, high, width](std::uint64_t, const std::uint32_t w[4], DType x[2]) {
+            x[0] = detail::uniform_value(low, high, width, detail::unit_uniform<DType>(w[0], w[1]));
+            x[1] = detail::uniform_value(low, high, width, detail::unit_uniform<DType>(w[2], w[3]));
+        });
+}
+
+/*
+ * The function that fills the matrix with normal random numbers
+ *
+ * Matrix::Generator gen(7);
+ * Matrix::Matrix<float> noise(64, 64);
+ *
+ * Matrix::normal(noise, 0.0f, 0.5f, gen);
+ *
+ * @param A the matrix that is filled
+ * @param mean the mean of the distribution
+ * @param stddev the standard deviation of the distribution
+ * @param gen the generator, it is advanced by the size of the matrix
+ * @retval None
+ */
+template <typename DType>
+void normal(Matrix<DType>& A, const DType mean, const DType stddev, Generator& gen) {
+
+    assert((stddev >= 0) &&
+        "The standard deviation cannot be negative!");
+
+    detail::fill_pairs(A, gen.get_seed(), gen.advance(detail::pair_counters(A)),
+        [mean, stddev](std::uint64_t, const std::uint32_t w[4], DType x[2]) {
+            double z[2];
+            detail::unit_normals(w, z);
+
+            x[0] = static_cast<DType>(mean + stddev * z[0]);
+            x[1] = static_cast<DType>(mean + stddev * z[1]);
+        });
+}
+
+/*
+ * The function that fills the matrix with 1 with the probability p and 0 otherwise
+ *
+ * Matrix::Matrix<double> mask(128, 128);
+ * Matrix::bernoulli(mask, 0.9);   // the dropout mask that keeps 90%
+ *
+ * @param A the matrix that is filled
+ * @param p the probability of 1
+ * @param gen the generator, it is advanced by the size of the matrix
+ * @retval None
+ */
+template <typename DType>
+void bernoulli(Matrix<DType>& A, const double p, Generator& gen) {
+
+    assert((p >= 0 && p <= 1) &&
+        "The probability must be in [0, 1]!");
+
+    detail::fill_pairs(A, gen.get_seed(), gen.advance(detail::pair_counters(A)),
+        [p](std::uint64_t, const std::uint32_t w[4], DType x[2]) {
+            x[0] = static_cast<DType>(detail::unit_uniform<double>(w[0], w[1]) < p);
+            x[1] = static_cast<DType>(detail::unit_uniform<double>(w[2], w[3]) < p);
+        });
+}
+
+/*
+ * The function that fills the matrix with truncated normal random numbers
+ *
+ * The numbers are normal with the mean and the standard deviation, and they
+ * are drawn again until they are in [mean - bound * stddev, mean + bound * stddev].
+ * The redraws of the element use the next attempts of its counter, so they
+ * don't depend on the other elements and the threads either.
+ *
+ * Matrix::Matrix<double> W(512, 512);
+ * Matrix::truncated_normal(W, 0.0, 0.02);   // within 2 standard deviations
+ *
+ * @param A the matrix that is filled
+ * @param mean the mean of the normal distribution
+ * @param stddev the standard deviation of the normal distribution
+ * @param bound the truncation in the standard deviations
+ * @param gen the generator, it is advanced by the size of the matrix
+ * @retval None
+ */
+template <typename DType>
+void truncated_normal(Matrix<DType>& A, const DType mean, const DType stddev, const DType bound,
+                      Generator& gen) {
+
+    assert((stddev >= 0) &&
+        "The standard deviation cannot be negative!");
+
+    assert((bound > 0) &&
+        "The bound must be positive!");
+
+    const std::uint64_t key = gen.get_seed();
+    const std::uint64_t first = gen.advance(detail::pair_counters(A));
+    const double limit = bound;
+
+    detail::fill_pairs(A, key, first,
+        [&](std::uint64_t counter, const std::uint32_t w[4], DType x[2]) {
+            double z[2];
+            detail::unit_normals(w, z);
+
+            // the rejected value is drawn again from the same half of the next attempts of its counter
+            for (int h = 0; h < 2; h++) {
+                for (std::uint32_t attempt = 1; std::abs(z[h]) > limit; attempt++) {
+                    std::uint32_t again[4];
+                    double redraw[2];
+
+                    gen.block(counter, attempt, again);
+                    detail::unit_normals(again, redraw);
+                    z[h] = redraw[h];
+                }
+
+                x[h] = static_cast<DType>(mean + stddev * z[h]);
+            }
+        });
+}
+
+} // end of namespace
+
+#endif // end of _DISTRIBUTIONS_CPP_
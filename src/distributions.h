@@ -0,0 +1,53 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#ifndef _DISTRIBUTIONS_H_
+#define _DISTRIBUTIONS_H_
+
+#include <vector>
+#include "matrix.h"
+#include "generator.h"
+
+namespace Matrix {
+
+template <typename DType>
+void uniform(Matrix<DType>&, const DType = 0, const DType = 1,
+             Generator& = default_generator());
+
+template <typename DType>
+void normal(Matrix<DType>&, const DType = 0, const DType = 1,
+            Generator& = default_generator());
+
+template <typename DType>
+void bernoulli(Matrix<DType>&, const double = 0.5,
+               Generator& = default_generator());
+
+template <typename DType>
+void truncated_normal(Matrix<DType>&, const DType = 0, const DType = 1, const DType = 2,
+                      Generator& = default_generator());
+
+} // end of namespace
+
+#include "distributions.cpp"
+#endif // end of _DISTRIBUTIONS_H_
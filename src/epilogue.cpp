@@ -0,0 +1,224 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#ifndef _EPILOGUE_CPP_
+#define _EPILOGUE_CPP_
+
+#include "matrix.h"
+#include "epilogue.h"
+
+#include <algorithm> // for std::max
+#include <cmath>     // for std::exp, std::tanh
+#include <assert.h>  // for assert
+
+namespace Matrix {
+
+namespace detail {
+
+// the pointer and the strides of the matrix broadcast to the rows x columns matrix,
+// the broadcast dimensions have the stride 0
+template <typename DType>
+struct BroadcastOperand {
+    const DType* data = nullptr;
+    long row_stride = 0;
+    long column_stride = 0;
+
+    BroadcastOperand(const Matrix<DType>* A, const int rows, const int columns) {
+        if (!A)
+            return;
+
+        auto shape = A->get_shape();
+
+        assert((shape.size() == 2 && (shape[0] == 1 || shape[0] == rows) &&
+            (shape[1] == 1 || shape[1] == columns)) &&
+            "The operand of the epilogue can not be broadcast to the output!");
+
+        data = A->data();
+        row_stride = (shape[0] == 1) ? 0 : shape[1];
+        column_stride = (shape[1] == 1) ? 0 : 1;
+    }
+};
+
+template <typename DType>
+void activate(const Activation activation, DType* c, const int count) {
+    switch (activation) {
+    case Activation::IDENTITY:
+        break;
+    case Activation::RELU:
+        for (int j = 0; j < count; j++)
+            c[j] = std::max(c[j], DType(0));
+        break;
+    case Activation::SIGMOID:
+        for (int j = 0; j < count; j++)
+            c[j] = 1 / (1 + std::exp(-c[j]));
+        break;
+    case Activation::TANH:
+        for (int j = 0; j < count; j++)
+            c[j] = std::tanh(c[j]);
+        break;
+    case Activation::EXP:
+        for (int j = 0; j < count; j++)
+            c[j] = std::exp(c[j]);
+        break;
+    }
+}
+
+// the finish of gemm_blocked that applies the epilogue to a row of a tile
+template <typename DType>
+struct EpilogueFinish {
+    Activation activation;
+    BroadcastOperand<DType> bias;
+    BroadcastOperand<DType> scale;
+
+    void operator()(const long row, const long column, DType* c, const int count) const {
+        if (scale.data) {
+            const DType* s = scale.data + row * scale.row_stride + column * scale.column_stride;
+            for (int j = 0; j < count; j++)
+                c[j] *= s[j * scale.column_stride];
+        }
+
+        if (bias.data) {
+            const DType* b = bias.data + row * bias.row_stride + column * bias.column_stride;
+            for (int j = 0; j < count; j++)
+                c[j] += b[j * bias.column_stride];
+        }
+
+        activate(activation, c, count);
+    }
+};
+
+} // end of namespace detail
+
+template <typename DType>
+Epilogue<DType>::Epilogue(const Activation activation, const Matrix<DType>* bias, const Matrix<DType>* scale)
+: activation(activation), bias(bias), scale(scale)
+{
+}
+
+/*
+ * The function that does C = epilogue(alpha * op(A) op(B) + beta * C)
+ *
+ * It is gemm that finishes every tile of C with the epilogue right after
+ * its last products, while the tile is still in the cache. So the bias, the
+ * scale and the activation of a layer cost no extra pass over C and no
+ * temporary matrix.
+ *
+ * Matrix::Matrix<float> X(64, 1024), W(1024, 4096), b(1, 4096);
+ * Matrix::Matrix<float> Y(64, 4096);
+ *
+ * Matrix::gemm(1.0f, X, W, 0.0f, Y, Matrix::Epilogue<float>(Matrix::Activation::RELU, &b));
+ *
+ * @param alpha the scale of the product
+ * @param A the first matrix, op(A) has the shape (N, K)
+ * @param B the second matrix, op(B) has the shape (K, M)
+ * @param beta the scale of the old content of C
+ * @param C the result matrix with the shape (N, M)
+ * @param epilogue the activation, the bias and the scale of the result
+ * @param transpose_a uses A^T instead of A if it is true
+ * @param transpose_b uses B^T instead of B if it is true
+ * @retval None
+ */
+template <typename DType>
+void gemm(const DType alpha, const Matrix<DType>& A, const Matrix<DType>& B,
+          const DType beta, Matrix<DType>& C, const Epilogue<DType>& epilogue,
+          const bool transpose_a, const bool transpose_b) {
+    detail::TraceSpan trace("gemm", A, B, C);
+
+    auto a_shape = A.get_shape();
+    auto b_shape = B.get_shape();
+    auto c_shape = C.get_shape();
+
+    assert((a_shape.size() == 2 && b_shape.size() == 2 && c_shape.size() == 2) &&
+        "The matrices must be two dimensional!");
+
+    int m = transpose_a ? a_shape[1] : a_shape[0];
+    int k = transpose_a ? a_shape[0] : a_shape[1];
+    int n = transpose_b ? b_shape[0] : b_shape[1];
+
+    assert((k == (transpose_b ? b_shape[1] : b_shape[0])) &&
+        "The matrix multiplication is impossible");
+    assert((c_shape[0] == m && c_shape[1] == n) &&
+        "The shape of the output matrix is wrong!");
+
+    trace.set_flops(2.0 * m * n * k);
+
+    detail::EpilogueFinish<DType> finish{epilogue.activation,
+                                         detail::BroadcastOperand<DType>(epilogue.bias, m, n),
+                                         detail::BroadcastOperand<DType>(epilogue.scale, m, n)};
+
+    detail::gemm_blocked<DType, DType>(m, n, k, alpha, A.data(), a_shape[1], transpose_a,
+                                       B.data(), b_shape[1], transpose_b, beta, C.data(), n,
+                                       nullptr, nullptr, finish);
+}
+
+/*
+ * The function that computes the dense layer activation(X W + b) in one pass
+ *
+ * It is sigmoid(dot(X, W) + b) and alike without the temporary matrices,
+ * see gemm with the epilogue. The activations other than the identity are
+ * for the floating point types.
+ *
+ * Matrix::Matrix<double> H = Matrix::dense(X, W1, b1, Matrix::Activation::TANH);
+ * Matrix::Matrix<double> Y = Matrix::dense(H, W2, b2, Matrix::Activation::SIGMOID);
+ *
+ * @param X the inputs with the shape (N, K)
+ * @param W the weights with the shape (K, M)
+ * @param b the bias with the shape (1, M), (N, 1), (N, M) or (1, 1)
+ * @param activation the function applied at the end
+ * @retval the matrix with the shape (N, M)
+ */
+template <typename DType>
+Matrix<DType> dense(const Matrix<DType>& X, const Matrix<DType>& W, const Matrix<DType>& b,
+                    const Activation activation) {
+    MATRIX_ACCOUNT_SCOPE("dense");
+    detail::TraceSpan trace("dense", X, W, b);
+
+    Matrix<DType> RESULT = detail::matrix_with_shape<DType>({X.get_shape()[0], W.get_shape()[1]});
+    trace.set_flops(2.0 * X.get_shape()[0] * X.get_shape()[1] * W.get_shape()[1]);
+    gemm<DType>(1, X, W, 0, RESULT, Epilogue<DType>(activation, &b));
+    return RESULT;
+}
+
+/*
+ * The function that computes activation(X W) in one pass
+ *
+ * @param X the inputs with the shape (N, K)
+ * @param W the weights with the shape (K, M)
+ * @param activation the function applied at the end
+ * @retval the matrix with the shape (N, M)
+ */
+template <typename DType>
+Matrix<DType> dense(const Matrix<DType>& X, const Matrix<DType>& W, const Activation activation) {
+    MATRIX_ACCOUNT_SCOPE("dense");
+    detail::TraceSpan trace("dense", X, W);
+
+    Matrix<DType> RESULT = detail::matrix_with_shape<DType>({X.get_shape()[0], W.get_shape()[1]});
+    trace.set_flops(2.0 * X.get_shape()[0] * X.get_shape()[1] * W.get_shape()[1]);
+    gemm<DType>(1, X, W, 0, RESULT, Epilogue<DType>(activation));
+    return RESULT;
+}
+
+} // end of namespace
+
+#endif // end of _EPILOGUE_CPP_
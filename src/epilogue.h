@@ -0,0 +1,68 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#ifndef _EPILOGUE_H_
+#define _EPILOGUE_H_
+
+#include "matrix.h"
+
+namespace Matrix {
+
+// the element-wise function at the end of the epilogue
+enum class Activation { IDENTITY, RELU, SIGMOID, TANH, EXP };
+
+/*
+ * The work that gemm does on the tiles of C after their products.
+ *
+ * Every element v = alpha * op(A) op(B) + beta * C becomes
+ * activation(scale * v + bias), where scale and bias are optional matrices
+ * broadcast to the shape of C: (1, M) for the columns, (N, 1) for the rows,
+ * (N, M) for every element or (1, 1). They are pointed, not copied, so they
+ * must live until gemm returns.
+ */
+template <typename DType>
+struct Epilogue {
+    Activation activation;
+    const Matrix<DType>* bias;
+    const Matrix<DType>* scale;
+
+    Epilogue(const Activation = Activation::IDENTITY, const Matrix<DType>* = nullptr,
+             const Matrix<DType>* = nullptr);
+};
+
+template <typename DType>
+void gemm(const DType, const Matrix<DType>&, const Matrix<DType>&, const DType, Matrix<DType>&,
+          const Epilogue<DType>&, const bool = false, const bool = false);
+
+template <typename DType>
+Matrix<DType> dense(const Matrix<DType>&, const Matrix<DType>&, const Matrix<DType>&,
+                    const Activation = Activation::IDENTITY);
+
+template <typename DType>
+Matrix<DType> dense(const Matrix<DType>&, const Matrix<DType>&, const Activation = Activation::IDENTITY);
+
+} // end of namespace
+
+#include "epilogue.cpp"
+#endif // end of _EPILOGUE_H_
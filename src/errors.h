@@ -41,5 +41,23 @@ class DecompositionError : public std::exception {
     }
 };
 
+class SerializationError : public std::exception {
+    virtual const char* what() const throw() {
+        return "The matrix could not be written or read.";
+    }
+};
+
+class ParseError : public std::exception {
+    virtual const char* what() const throw() {
+        return "The text could not be parsed as the matrix.";
+    }
+};
+
+class SharedMemoryError : public std::exception {
+    virtual const char* what() const throw() {
+        return "The shared memory segment could not be created or attached.";
+    }
+};
+
 }
 #endif // end of _ERRORS_H_
\ No newline at end of file
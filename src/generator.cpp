@@ -0,0 +1,209 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#ifndef _GENERATOR_CPP_
+#define _GENERATOR_CPP_
+
+#include "generator.h"
+
+#include <random> // for std::random_device
+
+namespace Matrix {
+
+namespace detail {
+
+// the multipliers and the key increments of Philox4x32 from Salmon et al.,
+// "Parallel random numbers: as easy as 1, 2, 3"
+constexpr std::uint32_t PHILOX_M0 = 0xD2511F53;
+constexpr std::uint32_t PHILOX_M1 = 0xCD9E8D57;
+constexpr std::uint32_t PHILOX_W0 = 0x9E3779B9;
+constexpr std::uint32_t PHILOX_W1 = 0xBB67AE85;
+constexpr int PHILOX_ROUNDS = 10;
+
+/*
+ * The blocks of Philox4x32-10 for the L counters (first + l, attempt, 0)
+ * where out[w][l] is the word w of the block l.
+ *
+ * The lanes are independent and the products are 32 x 32 -> 64 bits, so
+ * the loops over the lanes are vectorized by the compiler.
+ */
+template <int L>
+inline void philox_lanes(const std::uint64_t key, const std::uint64_t first,
+                         const std::uint32_t attempt, std::uint32_t out[4][L]) {
+    std::uint32_t c0[L], c1[L], c2[L], c3[L];
+
+    for (int l = 0; l < L; l++) {
+        std::uint64_t counter = first + l;
+        c0[l] = static_cast<std::uint32_t>(counter);
+        c1[l] = static_cast<std::uint32_t>(counter >> 32);
+        c2[l] = attempt;
+        c3[l] = 0;
+    }
+
+    std::uint32_t k0 = static_cast<std::uint32_t>(key);
+    std::uint32_t k1 = static_cast<std::uint32_t>(key >> 32);
+
+    for (int r = 0; r < PHILOX_ROUNDS; r++) {
+        for (int l = 0; l < L; l++) {
+            std::uint64_t p0 = static_cast<std::uint64_t>(PHILOX_M0) * c0[l];
+            std::uint64_t p1 = static_cast<std::uint64_t>(PHILOX_M1) * c2[l];
+
+            std::uint32_t n0 = static_cast<std::uint32_t>(p1 >> 32) ^ c1[l] ^ k0;
+            std::uint32_t n2 = static_cast<std::uint32_t>(p0 >> 32) ^ c3[l] ^ k1;
+
+            c1[l] = static_cast<std::uint32_t>(p1);
+            c3[l] = static_cast<std::uint32_t>(p0);
+            c0[l] = n0;
+            c2[l] = n2;
+        }
+
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+
+    for (int l = 0; l < L; l++) {
+        out[0][l] = c0[l];
+        out[1][l] = c1[l];
+        out[2][l] = c2[l];
+        out[3][l] = c3[l];
+    }
+}
+
+} // end of namespace detail
+
+/*
+ * The constructor of the generator
+ *
+ * The same seed always gives the same numbers, the offset starts from 0.
+ *
+ * @param seed the key of Philox
+ */
+inline Generator::Generator(const std::uint64_t seed)
+: SEED(seed), OFFSET(0)
+{
+}
+
+inline Generator::Generator(const Generator& other)
+: SEED(other.SEED), OFFSET(other.OFFSET.load())
+{
+}
+
+inline Generator& Generator::operator=(const Generator& other) {
+    SEED = other.SEED;
+    OFFSET = other.OFFSET.load();
+
+    return *this;
+}
+
+/*
+ * The method that restarts the generator with the new seed
+ *
+ * @param seed the key of Philox
+ * @retval None
+ */
+inline void Generator::seed(const std::uint64_t seed) {
+    SEED = seed;
+    OFFSET = 0;
+}
+
+inline std::uint64_t Generator::get_seed() const {
+    return SEED;
+}
+
+inline std::uint64_t Generator::get_offset() const {
+    return OFFSET.load();
+}
+
+/*
+ * The method that jumps to any position of the stream of the generator
+ *
+ * @param offset the counter that the next advance starts from
+ * @retval None
+ */
+inline void Generator::set_offset(const std::uint64_t offset) {
+    OFFSET = offset;
+}
+
+/*
+ * The method that reserves the next n counters
+ *
+ * It is safe to call from many threads, every call gets its own counters.
+ *
+ * @param n the number of counters
+ * @retval the first reserved counter
+ */
+inline std::uint64_t Generator::advance(const std::uint64_t n) {
+    return OFFSET.fetch_add(n);
+}
+
+/*
+ * The method that returns the 128 random bits of one counter
+ *
+ * The attempt is the second part of the counter, the fills use it to draw
+ * again for the same element, like the rejected truncated normal values.
+ *
+ * @param counter the counter, usually a reserved one
+ * @param attempt the second part of the counter
+ * @param out the 4 random words
+ * @retval None
+ */
+inline void Generator::block(const std::uint64_t counter, const std::uint32_t attempt,
+                             std::uint32_t out[4]) const {
+    std::uint32_t words[4][1];
+    detail::philox_lanes<1>(SEED, counter, attempt, words);
+
+    for (int w = 0; w < 4; w++)
+        out[w] = words[w][0];
+}
+
+/*
+ * The function that returns the generator of the functions called without one
+ *
+ * It is seeded from std::random_device once, so the calls of random() give
+ * different matrices. manual_seed makes them reproducible.
+ *
+ * @retval the default generator
+ */
+inline Generator& default_generator() {
+    static Generator generator((static_cast<std::uint64_t>(std::random_device()()) << 32) ^
+                               std::random_device()());
+    return generator;
+}
+
+/*
+ * The function that seeds the default generator
+ *
+ * Matrix::manual_seed(42);
+ * Matrix::Matrix<double> A = Matrix::random<double>(3, 3);   // the same A on every run
+ *
+ * @param seed the new seed
+ * @retval None
+ */
+inline void manual_seed(const std::uint64_t seed) {
+    default_generator().seed(seed);
+}
+
+} // end of namespace
+
+#endif // end of _GENERATOR_CPP_
@@ -0,0 +1,75 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#ifndef _GENERATOR_H_
+#define _GENERATOR_H_
+
+#include <cstdint>
+#include <atomic>
+
+namespace Matrix {
+
+/*
+ * The counter-based random number generator Philox4x32-10.
+ *
+ * The random bits of a counter are a pure function of the seed and the
+ * counter, there is no state to carry from one number to the next. So the
+ * element i of a matrix can always be made from the counter i, whichever
+ * thread fills it, and jumping ahead by n numbers is only adding n to the
+ * offset. The fills of the distributions reserve the counters of their
+ * elements by advance (one 128 bit block makes two doubles), so the next
+ * fill with the same generator gives new numbers.
+ *
+ * Matrix::Generator gen(42);
+ * std::uint32_t bits[4];
+ * gen.block(gen.advance(1), 0, bits);
+ */
+class Generator {
+public:
+    explicit Generator(const std::uint64_t = 0);
+    Generator(const Generator&);
+    Generator& operator=(const Generator&);
+
+    void seed(const std::uint64_t);
+    std::uint64_t get_seed() const;
+
+    std::uint64_t get_offset() const;
+    void set_offset(const std::uint64_t);
+
+    std::uint64_t advance(const std::uint64_t);
+
+    void block(const std::uint64_t, const std::uint32_t, std::uint32_t[4]) const;
+
+private:
+    std::uint64_t SEED;
+    std::atomic<std::uint64_t> OFFSET;
+};
+
+Generator& default_generator();
+void manual_seed(const std::uint64_t);
+
+} // end of namespace
+
+#include "generator.cpp"
+#endif // end of _GENERATOR_H_
@@ -0,0 +1,363 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#ifndef _HALF_CPP_
+#define _HALF_CPP_
+
+#include "matrix.h"
+#include "half.h"
+
+#include <cstring>  // for std::memcpy
+#include <assert.h> // for assert
+
+#if defined(__F16C__)
+#include <immintrin.h> // for the conversions of 8 halfs at once
+#endif
+
+namespace Matrix {
+
+namespace detail {
+
+inline std::uint32_t float_bits(const float f) {
+    std::uint32_t u;
+    std::memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+inline float bits_float(const std::uint32_t u) {
+    float f;
+    std::memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+/*
+ * float to half with the rounding to the nearest even, after F. Giesen,
+ * "float->half variants". The too large numbers become inf, NaN stays NaN.
+ */
+inline std::uint16_t float_to_half_bits(const float f) {
+    std::uint32_t u = float_bits(f);
+    const std::uint32_t sign = u & 0x80000000u;
+    u ^= sign;
+
+    std::uint32_t h;
+
+    if (u >= (127 + 16) << 23) {
+        // inf or NaN, and the numbers whose exponent is too large for half
+        h = (u > 0x7f800000u) ? 0x7e00 : 0x7c00;
+    } else if (u < 113 << 23) {
+        // the subnormal halfs, the float addition rounds the mantissa at the right place
+        const std::uint32_t magic = ((127 - 15) + (23 - 10) + 1) << 23;
+        h = float_bits(bits_float(u) + bits_float(magic)) - magic;
+    } else {
+        // the normal halfs, the exponent is rebiased and the mantissa is rounded
+        const std::uint32_t odd = (u >> 13) & 1;
+        u -= (127u - 15u) << 23;
+        u += 0xfff + odd;
+        h = u >> 13;
+    }
+
+    return static_cast<std::uint16_t>(h | (sign >> 16));
+}
+
+// half to float, it is exact
+inline float half_bits_to_float(const std::uint16_t h) {
+    const std::uint32_t shifted_exponent = 0x7c00 << 13;
+
+    std::uint32_t u = (h & 0x7fff) << 13;
+    const std::uint32_t exponent = u & shifted_exponent;
+    u += (127 - 15) << 23;
+
+    if (exponent == shifted_exponent) {
+        // inf or NaN
+        u += (128 - 16) << 23;
+    } else if (exponent == 0) {
+        // zero or subnormal, it is normalized by the float subtraction
+        u += 1 << 23;
+        u = float_bits(bits_float(u) - bits_float(113 << 23));
+    }
+
+    return bits_float(u | (static_cast<std::uint32_t>(h & 0x8000) << 16));
+}
+
+// float to bfloat16 with the rounding to the nearest even, NaN stays NaN
+inline std::uint16_t float_to_bfloat16_bits(const float f) {
+    std::uint32_t u = float_bits(f);
+
+    if ((u & 0x7fffffffu) > 0x7f800000u)
+        return static_cast<std::uint16_t>((u >> 16) | 0x40);
+
+    u += 0x7fff + ((u >> 16) & 1);
+    return static_cast<std::uint16_t>(u >> 16);
+}
+
+inline float bfloat16_bits_to_float(const std::uint16_t b) {
+    return bits_float(static_cast<std::uint32_t>(b) << 16);
+}
+
+// the value of the arithmetic types, and the float value of the 16 bit types
+template <typename DType>
+inline DType widen(const DType x) { return x; }
+
+inline float widen(const float16 x) { return x; }
+inline float widen(const bfloat16 x) { return x; }
+
+/*
+ * dst[i] = src[i] for i < n with the conversion of the element type.
+ *
+ * The generic one converts through the conversion operators (through float
+ * for the 16 bit types), the overloads below are the kernels of the hot
+ * conversions, the half ones use the F16C instructions if they are enabled.
+ */
+template <typename From, typename To>
+void convert_array(const From* src, To* dst, const long n) {
+    for (long i = 0; i < n; i++)
+        dst[i] = static_cast<To>(widen(src[i]));
+}
+
+template <typename From>
+void convert_array(const From* src, From* dst, const long n) {
+    std::copy(src, src + n, dst);
+}
+
+inline void convert_array(const float16* src, float* dst, const long n) {
+    long i = 0;
+
+#if defined(__F16C__)
+    for (; i + 8 <= n; i += 8) {
+        __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+    }
+#endif
+
+    for (; i < n; i++)
+        dst[i] = half_bits_to_float(src[i].bits);
+}
+
+inline void convert_array(const float* src, float16* dst, const long n) {
+    long i = 0;
+
+#if defined(__F16C__)
+    for (; i + 8 <= n; i += 8) {
+        __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), h);
+    }
+#endif
+
+    for (; i < n; i++)
+        dst[i].bits = float_to_half_bits(src[i]);
+}
+
+inline void convert_array(const bfloat16* src, float* dst, const long n) {
+    for (long i = 0; i < n; i++)
+        dst[i] = bfloat16_bits_to_float(src[i].bits);
+}
+
+inline void convert_array(const float* src, bfloat16* dst, const long n) {
+    for (long i = 0; i < n; i++)
+        dst[i].bits = float_to_bfloat16_bits(src[i]);
+}
+
+// the shared body of the gemm of the 16 bit matrices
+template <typename SType>
+void gemm_low_precision(const float alpha, const Matrix<SType>& A, const Matrix<SType>& B,
+                        const float beta, Matrix<float>& C, const bool transpose_a, const bool transpose_b) {
+
+    auto a_shape = A.get_shape();
+    auto b_shape = B.get_shape();
+    auto c_shape = C.get_shape();
+
+    assert((a_shape.size() == 2 && b_shape.size() == 2 && c_shape.size() == 2) &&
+        "The matrices must be two dimensional!");
+
+    int m = transpose_a ? a_shape[1] : a_shape[0];
+    int k = transpose_a ? a_shape[0] : a_shape[1];
+    int n = transpose_b ? b_shape[0] : b_shape[1];
+
+    assert((k == (transpose_b ? b_shape[1] : b_shape[0])) &&
+        "The matrix multiplication is impossible");
+    assert((c_shape[0] == m && c_shape[1] == n) &&
+        "The shape of the output matrix is wrong!");
+
+    gemm_blocked(m, n, k, alpha, A.data(), a_shape[1], transpose_a,
+                 B.data(), b_shape[1], transpose_b, beta, C.data(), n);
+}
+
+template <typename SType>
+Matrix<float> dot_low_precision(const Matrix<SType>& A, const Matrix<SType>& B) {
+    auto a_shape = A.get_shape();
+    auto b_shape = B.get_shape();
+
+    assert((a_shape.size() == 2 && b_shape.size() == 2) &&
+        "The matrices must be two dimensional!");
+
+    Matrix<float> RESULT(a_shape[0], b_shape[1]);
+    gemm_low_precision(1.0f, A, B, 0.0f, RESULT, false, false);
+
+    return RESULT;
+}
+
+} // end of namespace detail
+
+inline float16::float16(const float f)
+: bits(detail::float_to_half_bits(f))
+{
+}
+
+inline float16::operator float() const {
+    return detail::half_bits_to_float(bits);
+}
+
+inline float16& float16::operator+=(const float x) { return *this = float(*this) + x; }
+inline float16& float16::operator-=(const float x) { return *this = float(*this) - x; }
+inline float16& float16::operator*=(const float x) { return *this = float(*this) * x; }
+inline float16& float16::operator/=(const float x) { return *this = float(*this) / x; }
+
+/*
+ * The function that makes the half from its bits
+ *
+ * Matrix::float16 largest = Matrix::float16::from_bits(0x7bff);   // 65504
+ *
+ * @param bits the IEEE 754 binary16 bits
+ * @retval the half
+ */
+inline float16 float16::from_bits(const std::uint16_t bits) {
+    float16 h;
+    h.bits = bits;
+    return h;
+}
+
+inline bfloat16::bfloat16(const float f)
+: bits(detail::float_to_bfloat16_bits(f))
+{
+}
+
+inline bfloat16::operator float() const {
+    return detail::bfloat16_bits_to_float(bits);
+}
+
+inline bfloat16& bfloat16::operator+=(const float x) { return *this = float(*this) + x; }
+inline bfloat16& bfloat16::operator-=(const float x) { return *this = float(*this) - x; }
+inline bfloat16& bfloat16::operator*=(const float x) { return *this = float(*this) * x; }
+inline bfloat16& bfloat16::operator/=(const float x) { return *this = float(*this) / x; }
+
+inline bfloat16 bfloat16::from_bits(const std::uint16_t bits) {
+    bfloat16 b;
+    b.bits = bits;
+    return b;
+}
+
+/*
+ * The function that converts the matrix to another element type
+ *
+ * It is the way in and out of the 16 bit storage. The conversions between
+ * float and float16 or bfloat16 have their own kernels, the other ones go
+ * through float (double to float16 is rounded twice, first to float).
+ * The large matrices are converted by the threads of the pool.
+ *
+ * Matrix::Matrix<float> W(1024, 1024);
+ * Matrix::Matrix<Matrix::float16> W16 = Matrix::astype<Matrix::float16>(W);   // half of the memory
+ * Matrix::Matrix<double> W64 = Matrix::astype<double>(W16);
+ *
+ * @param A the matrix
+ * @retval the new matrix with the same shape and the element type To
+ */
+template <typename To, typename From>
+Matrix<To> astype(const Matrix<From>& A) {
+    Matrix<To> RESULT = detail::matrix_with_shape<To>(A.get_shape());
+
+    const From* src = A.data();
+    To* dst = RESULT.data();
+
+    detail::elementwise_for(A.get_matrix_size(), [src, dst](long first, long last) {
+        detail::convert_array(src + first, dst + first, last - first);
+    });
+
+    return RESULT;
+}
+
+/*
+ * The function that does C = alpha * op(A) op(B) + beta * C for the half matrices
+ *
+ * A and B are stored in 16 bits and C in float. The blocks of A and B are
+ * converted to float while they are packed for the kernel of gemm, so the
+ * products are accumulated in float and the memory traffic of the operands
+ * is halved. The parameters work like in gemm of the same types.
+ *
+ * Matrix::Matrix<Matrix::float16> W = Matrix::astype<Matrix::float16>(weights);
+ * Matrix::Matrix<Matrix::float16> X = Matrix::astype<Matrix::float16>(inputs);
+ * Matrix::Matrix<float> Y(64, 512);
+ *
+ * Matrix::gemm(1.0f, X, W, 0.0f, Y);
+ *
+ * @param alpha the scale of the product
+ * @param A the first matrix, op(A) has the shape (N, K)
+ * @param B the second matrix, op(B) has the shape (K, M)
+ * @param beta the scale of the old content of C
+ * @param C the float result matrix with the shape (N, M)
+ * @param transpose_a uses A^T instead of A if it is true
+ * @param transpose_b uses B^T instead of B if it is true
+ * @retval None
+ */
+inline void gemm(const float alpha, const Matrix<float16>& A, const Matrix<float16>& B,
+                 const float beta, Matrix<float>& C, const bool transpose_a, const bool transpose_b) {
+    detail::gemm_low_precision(alpha, A, B, beta, C, transpose_a, transpose_b);
+}
+
+/*
+ * The function that does C = alpha * op(A) op(B) + beta * C for the bfloat16 matrices
+ *
+ * It works like gemm of the float16 matrices.
+ */
+inline void gemm(const float alpha, const Matrix<bfloat16>& A, const Matrix<bfloat16>& B,
+                 const float beta, Matrix<float>& C, const bool transpose_a, const bool transpose_b) {
+    detail::gemm_low_precision(alpha, A, B, beta, C, transpose_a, transpose_b);
+}
+
+/*
+ * The function that multiplies two half matrices into a float matrix
+ *
+ * The products are accumulated in float, see gemm of the float16 matrices.
+ *
+ * @param A the first matrix with the shape (N, K)
+ * @param B the second matrix with the shape (K, M)
+ * @retval the float matrix with the shape (N, M)
+ */
+inline Matrix<float> dot(const Matrix<float16>& A, const Matrix<float16>& B) {
+    return detail::dot_low_precision(A, B);
+}
+
+/*
+ * The function that multiplies two bfloat16 matrices into a float matrix
+ *
+ * @param A the first matrix with the shape (N, K)
+ * @param B the second matrix with the shape (K, M)
+ * @retval the float matrix with the shape (N, M)
+ */
+inline Matrix<float> dot(const Matrix<bfloat16>& A, const Matrix<bfloat16>& B) {
+    return detail::dot_low_precision(A, B);
+}
+
+} // end of namespace
+
+#endif // end of _HALF_CPP_
@@ -0,0 +1,95 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#ifndef _HALF_H_
+#define _HALF_H_
+
+#include <cstdint>
+#include <vector>
+#include "matrix.h"
+
+namespace Matrix {
+
+/*
+ * The IEEE 754 half precision number, the storage type of Matrix<float16>.
+ *
+ * It has 1 sign bit, 5 exponent bits and 10 mantissa bits, so it keeps
+ * about 3 decimal digits up to 65504. The arithmetic is done in float:
+ * the number converts to float implicitly and is made from float with the
+ * rounding to the nearest even.
+ */
+struct float16 {
+    std::uint16_t bits;
+
+    float16() = default;
+    float16(const float);
+    operator float() const;
+
+    float16& operator+=(const float);
+    float16& operator-=(const float);
+    float16& operator*=(const float);
+    float16& operator/=(const float);
+
+    static float16 from_bits(const std::uint16_t);
+};
+
+/*
+ * The brain floating point number, the storage type of Matrix<bfloat16>.
+ *
+ * It is the upper half of float: 1 sign bit, 8 exponent bits and 7 mantissa
+ * bits, so it has the range of float with about 2 decimal digits. It works
+ * like float16.
+ */
+struct bfloat16 {
+    std::uint16_t bits;
+
+    bfloat16() = default;
+    bfloat16(const float);
+    operator float() const;
+
+    bfloat16& operator+=(const float);
+    bfloat16& operator-=(const float);
+    bfloat16& operator*=(const float);
+    bfloat16& operator/=(const float);
+
+    static bfloat16 from_bits(const std::uint16_t);
+};
+
+template <typename To, typename From>
+Matrix<To> astype(const Matrix<From>&);
+
+void gemm(const float, const Matrix<float16>&, const Matrix<float16>&, const float, Matrix<float>&,
+          const bool = false, const bool = false);
+
+void gemm(const float, const Matrix<bfloat16>&, const Matrix<bfloat16>&, const float, Matrix<float>&,
+          const bool = false, const bool = false);
+
+Matrix<float> dot(const Matrix<float16>&, const Matrix<float16>&);
+
+Matrix<float> dot(const Matrix<bfloat16>&, const Matrix<bfloat16>&);
+
+} // end of namespace
+
+#include "half.cpp"
+#endif // end of _HALF_H_
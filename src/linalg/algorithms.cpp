@@ -59,6 +59,9 @@ namespace Matrix {
  */
 template <typename DType>
 Matrix<DType> inv(Matrix<DType> A) {
+    MATRIX_ACCOUNT_SCOPE("inv");
+    detail::TraceSpan trace("inv", A);
+
     auto __shape = A.get_shape();
 
     assert((__shape.size() == 2) &&
@@ -66,6 +69,8 @@ Matrix<DType> inv(Matrix<DType> A) {
     assert((__shape[0] == __shape[1]) &&
         "The matrix must be the square matrix!");
 
+    trace.set_flops(2.0 * __shape[0] * __shape[0] * __shape[0]);
+
     try {
         auto lup = LUP(A);
 
@@ -104,7 +109,8 @@ Matrix<DType> inv(Matrix<DType> A) {
 
         // P is permutation matrix, therefore, P^-1 = P^T
         // If PA = LU => A = P^T LU, so, A^-1 = U^-1 L^-1 P
-        Matrix<DType> invA = dot(dot(invU, invL), transpoze(lup[2]));
+        Matrix<DType> invA(N, N);
+        gemm<DType>(1, dot(invU, invL), lup[2], 0, invA, false, true);
 
         return invA;
     } catch (DecompositionError& e) {
@@ -123,6 +129,9 @@ Matrix<DType> inv(Matrix<DType> A) {
  */
 template <typename DType>
 double det(Matrix<DType> A) {
+    MATRIX_ACCOUNT_SCOPE("det");
+    detail::TraceSpan trace("det", A);
+
     auto __shape = A.get_shape();
 
     assert((__shape.size() == 2) &&
@@ -130,6 +139,8 @@ double det(Matrix<DType> A) {
     assert((__shape[0] == __shape[1]) &&
         "The matrix must be the square matrix!");
 
+    trace.set_flops(2.0 / 3.0 * __shape[0] * __shape[0] * __shape[0]);
+
     try {
         auto U = LUP(A)[1];
         int N = __shape[0];
@@ -0,0 +1,515 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#ifndef _LINALG_BATCHED_CPP_
+#define _LINALG_BATCHED_CPP_
+
+#include "../matrix.h"
+#include "../linalg/batched.h"
+
+#include <vector>    // for std::vector
+#include <cmath>     // for std::abs
+#include <assert.h>  // for assert
+
+namespace Matrix {
+
+namespace detail {
+
+// the number of slices that are eliminated together by the structure-of-arrays kernel
+constexpr int BATCHED_LANES = 8;
+
+// the largest slice dimension that is handled by the structure-of-arrays kernel,
+// bigger slices are eliminated one by one
+constexpr int BATCHED_SOA_MAX_N = 16;
+
+/*
+ * The closed-form determinant of one row-major n x n slice where n <= 4.
+ */
+template <typename DType>
+DType det_small(const DType* a, const int n) {
+    switch (n) {
+    case 1:
+        return a[0];
+    case 2:
+        return a[0] * a[3] - a[1] * a[2];
+    case 3:
+        return a[0] * (a[4] * a[8] - a[5] * a[7])
+             + a[1] * (a[5] * a[6] - a[3] * a[8])
+             + a[2] * (a[3] * a[7] - a[4] * a[6]);
+    default: {
+        DType s0 = a[0] * a[5]  - a[4] * a[1];
+        DType s1 = a[0] * a[6]  - a[4] * a[2];
+        DType s2 = a[0] * a[7]  - a[4] * a[3];
+        DType s3 = a[1] * a[6]  - a[5] * a[2];
+        DType s4 = a[1] * a[7]  - a[5] * a[3];
+        DType s5 = a[2] * a[7]  - a[6] * a[3];
+        DType c5 = a[10] * a[15] - a[14] * a[11];
+        DType c4 = a[9]  * a[15] - a[13] * a[11];
+        DType c3 = a[9]  * a[14] - a[13] * a[10];
+        DType c2 = a[8]  * a[15] - a[12] * a[11];
+        DType c1 = a[8]  * a[14] - a[12] * a[10];
+        DType c0 = a[8]  * a[13] - a[12] * a[9];
+        return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    }
+    }
+}
+
+/*
+ * The closed-form inverse of one row-major n x n slice where n <= 4.
+ * If the slice is singular, the output is filled with zeros and false is returned.
+ */
+template <typename DType>
+bool inv_small(const DType* a, DType* out, const int n) {
+    const int size = n * n;
+
+    if (n == 1) {
+        if (a[0] == 0) {
+            out[0] = 0;
+            return false;
+        }
+        out[0] = 1 / a[0];
+        return true;
+    }
+
+    if (n == 2) {
+        DType d = a[0] * a[3] - a[1] * a[2];
+        if (d == 0) {
+            for (int i = 0; i < size; i++)
+                out[i] = 0;
+            return false;
+        }
+        DType inv_d = 1 / d;
+        out[0] =  a[3] * inv_d;
+        out[1] = -a[1] * inv_d;
+        out[2] = -a[2] * inv_d;
+        out[3] =  a[0] * inv_d;
+        return true;
+    }
+
+    if (n == 3) {
+        DType c00 = a[4] * a[8] - a[5] * a[7];
+        DType c01 = a[5] * a[6] - a[3] * a[8];
+        DType c02 = a[3] * a[7] - a[4] * a[6];
+        DType d = a[0] * c00 + a[1] * c01 + a[2] * c02;
+        if (d == 0) {
+            for (int i = 0; i < size; i++)
+                out[i] = 0;
+            return false;
+        }
+        DType inv_d = 1 / d;
+        out[0] = c00 * inv_d;
+        out[1] = (a[2] * a[7] - a[1] * a[8]) * inv_d;
+        out[2] = (a[1] * a[5] - a[2] * a[4]) * inv_d;
+        out[3] = c01 * inv_d;
+        out[4] = (a[0] * a[8] - a[2] * a[6]) * inv_d;
+        out[5] = (a[2] * a[3] - a[0] * a[5]) * inv_d;
+        out[6] = c02 * inv_d;
+        out[7] = (a[1] * a[6] - a[0] * a[7]) * inv_d;
+        out[8] = (a[0] * a[4] - a[1] * a[3]) * inv_d;
+        return true;
+    }
+
+    // n == 4, the expansion by the 2 x 2 minors of the first two and the last two rows
+    DType s0 = a[0] * a[5]  - a[4] * a[1];
+    DType s1 = a[0] * a[6]  - a[4] * a[2];
+    DType s2 = a[0] * a[7]  - a[4] * a[3];
+    DType s3 = a[1] * a[6]  - a[5] * a[2];
+    DType s4 = a[1] * a[7]  - a[5] * a[3];
+    DType s5 = a[2] * a[7]  - a[6] * a[3];
+    DType c5 = a[10] * a[15] - a[14] * a[11];
+    DType c4 = a[9]  * a[15] - a[13] * a[11];
+    DType c3 = a[9]  * a[14] - a[13] * a[10];
+    DType c2 = a[8]  * a[15] - a[12] * a[11];
+    DType c1 = a[8]  * a[14] - a[12] * a[10];
+    DType c0 = a[8]  * a[13] - a[12] * a[9];
+    DType d = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+
+    if (d == 0) {
+        for (int i = 0; i < size; i++)
+            out[i] = 0;
+        return false;
+    }
+
+    DType inv_d = 1 / d;
+    out[0]  = ( a[5]  * c5 - a[6]  * c4 + a[7]  * c3) * inv_d;
+    out[1]  = (-a[1]  * c5 + a[2]  * c4 - a[3]  * c3) * inv_d;
+    out[2]  = ( a[13] * s5 - a[14] * s4 + a[15] * s3) * inv_d;
+    out[3]  = (-a[9]  * s5 + a[10] * s4 - a[11] * s3) * inv_d;
+    out[4]  = (-a[4]  * c5 + a[6]  * c2 - a[7]  * c1) * inv_d;
+    out[5]  = ( a[0]  * c5 - a[2]  * c2 + a[3]  * c1) * inv_d;
+    out[6]  = (-a[12] * s5 + a[14] * s2 - a[15] * s1) * inv_d;
+    out[7]  = ( a[8]  * s5 - a[10] * s2 + a[11] * s1) * inv_d;
+    out[8]  = ( a[4]  * c4 - a[5]  * c2 + a[7]  * c0) * inv_d;
+    out[9]  = (-a[0]  * c4 + a[1]  * c2 - a[3]  * c0) * inv_d;
+    out[10] = ( a[12] * s4 - a[13] * s2 + a[15] * s0) * inv_d;
+    out[11] = (-a[8]  * s4 + a[9]  * s2 - a[11] * s0) * inv_d;
+    out[12] = (-a[4]  * c3 + a[5]  * c1 - a[6]  * c0) * inv_d;
+    out[13] = ( a[0]  * c3 - a[1]  * c1 + a[2]  * c0) * inv_d;
+    out[14] = (-a[12] * s3 + a[13] * s1 - a[14] * s0) * inv_d;
+    out[15] = ( a[8]  * s3 - a[9]  * s1 + a[10] * s0) * inv_d;
+    return true;
+}
+
+/*
+ * Gauss-Jordan elimination with partial pivoting on LANES slices at once.
+ *
+ * The slices are stored in structure-of-arrays layout, the element (r, c) of
+ * the lane l is at M[(r * cols + c) * LANES + l], so every innermost loop runs
+ * over the lanes and is vectorized by the compiler. The first n columns hold
+ * the slices and the remaining cols - n columns hold the right hand sides.
+ * Row swaps are done with selects instead of branches because every lane
+ * picks its own pivot row. A lane whose pivot is zero is marked as singular
+ * and continues with the pivot 1 so that it does not poison the others.
+ *
+ * If forward_only is true, only the rows below the pivot are eliminated,
+ * which is enough for the determinant.
+ */
+template <typename DType, int LANES>
+void gauss_jordan_soa(DType* M, const int n, const int cols, const bool forward_only,
+                      DType* determinant, unsigned char* singular) {
+
+    for (int l = 0; l < LANES; l++) {
+        determinant[l] = 1;
+        singular[l] = 0;
+    }
+
+    for (int k = 0; k < n; k++) {
+        DType best[LANES];
+        int pivot[LANES];
+
+        const DType* diagonal = M + (k * cols + k) * LANES;
+        for (int l = 0; l < LANES; l++) {
+            best[l] = std::abs(diagonal[l]);
+            pivot[l] = k;
+        }
+
+        for (int r = k + 1; r < n; r++) {
+            const DType* candidate = M + (r * cols + k) * LANES;
+            for (int l = 0; l < LANES; l++) {
+                DType v = std::abs(candidate[l]);
+                bool larger = v > best[l];
+                best[l] = larger ? v : best[l];
+                pivot[l] = larger ? r : pivot[l];
+            }
+        }
+
+        for (int l = 0; l < LANES; l++)
+            determinant[l] = (pivot[l] != k) ? -determinant[l] : determinant[l];
+
+        for (int r = k + 1; r < n; r++) {
+            for (int c = k; c < cols; c++) {
+                DType* row_k = M + (k * cols + c) * LANES;
+                DType* row_r = M + (r * cols + c) * LANES;
+                for (int l = 0; l < LANES; l++) {
+                    bool swap = (pivot[l] == r);
+                    DType t = row_k[l];
+                    row_k[l] = swap ? row_r[l] : t;
+                    row_r[l] = swap ? t : row_r[l];
+                }
+            }
+        }
+
+        DType inv_pivot[LANES];
+        for (int l = 0; l < LANES; l++) {
+            DType p = diagonal[l];
+            bool zero = (p == 0);
+            singular[l] |= zero;
+            determinant[l] *= p;
+            inv_pivot[l] = 1 / (zero ? DType(1) : p);
+        }
+
+        for (int c = k; c < cols; c++) {
+            DType* row_k = M + (k * cols + c) * LANES;
+            for (int l = 0; l < LANES; l++)
+                row_k[l] *= inv_pivot[l];
+        }
+
+        for (int r = forward_only ? k + 1 : 0; r < n; r++) {
+            if (r == k)
+                continue;
+
+            DType factor[LANES];
+            const DType* leading = M + (r * cols + k) * LANES;
+            for (int l = 0; l < LANES; l++)
+                factor[l] = leading[l];
+
+            for (int c = k; c < cols; c++) {
+                DType* row_r = M + (r * cols + c) * LANES;
+                const DType* row_k = M + (k * cols + c) * LANES;
+                for (int l = 0; l < LANES; l++)
+                    row_r[l] -= factor[l] * row_k[l];
+            }
+        }
+    }
+
+    for (int l = 0; l < LANES; l++)
+        determinant[l] = singular[l] ? DType(0) : determinant[l];
+}
+
+/*
+ * Runs gauss_jordan_soa over the whole batch, LANES slices at a time.
+ *
+ * A is (batch, n, n). If B is nullptr and nrhs is n, the right hand sides are
+ * the identity, so X receives the inverses. X may be nullptr when only the
+ * determinants are needed, det may be nullptr when they are not.
+ * The lanes of the last incomplete group are padded with the identity.
+ */
+template <typename DType, int LANES>
+void batched_gauss_jordan(const DType* A, const DType* B, DType* X, DType* det,
+                          std::vector<bool>& singular, const int batch, const int n,
+                          const int nrhs, const bool forward_only) {
+
+    const int cols = n + nrhs;
+    std::vector<DType> M(n * cols * LANES);
+    DType determinant[LANES];
+    unsigned char is_singular[LANES];
+
+    for (int first = 0; first < batch; first += LANES) {
+
+        for (int l = 0; l < LANES; l++) {
+            int b = first + l;
+            for (int r = 0; r < n; r++) {
+                for (int c = 0; c < n; c++)
+                    M[(r * cols + c) * LANES + l] = (b < batch) ?
+                        A[(b * n + r) * n + c] : DType(r == c);
+
+                for (int c = 0; c < nrhs; c++) {
+                    DType v;
+                    if (b >= batch || B == nullptr)
+                        v = (r == c);
+                    else
+                        v = B[(b * n + r) * nrhs + c];
+                    M[(r * cols + n + c) * LANES + l] = v;
+                }
+            }
+        }
+
+        gauss_jordan_soa<DType, LANES>(M.data(), n, cols, forward_only,
+                                       determinant, is_singular);
+
+        for (int l = 0; l < LANES && first + l < batch; l++) {
+            int b = first + l;
+            singular[b] = is_singular[l];
+
+            if (det != nullptr)
+                det[b] = determinant[l];
+
+            if (X == nullptr)
+                continue;
+
+            for (int r = 0; r < n; r++)
+                for (int c = 0; c < nrhs; c++)
+                    X[(b * n + r) * nrhs + c] = is_singular[l] ?
+                        DType(0) : M[(r * cols + n + c) * LANES + l];
+        }
+    }
+}
+
+} // end of namespace detail
+
+/*
+ * The function that returns the inverses of the stacked square matrices.
+ *
+ * The matrix A with the shape (batch, n, n) is treated as batch independent
+ * n x n matrices. The slices up to 4 x 4 are inverted by the closed-form
+ * formulas, the slices up to 16 x 16 by Gauss-Jordan elimination that runs
+ * on several slices at once, and the bigger ones one by one. Unlike inv,
+ * the singular slices don't raise an error. Instead, singular[b] is set to
+ * true and the slice b of the result is filled with zeros.
+ *
+ * Matrix::Matrix<double> A(1000, 3, 3);
+ * std::vector<bool> singular;
+ *
+ * Matrix::Matrix<double> invA = Matrix::batched_inv(A, singular);
+ *
+ * @param A the matrix with the shape (batch, n, n)
+ * @param singular the flags of the singular slices, it is resized to batch
+ * @retval the matrix with the shape (batch, n, n) holding the inverses
+ */
+template <typename DType>
+Matrix<DType> batched_inv(const Matrix<DType>& A, std::vector<bool>& singular) {
+    MATRIX_ACCOUNT_SCOPE("batched_inv");
+    detail::TraceSpan trace("batched_inv", A);
+
+    auto __shape = A.get_shape();
+
+    assert((__shape.size() == 3) &&
+        "The matrix must have the shape (batch, n, n)!");
+    assert((__shape[1] == __shape[2]) &&
+        "The slices of the matrix must be square matrices!");
+
+    trace.set_flops(2.0 * __shape[0] * __shape[1] * __shape[1] * __shape[1]);
+
+    int batch = __shape[0];
+    int n = __shape[1];
+
+    Matrix<DType> RESULT(batch, n, n);
+    singular.assign(batch, false);
+
+    const DType* a = A.data();
+    DType* out = RESULT.data();
+
+    if (n <= 4) {
+        for (int b = 0; b < batch; b++)
+            singular[b] = !detail::inv_small(a + b * n * n, out + b * n * n, n);
+    } else if (n <= detail::BATCHED_SOA_MAX_N) {
+        detail::batched_gauss_jordan<DType, detail::BATCHED_LANES>(
+            a, nullptr, out, nullptr, singular, batch, n, n, false);
+    } else {
+        detail::batched_gauss_jordan<DType, 1>(
+            a, nullptr, out, nullptr, singular, batch, n, n, false);
+    }
+
+    return RESULT;
+}
+
+/*
+ * The function that returns the determinants of the stacked square matrices.
+ *
+ * The matrix A with the shape (batch, n, n) is treated as batch independent
+ * n x n matrices. The determinant of a singular slice is 0.
+ *
+ * Matrix::Matrix<double> A(1000, 3, 3);
+ * Matrix::Matrix<double> D = Matrix::batched_det(A);  // the shape (1000)
+ *
+ * @param A the matrix with the shape (batch, n, n)
+ * @retval the matrix with the shape (batch) holding the determinants
+ */
+template <typename DType>
+Matrix<DType> batched_det(const Matrix<DType>& A) {
+    MATRIX_ACCOUNT_SCOPE("batched_det");
+    detail::TraceSpan trace("batched_det", A);
+
+    auto __shape = A.get_shape();
+
+    assert((__shape.size() == 3) &&
+        "The matrix must have the shape (batch, n, n)!");
+    assert((__shape[1] == __shape[2]) &&
+        "The slices of the matrix must be square matrices!");
+
+    trace.set_flops(2.0 / 3.0 * __shape[0] * __shape[1] * __shape[1] * __shape[1]);
+
+    int batch = __shape[0];
+    int n = __shape[1];
+
+    Matrix<DType> RESULT(batch);
+
+    const DType* a = A.data();
+    DType* out = RESULT.data();
+
+    if (n <= 4) {
+        for (int b = 0; b < batch; b++)
+            out[b] = detail::det_small(a + b * n * n, n);
+    } else {
+        std::vector<bool> singular(batch);
+        if (n <= detail::BATCHED_SOA_MAX_N)
+            detail::batched_gauss_jordan<DType, detail::BATCHED_LANES>(
+                a, nullptr, nullptr, out, singular, batch, n, 0, true);
+        else
+            detail::batched_gauss_jordan<DType, 1>(
+                a, nullptr, nullptr, out, singular, batch, n, 0, true);
+    }
+
+    return RESULT;
+}
+
+/*
+ * The function that solves the stacked linear systems A_b X_b = B_b.
+ *
+ * The matrix A has the shape (batch, n, n) and the matrix B has the shape
+ * (batch, n) for one right hand side per slice or (batch, n, k) for k right
+ * hand sides per slice. The result has the same shape as B. If the slice b
+ * of A is singular, singular[b] is set to true and the slice b of the result
+ * is filled with zeros instead of raising an error.
+ *
+ * Matrix::Matrix<double> A(1000, 3, 3);
+ * Matrix::Matrix<double> B(1000, 3);
+ * std::vector<bool> singular;
+ *
+ * Matrix::Matrix<double> X = Matrix::batched_solve(A, B, singular);
+ *
+ * @param A the matrix with the shape (batch, n, n)
+ * @param B the right hand sides with the shape (batch, n) or (batch, n, k)
+ * @param singular the flags of the singular slices, it is resized to batch
+ * @retval the solutions with the same shape as B
+ */
+template <typename DType>
+Matrix<DType> batched_solve(const Matrix<DType>& A, const Matrix<DType>& B, std::vector<bool>& singular) {
+    MATRIX_ACCOUNT_SCOPE("batched_solve");
+    detail::TraceSpan trace("batched_solve", A, B);
+
+    auto a_shape = A.get_shape();
+    auto b_shape = B.get_shape();
+
+    assert((a_shape.size() == 3) &&
+        "The matrix must have the shape (batch, n, n)!");
+    assert((a_shape[1] == a_shape[2]) &&
+        "The slices of the matrix must be square matrices!");
+    assert((b_shape.size() == 2 || b_shape.size() == 3) &&
+        "The right hand sides must have the shape (batch, n) or (batch, n, k)!");
+    assert((b_shape[0] == a_shape[0] && b_shape[1] == a_shape[1]) &&
+        "The shapes of the matrices are not compatible!");
+
+    int batch = a_shape[0];
+    int n = a_shape[1];
+    int nrhs = (b_shape.size() == 3) ? b_shape[2] : 1;
+    trace.set_flops(2.0 / 3.0 * batch * n * n * n + 2.0 * batch * n * n * nrhs);
+
+    Matrix<DType> RESULT(B);
+    singular.assign(batch, false);
+
+    const DType* a = A.data();
+    const DType* rhs = B.data();
+    DType* out = RESULT.data();
+
+    if (n <= 4) {
+        DType inverse[16];
+        for (int b = 0; b < batch; b++) {
+            singular[b] = !detail::inv_small(a + b * n * n, inverse, n);
+
+            const DType* rhs_b = rhs + b * n * nrhs;
+            DType* out_b = out + b * n * nrhs;
+            for (int r = 0; r < n; r++) {
+                for (int c = 0; c < nrhs; c++) {
+                    DType sum = 0;
+                    for (int i = 0; i < n; i++)
+                        sum += inverse[r * n + i] * rhs_b[i * nrhs + c];
+                    out_b[r * nrhs + c] = sum;
+                }
+            }
+        }
+    } else if (n <= detail::BATCHED_SOA_MAX_N) {
+        detail::batched_gauss_jordan<DType, detail::BATCHED_LANES>(
+            a, rhs, out, nullptr, singular, batch, n, nrhs, false);
+    } else {
+        detail::batched_gauss_jordan<DType, 1>(
+            a, rhs, out, nullptr, singular, batch, n, nrhs, false);
+    }
+
+    return RESULT;
+}
+
+} // end of namespace
+
+#endif // end of _LINALG_BATCHED_CPP_
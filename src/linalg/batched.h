@@ -0,0 +1,45 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#ifndef _LINALG_BATCHED_H_
+#define _LINALG_BATCHED_H_
+
+#include <vector>
+#include "../matrix.h"
+
+namespace Matrix {
+
+template <typename DType>
+Matrix<DType> batched_inv(const Matrix<DType>&, std::vector<bool>&);
+
+template <typename DType>
+Matrix<DType> batched_det(const Matrix<DType>&);
+
+template <typename DType>
+Matrix<DType> batched_solve(const Matrix<DType>&, const Matrix<DType>&, std::vector<bool>&);
+
+} // end of namespace
+
+#include "batched.cpp"
+#endif // end of _LINALG_BATCHED_H_
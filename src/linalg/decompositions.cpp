@@ -38,8 +38,12 @@ namespace Matrix {
 // reference : http://staff.ustc.edu.cn/~csli/graduate/algorithms/book6/chap31.htm
 template <typename DType>
 std::vector<Matrix<DType>> LUP(Matrix<DType> A) {
+    MATRIX_ACCOUNT_SCOPE("LUP");
+    detail::TraceSpan trace("LUP", A);
+
     auto __shape = A.get_shape();
     int N = __shape[0];
+    trace.set_flops(2.0 / 3.0 * N * N * N);
 
     std::vector<int> permutation(N);
 
@@ -64,12 +68,14 @@ std::vector<Matrix<DType>> LUP(Matrix<DType> A) {
         std::swap(permutation[i], permutation[max_row_index]);
         swap_rows(A, i, max_row_index);
 
+        std::vector<DType> multipliers(N - i - 1);
         for (int k = i + 1; k < N; k++) {
             A(k, i) /= A(i, i);
-
-            for (int l = i + 1; l < N; l++)
-                A(k, l) -= A(k, i) * A(i, l); 
+            multipliers[k - i - 1] = A(k, i);
         }
+
+        // A(k, l) -= A(k, i) * A(i, l) for the trailing rows and columns
+        rank1_update<DType>(A, i + 1, i + 1, multipliers.data(), A.data() + i * N + i + 1, -1);
     }
 
     Matrix<DType> L = identity<DType>(N);
@@ -94,7 +100,11 @@ std::vector<Matrix<DType>> LUP(Matrix<DType> A) {
 
 template <typename DType>
 std::vector<Matrix<DType>> QR(Matrix<DType> A) {
+    MATRIX_ACCOUNT_SCOPE("QR");
+    detail::TraceSpan trace("QR", A);
+
     auto __shape = A.get_shape();
+    trace.set_flops(3.0 * __shape[0] * __shape[1] * __shape[1]);
 
     std::vector<Vector<DType>> a_vectors = to_column_vectors(A);
     std::vector<Vector<DType>> q_vectors = gram_schmidt(a_vectors);
@@ -113,6 +123,8 @@ std::vector<Matrix<DType>> QR(Matrix<DType> A) {
 
 template <typename DType>
 std::vector<Matrix<DType>> cholesky(Matrix<DType> A) {
+    MATRIX_ACCOUNT_SCOPE("cholesky");
+    detail::TraceSpan trace("cholesky", A);
 
     // assert A is two dimensional matrix
     // assert A is square and symetric matrix
@@ -120,6 +132,7 @@ std::vector<Matrix<DType>> cholesky(Matrix<DType> A) {
     auto __shape = A.get_shape();
     int N = __shape[0];
     int M = __shape[1];
+    trace.set_flops(1.0 / 3.0 * N * N * N);
 
     Matrix<DType> L(A);
     Matrix<DType> LT(A);
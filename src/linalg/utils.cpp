@@ -35,9 +35,16 @@ namespace Matrix {
 
 template <typename DType>
 std::vector<Vector<DType>> gram_schmidt(std::vector<Vector<DType>> v) {
+    MATRIX_ACCOUNT_SCOPE("gram_schmidt");
+    detail::TraceSpan trace("gram_schmidt");
+
     // assert the v vectors are column vector
 
     int N = v.size();
+    if (N > 0) {
+        trace.add(v[0]);
+        trace.set_flops(2.0 * v[0].get_matrix_size() * N * N);
+    }
 
     std::vector<Vector<DType>> orthagonalized_vectors;
     std::vector<double> uu_dot;
@@ -0,0 +1,215 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#ifndef _MAPPED_CPP_
+#define _MAPPED_CPP_
+
+#include "matrix.h"
+#include "mapped.h"
+#include "npy.h"
+#include "errors.h"
+
+#include <cstdint>     // for std::uintptr_t
+#include <fstream>     // for std::ofstream, std::ifstream
+#include <fcntl.h>     // for open
+#include <sys/mman.h>  // for mmap, madvise, msync
+#include <sys/stat.h>  // for fstat
+#include <unistd.h>    // for close, sysconf
+
+namespace Matrix {
+
+namespace detail {
+
+inline std::size_t page_size() {
+    static const std::size_t size = sysconf(_SC_PAGESIZE);
+    return size;
+}
+
+inline int madvise_advice(const Advice advice) {
+    switch (advice) {
+        case Advice::SEQUENTIAL: return MADV_SEQUENTIAL;
+        case Advice::RANDOM:     return MADV_RANDOM;
+        case Advice::WILLNEED:   return MADV_WILLNEED;
+        default:                 return MADV_NORMAL;
+    }
+}
+
+// the pages that hold the elements of the matrix, the ranges of madvise and msync
+template <typename DType>
+std::pair<void*, std::size_t> storage_pages(const Matrix<DType>& A) {
+    const std::uintptr_t first = reinterpret_cast<std::uintptr_t>(A.data());
+    const std::uintptr_t last = first + static_cast<std::size_t>(A.get_matrix_size()) * sizeof(DType);
+    const std::uintptr_t begin = first / page_size() * page_size();
+
+    return {reinterpret_cast<void*>(begin), last - begin};
+}
+
+} // end of namespace detail
+
+/*
+ * The function that writes the matrix as the .npy file for open_mapped
+ *
+ * The file is the same .npy file that save writes, but its header is padded
+ * to the page size, so the elements start at a page boundary and the mapped
+ * matrix is page aligned. numpy.load and load read it as usual.
+ *
+ * Matrix::Matrix<float> W(4096, 4096);
+ * Matrix::save_mappable("weights.npy", W);
+ *
+ * @param path the path of the file, it is overwritten
+ * @param A the matrix
+ * @retval None
+ */
+template <typename DType>
+void save_mappable(const std::string& path, const Matrix<DType>& A) {
+    detail::TraceSpan trace("save_mappable", A);
+
+    std::ofstream out(path, std::ios::binary);
+    const std::string header = detail::npy_header<DType>(A.get_shape(), detail::page_size());
+
+    out.write(header.data(), header.size());
+    out.write(reinterpret_cast<const char*>(A.data()), static_cast<std::streamsize>(A.get_matrix_size()) * sizeof(DType));
+
+    if (!out)
+        throw SerializationError();
+}
+
+/*
+ * The function that opens the .npy file as the matrix without reading it
+ *
+ * The storage of the matrix is the mmap of the file, the pages are read
+ * when they are touched for the first time and they stay in the page cache
+ * that is shared by all processes that map the same file. The matrix works
+ * with all operations like any other matrix; its copies are the usual
+ * matrices in the memory. The file is unmapped when the matrix is destroyed.
+ *
+ * The elements must be in the byte order of the host and in the C order,
+ * the files of save and save_mappable are; the files of save_mappable
+ * have the page-aligned elements.
+ *
+ * Matrix::Matrix<float> W = Matrix::open_mapped<float>("weights.npy", Matrix::Mapping::READ_ONLY);
+ * Matrix::Matrix<float> Y = Matrix::dot(X, W);
+ *
+ * @param path the path of the .npy file
+ * @param mapping READ_ONLY, COPY_ON_WRITE or WRITE_BACK
+ * @param advice the expected access pattern given to madvise
+ * @retval the matrix whose elements are in the file
+ * @throw SerializationError if the file is not a .npy file of DType that can be mapped
+ */
+template <typename DType>
+Matrix<DType> open_mapped(const std::string& path, const Mapping mapping, const Advice advice) {
+    detail::TraceSpan trace("open_mapped");
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        throw SerializationError();
+
+    detail::NpyHeader header = detail::read_npy_header(in);
+    const std::size_t offset = in.tellg();
+    in.close();
+
+    if (!detail::is_native_npy<DType>(header))
+        throw SerializationError();
+
+    if (header.shape.empty())
+        header.shape.push_back(1);
+
+    long size = 1;
+    for (int dim : header.shape) {
+        size *= dim;
+        if (size > std::numeric_limits<int>::max())
+            throw SerializationError();
+    }
+
+    const std::size_t length = offset + static_cast<std::size_t>(size) * sizeof(DType);
+    const bool writable = mapping == Mapping::WRITE_BACK;
+
+    int fd = open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+    if (fd < 0)
+        throw SerializationError();
+
+    struct stat status;
+    if (fstat(fd, &status) != 0 || static_cast<std::size_t>(status.st_size) < length) {
+        close(fd);
+        throw SerializationError();
+    }
+
+    const int protection = (mapping == Mapping::READ_ONLY) ? PROT_READ : PROT_READ | PROT_WRITE;
+    const int flags = (mapping == Mapping::COPY_ON_WRITE) ? MAP_PRIVATE : MAP_SHARED;
+
+    // the mapping stays valid after the file is closed
+    void* base = mmap(nullptr, length, protection, flags, fd, 0);
+    close(fd);
+
+    if (base == MAP_FAILED)
+        throw SerializationError();
+
+    madvise(base, length, detail::madvise_advice(advice));
+
+    DType* data = reinterpret_cast<DType*>(static_cast<char*>(base) + offset);
+    Matrix<DType> RESULT = adopt<DType>(data, header.shape, [base, length](DType*) {
+        munmap(base, length);
+    });
+    trace.add(RESULT);
+    return RESULT;
+}
+
+/*
+ * The function that changes the access pattern hint of the mapped matrix
+ *
+ * Matrix::advise(W, Matrix::Advice::WILLNEED);
+ *
+ * @param A the matrix given by open_mapped
+ * @param advice the expected access pattern given to madvise
+ * @retval None
+ */
+template <typename DType>
+void advise(const Matrix<DType>& A, const Advice advice) {
+    auto pages = detail::storage_pages(A);
+    madvise(pages.first, pages.second, detail::madvise_advice(advice));
+}
+
+/*
+ * The function that writes the changes of the mapped matrix into the file
+ *
+ * It returns when the pages of the matrix are written, the matrices of
+ * READ_ONLY and COPY_ON_WRITE have nothing to write.
+ *
+ * W(0, 0) = 1.0f;
+ * Matrix::sync(W);
+ *
+ * @param A the matrix given by open_mapped with WRITE_BACK
+ * @retval None
+ * @throw SerializationError if the pages could not be written
+ */
+template <typename DType>
+void sync(const Matrix<DType>& A) {
+    auto pages = detail::storage_pages(A);
+    if (msync(pages.first, pages.second, MS_SYNC) != 0)
+        throw SerializationError();
+}
+
+} // end of namespace
+
+#endif // end of _MAPPED_CPP_
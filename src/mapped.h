@@ -0,0 +1,63 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#ifndef _MAPPED_H_
+#define _MAPPED_H_
+
+#include <string>
+#include "matrix.h"
+
+namespace Matrix {
+
+/*
+ * How the file is mapped.
+ *
+ * READ_ONLY     the pages are shared with the page cache and the other
+ *               processes, writing into the matrix is a segmentation fault
+ * COPY_ON_WRITE the pages are shared until they are written, the writes are
+ *               private to the process and never reach the file
+ * WRITE_BACK    the writes go into the file, sync waits until they are on the disk
+ */
+enum class Mapping { READ_ONLY, COPY_ON_WRITE, WRITE_BACK };
+
+// the madvise hint of the access pattern of the mapped matrix
+enum class Advice { NORMAL, SEQUENTIAL, RANDOM, WILLNEED };
+
+template <typename DType>
+void save_mappable(const std::string&, const Matrix<DType>&);
+
+template <typename DType>
+Matrix<DType> open_mapped(const std::string&, const Mapping = Mapping::COPY_ON_WRITE,
+                          const Advice = Advice::NORMAL);
+
+template <typename DType>
+void advise(const Matrix<DType>&, const Advice);
+
+template <typename DType>
+void sync(const Matrix<DType>&);
+
+} // end of namespace
+
+#include "mapped.cpp"
+#endif // end of _MAPPED_H_
@@ -31,14 +31,55 @@
 
 #include <vector>    // for std::vector
 #include <math.h>    // for exp
-#include <ctime>     // for std::time
-#include <cstdlib>   // for srand, rand
+#include <cstdlib>   // for RAND_MAX
 #include <iostream>  // for std::cin, std::cout
 #include <assert.h>  // for assert 
 #include <algorithm> // for swap
+#include <utility>   // for std::move
+
+#include "parallel.h"   // for parallel_for
+#include "generator.h"  // for the random values
+#include "accounting.h" // for the allocation and copy accounting
+#include "tracing.h"    // for the trace spans of the operations
+
+#if defined(__AVX__)
+#include <immintrin.h> // for the in-register transposes
+#endif
 
 namespace Matrix {
 
+namespace detail {
+
+// the number of independent accumulators of the reduction kernels, it is as
+// wide as one AVX-512 register of doubles, so the compiler can vectorize the
+// reductions without reordering the floating point additions
+constexpr int SIMD_LANES = 8;
+
+// the kernels don't use the thread pool below this many multiply-adds or elements
+constexpr long PARALLEL_MIN_WORK = 1L << 16;
+
+/*
+ * f(first, last) on the chunks of the items [0, count) by the thread pool,
+ * where one item is width elements, like one line of a matrix.
+ *
+ * The work below PARALLEL_MIN_WORK elements is done by the calling thread,
+ * the small matrices don't pay for waking up the pool. The chunks are never
+ * smaller than PARALLEL_MIN_WORK elements either.
+ */
+template <typename F>
+void elementwise_for(const long count, F f, const long width = 1) {
+    const long grain = std::max(1L, PARALLEL_MIN_WORK / width);
+
+    if (count <= grain) {
+        f(0L, count);
+        return;
+    }
+
+    parallel_for(0, count, grain, f);
+}
+
+} // end of namespace detail
+
 template <typename DType>
 template <typename... DIMS>
 Matrix<DType>::Matrix(const DIMS&... dims)
@@ -57,9 +98,13 @@ Matrix<DType>::Matrix(const DIMS&... dims)
     }
 
     MATRIX = new DType[MATRIX_SIZE];
+    detail::account_allocation(MATRIX, MATRIX_SIZE * sizeof(DType), false);
 
-    for (int i = 0; i < MATRIX_SIZE; i++)
-        MATRIX[i] = i;
+    DType* m = MATRIX;
+    detail::elementwise_for(MATRIX_SIZE, [m](long first, long last) {
+        for (long i = first; i < last; i++)
+            m[i] = i;
+    });
 }
 
 /*
@@ -77,25 +122,101 @@ Matrix<DType>::Matrix(const DIMS&... dims)
  * @retval the element of the matrix in index
  */
 template <typename DType>
-Matrix<DType>::Matrix(const Matrix<DType>& matrix_copy) {
+Matrix<DType>::Matrix(const Matrix<DType>& matrix_copy)
+: MATRIX(nullptr)
+{
     *this = matrix_copy;
 }
 
+/*
+ * The constructor of the matrix without elements, the storage is set by
+ * matrix_with_storage, so nothing is allocated or accounted here.
+ */
+template <typename DType>
+Matrix<DType>::Matrix(detail::NoStorage)
+: MATRIX_SIZE(0), MATRIX(nullptr)
+{
+}
+
+/*
+ * The move constructor
+ *
+ * The storage of the other matrix is taken over without copying it, the
+ * other matrix is left without elements and it can only be destroyed or
+ * assigned to.
+ *
+ * Matrix::Matrix<double> B(std::move(A));
+ */
+template <typename DType>
+Matrix<DType>::Matrix(Matrix<DType>&& matrix_move) noexcept
+: SHAPE(std::move(matrix_move.SHAPE)), MATRIX_SIZE(matrix_move.MATRIX_SIZE),
+  MATRIX(matrix_move.MATRIX), DELETER(std::move(matrix_move.DELETER))
+{
+    matrix_move.SHAPE.clear();
+    matrix_move.MATRIX_SIZE = 0;
+    matrix_move.MATRIX = nullptr;
+    matrix_move.DELETER = nullptr;
+}
+
 template <typename DType>
 Matrix<DType>::~Matrix() {
-    if (MATRIX != nullptr)
+    free_storage();
+}
+
+template <typename DType>
+void Matrix<DType>::free_storage() {
+    if (MATRIX == nullptr)
+        return;
+
+    detail::account_free(MATRIX);
+
+    if (DELETER)
+        DELETER(MATRIX);
+    else
         delete[] MATRIX;
+
+    MATRIX = nullptr;
+    DELETER = nullptr;
 }
 
 template <typename DType>
 Matrix<DType>& Matrix<DType>::operator=(const Matrix<DType>& matrix_copy) {
+    if (this == &matrix_copy)
+        return *this;
+
+    free_storage();
+
     SHAPE       = matrix_copy.SHAPE;
     MATRIX_SIZE = matrix_copy.MATRIX_SIZE;
 
     MATRIX = new DType[MATRIX_SIZE];
-    
-    for (int i = 0; i < MATRIX_SIZE; i++)
-        MATRIX[i] = matrix_copy.MATRIX[i];
+    detail::account_allocation(MATRIX, MATRIX_SIZE * sizeof(DType), true);
+
+    DType* m = MATRIX;
+    const DType* c = matrix_copy.MATRIX;
+    detail::elementwise_for(MATRIX_SIZE, [m, c](long first, long last) {
+        std::copy(c + first, c + last, m + first);
+    });
+
+    return *this;
+}
+
+template <typename DType>
+Matrix<DType>& Matrix<DType>::operator=(Matrix<DType>&& matrix_move) noexcept {
+    if (this == &matrix_move)
+        return *this;
+
+    free_storage();
+
+    SHAPE       = std::move(matrix_move.SHAPE);
+    MATRIX_SIZE = matrix_move.MATRIX_SIZE;
+    MATRIX      = matrix_move.MATRIX;
+    DELETER     = std::move(matrix_move.DELETER);
+
+    matrix_move.SHAPE.clear();
+    matrix_move.MATRIX_SIZE = 0;
+    matrix_move.MATRIX = nullptr;
+    matrix_move.DELETER = nullptr;
 
     return *this;
 }
@@ -169,6 +290,188 @@ auto Matrix<DType>::operator()(const Index&... index) const{
     return MATRIX[real_index];
 }
 
+namespace detail {
+
+/*
+ * The matrix with the shape whose elements are the data, it is not copied.
+ * The deleter is called with the data when the matrix is destroyed or
+ * assigned, so the matrix can own the storage that is not allocated by new[],
+ * like the mapped files.
+ */
+template <typename DType>
+Matrix<DType> matrix_with_storage(const std::vector<int>& shape, DType* data, std::function<void(DType*)> deleter) {
+    assert(shape.size() > 0 &&
+        "The matrix must have at least one dimension.");
+
+    Matrix<DType> RESULT(NoStorage{});
+
+    RESULT.MATRIX_SIZE = 1;
+    for (auto dim : shape) {
+        assert(dim > 0 &&
+            "The dimensions of matrix cannot nonpozitive");
+        RESULT.MATRIX_SIZE *= dim;
+    }
+
+    RESULT.SHAPE = shape;
+    RESULT.MATRIX = data;
+    RESULT.DELETER = std::move(deleter);
+
+    return RESULT;
+}
+
+// the new matrix with the shape given as std::vector<int>, its content is not
+// initialized, so the kernels that write every element skip the fill pass
+template <typename DType>
+Matrix<DType> matrix_with_shape(const std::vector<int>& shape) {
+    long size = 1;
+    for (auto dim : shape)
+        size *= dim;
+
+    DType* data = new DType[size];
+    account_allocation(data, size * sizeof(DType), false);
+
+    return matrix_with_storage<DType>(shape, data, nullptr);
+}
+
+/*
+ * The shape that the shapes a and b are broadcast to.
+ *
+ * The shapes are aligned from the last dimension, the missing leading
+ * dimensions are taken as 1, and the dimensions of size 1 are stretched
+ * to the other one. For example, (4, 1, 3) and (5, 1) give (4, 5, 3).
+ */
+inline std::vector<int> broadcast_shape(const std::vector<int>& a, const std::vector<int>& b) {
+    int ndim = std::max(a.size(), b.size());
+    std::vector<int> shape(ndim);
+
+    for (int d = 0; d < ndim; d++) {
+        int da = d - (ndim - static_cast<int>(a.size()));
+        int db = d - (ndim - static_cast<int>(b.size()));
+        int x = (da >= 0) ? a[da] : 1;
+        int y = (db >= 0) ? b[db] : 1;
+
+        assert((x == y || x == 1 || y == 1) &&
+            "The shapes of the matrices can not be broadcast together.");
+
+        shape[d] = std::max(x, y);
+    }
+
+    return shape;
+}
+
+// the strides of the operand with the given shape when it is read as the
+// broadcast shape, the stretched dimensions have the stride 0
+inline std::vector<long> broadcast_strides(const std::vector<int>& operand, const std::vector<int>& shape) {
+    int ndim = shape.size();
+    int offset = ndim - operand.size();
+    std::vector<long> strides(ndim, 0);
+
+    long stride = 1;
+    for (int d = ndim - 1; d >= offset; d--) {
+        int dim = operand[d - offset];
+        strides[d] = (dim == 1) ? 0 : stride;
+        stride *= dim;
+    }
+
+    return strides;
+}
+
+// out[i] = op(a[i * sa], b[i * sb]) for one line of the last dimension,
+// the strides are 0 or 1 so every case is a plain vectorizable loop
+template <typename DType, typename Op>
+inline void broadcast_line(DType* out, const DType* a, const long sa, const DType* b, const long sb,
+                           const int length, Op op) {
+    if (sa == 1 && sb == 1) {
+        for (int j = 0; j < length; j++)
+            out[j] = op(a[j], b[j]);
+    } else if (sa == 1) {
+        const DType y = b[0];
+        for (int j = 0; j < length; j++)
+            out[j] = op(a[j], y);
+    } else if (sb == 1) {
+        const DType x = a[0];
+        for (int j = 0; j < length; j++)
+            out[j] = op(x, b[j]);
+    } else {
+        const DType v = op(a[0], b[0]);
+        for (int j = 0; j < length; j++)
+            out[j] = v;
+    }
+}
+
+/*
+ * out = op(a, b) elementwisely where a and b are broadcast to the shape of out.
+ *
+ * The stretched operand is not materialized, it is read with the stride 0.
+ * The equal shapes are done in one flat loop, otherwise the lines of the
+ * last dimension are walked with an odometer over the leading dimensions,
+ * which covers the row vector (stride 1 in the line) and the column vector
+ * (stride 0 in the line) cases with the loops of broadcast_line.
+ * The large matrices are cut into chunks of the flat buffer or of the lines
+ * for the thread pool, every chunk starts its own odometer.
+ * out may be the same buffer as a when a has the shape of out.
+ */
+template <typename DType, typename Op>
+void broadcast_apply(DType* out, const std::vector<int>& shape,
+                     const DType* a, const std::vector<int>& a_shape,
+                     const DType* b, const std::vector<int>& b_shape, Op op) {
+
+    long size = 1;
+    for (auto dim : shape)
+        size *= dim;
+
+    if (a_shape == shape && b_shape == shape) {
+        elementwise_for(size, [&](long first, long last) {
+            for (long i = first; i < last; i++)
+                out[i] = op(a[i], b[i]);
+        });
+        return;
+    }
+
+    const int ndim = shape.size();
+    const std::vector<long> a_strides = broadcast_strides(a_shape, shape);
+    const std::vector<long> b_strides = broadcast_strides(b_shape, shape);
+
+    const int length = shape[ndim - 1];
+    const long lines = size / length;
+
+    elementwise_for(lines, [&](long first, long last) {
+        std::vector<int> index(ndim, 0);
+        long a_offset = 0;
+        long b_offset = 0;
+
+        // the odometer at the first line of the chunk
+        long rest = first;
+        for (int d = ndim - 2; d >= 0; d--) {
+            index[d] = rest % shape[d];
+            rest /= shape[d];
+            a_offset += index[d] * a_strides[d];
+            b_offset += index[d] * b_strides[d];
+        }
+
+        for (long line = first; line < last; line++) {
+            broadcast_line(out + line * length, a + a_offset, a_strides[ndim - 1],
+                           b + b_offset, b_strides[ndim - 1], length, op);
+
+            // the next line, the leading dimensions are counted like an odometer
+            for (int d = ndim - 2; d >= 0; d--) {
+                index[d]++;
+                a_offset += a_strides[d];
+                b_offset += b_strides[d];
+
+                if (index[d] < shape[d])
+                    break;
+
+                a_offset -= a_strides[d] * shape[d];
+                b_offset -= b_strides[d] * shape[d];
+                index[d] = 0;
+            }
+        }
+    }, length);
+}
+
+} // end of namespace detail
+
 /*
  * The operator overloading to divide elements of the matrix by certain value
  *
@@ -197,8 +500,11 @@ Matrix<DType>& Matrix<DType>::operator/=(const DType val) {
     assert((val != 0) && 
         "The divisor cannot be zero!");
 
-    for (int i = 0; i < MATRIX_SIZE; i++)
-        MATRIX[i] /= val;
+    DType* m = MATRIX;
+    detail::elementwise_for(MATRIX_SIZE, [m, val](long first, long last) {
+        for (long i = first; i < last; i++)
+            m[i] /= val;
+    });
 
     return *this;
 }
@@ -231,6 +537,9 @@ Matrix<DType>& Matrix<DType>::operator/=(const DType val) {
  */
 template <typename DType>
 Matrix<DType> Matrix<DType>::operator/(const DType val) {
+    MATRIX_ACCOUNT_SCOPE("operator/");
+    detail::TraceSpan trace("operator/", *this);
+    trace.set_flops(MATRIX_SIZE);
     
     assert((val != 0) && 
         "The divisor cannot be zero!");
@@ -266,8 +575,11 @@ Matrix<DType> Matrix<DType>::operator/(const DType val) {
  */
 template <typename DType>
 Matrix<DType>& Matrix<DType>::operator+=(const DType val) {
-    for (int i = 0; i < MATRIX_SIZE; i++)
-        MATRIX[i] += val;
+    DType* m = MATRIX;
+    detail::elementwise_for(MATRIX_SIZE, [m, val](long first, long last) {
+        for (long i = first; i < last; i++)
+            m[i] += val;
+    });
 
     return *this;
 }
@@ -299,6 +611,10 @@ Matrix<DType>& Matrix<DType>::operator+=(const DType val) {
  */
 template <typename DType>
 Matrix<DType> Matrix<DType>::operator+(const DType val) {
+    MATRIX_ACCOUNT_SCOPE("operator+");
+    detail::TraceSpan trace("operator+", *this);
+    trace.set_flops(MATRIX_SIZE);
+
     Matrix<DType> RESULT(*this);
     RESULT += val;
     
@@ -328,22 +644,29 @@ Matrix<DType> Matrix<DType>::operator+(const DType val) {
  *     [12.0, 14.0, 16.0]]
  *
  *
+ * The shape of A doesn't have to be same as the shape of the matrix, it is
+ * broadcast like NumPy: the shapes are aligned from the last dimension, the
+ * missing leading dimensions of A and its dimensions of size 1 are repeated.
+ * A is not copied to the full shape. For example, a bias row is added to
+ * every row of a batch:
+ *
+ * Matrix::Matrix<double> X(4, 3);
+ * Matrix::Matrix<double> b(1, 3);   // or Matrix::Matrix<double> b(3);
+ *
+ * X += b;
+ *
  * @param A the other matrix which will add elementwisely
  * 
  * @retval the same matrix whose elemets are added to another matrix elementwisely.
  */
 template <typename DType>
 Matrix<DType>& Matrix<DType>::operator+=(const Matrix<DType>& A) {
-    
-    assert((SHAPE.size() == A.SHAPE.size()) &&
-        "The dimensions of the matrices must be same.");
 
-    for (int i = 0; i < SHAPE.size(); i++)
-        assert((SHAPE[i] == A.SHAPE[i]) &&
-            "The dimensions of the matrices must be same.");
+    assert((detail::broadcast_shape(SHAPE, A.SHAPE) == SHAPE) &&
+        "The matrix must be broadcast to the shape of this matrix.");
 
-    for (int i = 0; i < MATRIX_SIZE; i++)
-        MATRIX[i] += A.MATRIX[i];
+    detail::broadcast_apply(MATRIX, SHAPE, MATRIX, SHAPE, A.MATRIX, A.SHAPE,
+        [](const DType x, const DType y) { return x + y; });
 
     return *this;
 }
@@ -371,23 +694,26 @@ Matrix<DType>& Matrix<DType>::operator+=(const Matrix<DType>& A) {
  *     [6.0, 8.0, 10.0],
  *     [12.0, 14.0, 16.0]]
  *
+ * The matrices are broadcast to their common shape, so the result can be
+ * bigger than both of them. For example, the column vector with the shape
+ * (3, 1) plus the row vector with the shape (1, 4) is a (3, 4) matrix.
+ *
  * @param A the other matrix which will add elementwisely
  * 
  * @retval the new matrix whose elemets are added to another matrix elementwisely.
  */
 template <typename DType>
 Matrix<DType> Matrix<DType>::operator+(const Matrix<DType>& A) {
-    
-    assert((SHAPE.size() == A.SHAPE.size()) &&
-        "The dimensions of the matrices must be same.");
+    MATRIX_ACCOUNT_SCOPE("operator+");
+    detail::TraceSpan trace("operator+", *this, A);
 
-    for (int i = 0; i < SHAPE.size(); i++)
-        assert((SHAPE[i] == A.SHAPE[i]) &&
-            "The dimensions of the matrices must be same.");
+    std::vector<int> shape = detail::broadcast_shape(SHAPE, A.SHAPE);
+    Matrix<DType> RESULT = detail::matrix_with_shape<DType>(shape);
+    trace.set_flops(RESULT.get_matrix_size());
+
+    detail::broadcast_apply(RESULT.MATRIX, shape, MATRIX, SHAPE, A.MATRIX, A.SHAPE,
+        [](const DType x, const DType y) { return x + y; });
 
-    Matrix<DType> RESULT(*this);
-    RESULT += A;
-    
     return RESULT;
 }
 
@@ -417,8 +743,11 @@ Matrix<DType> Matrix<DType>::operator+(const Matrix<DType>& A) {
 template <typename DType>
 Matrix<DType>& Matrix<DType>::operator-=(const DType val) { 
 
-    for (int i = 0; i < MATRIX_SIZE; i++)
-        MATRIX[i] -= val;
+    DType* m = MATRIX;
+    detail::elementwise_for(MATRIX_SIZE, [m, val](long first, long last) {
+        for (long i = first; i < last; i++)
+            m[i] -= val;
+    });
 
     return *this;
 }
@@ -450,6 +779,9 @@ Matrix<DType>& Matrix<DType>::operator-=(const DType val) {
  */
 template <typename DType>
 Matrix<DType> Matrix<DType>::operator-(const DType val) {
+    MATRIX_ACCOUNT_SCOPE("operator-");
+    detail::TraceSpan trace("operator-", *this);
+    trace.set_flops(MATRIX_SIZE);
     
     Matrix<DType> RESULT(*this);
     RESULT -= val;
@@ -480,6 +812,8 @@ Matrix<DType> Matrix<DType>::operator-(const DType val) {
  *     [0.0, 0.0, 0.0]]
  *
  *
+ * A is broadcast in the same way as in operator+.
+ *
  * @param A the other matrix which will add elementwisely
  * 
  * @retval the same matrix whose elemets are substracted to another matrix elementwisely.
@@ -487,16 +821,11 @@ Matrix<DType> Matrix<DType>::operator-(const DType val) {
 template <typename DType>
 Matrix<DType>& Matrix<DType>::operator-=(const Matrix<DType>& A) {
 
-    assert((SHAPE.size() == A.SHAPE.size()) &&
-        "The dimensions of the matrices must be same.");
-
-    for (int i = 0; i < SHAPE.size(); i++)
-        assert((SHAPE[i] == A.SHAPE[i]) &&
-            "The dimensions of the matrices must be same.");
+    assert((detail::broadcast_shape(SHAPE, A.SHAPE) == SHAPE) &&
+        "The matrix must be broadcast to the shape of this matrix.");
 
-
-    for (int i = 0; i < MATRIX_SIZE; i++)
-        MATRIX[i] -= A.MATRIX[i];
+    detail::broadcast_apply(MATRIX, SHAPE, MATRIX, SHAPE, A.MATRIX, A.SHAPE,
+        [](const DType x, const DType y) { return x - y; });
 
     return *this;
 }
@@ -525,23 +854,24 @@ Matrix<DType>& Matrix<DType>::operator-=(const Matrix<DType>& A) {
  *     [12.0, 14.0, 16.0]]
  *
  *
+ * A is broadcast in the same way as in operator+.
+ *
  * @param A the other matrix which will substract elementwisely
  * 
  * @retval the new matrix whose elemets are substracted to another matrix elementwisely.
  */
 template <typename DType>
 Matrix<DType> Matrix<DType>::operator-(const Matrix<DType>& A) {
+    MATRIX_ACCOUNT_SCOPE("operator-");
+    detail::TraceSpan trace("operator-", *this, A);
 
-    assert((SHAPE.size() == A.SHAPE.size()) &&
-        "The dimensions of the matrices must be same.");
+    std::vector<int> shape = detail::broadcast_shape(SHAPE, A.SHAPE);
+    Matrix<DType> RESULT = detail::matrix_with_shape<DType>(shape);
+    trace.set_flops(RESULT.get_matrix_size());
 
-    for (int i = 0; i < SHAPE.size(); i++)
-        assert((SHAPE[i] == A.SHAPE[i]) &&
-            "The dimensions of the matrices must be same.");
+    detail::broadcast_apply(RESULT.MATRIX, shape, MATRIX, SHAPE, A.MATRIX, A.SHAPE,
+        [](const DType x, const DType y) { return x - y; });
 
-    Matrix<DType> RESULT(*this);
-    RESULT -= A;
-    
     return RESULT;
 }
 
@@ -571,8 +901,11 @@ Matrix<DType> Matrix<DType>::operator-(const Matrix<DType>& A) {
 template <typename DType>
 Matrix<DType>& Matrix<DType>::operator*=(const DType val) {
 
-    for (int i = 0; i < MATRIX_SIZE; i++)
-        MATRIX[i] *= val;
+    DType* m = MATRIX;
+    detail::elementwise_for(MATRIX_SIZE, [m, val](long first, long last) {
+        for (long i = first; i < last; i++)
+            m[i] *= val;
+    });
 
     return *this;
 }
@@ -604,6 +937,9 @@ Matrix<DType>& Matrix<DType>::operator*=(const DType val) {
  */
 template <typename DType>
 Matrix<DType> Matrix<DType>::operator*(const DType val) {
+    MATRIX_ACCOUNT_SCOPE("operator*");
+    detail::TraceSpan trace("operator*", *this);
+    trace.set_flops(MATRIX_SIZE);
 
     Matrix<DType> RESULT(*this);
     RESULT *= val;
@@ -635,6 +971,8 @@ Matrix<DType> Matrix<DType>::operator*(const DType val) {
  *     [36.0, 49.0, 64.0]]
  *
  *
+ * A is broadcast in the same way as in operator+.
+ *
  * @param A the other matrix which will multiply elementwisely
  * 
  * @retval the new matrix whose elemets are multiplied to another matrix elementwisely.
@@ -642,15 +980,11 @@ Matrix<DType> Matrix<DType>::operator*(const DType val) {
 template <typename DType>
 Matrix<DType>& Matrix<DType>::operator*=(const Matrix<DType>& A) {
 
-    assert((SHAPE.size() == A.SHAPE.size()) &&
-        "The dimensions of the matrices must be same.");
-
-    for (int i = 0; i < SHAPE.size(); i++)
-        assert((SHAPE[i] == A.SHAPE[i]) &&
-            "The dimensions of the matrices must be same.");
+    assert((detail::broadcast_shape(SHAPE, A.SHAPE) == SHAPE) &&
+        "The matrix must be broadcast to the shape of this matrix.");
 
-    for (int i = 0; i < MATRIX_SIZE; i++)
-        MATRIX[i] *= A.MATRIX[i];
+    detail::broadcast_apply(MATRIX, SHAPE, MATRIX, SHAPE, A.MATRIX, A.SHAPE,
+        [](const DType x, const DType y) { return x * y; });
 
     return *this;
 }
@@ -679,23 +1013,24 @@ Matrix<DType>& Matrix<DType>::operator*=(const Matrix<DType>& A) {
  *     [36.0, 49.0, 64.0]]
  *
  *
+ * A is broadcast in the same way as in operator+.
+ *
  * @param A the other matrix which will multiply elementwisely
  * 
  * @retval the new matrix whose elemets are multiplied to another matrix elementwisely.
  */
 template <typename DType>
 Matrix<DType> Matrix<DType>::operator*(const Matrix<DType>& A) {
+    MATRIX_ACCOUNT_SCOPE("operator*");
+    detail::TraceSpan trace("operator*", *this, A);
 
-    assert((SHAPE.size() == A.SHAPE.size()) &&
-        "The dimensions of the matrices must be same.");
+    std::vector<int> shape = detail::broadcast_shape(SHAPE, A.SHAPE);
+    Matrix<DType> RESULT = detail::matrix_with_shape<DType>(shape);
+    trace.set_flops(RESULT.get_matrix_size());
 
-    for (int i = 0; i < SHAPE.size(); i++)
-        assert((SHAPE[i] == A.SHAPE[i]) &&
-            "The dimensions of the matrices must be same.");
+    detail::broadcast_apply(RESULT.MATRIX, shape, MATRIX, SHAPE, A.MATRIX, A.SHAPE,
+        [](const DType x, const DType y) { return x * y; });
 
-    Matrix<DType> RESULT(*this);
-    RESULT *= A;
-    
     return RESULT;
 }
 
@@ -721,6 +1056,91 @@ int Matrix<DType>::get_matrix_size() const{
     return MATRIX_SIZE;
 }
 
+/*
+ * The method that returns the pointer to the contiguous storage of the matrix
+ *
+ * The elements are stored in row-major order, so the element A(i, j) of
+ * the matrix with the shape (N, M) is at data()[i * M + j]. It is used by
+ * the kernels that can not afford the index calculation of operator().
+ *
+ * Matrix<double> A(3, 3);
+ * double* p = A.data();
+ *
+ * @param no parameter
+ *
+ * @retval the pointer to the first element of the matrix
+ */
+template <typename DType>
+DType* Matrix<DType>::data() {
+    return MATRIX;
+}
+
+template <typename DType>
+const DType* Matrix<DType>::data() const {
+    return MATRIX;
+}
+
+/*
+ * The method that hands the storage of the matrix out without copying it
+ *
+ * The matrix is left without elements like a moved-from matrix, and the
+ * caller owns the returned buffer and frees it by delete[]. It only works
+ * for the storage allocated by the library or adopted without a deleter;
+ * the borrowed, adopted, mapped and shared matrices are released with
+ * their deleter by the other overload.
+ *
+ * Matrix::Matrix<float> A(1024, 1024);
+ * float* buffer = A.release();
+ * bus.send(buffer, [](float* p) { delete[] p; });
+ *
+ * @param no parameter
+ *
+ * @retval the pointer to the first element of the matrix
+ */
+template <typename DType>
+DType* Matrix<DType>::release() {
+    assert(!DELETER &&
+        "The storage with a deleter must be released with the deleter.");
+
+    std::function<void(DType*)> deleter;
+    return release(deleter);
+}
+
+/*
+ * The method that hands the storage and the function that frees it out
+ *
+ * The caller frees the returned buffer by calling deleter with it: the
+ * deleter of the adopted buffer, the unmapping of the mapped and shared
+ * matrices, nothing for the borrowed buffer and delete[] for the storage
+ * allocated by the library.
+ *
+ * std::function<void(float*)> deleter;
+ * float* buffer = X.release(deleter);
+ * ...
+ * deleter(buffer);
+ *
+ * @param deleter the function that frees the buffer, it is set by the method
+ *
+ * @retval the pointer to the first element of the matrix
+ */
+template <typename DType>
+DType* Matrix<DType>::release(std::function<void(DType*)>& deleter) {
+    DType* buffer = MATRIX;
+    detail::account_free(MATRIX);
+
+    if (DELETER)
+        deleter = std::move(DELETER);
+    else
+        deleter = [](DType* p) { delete[] p; };
+
+    SHAPE.clear();
+    MATRIX_SIZE = 0;
+    MATRIX = nullptr;
+    DELETER = nullptr;
+
+    return buffer;
+}
+
 template <typename DType>
 void Matrix<DType>::print_shape() const{
     std::cout << "(";
@@ -766,6 +1186,8 @@ void Matrix<DType>::print_shape() const{
  */
 template <typename DType>
 Matrix<DType> dot(const Matrix<DType>& A, const Matrix<DType>& B) {
+    MATRIX_ACCOUNT_SCOPE("dot");
+    detail::TraceSpan trace("dot", A, B);
 
     auto a_shape = A.get_shape();
     auto b_shape = B.get_shape();
@@ -773,22 +1195,595 @@ Matrix<DType> dot(const Matrix<DType>& A, const Matrix<DType>& B) {
     assert(a_shape[1] == b_shape[0] &&
         "The matrix multiplication is impossible");
 
-    Matrix<DType> AB = zeros<DType>(a_shape[0], b_shape[1]);
+    trace.set_flops(2.0 * a_shape[0] * a_shape[1] * b_shape[1]);
+
+    // the matrix-vector products don't need the generic loop
+    if (b_shape[1] == 1) {
+        Matrix<DType> AB(a_shape[0], 1);
+        gemv<DType>(1, A, B, 0, AB);
+        return AB;
+    }
 
-    for (int x = 0; x < a_shape[0]; x++) {
-        for (int y = 0; y < b_shape[1]; y++)
-            for (int i = 0; i < a_shape[1]; i++)
-                AB(x, y) += A(x, i) * B(i, y);
+    if (a_shape[0] == 1) {
+        Matrix<DType> AB(1, b_shape[1]);
+        gemv<DType>(1, B, A, 0, AB, true);
+        return AB;
     }
 
+    Matrix<DType> AB(a_shape[0], b_shape[1]);
+    gemm<DType>(1, A, B, 0, AB);
+
     return AB;
 }
 
 template <typename DType, typename... MATRICES>
 Matrix<DType> dot(const Matrix<DType>& first_matrix, const MATRICES&... matrices) {
+    MATRIX_ACCOUNT_SCOPE("dot");
+
     return dot(first_matrix, dot(matrices...));
 }
 
+namespace detail {
+
+// y[i] = alpha * dot(A[i, :], x) + beta * y[i] for the rows [first, last)
+template <typename DType>
+void gemv_rows(const DType* A, const int M, const DType* x, const DType alpha,
+               const DType beta, DType* y, const long first, const long last) {
+
+    constexpr int L = SIMD_LANES;
+    long i = first;
+
+    // four rows at once, so every element of x is loaded once for four rows
+    for (; i + 4 <= last; i += 4) {
+        const DType* a0 = A + i * M;
+        const DType* a1 = a0 + M;
+        const DType* a2 = a1 + M;
+        const DType* a3 = a2 + M;
+
+        DType acc0[L] = {}, acc1[L] = {}, acc2[L] = {}, acc3[L] = {};
+
+        int j = 0;
+        for (; j + L <= M; j += L) {
+            for (int l = 0; l < L; l++) {
+                DType xv = x[j + l];
+                acc0[l] += a0[j + l] * xv;
+                acc1[l] += a1[j + l] * xv;
+                acc2[l] += a2[j + l] * xv;
+                acc3[l] += a3[j + l] * xv;
+            }
+        }
+
+        DType s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+        for (int l = 0; l < L; l++) {
+            s0 += acc0[l];
+            s1 += acc1[l];
+            s2 += acc2[l];
+            s3 += acc3[l];
+        }
+
+        for (; j < M; j++) {
+            s0 += a0[j] * x[j];
+            s1 += a1[j] * x[j];
+            s2 += a2[j] * x[j];
+            s3 += a3[j] * x[j];
+        }
+
+        // beta = 0 overwrites y, so NaNs in the old content don't leak out
+        y[i]     = alpha * s0 + ((beta == 0) ? DType(0) : beta * y[i]);
+        y[i + 1] = alpha * s1 + ((beta == 0) ? DType(0) : beta * y[i + 1]);
+        y[i + 2] = alpha * s2 + ((beta == 0) ? DType(0) : beta * y[i + 2]);
+        y[i + 3] = alpha * s3 + ((beta == 0) ? DType(0) : beta * y[i + 3]);
+    }
+
+    for (; i < last; i++) {
+        const DType* a = A + i * M;
+        DType acc[L] = {};
+
+        int j = 0;
+        for (; j + L <= M; j += L)
+            for (int l = 0; l < L; l++)
+                acc[l] += a[j + l] * x[j + l];
+
+        DType s = 0;
+        for (int l = 0; l < L; l++)
+            s += acc[l];
+
+        for (; j < M; j++)
+            s += a[j] * x[j];
+
+        y[i] = alpha * s + ((beta == 0) ? DType(0) : beta * y[i]);
+    }
+}
+
+// y[:] += sum of scale * x[i] * A[i, :] for the rows [first, last)
+template <typename DType>
+void gemv_t_rows(const DType* A, const int M, const DType* x, const DType scale,
+                 DType* y, const long first, const long last) {
+
+    long i = first;
+
+    // four rows at once, so y is loaded and stored once for four rows
+    for (; i + 4 <= last; i += 4) {
+        const DType* a0 = A + i * M;
+        const DType* a1 = a0 + M;
+        const DType* a2 = a1 + M;
+        const DType* a3 = a2 + M;
+
+        DType x0 = scale * x[i];
+        DType x1 = scale * x[i + 1];
+        DType x2 = scale * x[i + 2];
+        DType x3 = scale * x[i + 3];
+
+        for (int j = 0; j < M; j++)
+            y[j] += x0 * a0[j] + x1 * a1[j] + x2 * a2[j] + x3 * a3[j];
+    }
+
+    for (; i < last; i++) {
+        const DType* a = A + i * M;
+        DType xi = scale * x[i];
+
+        for (int j = 0; j < M; j++)
+            y[j] += xi * a[j];
+    }
+}
+
+} // end of namespace detail
+
+/*
+ * The function that does the matrix-vector product y = alpha * A x + beta * y
+ *
+ * The result is written into the existing y, so no matrix is allocated.
+ * If transpose is true, y = alpha * A^T x + beta * y is computed without
+ * transposing A. x and y can be the column vectors, the row vectors or any
+ * matrices with the right number of elements. If beta is 0, the old content
+ * of y is not read. The rows of A are shared by the threads of the pool
+ * when the matrix is large enough.
+ *
+ * Matrix::Matrix<double> A(3, 2);
+ * Matrix::Vector<double> x(2, 1);
+ * Matrix::Vector<double> y = Matrix::zeros<double>(3, 1);
+ *
+ * Matrix::gemv(2.0, A, x, 1.0, y);   // y = 2 A x + y
+ *
+ * @param alpha the scale of the product
+ * @param A the matrix with the shape (N, M)
+ * @param x the vector with M elements (N elements if transpose is true)
+ * @param beta the scale of the old content of y
+ * @param y the vector with N elements (M elements if transpose is true)
+ * @param transpose multiplies by A^T instead of A if it is true
+ * @retval None
+ */
+template <typename DType>
+void gemv(const DType alpha, const Matrix<DType>& A, const Matrix<DType>& x,
+          const DType beta, Matrix<DType>& y, const bool transpose) {
+    detail::TraceSpan trace("gemv", A, x, y);
+
+    auto a_shape = A.get_shape();
+
+    assert((a_shape.size() == 2) &&
+        "The matrix must be two dimensional!");
+
+    const int N = a_shape[0];
+    const int M = a_shape[1];
+
+    assert((x.get_matrix_size() == (transpose ? N : M)) &&
+        "The matrix-vector multiplication is impossible");
+    assert((y.get_matrix_size() == (transpose ? M : N)) &&
+        "The size of the output vector is wrong!");
+
+    trace.set_flops(2.0 * N * M);
+
+    const DType* a = A.data();
+    const DType* xp = x.data();
+    DType* yp = y.data();
+
+    const long grain = std::max(4L, detail::PARALLEL_MIN_WORK / M);
+
+    if (!transpose) {
+        parallel_for(0, N, grain, [&](long first, long last) {
+            detail::gemv_rows(a, M, xp, alpha, beta, yp, first, last);
+        });
+        return;
+    }
+
+    for (int j = 0; j < M; j++)
+        yp[j] = (beta == 0) ? DType(0) : beta * yp[j];
+
+    // every chunk of rows sums into its own partial vector, then they are reduced
+    long chunks = std::min(static_cast<long>(get_num_threads()),
+                           static_cast<long>(N) * M / detail::PARALLEL_MIN_WORK);
+
+    if (chunks <= 1) {
+        detail::gemv_t_rows(a, M, xp, alpha, yp, 0, N);
+        return;
+    }
+
+    std::vector<DType> partial(chunks * M, DType(0));
+
+    parallel_for(0, chunks, 1, [&](long first, long last) {
+        for (long c = first; c < last; c++)
+            detail::gemv_t_rows(a, M, xp, alpha, partial.data() + c * M,
+                                c * N / chunks, (c + 1) * N / chunks);
+    });
+
+    parallel_for(0, M, detail::PARALLEL_MIN_WORK / chunks, [&](long first, long last) {
+        for (long c = 0; c < chunks; c++) {
+            const DType* p = partial.data() + c * M;
+            for (long j = first; j < last; j++)
+                yp[j] += p[j];
+        }
+    });
+}
+
+namespace detail {
+
+// the register tile of the GEMM micro-kernel, GEMM_MR x GEMM_NR accumulators
+constexpr int GEMM_MR = 4;
+constexpr int GEMM_NR = 8;
+
+// the cache blocks, a GEMM_MC x GEMM_KC block of A stays in L2 and
+// a GEMM_KC x GEMM_NC panel of B stays in L3
+constexpr int GEMM_MC = 128;
+constexpr int GEMM_KC = 256;
+constexpr int GEMM_NC = 2048;
+
+// op(A)(i, p) of the row-major matrix A with the row length lda
+template <typename DType>
+inline DType op_at(const DType* A, const int lda, const bool transpose, const long i, const long p) {
+    return transpose ? A[p * lda + i] : A[i * lda + p];
+}
+
+// packs op(A)[ic : ic + mc, pc : pc + kc] into slivers of GEMM_MR rows,
+// the rows past mc are padded with zeros, the elements are converted from
+// the storage type SType to the computation type DType on the way
+template <typename SType, typename DType>
+void pack_a(const SType* A, const int lda, const bool transpose, const int ic, const int pc,
+            const int mc, const int kc, DType* packed) {
+
+    for (int ir = 0; ir < mc; ir += GEMM_MR) {
+        int mr = std::min(GEMM_MR, mc - ir);
+        for (int p = 0; p < kc; p++)
+            for (int i = 0; i < GEMM_MR; i++)
+                *packed++ = (i < mr) ?
+                    static_cast<DType>(op_at(A, lda, transpose, ic + ir + i, pc + p)) : DType(0);
+    }
+}
+
+// packs the slivers [first, last) of op(B)[pc : pc + kc, jc : jc + nc],
+// every sliver has GEMM_NR columns and the columns past nc are padded with zeros
+template <typename SType, typename DType>
+void pack_b(const SType* B, const int ldb, const bool transpose, const int pc, const int jc,
+            const int kc, const int nc, DType* packed, const long first, const long last) {
+
+    for (long s = first; s < last; s++) {
+        int jr = s * GEMM_NR;
+        int nr = std::min(GEMM_NR, nc - jr);
+        DType* sliver = packed + s * kc * GEMM_NR;
+
+        for (int p = 0; p < kc; p++)
+            for (int j = 0; j < GEMM_NR; j++)
+                *sliver++ = (j < nr) ?
+                    static_cast<DType>(op_at(B, ldb, transpose, pc + p, jc + jr + j)) : DType(0);
+    }
+}
+
+// acc = the product of one packed sliver of A and one packed sliver of B,
+// the innermost loop is vectorized over the GEMM_NR columns
+template <typename DType>
+void gemm_micro_kernel(const int kc, const DType* a, const DType* b, DType acc[GEMM_MR][GEMM_NR]) {
+
+    for (int i = 0; i < GEMM_MR; i++)
+        for (int j = 0; j < GEMM_NR; j++)
+            acc[i][j] = 0;
+
+    for (int p = 0; p < kc; p++) {
+        for (int i = 0; i < GEMM_MR; i++) {
+            DType ai = a[p * GEMM_MR + i];
+            for (int j = 0; j < GEMM_NR; j++)
+                acc[i][j] += ai * b[p * GEMM_NR + j];
+        }
+    }
+}
+
+// the default finish of the tiles of gemm, they are left as they are
+struct NoFinish {
+    template <typename DType>
+    void operator()(const long, const long, DType*, const int) const {}
+};
+
+// C[ic : ic + mc, jc : jc + nc] += alpha * (packed A block) (packed B panel),
+// if lower is true, only the elements on and below the diagonal of C are computed;
+// if last is true, these are the final sums of the tile and finish(row, column, c, count)
+// is called on every row of the tile while it is still in the cache
+template <typename DType, typename Finish = NoFinish>
+void gemm_macro_kernel(const int mc, const int nc, const int kc, const DType alpha,
+                       const DType* packed_a, const DType* packed_b,
+                       DType* C, const int ldc, const int ic, const int jc,
+                       const bool lower = false, const Finish& finish = Finish(), const bool last = false) {
+
+    DType acc[GEMM_MR][GEMM_NR];
+
+    for (int jr = 0; jr < nc; jr += GEMM_NR) {
+        int nr = std::min(GEMM_NR, nc - jr);
+        const DType* b = packed_b + static_cast<long>(jr / GEMM_NR) * kc * GEMM_NR;
+
+        for (int ir = 0; ir < mc; ir += GEMM_MR) {
+            int mr = std::min(GEMM_MR, mc - ir);
+            const DType* a = packed_a + static_cast<long>(ir / GEMM_MR) * kc * GEMM_MR;
+
+            // the tiles entirely above the diagonal are skipped
+            if (lower && jc + jr > ic + ir + mr - 1)
+                continue;
+
+            gemm_micro_kernel(kc, a, b, acc);
+
+            for (int i = 0; i < mr; i++) {
+                int row = ic + ir + i;
+                int count = lower ? std::min(nr, row - jc - jr + 1) : nr;
+                DType* c = C + static_cast<long>(row) * ldc + jc + jr;
+                for (int j = 0; j < count; j++)
+                    c[j] += alpha * acc[i][j];
+
+                if (last)
+                    finish(row, jc + jr, c, count);
+            }
+        }
+    }
+}
+
+// the offset of the block op(A)[ic :, pc : pc + kc] in op(A) packed whole,
+// all the blocks of rows of one pc follow each other
+inline long packed_a_offset(const int m, const int pc, const int ic, const int kc) {
+    const long rows = (m + GEMM_MR - 1) / GEMM_MR * GEMM_MR;
+    return rows * pc + static_cast<long>(ic) * kc;
+}
+
+// the offset of the panel op(B)[pc : pc + kc, jc :] in op(B) packed whole,
+// all the blocks of one panel of columns follow each other
+inline long packed_b_offset(const int k, const int n, const int pc, const int jc) {
+    const long slivers = (std::min(GEMM_NC, n - jc) + GEMM_NR - 1) / GEMM_NR;
+    return static_cast<long>(jc) * k + slivers * GEMM_NR * pc;
+}
+
+// C = alpha * op(A) op(B) + beta * C on the raw row-major buffers,
+// op(A) is m x k, op(B) is k x n and C is m x n, A and B may be stored in
+// a narrower type SType, they are computed in DType after the packing;
+// if prepacked_a or prepacked_b is given, that operand was packed whole
+// beforehand (see PackedMatrix) and its raw buffer is not read;
+// finish is applied to the final elements of C (see gemm_macro_kernel)
+template <typename SType, typename DType, typename Finish = NoFinish>
+void gemm_blocked(const int m, const int n, const int k, const DType alpha,
+                  const SType* A, const int lda, const bool transpose_a,
+                  const SType* B, const int ldb, const bool transpose_b,
+                  const DType beta, DType* C, const int ldc,
+                  const DType* prepacked_a = nullptr, const DType* prepacked_b = nullptr,
+                  const Finish& finish = Finish()) {
+
+    // without the product, beta * C is already the final C
+    const bool empty = (k == 0 || alpha == 0);
+
+    parallel_for(0, m, std::max(1L, PARALLEL_MIN_WORK / n), [&](long first, long last) {
+        for (long i = first; i < last; i++) {
+            DType* c = C + i * ldc;
+            for (int j = 0; j < n; j++)
+                c[j] = (beta == 0) ? DType(0) : beta * c[j];
+
+            if (empty)
+                finish(i, 0, c, n);
+        }
+    });
+
+    if (empty)
+        return;
+
+    const long m_blocks = (m + GEMM_MC - 1) / GEMM_MC;
+    std::vector<DType> packed_b;
+
+    for (int jc = 0; jc < n; jc += GEMM_NC) {
+        int nc = std::min(GEMM_NC, n - jc);
+        long slivers = (nc + GEMM_NR - 1) / GEMM_NR;
+
+        for (int pc = 0; pc < k; pc += GEMM_KC) {
+            int kc = std::min(GEMM_KC, k - pc);
+
+            const DType* panel_b;
+
+            if (prepacked_b) {
+                panel_b = prepacked_b + packed_b_offset(k, n, pc, jc);
+            } else {
+                packed_b.resize(slivers * kc * GEMM_NR);
+                parallel_for(0, slivers, std::max(1L, PARALLEL_MIN_WORK / (kc * GEMM_NR)),
+                    [&](long first, long last) {
+                        pack_b(B, ldb, transpose_b, pc, jc, kc, nc, packed_b.data(), first, last);
+                    });
+                panel_b = packed_b.data();
+            }
+
+            // the blocks of rows are independent, every chunk packs its own blocks of A
+            long work = static_cast<long>(m) * nc * kc;
+            long grain = (work < PARALLEL_MIN_WORK) ? m_blocks : 1;
+
+            parallel_for(0, m_blocks, grain, [&](long first, long last) {
+                std::vector<DType> packed_a(prepacked_a ? 0 :
+                    static_cast<long>(GEMM_MC + GEMM_MR - 1) / GEMM_MR * GEMM_MR * kc);
+
+                for (long block = first; block < last; block++) {
+                    int ic = block * GEMM_MC;
+                    int mc = std::min(GEMM_MC, m - ic);
+                    const DType* block_a = packed_a.data();
+
+                    if (prepacked_a)
+                        block_a = prepacked_a + packed_a_offset(m, pc, ic, kc);
+                    else
+                        pack_a(A, lda, transpose_a, ic, pc, mc, kc, packed_a.data());
+
+                    gemm_macro_kernel(mc, nc, kc, alpha, block_a, panel_b, C, ldc, ic, jc,
+                                      false, finish, pc + kc == k);
+                }
+            });
+        }
+    }
+}
+
+} // end of namespace detail
+
+/*
+ * The function that does the general matrix product C = alpha * op(A) op(B) + beta * C
+ *
+ * op(X) is X^T if the corresponding transpose flag is true, X otherwise.
+ * The transposed operands are read in their own layout while they are packed
+ * into the cache blocks, so no transposed copy is made. The result is written
+ * into the existing C. If beta is 0, the old content of C is not read.
+ * The blocks of rows of C are shared by the threads of the pool. C must
+ * not be A or B: C is written while the later panels of A and B are still
+ * being packed, so gemm(1.0, C, B, 0.0, C) is not allowed.
+ *
+ * Matrix::Matrix<double> X(100, 3);
+ * Matrix::Matrix<double> G(3, 3);
+ *
+ * Matrix::gemm(1.0, X, X, 0.0, G, true, false);   // G = X^T X
+ *
+ * @param alpha the scale of the product
+ * @param A the first matrix, op(A) has the shape (N, K)
+ * @param B the second matrix, op(B) has the shape (K, M)
+ * @param beta the scale of the old content of C
+ * @param C the result matrix with the shape (N, M)
+ * @param transpose_a uses A^T instead of A if it is true
+ * @param transpose_b uses B^T instead of B if it is true
+ * @retval None
+ */
+template <typename DType>
+void gemm(const DType alpha, const Matrix<DType>& A, const Matrix<DType>& B,
+          const DType beta, Matrix<DType>& C, const bool transpose_a, const bool transpose_b) {
+    detail::TraceSpan trace("gemm", A, B, C);
+
+    auto a_shape = A.get_shape();
+    auto b_shape = B.get_shape();
+    auto c_shape = C.get_shape();
+
+    assert((a_shape.size() == 2 && b_shape.size() == 2 && c_shape.size() == 2) &&
+        "The matrices must be two dimensional!");
+    assert((C.data() != A.data() && C.data() != B.data()) &&
+        "The output matrix must not be an operand!");
+
+    int m = transpose_a ? a_shape[1] : a_shape[0];
+    int k = transpose_a ? a_shape[0] : a_shape[1];
+    int n = transpose_b ? b_shape[0] : b_shape[1];
+
+    assert((k == (transpose_b ? b_shape[1] : b_shape[0])) &&
+        "The matrix multiplication is impossible");
+    assert((c_shape[0] == m && c_shape[1] == n) &&
+        "The shape of the output matrix is wrong!");
+
+    trace.set_flops(2.0 * m * n * k);
+
+    detail::gemm_blocked(m, n, k, alpha, A.data(), a_shape[1], transpose_a,
+                         B.data(), b_shape[1], transpose_b, beta, C.data(), n);
+}
+
+/*
+ * The function that does the symmetric rank-k update C = alpha * A A^T + beta * C
+ *
+ * If transpose is true, C = alpha * A^T A + beta * C is computed instead.
+ * Only the lower triangle of C is computed, which is half of the work of
+ * gemm. If mirror is true, the lower triangle is copied to the upper one,
+ * otherwise the upper triangle is not touched. With beta = 1, the Gram
+ * matrices of the batches of rows can be accumulated into the same C.
+ * The result can be passed to cholesky directly.
+ *
+ * Matrix::Matrix<double> X(1000, 20);
+ * Matrix::Matrix<double> G(20, 20);
+ *
+ * Matrix::syrk(1.0, X, 0.0, G, true);   // G = X^T X
+ * auto L = Matrix::cholesky(G)[0];
+ *
+ * @param alpha the scale of the product
+ * @param A the matrix with the shape (N, K) (the shape (K, N) if transpose is true)
+ * @param beta the scale of the old content of C
+ * @param C the symmetric result matrix with the shape (N, N)
+ * @param transpose computes A^T A instead of A A^T if it is true
+ * @param mirror copies the lower triangle of C to the upper one if it is true
+ * @retval None
+ */
+template <typename DType>
+void syrk(const DType alpha, const Matrix<DType>& A, const DType beta, Matrix<DType>& C,
+          const bool transpose, const bool mirror) {
+    detail::TraceSpan trace("syrk", A, C);
+
+    auto a_shape = A.get_shape();
+    auto c_shape = C.get_shape();
+
+    assert((a_shape.size() == 2 && c_shape.size() == 2) &&
+        "The matrices must be two dimensional!");
+
+    const int n = transpose ? a_shape[1] : a_shape[0];
+    const int k = transpose ? a_shape[0] : a_shape[1];
+    const int lda = a_shape[1];
+
+    assert((c_shape[0] == n && c_shape[1] == n) &&
+        "The shape of the output matrix is wrong!");
+
+    // the lower triangle with the diagonal
+    trace.set_flops(1.0 * n * (n + 1) * k);
+
+    const DType* a = A.data();
+    DType* c = C.data();
+
+    parallel_for(0, n, std::max(1L, detail::PARALLEL_MIN_WORK / n), [&](long first, long last) {
+        for (long i = first; i < last; i++)
+            for (long j = 0; j <= i; j++)
+                c[i * n + j] = (beta == 0) ? DType(0) : beta * c[i * n + j];
+    });
+
+    using namespace detail;
+
+    const long m_blocks = (n + GEMM_MC - 1) / GEMM_MC;
+    std::vector<DType> packed_b;
+
+    // the same blocking as gemm with op(B) = op(A)^T, the blocks of rows
+    // above the panel of columns have nothing in the lower triangle
+    for (int jc = 0; jc < n && k > 0 && alpha != 0; jc += GEMM_NC) {
+        int nc = std::min(GEMM_NC, n - jc);
+        long slivers = (nc + GEMM_NR - 1) / GEMM_NR;
+
+        for (int pc = 0; pc < k; pc += GEMM_KC) {
+            int kc = std::min(GEMM_KC, k - pc);
+
+            packed_b.resize(slivers * kc * GEMM_NR);
+            parallel_for(0, slivers, std::max(1L, PARALLEL_MIN_WORK / (kc * GEMM_NR)),
+                [&](long first, long last) {
+                    pack_b(a, lda, !transpose, pc, jc, kc, nc, packed_b.data(), first, last);
+                });
+
+            long first_block = jc / GEMM_MC;
+            long work = static_cast<long>(n - jc) * nc * kc / 2;
+            long grain = (work < PARALLEL_MIN_WORK) ? m_blocks : 1;
+
+            parallel_for(first_block, m_blocks, grain, [&](long first, long last) {
+                std::vector<DType> packed_a(static_cast<long>(GEMM_MC + GEMM_MR - 1) / GEMM_MR * GEMM_MR * kc);
+
+                for (long block = first; block < last; block++) {
+                    int ic = block * GEMM_MC;
+                    int mc = std::min(GEMM_MC, n - ic);
+
+                    pack_a(a, lda, transpose, ic, pc, mc, kc, packed_a.data());
+                    gemm_macro_kernel(mc, nc, kc, alpha, packed_a.data(), packed_b.data(),
+                                      c, n, ic, jc, true);
+                }
+            });
+        }
+    }
+
+    if (!mirror)
+        return;
+
+    parallel_for(0, n, std::max(1L, detail::PARALLEL_MIN_WORK / n), [&](long first, long last) {
+        for (long i = first; i < last; i++)
+            for (long j = i + 1; j < n; j++)
+                c[i * n + j] = c[j * n + i];
+    });
+}
+
 /*
  * The function that returns new matrix which gets by applying 
  * sigmoid function to the elemets of the old matrix. 
@@ -817,18 +1812,21 @@ Matrix<DType> dot(const Matrix<DType>& first_matrix, const MATRICES&... matrices
  */
 template <typename DType>
 Matrix<DType> sigmoid(const Matrix<DType>& A) {
+    MATRIX_ACCOUNT_SCOPE("sigmoid");
+    detail::TraceSpan trace("sigmoid", A);
 
     assert((std::is_same<DType, double>::value) && 
         "DType must be double!");
     
-    Matrix<DType> RESULT(A); 
-    
-    for (int i = 0; i < A.MATRIX_SIZE; i++) {
-        double x = RESULT.MATRIX[i];
-        double result = 1 / (1 + std::exp(-1 * x));
-        RESULT.MATRIX[i] = result;
-    }
-    
+    Matrix<DType> RESULT = detail::matrix_with_shape<DType>(A.SHAPE);
+
+    const DType* a = A.MATRIX;
+    DType* r = RESULT.MATRIX;
+    detail::elementwise_for(A.MATRIX_SIZE, [a, r](long first, long last) {
+        for (long i = first; i < last; i++)
+            r[i] = 1 / (1 + std::exp(-a[i]));
+    });
+
     return RESULT;
 }
 
@@ -860,17 +1858,22 @@ Matrix<DType> sigmoid(const Matrix<DType>& A) {
  */
 template <typename DType>
 Matrix<DType> exp(const Matrix<DType>& A) {
+    MATRIX_ACCOUNT_SCOPE("exp");
+    detail::TraceSpan trace("exp", A);
 
     assert((std::is_same<DType, double>::value) && 
         "DType must be double!");
 
-    Matrix<DType> RESULT(A);
- 
-    for (int i = 0; i < A.MATRIX_SIZE; i++) {
-        double x = RESULT.MATRIX[i];
-        RESULT.MATRIX[i] = std::exp(x);
-    } 
-    return RESULT; 
+    Matrix<DType> RESULT = detail::matrix_with_shape<DType>(A.SHAPE);
+
+    const DType* a = A.MATRIX;
+    DType* r = RESULT.MATRIX;
+    detail::elementwise_for(A.MATRIX_SIZE, [a, r](long first, long last) {
+        for (long i = first; i < last; i++)
+            r[i] = std::exp(a[i]);
+    });
+
+    return RESULT;
 }
 
 /*
@@ -901,18 +1904,23 @@ Matrix<DType> exp(const Matrix<DType>& A) {
  */
 template <typename DType>
 Matrix<DType> tanh(const Matrix<DType>& A) {
+    MATRIX_ACCOUNT_SCOPE("tanh");
+    detail::TraceSpan trace("tanh", A);
 
     assert((std::is_same<DType, double>::value) && 
         "DType must be double!");
 
-    Matrix<DType> RESULT(A);
-    
-    for (int i = 0; i < A.MATRIX_SIZE; i++) {
-        double x = RESULT.MATRIX[i];
-        RESULT.MATRIX[i] = 
-            (std::exp(x) - std::exp(-x)) / (std::exp(x) + std::exp(-x));
-    
-    }
+    Matrix<DType> RESULT = detail::matrix_with_shape<DType>(A.SHAPE);
+
+    const DType* a = A.MATRIX;
+    DType* r = RESULT.MATRIX;
+    detail::elementwise_for(A.MATRIX_SIZE, [a, r](long first, long last) {
+        for (long i = first; i < last; i++) {
+            DType x = a[i];
+            r[i] = (std::exp(x) - std::exp(-x)) / (std::exp(x) + std::exp(-x));
+        }
+    });
+
     return RESULT;
 }
 
@@ -928,10 +1936,14 @@ Matrix<DType> tanh(const Matrix<DType>& A) {
  */
 template <typename DType, typename... DIMS>
 Matrix<DType> zeros(const DIMS... dims) {
+    MATRIX_ACCOUNT_SCOPE("zeros");
+
     Matrix<DType> RESULT(dims...);
-    
-    for (int i = 0; i < RESULT.MATRIX_SIZE; i++)
-        RESULT.MATRIX[i] = 0;
+
+    DType* r = RESULT.MATRIX;
+    detail::elementwise_for(RESULT.MATRIX_SIZE, [r](long first, long last) {
+        std::fill(r + first, r + last, DType(0));
+    });
 
     return RESULT;
 }
@@ -946,30 +1958,57 @@ Matrix<DType> zeros(const DIMS... dims) {
  */
 template <typename DType, typename... DIMS>
 Matrix<DType> ones(const DIMS... dims) {
+    MATRIX_ACCOUNT_SCOPE("ones");
+
     Matrix<DType> RESULT(dims...);
-    
-    for (int i = 0; i < RESULT.MATRIX_SIZE; i++)
-        RESULT.MATRIX[i] = 1;
+
+    DType* r = RESULT.MATRIX;
+    detail::elementwise_for(RESULT.MATRIX_SIZE, [r](long first, long last) {
+        std::fill(r + first, r + last, DType(1));
+    });
 
     return RESULT;
 }
 
 /*
  * The function that creates the matrix with random values
- * TODO: add the distribution option and improve the func with mersenne twist generator
- * Matrix::Matrix<double> C = Matrix::random(3, 3);
+ * Matrix::Matrix<double> C = Matrix::random<double>(3, 3);
+ *
+ * The values are integers in [0, RAND_MAX] like std::rand gives. They are
+ * drawn from the default generator, so every call gives a new matrix, and
+ * Matrix::manual_seed makes the calls reproducible. See distributions.h for
+ * the uniform, normal, bernoulli and truncated normal fills.
  *
  * @param dims the dimensions for the matrix with random variables
  * @retval the result matrix
  */
 template <typename DType, typename... DIMS>
 Matrix<DType> random(const DIMS... dims) {
+    MATRIX_ACCOUNT_SCOPE("random");
+
     Matrix<DType> RESULT(dims...);
-   
-    std::srand(static_cast<unsigned int>(std::time(nullptr)));
-    // be careful 
-    for (int i = 0; i < RESULT.MATRIX_SIZE; i++)
-        RESULT.MATRIX[i] = std::rand();
+
+    // the 4 words of the block of the counter first + b are the elements 4b to 4b + 3
+    constexpr int L = detail::SIMD_LANES;
+    const long size = RESULT.MATRIX_SIZE;
+    const long blocks = (size + 3) / 4;
+
+    Generator& gen = default_generator();
+    const std::uint64_t key = gen.get_seed();
+    const std::uint64_t first = gen.advance(blocks);
+
+    DType* r = RESULT.MATRIX;
+    detail::elementwise_for(blocks, [=](long begin, long end) {
+        std::uint32_t words[4][L];
+
+        for (long b = begin; b < end; b += L) {
+            detail::philox_lanes<L>(key, first + b, 0, words);
+
+            for (int l = 0; l < std::min<long>(L, end - b); l++)
+                for (int w = 0; w < 4 && 4 * (b + l) + w < size; w++)
+                    r[4 * (b + l) + w] = words[w][l] % (static_cast<std::uint64_t>(RAND_MAX) + 1);
+        }
+    }, 4);
 
     return RESULT;
 }
@@ -1025,6 +2064,8 @@ void reshape(Matrix<DType>& A, const std::vector<int> dims) {
  */
 template <typename DType>
 Matrix<DType> squeeze(const Matrix<DType> A) {
+    MATRIX_ACCOUNT_SCOPE("squeeze");
+
     Matrix<DType> B(A);
 
     std::vector<int> new_dims;
@@ -1049,6 +2090,8 @@ Matrix<DType> squeeze(const Matrix<DType> A) {
  */
 template <typename DType>
 Matrix<DType> identity(const int N) {
+    MATRIX_ACCOUNT_SCOPE("identity");
+
     Matrix<DType> I = zeros<DType>(N, N);
 
     for (int i = 0; i < N; i++) 
@@ -1057,11 +2100,115 @@ Matrix<DType> identity(const int N) {
     return I;
 }
 
+/*
+ * The function that wraps the external buffer as the matrix without copying it
+ *
+ * The matrix does not own the buffer: the buffer must outlive the matrix and
+ * it is not freed by it. The changes of the matrix are the changes of the
+ * buffer; the copies of the matrix are the usual matrices.
+ *
+ * float* frame = bus.receive();   // 64 x 128 floats in the row-major order
+ * Matrix::Matrix<float> X = Matrix::borrow(frame, {64, 128});
+ *
+ * @param data the buffer of the elements in the row-major order
+ * @param shape the shape of the matrix, the buffer has the product of its dimensions elements
+ * @retval the matrix whose elements are the buffer
+ */
+template <typename DType>
+Matrix<DType> borrow(DType* data, const std::vector<int>& shape) {
+    return detail::matrix_with_storage<DType>(shape, data, [](DType*) {});
+}
+
+/*
+ * The function that takes the ownership of the external buffer without copying it
+ *
+ * The matrix frees the buffer by the deleter when it is destroyed or assigned
+ * to, or by delete[] without the deleter.
+ *
+ * float* frame = bus.take();
+ * Matrix::Matrix<float> X = Matrix::adopt(frame, {64, 128}, [](float* p) { bus.give_back(p); });
+ *
+ * @param data the buffer of the elements in the row-major order
+ * @param shape the shape of the matrix, the buffer has the product of its dimensions elements
+ * @param deleter the function that frees the buffer
+ * @retval the matrix that owns the buffer
+ */
+template <typename DType>
+Matrix<DType> adopt(DType* data, const std::vector<int>& shape, std::function<void(DType*)> deleter) {
+    return detail::matrix_with_storage<DType>(shape, data, std::move(deleter));
+}
+
+namespace detail {
+
+// the rows are swapped through a buffer of this many bytes, small enough for L1
+constexpr int SWAP_BLOCK_BYTES = 4096;
+
+// swaps x[0, n) and y[0, n) block by block, the copies of the blocks are
+// done by std::copy, which becomes memmove for the arithmetic types
+template <typename DType>
+void swap_block(DType* x, DType* y, const long n) {
+    constexpr long B = SWAP_BLOCK_BYTES / sizeof(DType);
+    DType buffer[B];
+
+    for (long i = 0; i < n; i += B) {
+        const long b = std::min(B, n - i);
+
+        std::copy(x + i, x + i + b, buffer);
+        std::copy(y + i, y + i + b, x + i);
+        std::copy(buffer, buffer + b, y + i);
+    }
+}
+
+// y[i] += alpha * x[i] for i < n
+template <typename DType>
+inline void axpy(const DType alpha, const DType* x, DType* y, const long n) {
+    for (long i = 0; i < n; i++)
+        y[i] += alpha * x[i];
+}
+
+// x[i] *= alpha for i < n
+template <typename DType>
+inline void scal(const DType alpha, DType* x, const long n) {
+    for (long i = 0; i < n; i++)
+        x[i] *= alpha;
+}
+
+// the rows and the columns of the two dimensional matrix
+template <typename DType>
+inline void matrix_extents(const Matrix<DType>& A, int& N, int& M) {
+    auto shape = A.get_shape();
+
+    assert((shape.size() == 2) &&
+        "The matrix must be two dimensional!");
+
+    N = shape[0];
+    M = shape[1];
+}
+
+} // end of namespace detail
+
+/*
+ * The function that swaps two rows of the matrix
+ *
+ * The rows are swapped on their raw memory block by block, the long rows
+ * are cut into chunks for the thread pool.
+ *
+ * Matrix::Matrix<double> A(3, 3);
+ * Matrix::swap_rows(A, 0, 2);
+ *
+ *    [[6.0, 7.0, 8.0],
+ *     [3.0, 4.0, 5.0],
+ *     [0.0, 1.0, 2.0]]
+ *
+ * @param A the two dimensional matrix
+ * @param first_row the index of the first row
+ * @param second_row the index of the second row
+ * @retval None
+ */
 template <typename DType>
 void swap_rows(Matrix<DType>& A, const int first_row, const int second_row) {
-    auto __shape = A.get_shape();
-    int N = __shape[0];
-    int M = __shape[1];
+    int N, M;
+    detail::matrix_extents(A, N, M);
 
     assert(((first_row < N) && (second_row < N)) &&
         "Invalid row index!");
@@ -1069,15 +2216,38 @@ void swap_rows(Matrix<DType>& A, const int first_row, const int second_row) {
     assert(((first_row >= 0) && (second_row >= 0)) &&
         "Invalid row index!");
 
-    for (int i = 0; i < M; i++)
-        std::swap(A(first_row, i), A(second_row, i));
+    if (first_row == second_row)
+        return;
+
+    DType* x = A.data() + static_cast<long>(first_row) * M;
+    DType* y = A.data() + static_cast<long>(second_row) * M;
+
+    detail::elementwise_for(M, [x, y](long first, long last) {
+        detail::swap_block(x + first, y + first, last - first);
+    });
 }
 
+/*
+ * The function that adds the scaled row to another row
+ *
+ * A[second_row, :] += scalar * A[first_row, :]
+ *
+ * Matrix::Matrix<double> A(2, 3);
+ * Matrix::replace_rows(A, 0, 1, -1.0);
+ *
+ *    [[0.0, 1.0, 2.0],
+ *     [3.0, 3.0, 3.0]]
+ *
+ * @param A the two dimensional matrix
+ * @param first_row the index of the row that is scaled and added
+ * @param second_row the index of the row that is changed
+ * @param scalar the factor of first_row
+ * @retval None
+ */
 template <typename DType>
 void replace_rows(Matrix<DType>& A, const int first_row, const int second_row, const double scalar) {
-    auto __shape = A.get_shape();
-    int N = __shape[0];
-    int M = __shape[1];
+    int N, M;
+    detail::matrix_extents(A, N, M);
 
     assert(((first_row < N) && (second_row < N)) &&
         "Invalid row index!");
@@ -1085,39 +2255,375 @@ void replace_rows(Matrix<DType>& A, const int first_row, const int second_row, c
     assert(((first_row >= 0) && (second_row >= 0)) &&
         "Invalid row index!");
 
-    for (int i = 0; i < M; i++)
-        A(second_row, i) += A(first_row, i) * scalar;
+    const DType alpha = scalar;
+    const DType* x = A.data() + static_cast<long>(first_row) * M;
+    DType* y = A.data() + static_cast<long>(second_row) * M;
+
+    detail::elementwise_for(M, [alpha, x, y](long first, long last) {
+        detail::axpy(alpha, x + first, y + first, last - first);
+    });
 }
 
+/*
+ * The function that multiplies the row by the scalar
+ *
+ * Matrix::Matrix<double> A(2, 3);
+ * Matrix::scale_row(A, 1, 2.0);
+ *
+ *    [[0.0, 1.0, 2.0],
+ *     [6.0, 8.0, 10.0]]
+ *
+ * @param A the two dimensional matrix
+ * @param row the index of the row
+ * @param scalar the factor
+ * @retval None
+ */
 template <typename DType>
 void scale_row(Matrix<DType>& A, const int row, const double scalar) {
-    
-    auto __shape = A.get_shape();
-    int N = __shape[0];
-    int M = __shape[1];
+    int N, M;
+    detail::matrix_extents(A, N, M);
 
     assert((row < N && row >= 0) &&
         "Invalid row index!");
 
-    for (int i = 0; i < M; i++)
-        A(row, i) *= scalar;
+    const DType alpha = scalar;
+    DType* x = A.data() + static_cast<long>(row) * M;
+
+    detail::elementwise_for(M, [alpha, x](long first, long last) {
+        detail::scal(alpha, x + first, last - first);
+    });
+}
+
+/*
+ * The function that swaps two columns of the matrix
+ *
+ * The columns are strided in the memory, so the rows are walked once and
+ * the blocks of rows are done by the thread pool.
+ *
+ * @param A the two dimensional matrix
+ * @param first_column the index of the first column
+ * @param second_column the index of the second column
+ * @retval None
+ */
+template <typename DType>
+void swap_columns(Matrix<DType>& A, const int first_column, const int second_column) {
+    int N, M;
+    detail::matrix_extents(A, N, M);
+
+    assert(((first_column < M) && (second_column < M)) &&
+        "Invalid column index!");
+
+    assert(((first_column >= 0) && (second_column >= 0)) &&
+        "Invalid column index!");
+
+    DType* a = A.data();
+
+    detail::elementwise_for(N, [=](long first, long last) {
+        for (long r = first; r < last; r++)
+            std::swap(a[r * M + first_column], a[r * M + second_column]);
+    }, M);
 }
 
+/*
+ * The function that adds the scaled column to another column
+ *
+ * A[:, second_column] += scalar * A[:, first_column]
+ *
+ * @param A the two dimensional matrix
+ * @param first_column the index of the column that is scaled and added
+ * @param second_column the index of the column that is changed
+ * @param scalar the factor of first_column
+ * @retval None
+ */
 template <typename DType>
-Matrix<DType> transpoze(const Matrix<DType> A) {
+void replace_columns(Matrix<DType>& A, const int first_column, const int second_column, const double scalar) {
+    int N, M;
+    detail::matrix_extents(A, N, M);
+
+    assert(((first_column < M) && (second_column < M)) &&
+        "Invalid column index!");
+
+    assert(((first_column >= 0) && (second_column >= 0)) &&
+        "Invalid column index!");
+
+    const DType alpha = scalar;
+    DType* a = A.data();
+
+    detail::elementwise_for(N, [=](long first, long last) {
+        for (long r = first; r < last; r++)
+            a[r * M + second_column] += alpha * a[r * M + first_column];
+    }, M);
+}
+
+/*
+ * The function that multiplies the column by the scalar
+ *
+ * @param A the two dimensional matrix
+ * @param column the index of the column
+ * @param scalar the factor
+ * @retval None
+ */
+template <typename DType>
+void scale_column(Matrix<DType>& A, const int column, const double scalar) {
+    int N, M;
+    detail::matrix_extents(A, N, M);
+
+    assert((column < M && column >= 0) &&
+        "Invalid column index!");
+
+    const DType alpha = scalar;
+    DType* a = A.data();
+
+    detail::elementwise_for(N, [=](long first, long last) {
+        for (long r = first; r < last; r++)
+            a[r * M + column] *= alpha;
+    }, M);
+}
+
+/*
+ * The function that applies the rank-1 update to the trailing block of the matrix
+ *
+ * A[r, c] += alpha * x[r - first_row] * y[c - first_column]
+ * for first_row <= r < N and first_column <= c < M
+ *
+ * It is the step of the Gaussian elimination: the multipliers x of the
+ * rows below the pivot times the pivot row y are subtracted with alpha -1.
+ * Every row is one axpy on its raw memory, the rows are done by the
+ * thread pool. y may point into A, but not into the rows being updated.
+ *
+ * Matrix::Matrix<double> A(3, 3);
+ * std::vector<double> x = {1, 2};
+ * Matrix::rank1_update(A, 1, 0, x.data(), A.data(), -1.0);   // the rows 1 and 2 minus x times the row 0
+ *
+ * @param A the two dimensional matrix
+ * @param first_row the first updated row
+ * @param first_column the first updated column
+ * @param x N - first_row factors of the rows
+ * @param y M - first_column elements of the row that is added
+ * @param alpha the scale of the update
+ * @retval None
+ */
+template <typename DType>
+void rank1_update(Matrix<DType>& A, const int first_row, const int first_column,
+                  const DType* x, const DType* y, const DType alpha) {
+    int N, M;
+    detail::matrix_extents(A, N, M);
+
+    assert((first_row >= 0 && first_row <= N) &&
+        "Invalid row index!");
+
+    assert((first_column >= 0 && first_column <= M) &&
+        "Invalid column index!");
+
+    const long width = M - first_column;
+    DType* a = A.data() + static_cast<long>(first_row) * M + first_column;
+
+    detail::elementwise_for(N - first_row, [=](long first, long last) {
+        for (long r = first; r < last; r++)
+            detail::axpy(alpha * x[r], y, a + r * M, width);
+    }, std::max(1L, width));
+}
+
+namespace detail {
+
+// the tiles of this many elements are small enough to stay in L1 with their transposes
+constexpr int TRANSPOSE_TILE = 32;
+
+// dst[j * ldd + i] = src[i * lds + j] for one 4 x 4 block
+template <typename DType>
+inline void transpose_4x4(const DType* src, const long lds, DType* dst, const long ldd) {
+    for (int i = 0; i < 4; i++)
+        for (int j = 0; j < 4; j++)
+            dst[j * ldd + i] = src[i * lds + j];
+}
+
+#if defined(__AVX__)
+// the 4 x 4 block of doubles is transposed in four AVX registers
+inline void transpose_4x4(const double* src, const long lds, double* dst, const long ldd) {
+    __m256d r0 = _mm256_loadu_pd(src);
+    __m256d r1 = _mm256_loadu_pd(src + lds);
+    __m256d r2 = _mm256_loadu_pd(src + 2 * lds);
+    __m256d r3 = _mm256_loadu_pd(src + 3 * lds);
+
+    __m256d t0 = _mm256_unpacklo_pd(r0, r1);
+    __m256d t1 = _mm256_unpackhi_pd(r0, r1);
+    __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+    __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+
+    _mm256_storeu_pd(dst,           _mm256_permute2f128_pd(t0, t2, 0x20));
+    _mm256_storeu_pd(dst + ldd,     _mm256_permute2f128_pd(t1, t3, 0x20));
+    _mm256_storeu_pd(dst + 2 * ldd, _mm256_permute2f128_pd(t0, t2, 0x31));
+    _mm256_storeu_pd(dst + 3 * ldd, _mm256_permute2f128_pd(t1, t3, 0x31));
+}
+#endif
+
+// transposes the tile src[r0 : r1, c0 : c1] into dst by 4 x 4 blocks
+template <typename DType>
+void transpose_tile(const DType* src, const long lds, DType* dst, const long ldd,
+                    const int r0, const int r1, const int c0, const int c1) {
+    int i = r0;
+    for (; i + 4 <= r1; i += 4) {
+        int j = c0;
+        for (; j + 4 <= c1; j += 4)
+            transpose_4x4(src + i * lds + j, lds, dst + j * ldd + i, ldd);
+
+        for (; j < c1; j++)
+            for (int k = i; k < i + 4; k++)
+                dst[j * ldd + k] = src[k * lds + j];
+    }
+
+    for (; i < r1; i++)
+        for (int j = c0; j < c1; j++)
+            dst[j * ldd + i] = src[i * lds + j];
+}
+
+// cache-oblivious transpose, the longer side is halved until the block is one tile
+template <typename DType>
+void transpose_recursive(const DType* src, const long lds, DType* dst, const long ldd,
+                         const int r0, const int r1, const int c0, const int c1) {
+    int rows = r1 - r0;
+    int cols = c1 - c0;
+
+    if (rows <= TRANSPOSE_TILE && cols <= TRANSPOSE_TILE) {
+        transpose_tile(src, lds, dst, ldd, r0, r1, c0, c1);
+    } else if (rows >= cols) {
+        int middle = r0 + rows / 2;
+        transpose_recursive(src, lds, dst, ldd, r0, middle, c0, c1);
+        transpose_recursive(src, lds, dst, ldd, middle, r1, c0, c1);
+    } else {
+        int middle = c0 + cols / 2;
+        transpose_recursive(src, lds, dst, ldd, r0, r1, c0, middle);
+        transpose_recursive(src, lds, dst, ldd, r0, r1, middle, c1);
+    }
+}
+
+// swaps the tile a[r0 : r1, c0 : c1] with the transpose of a[c0 : c1, r0 : r1],
+// if the tile is on the diagonal, it is transposed in place
+template <typename DType>
+void swap_transpose_tiles(DType* a, const long lda,
+                          const int r0, const int r1, const int c0, const int c1) {
+    for (int i = r0; i < r1; i++) {
+        int first = (r0 == c0) ? i + 1 : c0;
+        for (int j = first; j < c1; j++)
+            std::swap(a[i * lda + j], a[j * lda + i]);
+    }
+}
+
+} // end of namespace detail
+
+/*
+ * The function that returns the transpose of the matrix
+ *
+ * The matrix is transposed by the cache-oblivious recursion that halves the
+ * longer side of the block until it fits in the cache, and the blocks are
+ * transposed in 4 x 4 pieces (in the AVX registers for double matrices).
+ * The stripes of rows are shared by the threads of the pool.
+ *
+ * Matrix::Matrix<double> A(2, 3);
+ *
+ *     The matrix A          The matrix B
+ *   -----------------    -----------------
+ *    [[0, 1, 2],          [[0, 3],
+ *     [3, 4, 5]]           [1, 4],
+ *                          [2, 5]]
+ *
+ * Matrix::Matrix<double> B = Matrix::transpoze(A);
+ *
+ * @param A the two dimensional matrix
+ * @retval the transpose of the matrix
+ */
+template <typename DType>
+Matrix<DType> transpoze(const Matrix<DType>& A) {
+    MATRIX_ACCOUNT_SCOPE("transpoze");
+    detail::TraceSpan trace("transpoze", A);
 
     int N = A.get_shape()[0];
     int M = A.get_shape()[1];
 
     Matrix<DType> RESULT(M, N);
 
-    for (int i = 0; i < N; i++)
-        for (int j = 0; j < M; j++)
-            RESULT(j, i) = A(i, j);
+    const DType* src = A.data();
+    DType* dst = RESULT.data();
+
+    const long stripe = detail::TRANSPOSE_TILE * 8;
+    const long stripes = (N + stripe - 1) / stripe;
+    const long grain = std::max(1L, detail::PARALLEL_MIN_WORK / (stripe * M));
+
+    parallel_for(0, stripes, grain, [&](long first, long last) {
+        for (long s = first; s < last; s++)
+            detail::transpose_recursive(src, M, dst, N, s * stripe,
+                                        std::min<long>(N, (s + 1) * stripe), 0, M);
+    });
 
     return RESULT;
 }
 
+/*
+ * The function that transposes the matrix without allocating a new matrix
+ *
+ * The square matrices are transposed by swapping the pairs of tiles across
+ * the diagonal. The rectangular matrices are transposed by following the
+ * cycles of the permutation, it needs one bit per element to mark the moved
+ * elements but it is much slower than transpoze, so it should be used only
+ * when there is no memory for a second matrix.
+ *
+ * Matrix::Matrix<double> A(2, 3);
+ * Matrix::transpoze_inplace(A);   // A has the shape (3, 2) now
+ *
+ * @param A the two dimensional matrix
+ * @retval None
+ */
+template <typename DType>
+void transpoze_inplace(Matrix<DType>& A) {
+
+    auto __shape = A.get_shape();
+
+    assert((__shape.size() == 2) &&
+        "The matrix must be two dimensional!");
+
+    const int N = __shape[0];
+    const int M = __shape[1];
+    DType* a = A.data();
+
+    if (N == M) {
+        const int tile = detail::TRANSPOSE_TILE;
+        const long tiles = (N + tile - 1) / tile;
+        const long grain = std::max(1L, detail::PARALLEL_MIN_WORK / (static_cast<long>(tile) * N));
+
+        // the row of tiles bi owns the pairs (bi, bj) with bj >= bi, so the threads never meet
+        parallel_for(0, tiles, grain, [&](long first, long last) {
+            for (long bi = first; bi < last; bi++) {
+                int r0 = bi * tile;
+                int r1 = std::min(N, r0 + tile);
+                for (int c0 = r0; c0 < N; c0 += tile)
+                    detail::swap_transpose_tiles(a, N, r0, r1, c0, std::min(N, c0 + tile));
+            }
+        });
+
+        return;
+    }
+
+    // the element at k moves to (k % M) * N + k / M, the first and the last ones never move
+    const long size = static_cast<long>(N) * M;
+    std::vector<bool> moved(size, false);
+
+    for (long start = 1; start < size - 1; start++) {
+        if (moved[start])
+            continue;
+
+        long k = start;
+        DType carried = a[k];
+        do {
+            long next = (k % M) * N + k / M;
+            std::swap(carried, a[next]);
+            moved[next] = true;
+            k = next;
+        } while (k != start);
+    }
+
+    reshape(A, {M, N});
+}
+
 /*
 template<typename DType>
 Matrix<DType> augment(Matrix<DType> A, Matrix<DType> B) {
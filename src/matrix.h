@@ -1,9 +1,23 @@
 #ifndef _MATRIX_H_
 #define _MATRIX_H_
+#include <functional>
 #include <vector>
 
 namespace Matrix {
 
+template <typename DType>
+class Matrix;
+
+namespace detail {
+
+// selects the constructor of the matrix without elements
+struct NoStorage {};
+
+template <typename T>
+Matrix<T> matrix_with_storage(const std::vector<int>&, T*, std::function<void(T*)>);
+
+} // end of namespace detail
+
 template <typename DType>
 class Matrix {
 
@@ -34,9 +48,13 @@ friend Matrix<T> squeeze(const Matrix<T>);
 template <typename T>
 friend Matrix<T> identity(const int);
 
+template <typename T>
+friend Matrix<T> detail::matrix_with_storage(const std::vector<int>&, T*, std::function<void(T*)>);
+
 public:
 
     Matrix<DType>(const Matrix<DType>&);
+    Matrix<DType>(Matrix<DType>&&) noexcept;
 
     template <typename... DIMS>
     Matrix<DType>(const DIMS&...);
@@ -48,6 +66,7 @@ public:
     auto operator()(const Index&...) const;
 
     Matrix<DType>& operator=(const Matrix<DType>&);
+    Matrix<DType>& operator=(Matrix<DType>&&) noexcept;
 
     Matrix<DType>& operator/=(const DType);
     Matrix<DType>  operator/(const DType);
@@ -72,10 +91,23 @@ public:
     std::vector<int> get_shape() const;
     void print_shape() const;
     int get_matrix_size() const;
+
+    DType* data();
+    const DType* data() const;
+
+    DType* release();
+    DType* release(std::function<void(DType*)>&);
 private:
     std::vector<int> SHAPE; 
     int MATRIX_SIZE;
     DType* MATRIX;
+
+    // frees MATRIX if it is not allocated by the matrix, like the mapped files
+    std::function<void(DType*)> DELETER;
+
+    explicit Matrix<DType>(detail::NoStorage);
+
+    void free_storage();
 };
 
 template <typename DType> 
@@ -84,6 +116,17 @@ Matrix<DType> dot(const Matrix<DType>&, const Matrix<DType>&);
 template <typename DType, typename... MATRICES>
 Matrix<DType> dot(const Matrix<DType>&, const MATRICES&...);
 
+template <typename DType>
+void gemv(const DType, const Matrix<DType>&, const Matrix<DType>&, const DType, Matrix<DType>&, const bool = false);
+
+template <typename DType>
+void gemm(const DType, const Matrix<DType>&, const Matrix<DType>&, const DType, Matrix<DType>&,
+          const bool = false, const bool = false);
+
+template <typename DType>
+void syrk(const DType, const Matrix<DType>&, const DType, Matrix<DType>&,
+          const bool = false, const bool = true);
+
 template <typename DType> 
 Matrix<DType> sigmoid(const Matrix<DType>&);
 
@@ -111,6 +154,12 @@ Matrix<DType> squeeze(const Matrix<DType>);
 template <typename DType>
 Matrix<DType> identity(const int);
 
+template <typename DType>
+Matrix<DType> borrow(DType*, const std::vector<int>&);
+
+template <typename DType>
+Matrix<DType> adopt(DType*, const std::vector<int>&, std::function<void(DType*)> = nullptr);
+
 template <typename DType>
 void swap_rows(Matrix<DType>&, const int, const int);
 
@@ -118,10 +167,25 @@ template <typename DType>
 void replace_rows(Matrix<DType>&, const int, const int, const double);
 
 template <typename DType>
-void scale_row(Matrix<DType>&, const int, const int);
+void scale_row(Matrix<DType>&, const int, const double);
+
+template <typename DType>
+void swap_columns(Matrix<DType>&, const int, const int);
+
+template <typename DType>
+void replace_columns(Matrix<DType>&, const int, const int, const double);
+
+template <typename DType>
+void scale_column(Matrix<DType>&, const int, const double);
+
+template <typename DType>
+void rank1_update(Matrix<DType>&, const int, const int, const DType*, const DType*, const DType = 1);
+
+template <typename DType>
+Matrix<DType> transpoze(const Matrix<DType>&);
 
 template <typename DType>
-Matrix<DType> transpoze(const Matrix<DType>);
+void transpoze_inplace(Matrix<DType>&);
 
 } // end of Matrix namespace
 
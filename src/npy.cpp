@@ -0,0 +1,724 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#ifndef _NPY_CPP_
+#define _NPY_CPP_
+
+#include "matrix.h"
+#include "npy.h"
+#include "half.h"
+#include "errors.h"
+
+#include <algorithm>   // for std::reverse
+#include <cstring>     // for std::memcpy, std::memcmp
+#include <limits>      // for std::numeric_limits
+#include <type_traits> // for std::is_same, std::is_floating_point
+
+namespace Matrix {
+
+namespace detail {
+
+constexpr char NPY_MAGIC[6] = {'\x93', 'N', 'U', 'M', 'P', 'Y'};
+
+// the header of .npy is padded so that the data starts at a multiple of this
+constexpr std::size_t NPY_ALIGNMENT = 64;
+
+inline bool host_is_little_endian() {
+    const std::uint16_t one = 1;
+    unsigned char first;
+    std::memcpy(&first, &one, 1);
+    return first == 1;
+}
+
+// the little endian fields of the .npy header and the zip format
+inline void put_le(std::string& out, const std::uint64_t value, const int bytes) {
+    for (int b = 0; b < bytes; b++)
+        out += char((value >> (8 * b)) & 0xff);
+}
+
+// the type of the elements in the .npy header without the byte order, like f8 or i4
+template <typename DType>
+std::string npy_type() {
+    if (std::is_same<DType, bool>::value)
+        return "b1";
+    if (std::is_same<DType, float16>::value)
+        return "f2";
+
+    static_assert(std::is_arithmetic<DType>::value || std::is_same<DType, float16>::value,
+        "The matrices of this type can not be saved!");
+
+    const char kind = std::is_floating_point<DType>::value ? 'f' : (std::is_signed<DType>::value ? 'i' : 'u');
+    return kind + std::to_string(sizeof(DType));
+}
+
+// the byte order character of the elements of the host
+template <typename DType>
+char npy_byte_order() {
+    return (sizeof(DType) == 1) ? '|' : (host_is_little_endian() ? '<' : '>');
+}
+
+/*
+ * The header of the .npy file of the matrix with the shape: the magic,
+ * the version, the length of the dictionary and the dictionary that is
+ * padded with spaces and a newline to the alignment, a multiple of 64.
+ * Version 2 has the four byte length for the dictionaries longer than 65535 bytes.
+ */
+template <typename DType>
+std::string npy_header(const std::vector<int>& shape, const std::size_t alignment = NPY_ALIGNMENT) {
+    std::string dict = "{'descr': '" + std::string(1, npy_byte_order<DType>()) + npy_type<DType>() +
+                       "', 'fortran_order': False, 'shape': (";
+
+    for (std::size_t d = 0; d < shape.size(); d++)
+        dict += (d ? ", " : "") + std::to_string(shape[d]);
+
+    dict += (shape.size() == 1) ? ",), }" : "), }";
+
+    // the magic, the version and the two byte length of version 1, or the four byte length of version 2
+    std::size_t prefix = sizeof(NPY_MAGIC) + 2 + 2;
+    std::size_t total = (prefix + dict.size() + 1 + alignment - 1) / alignment * alignment;
+
+    if (total - prefix > 65535) {
+        prefix += 2;
+        total = (prefix + dict.size() + 1 + alignment - 1) / alignment * alignment;
+    }
+
+    dict.append(total - prefix - dict.size() - 1, ' ');
+    dict += '\n';
+
+    std::string header(NPY_MAGIC, sizeof(NPY_MAGIC));
+    header += (prefix == sizeof(NPY_MAGIC) + 4) ? '\x01' : '\x02';
+    header += '\x00';
+    put_le(header, dict.size(), prefix - sizeof(NPY_MAGIC) - 2);
+
+    return header + dict;
+}
+
+struct NpyHeader {
+    char byte_order;
+    std::string type;
+    bool fortran_order;
+    std::vector<int> shape;
+};
+
+// the text after the key in the dictionary of the .npy header
+inline std::size_t npy_value(const std::string& dict, const std::string& key) {
+    std::size_t at = dict.find("'" + key + "'");
+    if (at == std::string::npos)
+        at = dict.find("\"" + key + "\"");
+    if (at == std::string::npos)
+        throw SerializationError();
+
+    at = dict.find(':', at + key.size() + 2);
+    if (at == std::string::npos)
+        throw SerializationError();
+
+    return dict.find_first_not_of(' ', at + 1);
+}
+
+inline NpyHeader read_npy_header(std::istream& in) {
+    char prefix[sizeof(NPY_MAGIC) + 2];
+    if (!in.read(prefix, sizeof(prefix)) || std::memcmp(prefix, NPY_MAGIC, sizeof(NPY_MAGIC)) != 0)
+        throw SerializationError();
+
+    const int major = prefix[sizeof(NPY_MAGIC)];
+    unsigned char bytes[4] = {};
+    if (major < 1 || major > 3 || !in.read(reinterpret_cast<char*>(bytes), major == 1 ? 2 : 4))
+        throw SerializationError();
+
+    const std::size_t length = bytes[0] | (bytes[1] << 8) | (std::size_t(bytes[2]) << 16) | (std::size_t(bytes[3]) << 24);
+    std::string dict(length, '\0');
+    if (!in.read(&dict[0], length))
+        throw SerializationError();
+
+    NpyHeader header;
+
+    // 'descr': '<f8'
+    std::size_t at = npy_value(dict, "descr");
+    if (at == std::string::npos || (dict[at] != '\'' && dict[at] != '"'))
+        throw SerializationError();
+    const std::size_t end = dict.find(dict[at], at + 1);
+    if (end == std::string::npos || end - at < 3)
+        throw SerializationError();
+    header.byte_order = dict[at + 1];
+    header.type = dict.substr(at + 2, end - at - 2);
+
+    // 'fortran_order': False
+    at = npy_value(dict, "fortran_order");
+    if (at == std::string::npos)
+        throw SerializationError();
+    header.fortran_order = dict.compare(at, 4, "True") == 0;
+
+    // 'shape': (3, 4)
+    at = npy_value(dict, "shape");
+    if (at == std::string::npos || dict[at] != '(')
+        throw SerializationError();
+
+    for (at = at + 1; at < dict.size() && dict[at] != ')'; ) {
+        if (dict[at] == ' ' || dict[at] == ',') {
+            at++;
+            continue;
+        }
+
+        // the digits are read by hand, anything else like 3L is not a valid dimension
+        long dim = 0;
+        const std::size_t first = at;
+        for (; at < dict.size() && dict[at] >= '0' && dict[at] <= '9'; at++) {
+            dim = 10 * dim + (dict[at] - '0');
+            if (dim > std::numeric_limits<int>::max())
+                throw SerializationError();
+        }
+
+        if (at == first || dim <= 0)
+            throw SerializationError();
+
+        header.shape.push_back(dim);
+    }
+
+    return header;
+}
+
+// the elements of the file can be used as they are: DType, the byte order of the host and the C order
+template <typename DType>
+bool is_native_npy(const NpyHeader& header) {
+    const char other_order = host_is_little_endian() ? '>' : '<';
+
+    return header.type == npy_type<DType>() && !(sizeof(DType) > 1 && header.byte_order == other_order) &&
+           !(header.fortran_order && header.shape.size() > 1);
+}
+
+// reverses the bytes of every element of the other byte order
+template <typename DType>
+void swap_bytes(DType* data, const long count) {
+    unsigned char* bytes = reinterpret_cast<unsigned char*>(data);
+
+    elementwise_for(count, [bytes](long first, long last) {
+        for (long i = first; i < last; i++)
+            std::reverse(bytes + i * sizeof(DType), bytes + (i + 1) * sizeof(DType));
+    });
+}
+
+// the elements of the column-major (Fortran) order in the row-major order of the matrix
+template <typename DType>
+void from_fortran_order(Matrix<DType>& A) {
+    auto shape = A.get_shape();
+    const int ndim = shape.size();
+    const long size = A.get_matrix_size();
+
+    std::vector<DType> column_major(A.data(), A.data() + size);
+    std::vector<long> strides(ndim, 1);
+    for (int d = 1; d < ndim; d++)
+        strides[d] = strides[d - 1] * shape[d - 1];
+
+    // the row-major odometer with the column-major offset of its position
+    std::vector<int> index(ndim, 0);
+    long offset = 0;
+    DType* a = A.data();
+
+    for (long p = 0; p < size; p++) {
+        a[p] = column_major[offset];
+
+        for (int d = ndim - 1; d >= 0; d--) {
+            offset += strides[d];
+            if (++index[d] < shape[d])
+                break;
+            offset -= strides[d] * shape[d];
+            index[d] = 0;
+        }
+    }
+}
+
+inline std::uint64_t get_le(const unsigned char* in, const int bytes) {
+    std::uint64_t value = 0;
+    for (int b = bytes - 1; b >= 0; b--)
+        value = (value << 8) | in[b];
+    return value;
+}
+
+// the CRC-32 of zip, slicing by 8 bytes
+inline std::uint32_t crc32(std::uint32_t crc, const unsigned char* data, std::size_t n) {
+    static const std::vector<std::uint32_t> table = [] {
+        std::vector<std::uint32_t> t(8 * 256);
+        for (std::uint32_t i = 0; i < 256; i++) {
+            std::uint32_t c = i;
+            for (int k = 0; k < 8; k++)
+                c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        for (std::uint32_t i = 0; i < 256; i++)
+            for (int s = 1; s < 8; s++)
+                t[s * 256 + i] = (t[(s - 1) * 256 + i] >> 8) ^ t[t[(s - 1) * 256 + i] & 0xff];
+        return t;
+    }();
+
+    const std::uint32_t* t = table.data();
+    crc = ~crc;
+
+    for (; n >= 8; n -= 8, data += 8) {
+        const std::uint32_t lo = crc ^ (data[0] | (data[1] << 8) | (data[2] << 16) | (std::uint32_t(data[3]) << 24));
+        const std::uint32_t hi = data[4] | (data[5] << 8) | (data[6] << 16) | (std::uint32_t(data[7]) << 24);
+        crc = t[7 * 256 + (lo & 0xff)] ^ t[6 * 256 + ((lo >> 8) & 0xff)] ^
+              t[5 * 256 + ((lo >> 16) & 0xff)] ^ t[4 * 256 + (lo >> 24)] ^
+              t[3 * 256 + (hi & 0xff)] ^ t[2 * 256 + ((hi >> 8) & 0xff)] ^
+              t[1 * 256 + ((hi >> 16) & 0xff)] ^ t[hi >> 24];
+    }
+
+    for (; n > 0; n--, data++)
+        crc = t[(crc ^ *data) & 0xff] ^ (crc >> 8);
+
+    return ~crc;
+}
+
+constexpr std::uint32_t ZIP_LOCAL_HEADER = 0x04034b50;
+constexpr std::uint32_t ZIP_CENTRAL_HEADER = 0x02014b50;
+constexpr std::uint32_t ZIP64_END_RECORD = 0x06064b50;
+constexpr std::uint32_t ZIP64_END_LOCATOR = 0x07064b50;
+constexpr std::uint32_t ZIP_END_RECORD = 0x06054b50;
+constexpr std::uint64_t ZIP32_LIMIT = 0xffffffffu;
+
+// 1980-01-01 00:00, the archives of the same matrices are the same bytes
+constexpr std::uint16_t ZIP_DATE = (1 << 5) | 1;
+
+} // end of namespace detail
+
+/*
+ * The function that writes the matrix in the .npy format of numpy
+ *
+ * The header describes the element type, the byte order of the host and the
+ * shape, and the elements follow it in one write, at an offset that is a
+ * multiple of 64. float, double, the integer types, bool and float16 can
+ * be saved; numpy.load reads the file back as the same array.
+ *
+ * Matrix::Matrix<float> W(4096, 4096);
+ * Matrix::save("weights.npy", W);
+ *
+ * @param out the stream opened in the binary mode
+ * @param A the matrix
+ * @retval None
+ */
+template <typename DType>
+void save(std::ostream& out, const Matrix<DType>& A) {
+    detail::TraceSpan trace("save", A);
+
+    const std::string header = detail::npy_header<DType>(A.get_shape());
+
+    out.write(header.data(), header.size());
+    out.write(reinterpret_cast<const char*>(A.data()), static_cast<std::streamsize>(A.get_matrix_size()) * sizeof(DType));
+
+    if (!out)
+        throw SerializationError();
+}
+
+template <typename DType>
+void save(const std::string& path, const Matrix<DType>& A) {
+    std::ofstream out(path, std::ios::binary);
+    save(out, A);
+}
+
+/*
+ * The function that reads the matrix from the .npy format
+ *
+ * The elements are read into the new matrix with one bulk read. The files
+ * of the other byte order and in the Fortran order are converted after the
+ * read. The element type of the file must be the type of DType, like <f4 for
+ * float; the zero dimensional arrays become the matrices of one element.
+ *
+ * Matrix::Matrix<float> W = Matrix::load<float>("weights.npy");
+ *
+ * @param in the stream opened in the binary mode
+ * @retval the matrix
+ * @throw SerializationError if the stream is not a .npy file of DType or it ends early
+ */
+template <typename DType>
+Matrix<DType> load(std::istream& in) {
+    detail::TraceSpan trace("load");
+
+    detail::NpyHeader header = detail::read_npy_header(in);
+
+    if (header.type != detail::npy_type<DType>())
+        throw SerializationError();
+
+    if (header.shape.empty())
+        header.shape.push_back(1);
+
+    long size = 1;
+    for (int dim : header.shape) {
+        size *= dim;
+        if (size > std::numeric_limits<int>::max())
+            throw SerializationError();
+    }
+
+    Matrix<DType> RESULT = detail::matrix_with_shape<DType>(header.shape);
+
+    if (!in.read(reinterpret_cast<char*>(RESULT.data()), static_cast<std::streamsize>(size) * sizeof(DType)))
+        throw SerializationError();
+
+    const char other_order = detail::host_is_little_endian() ? '>' : '<';
+    if (sizeof(DType) > 1 && header.byte_order == other_order)
+        detail::swap_bytes(RESULT.data(), size);
+
+    if (header.fortran_order && header.shape.size() > 1)
+        detail::from_fortran_order(RESULT);
+
+    trace.add(RESULT);
+    return RESULT;
+}
+
+template <typename DType>
+Matrix<DType> load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        throw SerializationError();
+
+    return load<DType>(in);
+}
+
+/*
+ * The constructor that creates the archive file
+ *
+ * std::vector<Matrix::Matrix<float>> layers = ...;
+ * Matrix::ArchiveWriter archive("model.npz");
+ * archive.add("W1", layers[0]);
+ * archive.add("b1", layers[1]);
+ * archive.close();
+ *
+ * @param path the path of the archive, it is overwritten
+ */
+inline ArchiveWriter::ArchiveWriter(const std::string& path)
+: FILE(path, std::ios::binary), CLOSED(false)
+{
+    if (!FILE)
+        throw SerializationError();
+}
+
+inline ArchiveWriter::~ArchiveWriter() {
+    try {
+        close();
+    } catch (...) {
+    }
+}
+
+/*
+ * The function that writes the matrix into the archive as name.npy
+ *
+ * @param name the name of the matrix in the archive
+ * @param A the matrix
+ * @retval None
+ */
+template <typename DType>
+void ArchiveWriter::add(const std::string& name, const Matrix<DType>& A) {
+    assert(!CLOSED && "The archive is closed!");
+
+    const std::string header = detail::npy_header<DType>(A.get_shape());
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(A.data());
+    const std::uint64_t bytes = static_cast<std::uint64_t>(A.get_matrix_size()) * sizeof(DType);
+
+    Entry entry;
+    entry.name = name + ".npy";
+    entry.size = header.size() + bytes;
+    entry.offset = FILE.tellp();
+    entry.crc = detail::crc32(0, reinterpret_cast<const unsigned char*>(header.data()), header.size());
+    entry.crc = detail::crc32(entry.crc, data, bytes);
+
+    const bool zip64 = entry.size >= detail::ZIP32_LIMIT;
+
+    std::string local;
+    detail::put_le(local, detail::ZIP_LOCAL_HEADER, 4);
+    detail::put_le(local, zip64 ? 45 : 20, 2);   // the version needed
+    detail::put_le(local, 0, 2);                  // the flags
+    detail::put_le(local, 0, 2);                  // stored, no compression
+    detail::put_le(local, 0, 2);
+    detail::put_le(local, detail::ZIP_DATE, 2);
+    detail::put_le(local, entry.crc, 4);
+    detail::put_le(local, zip64 ? detail::ZIP32_LIMIT : entry.size, 4);
+    detail::put_le(local, zip64 ? detail::ZIP32_LIMIT : entry.size, 4);
+    detail::put_le(local, entry.name.size(), 2);
+    detail::put_le(local, zip64 ? 20 : 0, 2);
+    local += entry.name;
+
+    if (zip64) {
+        detail::put_le(local, 1, 2);
+        detail::put_le(local, 16, 2);
+        detail::put_le(local, entry.size, 8);
+        detail::put_le(local, entry.size, 8);
+    }
+
+    FILE.write(local.data(), local.size());
+    FILE.write(header.data(), header.size());
+    FILE.write(reinterpret_cast<const char*>(data), bytes);
+
+    if (!FILE)
+        throw SerializationError();
+
+    ENTRIES.push_back(entry);
+}
+
+/*
+ * The function that writes the central directory and closes the file
+ *
+ * It is called by the destructor if it was not called, but the errors are
+ * only reported by the explicit call.
+ *
+ * @retval None
+ */
+inline void ArchiveWriter::close() {
+    if (CLOSED)
+        return;
+
+    CLOSED = true;
+
+    const std::uint64_t directory_offset = FILE.tellp();
+    std::string directory;
+
+    for (const Entry& entry : ENTRIES) {
+        const bool large_size = entry.size >= detail::ZIP32_LIMIT;
+        const bool large_offset = entry.offset >= detail::ZIP32_LIMIT;
+
+        std::string extra;
+        if (large_size) {
+            detail::put_le(extra, entry.size, 8);
+            detail::put_le(extra, entry.size, 8);
+        }
+        if (large_offset)
+            detail::put_le(extra, entry.offset, 8);
+        if (!extra.empty()) {
+            std::string field;
+            detail::put_le(field, 1, 2);
+            detail::put_le(field, extra.size(), 2);
+            extra = field + extra;
+        }
+
+        detail::put_le(directory, detail::ZIP_CENTRAL_HEADER, 4);
+        detail::put_le(directory, 45, 2);   // the version made by
+        detail::put_le(directory, extra.empty() ? 20 : 45, 2);
+        detail::put_le(directory, 0, 2);
+        detail::put_le(directory, 0, 2);
+        detail::put_le(directory, 0, 2);
+        detail::put_le(directory, detail::ZIP_DATE, 2);
+        detail::put_le(directory, entry.crc, 4);
+        detail::put_le(directory, large_size ? detail::ZIP32_LIMIT : entry.size, 4);
+        detail::put_le(directory, large_size ? detail::ZIP32_LIMIT : entry.size, 4);
+        detail::put_le(directory, entry.name.size(), 2);
+        detail::put_le(directory, extra.size(), 2);
+        detail::put_le(directory, 0, 2);    // the comment
+        detail::put_le(directory, 0, 2);    // the disk
+        detail::put_le(directory, 0, 2);    // the internal attributes
+        detail::put_le(directory, 0, 4);    // the external attributes
+        detail::put_le(directory, large_offset ? detail::ZIP32_LIMIT : entry.offset, 4);
+        directory += entry.name + extra;
+    }
+
+    const std::uint64_t directory_size = directory.size();
+    const std::uint64_t count = ENTRIES.size();
+    const bool zip64 = count >= 0xffff || directory_offset >= detail::ZIP32_LIMIT ||
+                       directory_size >= detail::ZIP32_LIMIT;
+
+    std::string end;
+
+    if (zip64) {
+        const std::uint64_t record_offset = directory_offset + directory_size;
+
+        detail::put_le(end, detail::ZIP64_END_RECORD, 4);
+        detail::put_le(end, 44, 8);         // the size of the rest of the record
+        detail::put_le(end, 45, 2);
+        detail::put_le(end, 45, 2);
+        detail::put_le(end, 0, 4);
+        detail::put_le(end, 0, 4);
+        detail::put_le(end, count, 8);
+        detail::put_le(end, count, 8);
+        detail::put_le(end, directory_size, 8);
+        detail::put_le(end, directory_offset, 8);
+
+        detail::put_le(end, detail::ZIP64_END_LOCATOR, 4);
+        detail::put_le(end, 0, 4);
+        detail::put_le(end, record_offset, 8);
+        detail::put_le(end, 1, 4);
+    }
+
+    detail::put_le(end, detail::ZIP_END_RECORD, 4);
+    detail::put_le(end, 0, 2);
+    detail::put_le(end, 0, 2);
+    detail::put_le(end, zip64 ? 0xffff : count, 2);
+    detail::put_le(end, zip64 ? 0xffff : count, 2);
+    detail::put_le(end, zip64 ? detail::ZIP32_LIMIT : directory_size, 4);
+    detail::put_le(end, zip64 ? detail::ZIP32_LIMIT : directory_offset, 4);
+    detail::put_le(end, 0, 2);
+
+    FILE.write(directory.data(), directory.size());
+    FILE.write(end.data(), end.size());
+    FILE.close();
+
+    if (!FILE)
+        throw SerializationError();
+}
+
+/*
+ * The constructor that opens the archive and reads its central directory
+ *
+ * Matrix::ArchiveReader archive("model.npz");
+ * Matrix::Matrix<float> W1 = archive.get<float>("W1");
+ *
+ * @param path the path of the archive
+ * @throw SerializationError if the file is not a zip archive or it is compressed
+ */
+inline ArchiveReader::ArchiveReader(const std::string& path)
+: FILE(path, std::ios::binary)
+{
+    if (!FILE)
+        throw SerializationError();
+
+    // the end record is in the last 22 bytes, after the comment of at most 65535 bytes
+    FILE.seekg(0, std::ios::end);
+    const std::uint64_t file_size = FILE.tellg();
+    const std::uint64_t tail_size = std::min<std::uint64_t>(file_size, 22 + 65535);
+
+    std::vector<unsigned char> tail(tail_size);
+    FILE.seekg(file_size - tail_size);
+    if (tail_size < 22 || !FILE.read(reinterpret_cast<char*>(tail.data()), tail_size))
+        throw SerializationError();
+
+    long end = tail_size - 22;
+    while (end >= 0 && detail::get_le(&tail[end], 4) != detail::ZIP_END_RECORD)
+        end--;
+    if (end < 0)
+        throw SerializationError();
+
+    std::uint64_t count = detail::get_le(&tail[end + 10], 2);
+    std::uint64_t directory_size = detail::get_le(&tail[end + 12], 4);
+    std::uint64_t directory_offset = detail::get_le(&tail[end + 16], 4);
+
+    // the zip64 end record, found through its locator right before the end record
+    if (count == 0xffff || directory_size == detail::ZIP32_LIMIT || directory_offset == detail::ZIP32_LIMIT) {
+        unsigned char locator[20], record[56];
+
+        FILE.seekg(file_size - tail_size + end - 20);
+        if (!FILE.read(reinterpret_cast<char*>(locator), 20) ||
+            detail::get_le(locator, 4) != detail::ZIP64_END_LOCATOR)
+            throw SerializationError();
+
+        FILE.seekg(detail::get_le(locator + 8, 8));
+        if (!FILE.read(reinterpret_cast<char*>(record), 56) ||
+            detail::get_le(record, 4) != detail::ZIP64_END_RECORD)
+            throw SerializationError();
+
+        count = detail::get_le(record + 32, 8);
+        directory_size = detail::get_le(record + 40, 8);
+        directory_offset = detail::get_le(record + 48, 8);
+    }
+
+    std::vector<unsigned char> directory(directory_size);
+    FILE.seekg(directory_offset);
+    if (!FILE.read(reinterpret_cast<char*>(directory.data()), directory_size))
+        throw SerializationError();
+
+    std::size_t at = 0;
+    for (std::uint64_t e = 0; e < count; e++) {
+        if (at + 46 > directory.size() || detail::get_le(&directory[at], 4) != detail::ZIP_CENTRAL_HEADER)
+            throw SerializationError();
+
+        const unsigned char* header = &directory[at];
+        const std::size_t name_length = detail::get_le(header + 28, 2);
+        const std::size_t extra_length = detail::get_le(header + 30, 2);
+        const std::size_t comment_length = detail::get_le(header + 32, 2);
+
+        if (detail::get_le(header + 10, 2) != 0 || at + 46 + name_length + extra_length > directory.size())
+            throw SerializationError();
+
+        Entry entry;
+        entry.name = std::string(reinterpret_cast<const char*>(header + 46), name_length);
+        std::uint64_t compressed = detail::get_le(header + 20, 4);
+        entry.size = detail::get_le(header + 24, 4);
+        entry.offset = detail::get_le(header + 42, 4);
+
+        // the zip64 field has the 8 byte values of the fields that don't fit, in this order
+        const unsigned char* extra = header + 46 + name_length;
+        for (std::size_t x = 0; x + 4 <= extra_length; ) {
+            const std::size_t id = detail::get_le(extra + x, 2);
+            const std::size_t length = detail::get_le(extra + x + 2, 2);
+            const unsigned char* field = extra + x + 4;
+
+            if (id == 1) {
+                if (entry.size == detail::ZIP32_LIMIT)
+                    entry.size = detail::get_le(field, 8), field += 8;
+                if (compressed == detail::ZIP32_LIMIT)
+                    compressed = detail::get_le(field, 8), field += 8;
+                if (entry.offset == detail::ZIP32_LIMIT)
+                    entry.offset = detail::get_le(field, 8);
+            }
+
+            x += 4 + length;
+        }
+
+        if (entry.name.size() > 4 && entry.name.compare(entry.name.size() - 4, 4, ".npy") == 0)
+            entry.name.resize(entry.name.size() - 4);
+
+        ENTRIES.push_back(entry);
+        at += 46 + name_length + extra_length + comment_length;
+    }
+}
+
+// the names of the matrices in the order of the archive, without .npy
+inline std::vector<std::string> ArchiveReader::names() const {
+    std::vector<std::string> RESULT;
+    for (const Entry& entry : ENTRIES)
+        RESULT.push_back(entry.name);
+    return RESULT;
+}
+
+inline bool ArchiveReader::contains(const std::string& name) const {
+    for (const Entry& entry : ENTRIES)
+        if (entry.name == name)
+            return true;
+    return false;
+}
+
+/*
+ * The function that reads the matrix from the archive
+ *
+ * @param name the name of the matrix without .npy
+ * @retval the matrix, read with one bulk read like in load
+ * @throw SerializationError if there is no such matrix or it is not a .npy file of DType
+ */
+template <typename DType>
+Matrix<DType> ArchiveReader::get(const std::string& name) {
+    for (const Entry& entry : ENTRIES) {
+        if (entry.name != name)
+            continue;
+
+        unsigned char local[30];
+        FILE.clear();
+        FILE.seekg(entry.offset);
+        if (!FILE.read(reinterpret_cast<char*>(local), 30) ||
+            detail::get_le(local, 4) != detail::ZIP_LOCAL_HEADER)
+            throw SerializationError();
+
+        FILE.seekg(entry.offset + 30 + detail::get_le(local + 26, 2) + detail::get_le(local + 28, 2));
+        return load<DType>(FILE);
+    }
+
+    throw SerializationError();
+}
+
+} // end of namespace
+
+#endif // end of _NPY_CPP_
@@ -0,0 +1,114 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#ifndef _NPY_H_
+#define _NPY_H_
+
+#include <cstdint>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "matrix.h"
+
+namespace Matrix {
+
+template <typename DType>
+void save(std::ostream&, const Matrix<DType>&);
+
+template <typename DType>
+void save(const std::string&, const Matrix<DType>&);
+
+template <typename DType>
+Matrix<DType> load(std::istream&);
+
+template <typename DType>
+Matrix<DType> load(const std::string&);
+
+/*
+ * The writer of the archive of named matrices, the .npz format of numpy.
+ *
+ * The archive is a zip file with one .npy file for every matrix. The files
+ * are stored without the compression, so the matrices are read back with one
+ * bulk read each. The zip64 extensions are used for the files and the
+ * archives larger than 4 GB.
+ */
+class ArchiveWriter {
+public:
+
+    explicit ArchiveWriter(const std::string&);
+    ~ArchiveWriter();
+
+    template <typename DType>
+    void add(const std::string&, const Matrix<DType>&);
+
+    void close();
+
+private:
+    struct Entry {
+        std::string name;
+        std::uint32_t crc;
+        std::uint64_t size;
+        std::uint64_t offset;
+    };
+
+    std::ofstream FILE;
+    std::vector<Entry> ENTRIES;
+    bool CLOSED;
+};
+
+/*
+ * The reader of the archives written by ArchiveWriter or numpy.savez.
+ *
+ * The central directory of the archive is read when it is opened, every
+ * matrix is read when it is asked for. The compressed archives of
+ * numpy.savez_compressed are not supported.
+ */
+class ArchiveReader {
+public:
+
+    explicit ArchiveReader(const std::string&);
+
+    std::vector<std::string> names() const;
+    bool contains(const std::string&) const;
+
+    template <typename DType>
+    Matrix<DType> get(const std::string&);
+
+private:
+    struct Entry {
+        std::string name;
+        std::uint64_t size;
+        std::uint64_t offset;
+    };
+
+    std::ifstream FILE;
+    std::vector<Entry> ENTRIES;
+};
+
+} // end of namespace
+
+#include "npy.cpp"
+#endif // end of _NPY_H_
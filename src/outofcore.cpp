@@ -0,0 +1,588 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#ifndef _OUTOFCORE_CPP_
+#define _OUTOFCORE_CPP_
+
+#include "matrix.h"
+#include "outofcore.h"
+#include "npy.h"
+#include "mapped.h"
+#include "reductions.h"
+#include "errors.h"
+
+#include <algorithm>   // for std::min
+#include <cerrno>      // for errno
+#include <cmath>       // for std::sqrt
+#include <fstream>     // for std::ifstream
+#include <future>      // for std::async
+#include <limits>      // for std::numeric_limits
+#include <memory>      // for std::unique_ptr
+#include <fcntl.h>     // for open
+#include <sys/stat.h>  // for fstat
+#include <unistd.h>    // for pread, pwrite, ftruncate, close
+
+namespace Matrix {
+
+namespace detail {
+
+inline std::size_t& memory_budget() {
+    static std::size_t budget = std::size_t(1) << 30;
+    return budget;
+}
+
+// pread and pwrite until all bytes are done, they may stop early
+inline void pread_all(const int fd, char* buffer, std::size_t bytes, off_t offset) {
+    while (bytes > 0) {
+        const ssize_t done = pread(fd, buffer, bytes, offset);
+        if (done < 0 && errno == EINTR)
+            continue;
+        if (done <= 0)
+            throw SerializationError();
+
+        buffer += done;
+        bytes -= done;
+        offset += done;
+    }
+}
+
+inline void pwrite_all(const int fd, const char* buffer, std::size_t bytes, off_t offset) {
+    while (bytes > 0) {
+        const ssize_t done = pwrite(fd, buffer, bytes, offset);
+        if (done < 0 && errno == EINTR)
+            continue;
+        if (done <= 0)
+            throw SerializationError();
+
+        buffer += done;
+        bytes -= done;
+        offset += done;
+    }
+}
+
+/*
+ * The tiles of the out-of-core dot, rows x depth of A, depth x cols of B and
+ * rows x cols of C, so that two of each fit into the budget of elements: one
+ * is computed while the next one is read or the last one is written. The
+ * tiles are as square as the budget allows, every element of A is read
+ * N / cols times and every element of B is read M / rows times.
+ */
+inline void out_of_core_tiles(const long M, const long N, const long K, const long budget,
+                              long& rows, long& cols, long& depth) {
+    assert(budget >= 6 && "The memory budget is too small for the tiles!");
+
+    depth = std::min(K, std::max(1L, static_cast<long>(std::sqrt(budget / 6.0))));
+
+    // 2 * s * s + 4 * depth * s <= budget for the square rows = cols = s
+    const double d = depth;
+    const long side = std::max(1L, static_cast<long>((std::sqrt(16 * d * d + 8.0 * budget) - 4 * d) / 4));
+
+    rows = std::min(M, side);
+    cols = std::min(N, std::max(1L, (budget - 2 * rows * depth) / (2 * (depth + rows))));
+    rows = std::min(M, std::max(1L, (budget - 2 * depth * cols) / (2 * (depth + cols))));
+}
+
+/*
+ * Calls f(chunk, first) for the chunks of the rows of A seen as the matrix
+ * (rows, cols), where chunk is the matrix of the rows from first on that is
+ * only valid during the call. Two chunks fit into the memory budget, the
+ * next one is read on the reader thread while f runs.
+ */
+template <typename DType, typename F>
+void stream_rows(const FileMatrix<DType>& A, const long rows, const long cols, F f) {
+    const long budget = get_memory_budget() / (2 * sizeof(DType));
+
+    assert(cols <= budget && "The memory budget is too small for a row of the matrix!");
+
+    const long chunk = std::min(std::min(rows, budget / cols), std::numeric_limits<int>::max() / cols);
+    std::unique_ptr<DType[]> buffers[2] = {
+        std::unique_ptr<DType[]>(new DType[chunk * cols]),
+        std::unique_ptr<DType[]>(new DType[chunk * cols])
+    };
+
+    auto load = [&A, &buffers, rows, cols, chunk](const long first, const int slot) {
+        return std::async(std::launch::async, [&A, &buffers, rows, cols, chunk, first, slot] {
+            A.read(first * cols, std::min(chunk, rows - first) * cols, buffers[slot].get());
+        });
+    };
+
+    std::future<void> pending = load(0, 0);
+    int slot = 0;
+
+    for (long first = 0; first < rows; first += chunk, slot ^= 1) {
+        pending.get();
+        if (first + chunk < rows)
+            pending = load(first + chunk, slot ^ 1);
+
+        const int count = std::min(chunk, rows - first);
+        const Matrix<DType> view = borrow<DType>(buffers[slot].get(), {count, static_cast<int>(cols)});
+        f(view, first);
+    }
+}
+
+// pick(...) over all elements of A, where reduce gives the result of a chunk
+template <typename DType, typename Reduce, typename Pick>
+DType stream_reduce(const FileMatrix<DType>& A, Reduce reduce, Pick pick) {
+    std::vector<DType> partial;
+
+    stream_rows(A, A.get_matrix_size(), 1, [&](const Matrix<DType>& chunk, long) {
+        partial.push_back(reduce(chunk));
+    });
+
+    return lanes_reduce(partial.data(), partial.size(), Identity<DType>(), pick);
+}
+
+/*
+ * The reduction of the 2-dimensional A along the axis. The chunks of rows
+ * are reduced by reduce(chunk, axis); along the axis 0 the results of the
+ * chunks are combined elementwise by pick, along the axis 1 they are the
+ * rows of the result.
+ */
+template <typename DType, typename Reduce, typename Pick>
+Matrix<DType> stream_reduce_axis(const FileMatrix<DType>& A, int axis, const bool keepdims,
+                                 Reduce reduce, Pick pick) {
+    auto shape = A.get_shape();
+
+    assert(shape.size() == 2 &&
+        "The out-of-core reductions along an axis are for the 2-dimensional matrices!");
+
+    if (axis < 0)
+        axis += 2;
+
+    assert((axis == 0 || axis == 1) && "The axis is out of range!");
+
+    Matrix<DType> RESULT = matrix_with_shape<DType>({shape[1 - axis]});
+    DType* r = RESULT.data();
+
+    stream_rows(A, shape[0], shape[1], [&](const Matrix<DType>& chunk, long first) {
+        Matrix<DType> part = reduce(chunk, axis);
+        const DType* p = part.data();
+
+        if (axis == 1) {
+            std::copy(p, p + part.get_matrix_size(), r + first);
+        } else if (first == 0) {
+            std::copy(p, p + part.get_matrix_size(), r);
+        } else {
+            for (int i = 0; i < shape[1]; i++)
+                r[i] = pick(r[i], p[i]);
+        }
+    });
+
+    if (keepdims)
+        reshape(RESULT, (axis == 0) ? std::vector<int>{1, shape[1]} : std::vector<int>{shape[0], 1});
+
+    return RESULT;
+}
+
+template <typename DType>
+struct Plus {
+    DType operator()(const DType x, const DType y) const { return x + y; }
+};
+
+} // end of namespace detail
+
+/*
+ * The constructor that opens the .npy file as the matrix in the file
+ *
+ * Matrix::FileMatrix<float> A("activations.npy");
+ *
+ * @param path the path of the .npy file
+ * @param writable opens the file for write and write_tile if it is true
+ * @throw SerializationError if the file is not a .npy file of DType in the C order and the byte order of the host
+ */
+template <typename DType>
+FileMatrix<DType>::FileMatrix(const std::string& path, const bool writable)
+: OFFSET(0), FD(-1)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        throw SerializationError();
+
+    detail::NpyHeader header = detail::read_npy_header(in);
+    OFFSET = in.tellg();
+    in.close();
+
+    if (!detail::is_native_npy<DType>(header))
+        throw SerializationError();
+
+    SHAPE = header.shape.empty() ? std::vector<int>{1} : header.shape;
+
+    FD = open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+    if (FD < 0)
+        throw SerializationError();
+
+    struct stat status;
+    if (fstat(FD, &status) != 0 || status.st_size < OFFSET + get_matrix_size() * static_cast<long>(sizeof(DType))) {
+        close(FD);
+        throw SerializationError();
+    }
+}
+
+/*
+ * The constructor that creates the .npy file of the matrix with the shape
+ *
+ * The header is padded to the page size like in save_mappable; the elements
+ * are not written, they are zeros until they are written by write or
+ * write_tile, and the file system does not store them until then.
+ *
+ * Matrix::FileMatrix<float> C("product.npy", {100000, 100000});
+ *
+ * @param path the path of the .npy file, it is overwritten
+ * @param shape the shape of the matrix
+ */
+template <typename DType>
+FileMatrix<DType>::FileMatrix(const std::string& path, const std::vector<int>& shape)
+: SHAPE(shape), OFFSET(0), FD(-1)
+{
+    for (auto dim : SHAPE)
+        assert(dim > 0 &&
+            "The dimensions of matrix cannot nonpozitive");
+
+    const std::string header = detail::npy_header<DType>(SHAPE, detail::page_size());
+    OFFSET = header.size();
+
+    FD = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (FD < 0)
+        throw SerializationError();
+
+    try {
+        detail::pwrite_all(FD, header.data(), header.size(), 0);
+        if (ftruncate(FD, OFFSET + get_matrix_size() * static_cast<long>(sizeof(DType))) != 0)
+            throw SerializationError();
+    } catch (...) {
+        close(FD);
+        throw;
+    }
+}
+
+template <typename DType>
+FileMatrix<DType>::~FileMatrix() {
+    if (FD >= 0)
+        close(FD);
+}
+
+template <typename DType>
+std::vector<int> FileMatrix<DType>::get_shape() const {
+    return SHAPE;
+}
+
+// the number of the elements, it can be larger than the size of any Matrix
+template <typename DType>
+long FileMatrix<DType>::get_matrix_size() const {
+    long size = 1;
+    for (auto dim : SHAPE)
+        size *= dim;
+    return size;
+}
+
+/*
+ * The methods that read and write the elements from the flat index first on
+ *
+ * @param first the flat index of the first element in the row-major order
+ * @param count the number of the elements
+ * @param out, in the buffer of count elements
+ * @throw SerializationError if the file could not be read or written
+ */
+template <typename DType>
+void FileMatrix<DType>::read(const long first, const long count, DType* out) const {
+    assert(first >= 0 && first + count <= get_matrix_size() && "Out of bounds!");
+
+    detail::pread_all(FD, reinterpret_cast<char*>(out), count * sizeof(DType), OFFSET + first * sizeof(DType));
+}
+
+template <typename DType>
+void FileMatrix<DType>::write(const long first, const long count, const DType* in) {
+    assert(first >= 0 && first + count <= get_matrix_size() && "Out of bounds!");
+
+    detail::pwrite_all(FD, reinterpret_cast<const char*>(in), count * sizeof(DType), OFFSET + first * sizeof(DType));
+}
+
+/*
+ * The methods that read and write the tile of the matrix seen as
+ * (shape[0], the product of the other dimensions)
+ *
+ * The tile is the rows from row on and the columns from column on, it is
+ * stored in the buffer in the row-major order without the gaps.
+ *
+ * std::vector<float> tile(64 * 32);
+ * A.read_tile(128, 64, 0, 32, tile.data());   // A[128:192, 0:32]
+ *
+ * @param row the first row of the tile
+ * @param rows the number of the rows of the tile
+ * @param column the first column of the tile
+ * @param columns the number of the columns of the tile
+ * @param out, in the buffer of rows * columns elements
+ * @throw SerializationError if the file could not be read or written
+ */
+template <typename DType>
+void FileMatrix<DType>::read_tile(const long row, const long rows, const long column, const long columns,
+                                  DType* out) const {
+    const long width = get_matrix_size() / SHAPE[0];
+
+    assert(row >= 0 && row + rows <= SHAPE[0] && column >= 0 && column + columns <= width &&
+        "Out of bounds!");
+
+    if (columns == width)
+        return read(row * width, rows * width, out);
+
+    for (long i = 0; i < rows; i++)
+        read((row + i) * width + column, columns, out + i * columns);
+}
+
+template <typename DType>
+void FileMatrix<DType>::write_tile(const long row, const long rows, const long column, const long columns,
+                                   const DType* in) {
+    const long width = get_matrix_size() / SHAPE[0];
+
+    assert(row >= 0 && row + rows <= SHAPE[0] && column >= 0 && column + columns <= width &&
+        "Out of bounds!");
+
+    if (columns == width)
+        return write(row * width, rows * width, in);
+
+    for (long i = 0; i < rows; i++)
+        write((row + i) * width + column, columns, in + i * columns);
+}
+
+/*
+ * The functions that set and return the memory budget of the out-of-core
+ * operations in bytes, 1 GB by default
+ *
+ * The buffers of the tiles of one operation fit into the budget, the
+ * matrices in the files can be any times larger than it.
+ *
+ * Matrix::set_memory_budget(std::size_t(4) << 30);
+ *
+ * @param bytes the budget in bytes
+ * @retval None
+ */
+inline void set_memory_budget(const std::size_t bytes) {
+    detail::memory_budget() = bytes;
+}
+
+inline std::size_t get_memory_budget() {
+    return detail::memory_budget();
+}
+
+/*
+ * The function that multiplies the matrices in the files, C = A . B
+ *
+ * A, B and C are read and written in tiles that fit into the memory budget
+ * (see detail::out_of_core_tiles). The tiles of the next step are read on
+ * a reader thread and the finished tiles of C are written on a writer
+ * thread while the current tiles are multiplied by the in-memory gemm, so
+ * the disk and the cores work at the same time. The tile of A is not read
+ * again while it stays the same.
+ *
+ * Matrix::set_memory_budget(std::size_t(8) << 30);
+ * Matrix::FileMatrix<float> A("A.npy"), B("B.npy");
+ * Matrix::FileMatrix<float> C("C.npy", {A.get_shape()[0], B.get_shape()[1]});
+ * Matrix::dot(A, B, C);
+ *
+ * @param A the (M, K) matrix
+ * @param B the (K, N) matrix
+ * @param C the (M, N) matrix that is overwritten by the product
+ * @retval None
+ * @throw SerializationError if the files could not be read or written
+ */
+template <typename DType>
+void dot(const FileMatrix<DType>& A, const FileMatrix<DType>& B, FileMatrix<DType>& C) {
+    detail::TraceSpan trace("dot (out of core)", A, B);
+
+    auto a_shape = A.get_shape();
+    auto b_shape = B.get_shape();
+    auto c_shape = C.get_shape();
+
+    assert(a_shape.size() == 2 && b_shape.size() == 2 && c_shape.size() == 2 &&
+        "The out-of-core dot is for the 2-dimensional matrices!");
+    assert(a_shape[1] == b_shape[0] && c_shape[0] == a_shape[0] && c_shape[1] == b_shape[1] &&
+        "The shapes of the matrices do not match!");
+
+    const long M = a_shape[0], N = b_shape[1], K = a_shape[1];
+    trace.set_flops(2.0 * M * N * K);
+
+    long rows, cols, depth;
+    detail::out_of_core_tiles(M, N, K, get_memory_budget() / sizeof(DType), rows, cols, depth);
+
+    struct Step { long i, j, p; };
+    std::vector<Step> steps;
+    for (long i = 0; i < M; i += rows)
+        for (long j = 0; j < N; j += cols)
+            for (long p = 0; p < K; p += depth)
+                steps.push_back({i, j, p});
+
+    std::unique_ptr<DType[]> a[2], b[2], c[2];
+    for (int s = 0; s < 2; s++) {
+        a[s].reset(new DType[rows * depth]);
+        b[s].reset(new DType[depth * cols]);
+        c[s].reset(new DType[rows * cols]);
+    }
+
+    auto load = [&](const Step step, const int sa, const int sb, const bool read_a, const bool read_b) {
+        return std::async(std::launch::async, [&, step, sa, sb, read_a, read_b] {
+            if (read_a)
+                A.read_tile(step.i, std::min(rows, M - step.i), step.p, std::min(depth, K - step.p), a[sa].get());
+            if (read_b)
+                B.read_tile(step.p, std::min(depth, K - step.p), step.j, std::min(cols, N - step.j), b[sb].get());
+        });
+    };
+
+    std::future<void> pending = load(steps[0], 0, 0, true, true);
+    std::future<void> stored[2];
+    int ca = 0, cb = 0, cc = 0;
+
+    for (std::size_t s = 0; s < steps.size(); s++) {
+        const Step step = steps[s];
+        pending.get();
+
+        // the next tiles are read into the other buffers unless they are the current ones
+        int na = ca, nb = cb;
+        if (s + 1 < steps.size()) {
+            const Step next = steps[s + 1];
+            if (next.i != step.i || next.p != step.p)
+                na = 1 - ca;
+            if (next.p != step.p || next.j != step.j)
+                nb = 1 - cb;
+            pending = load(next, na, nb, na != ca, nb != cb);
+        }
+
+        const int m = std::min(rows, M - step.i);
+        const int n = std::min(cols, N - step.j);
+        const int k = std::min(depth, K - step.p);
+
+        // the buffer of C is free when its last tile is written
+        if (step.p == 0 && stored[cc].valid())
+            stored[cc].get();
+
+        detail::gemm_blocked<DType, DType>(m, n, k, DType(1), a[ca].get(), k, false, b[cb].get(), n, false,
+                                           DType(step.p == 0 ? 0 : 1), c[cc].get(), n);
+
+        if (step.p + depth >= K) {
+            const int slot = cc;
+            stored[slot] = std::async(std::launch::async, [&C, &c, step, m, n, slot] {
+                C.write_tile(step.i, m, step.j, n, c[slot].get());
+            });
+            cc = 1 - cc;
+        }
+
+        ca = na;
+        cb = nb;
+    }
+
+    for (auto& store : stored)
+        if (store.valid())
+            store.get();
+}
+
+/*
+ * The out-of-core reductions of the matrices in the files
+ *
+ * They work like the reductions of the matrices in the memory, the chunks of
+ * rows that fit into the memory budget are reduced while the next one is read.
+ * The reductions along an axis are for the 2-dimensional matrices; two rows
+ * must fit into the budget.
+ *
+ * Matrix::FileMatrix<double> A("samples.npy");
+ * double total = Matrix::sum(A);
+ * Matrix::Matrix<double> means = Matrix::mean(A, 0);
+ *
+ * @param A the matrix in the file
+ * @param axis the axis that is reduced
+ * @param keepdims keeps the axis with the size 1 if it is true
+ * @retval the reduction of all elements or the reductions along the axis
+ * @throw SerializationError if the file could not be read
+ */
+template <typename DType>
+DType sum(const FileMatrix<DType>& A) {
+    detail::TraceSpan trace("sum (out of core)", A);
+
+    std::vector<DType> partial;
+
+    detail::stream_rows(A, A.get_matrix_size(), 1, [&](const Matrix<DType>& chunk, long) {
+        partial.push_back(sum(chunk));
+    });
+
+    return detail::pairwise_sum(partial.data(), partial.size(), detail::Identity<DType>());
+}
+
+template <typename DType>
+Matrix<DType> sum(const FileMatrix<DType>& A, const int axis, const bool keepdims) {
+    detail::TraceSpan trace("sum (out of core)", A);
+
+    return detail::stream_reduce_axis(A, axis, keepdims,
+        [](const Matrix<DType>& chunk, int along) { return sum(chunk, along); }, detail::Plus<DType>());
+}
+
+template <typename DType>
+DType mean(const FileMatrix<DType>& A) {
+    detail::TraceSpan trace("mean (out of core)", A);
+
+    return sum(A) / static_cast<DType>(A.get_matrix_size());
+}
+
+template <typename DType>
+Matrix<DType> mean(const FileMatrix<DType>& A, const int axis, const bool keepdims) {
+    detail::TraceSpan trace("mean (out of core)", A);
+
+    Matrix<DType> RESULT = sum(A, axis, keepdims);
+    RESULT /= static_cast<DType>(A.get_shape()[(axis < 0) ? axis + 2 : axis]);
+
+    return RESULT;
+}
+
+template <typename DType>
+DType min(const FileMatrix<DType>& A) {
+    detail::TraceSpan trace("min (out of core)", A);
+
+    return detail::stream_reduce(A, [](const Matrix<DType>& chunk) { return min(chunk); },
+                                 detail::Smaller<DType>());
+}
+
+template <typename DType>
+Matrix<DType> min(const FileMatrix<DType>& A, const int axis, const bool keepdims) {
+    detail::TraceSpan trace("min (out of core)", A);
+
+    return detail::stream_reduce_axis(A, axis, keepdims,
+        [](const Matrix<DType>& chunk, int along) { return min(chunk, along); }, detail::Smaller<DType>());
+}
+
+template <typename DType>
+DType max(const FileMatrix<DType>& A) {
+    detail::TraceSpan trace("max (out of core)", A);
+
+    return detail::stream_reduce(A, [](const Matrix<DType>& chunk) { return max(chunk); },
+                                 detail::Larger<DType>());
+}
+
+template <typename DType>
+Matrix<DType> max(const FileMatrix<DType>& A, const int axis, const bool keepdims) {
+    detail::TraceSpan trace("max (out of core)", A);
+
+    return detail::stream_reduce_axis(A, axis, keepdims,
+        [](const Matrix<DType>& chunk, int along) { return max(chunk, along); }, detail::Larger<DType>());
+}
+
+} // end of namespace
+
+#endif // end of _OUTOFCORE_CPP_
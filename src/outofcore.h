@@ -0,0 +1,103 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#ifndef _OUTOFCORE_H_
+#define _OUTOFCORE_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "matrix.h"
+
+namespace Matrix {
+
+/*
+ * The matrix that stays in the .npy file, for the matrices larger than the memory.
+ *
+ * Its elements are never in the memory all at once: the out-of-core dot and
+ * reductions read it in tiles that fit into the memory budget (see
+ * set_memory_budget), and read the next tile on a reader thread while the
+ * current one is computed. The elements must be in the C order and in the
+ * byte order of the host, like in the files of save and save_mappable.
+ */
+template <typename DType>
+class FileMatrix {
+public:
+
+    explicit FileMatrix(const std::string&, const bool = false);
+    FileMatrix(const std::string&, const std::vector<int>&);
+    ~FileMatrix();
+
+    FileMatrix(const FileMatrix&) = delete;
+    FileMatrix& operator=(const FileMatrix&) = delete;
+
+    std::vector<int> get_shape() const;
+    long get_matrix_size() const;
+
+    void read(const long, const long, DType*) const;
+    void write(const long, const long, const DType*);
+
+    void read_tile(const long, const long, const long, const long, DType*) const;
+    void write_tile(const long, const long, const long, const long, const DType*);
+
+private:
+    std::vector<int> SHAPE;
+    long OFFSET;
+    int FD;
+};
+
+void set_memory_budget(const std::size_t);
+std::size_t get_memory_budget();
+
+template <typename DType>
+void dot(const FileMatrix<DType>&, const FileMatrix<DType>&, FileMatrix<DType>&);
+
+template <typename DType>
+DType sum(const FileMatrix<DType>&);
+
+template <typename DType>
+Matrix<DType> sum(const FileMatrix<DType>&, const int, const bool = false);
+
+template <typename DType>
+DType mean(const FileMatrix<DType>&);
+
+template <typename DType>
+Matrix<DType> mean(const FileMatrix<DType>&, const int, const bool = false);
+
+template <typename DType>
+DType min(const FileMatrix<DType>&);
+
+template <typename DType>
+Matrix<DType> min(const FileMatrix<DType>&, const int, const bool = false);
+
+template <typename DType>
+DType max(const FileMatrix<DType>&);
+
+template <typename DType>
+Matrix<DType> max(const FileMatrix<DType>&, const int, const bool = false);
+
+} // end of namespace
+
+#include "outofcore.cpp"
+#endif // end of _OUTOFCORE_H_
@@ -0,0 +1,419 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#ifndef _PACKED_CPP_
+#define _PACKED_CPP_
+
+#include "matrix.h"
+#include "packed.h"
+#include "errors.h"
+
+#include <cstdint>   // for the fixed width fields of the file
+#include <cstring>   // for std::memcmp
+#include <fstream>   // for std::ifstream, std::ofstream
+#include <type_traits>
+#include <assert.h>  // for assert
+
+namespace Matrix {
+
+namespace detail {
+
+// the first bytes of a saved PackedMatrix
+constexpr char PACKED_MAGIC[8] = {'A', 'T', 'R', 'I', 'X', 'P', 'K', '\0'};
+constexpr std::uint32_t PACKED_VERSION = 1;
+
+// the element type in the file: its size, and whether it is a floating point and a signed type
+template <typename DType>
+std::uint32_t packed_type_code() {
+    return sizeof(DType) | (std::is_floating_point<DType>::value << 8) | (std::is_signed<DType>::value << 9);
+}
+
+// packs the whole op(A) (m x k) like gemm_blocked packs its blocks of rows
+template <typename DType>
+void pack_a_whole(const DType* A, const int lda, const bool transpose, const int m, const int k, DType* packed) {
+    const long m_blocks = (m + GEMM_MC - 1) / GEMM_MC;
+
+    for (int pc = 0; pc < k; pc += GEMM_KC) {
+        int kc = std::min(GEMM_KC, k - pc);
+
+        parallel_for(0, m_blocks, std::max(1L, PARALLEL_MIN_WORK / (GEMM_MC * kc)), [&](long first, long last) {
+            for (long block = first; block < last; block++) {
+                int ic = block * GEMM_MC;
+                pack_a(A, lda, transpose, ic, pc, std::min(GEMM_MC, m - ic), kc,
+                       packed + packed_a_offset(m, pc, ic, kc));
+            }
+        });
+    }
+}
+
+// packs the whole op(B) (k x n) like gemm_blocked packs its panels
+template <typename DType>
+void pack_b_whole(const DType* B, const int ldb, const bool transpose, const int k, const int n, DType* packed) {
+    for (int jc = 0; jc < n; jc += GEMM_NC) {
+        int nc = std::min(GEMM_NC, n - jc);
+        long slivers = (nc + GEMM_NR - 1) / GEMM_NR;
+
+        for (int pc = 0; pc < k; pc += GEMM_KC) {
+            int kc = std::min(GEMM_KC, k - pc);
+            DType* panel = packed + packed_b_offset(k, n, pc, jc);
+
+            parallel_for(0, slivers, std::max(1L, PARALLEL_MIN_WORK / (kc * GEMM_NR)), [&](long first, long last) {
+                pack_b(B, ldb, transpose, pc, jc, kc, nc, panel, first, last);
+            });
+        }
+    }
+}
+
+/*
+ * y = alpha * x op(B) + beta * y for the row vector x and the packed op(B)
+ *
+ * With one row, the register tile of gemm would be mostly padding, so the
+ * slivers of B are streamed once with GEMM_NR accumulators instead. The sums
+ * are added to y block by block of GEMM_KC like in gemm.
+ */
+template <typename DType>
+void gemv_packed_b(const int k, const int n, const DType alpha, const DType* x,
+                   const DType* packed, const DType beta, DType* y) {
+
+    for (int j = 0; j < n; j++)
+        y[j] = (beta == 0) ? DType(0) : beta * y[j];
+
+    if (k == 0 || alpha == 0)
+        return;
+
+    for (int jc = 0; jc < n; jc += GEMM_NC) {
+        int nc = std::min(GEMM_NC, n - jc);
+        long slivers = (nc + GEMM_NR - 1) / GEMM_NR;
+
+        parallel_for(0, slivers, std::max(1L, PARALLEL_MIN_WORK / (static_cast<long>(k) * GEMM_NR)),
+            [&](long first, long last) {
+                for (long s = first; s < last; s++) {
+                    int jr = s * GEMM_NR;
+                    int nr = std::min(GEMM_NR, nc - jr);
+                    DType* c = y + jc + jr;
+
+                    for (int pc = 0; pc < k; pc += GEMM_KC) {
+                        int kc = std::min(GEMM_KC, k - pc);
+                        const DType* b = packed + packed_b_offset(k, n, pc, jc) + s * kc * GEMM_NR;
+                        DType acc[GEMM_NR] = {};
+
+                        for (int p = 0; p < kc; p++)
+                            for (int j = 0; j < GEMM_NR; j++)
+                                acc[j] += x[pc + p] * b[p * GEMM_NR + j];
+
+                        for (int j = 0; j < nr; j++)
+                            c[j] += alpha * acc[j];
+                    }
+                }
+            });
+    }
+}
+
+template <typename T>
+void write_field(std::ostream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+T read_field(std::istream& in) {
+    T value;
+    if (!in.read(reinterpret_cast<char*>(&value), sizeof(T)))
+        throw SerializationError();
+    return value;
+}
+
+} // end of namespace detail
+
+/*
+ * The constructor that packs op(W)
+ *
+ * The packed matrix is the right operand of dot and gemm by default, with
+ * left = true it is the left one. The rows (or the columns) are padded to the
+ * register tile of gemm, so it takes a little more memory than W.
+ *
+ * Matrix::Matrix<float> W(4096, 1024);
+ * Matrix::PackedMatrix<float> PW(W);           // for X W
+ * Matrix::PackedMatrix<float> PWT(W, false, true);   // for X W^T
+ *
+ * Matrix::Matrix<float> Y = Matrix::dot(X, PW);
+ *
+ * @param W the two dimensional matrix
+ * @param left packs op(W) as the left operand if it is true
+ * @param transpose packs W^T instead of W if it is true
+ */
+template <typename DType>
+PackedMatrix<DType>::PackedMatrix(const Matrix<DType>& W, const bool left, const bool transpose)
+: LEFT(left)
+{
+    auto shape = W.get_shape();
+
+    assert((shape.size() == 2) && "The matrix must be two dimensional!");
+
+    const int rows = transpose ? shape[1] : shape[0];
+    const int columns = transpose ? shape[0] : shape[1];
+    SHAPE = {rows, columns};
+
+    if (LEFT) {
+        PACKED.resize(static_cast<long>(rows + detail::GEMM_MR - 1) / detail::GEMM_MR * detail::GEMM_MR * columns);
+        detail::pack_a_whole(W.data(), shape[1], transpose, rows, columns, PACKED.data());
+    } else {
+        PACKED.resize(static_cast<long>(columns + detail::GEMM_NR - 1) / detail::GEMM_NR * detail::GEMM_NR * rows);
+        detail::pack_b_whole(W.data(), shape[1], transpose, rows, columns, PACKED.data());
+    }
+}
+
+// the shape of op(W)
+template <typename DType>
+std::vector<int> PackedMatrix<DType>::get_shape() const {
+    return SHAPE;
+}
+
+template <typename DType>
+bool PackedMatrix<DType>::is_left() const {
+    return LEFT;
+}
+
+// the number of the elements in the packed layout, with the padding
+template <typename DType>
+long PackedMatrix<DType>::get_packed_size() const {
+    return PACKED.size();
+}
+
+template <typename DType>
+const DType* PackedMatrix<DType>::data() const {
+    return PACKED.data();
+}
+
+/*
+ * The function that writes the packed matrix to the binary stream
+ *
+ * The packed layout is written as it is, after a header with the element
+ * type and the blocking of gemm. It is read back by load_packed in the
+ * builds with the same blocking, on the machines with the same byte order.
+ *
+ * Matrix::PackedMatrix<float>(W).save("weights.pk");
+ * auto PW = Matrix::load_packed<float>("weights.pk");
+ *
+ * @param out the stream opened in the binary mode
+ * @retval None
+ */
+template <typename DType>
+void PackedMatrix<DType>::save(std::ostream& out) const {
+    out.write(detail::PACKED_MAGIC, sizeof(detail::PACKED_MAGIC));
+    detail::write_field(out, detail::PACKED_VERSION);
+    detail::write_field(out, detail::packed_type_code<DType>());
+
+    for (std::int32_t block : {detail::GEMM_MR, detail::GEMM_NR, detail::GEMM_MC, detail::GEMM_KC, detail::GEMM_NC})
+        detail::write_field(out, block);
+
+    detail::write_field(out, static_cast<std::int32_t>(SHAPE[0]));
+    detail::write_field(out, static_cast<std::int32_t>(SHAPE[1]));
+    detail::write_field(out, static_cast<std::uint8_t>(LEFT));
+    detail::write_field(out, static_cast<std::uint64_t>(PACKED.size()));
+    out.write(reinterpret_cast<const char*>(PACKED.data()), PACKED.size() * sizeof(DType));
+
+    if (!out)
+        throw SerializationError();
+}
+
+template <typename DType>
+void PackedMatrix<DType>::save(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary);
+    save(out);
+}
+
+/*
+ * The function that reads the packed matrix written by save
+ *
+ * @param in the stream opened in the binary mode
+ * @retval the packed matrix, ready for dot and gemm
+ * @throw SerializationError if the stream ends early, or it has another
+ *        element type or the blocking of another build
+ */
+template <typename DType>
+PackedMatrix<DType> load_packed(std::istream& in) {
+    char magic[sizeof(detail::PACKED_MAGIC)];
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, detail::PACKED_MAGIC, sizeof(magic)) != 0)
+        throw SerializationError();
+
+    if (detail::read_field<std::uint32_t>(in) != detail::PACKED_VERSION ||
+        detail::read_field<std::uint32_t>(in) != detail::packed_type_code<DType>())
+        throw SerializationError();
+
+    for (std::int32_t block : {detail::GEMM_MR, detail::GEMM_NR, detail::GEMM_MC, detail::GEMM_KC, detail::GEMM_NC})
+        if (detail::read_field<std::int32_t>(in) != block)
+            throw SerializationError();
+
+    PackedMatrix<DType> RESULT;
+    const int rows = detail::read_field<std::int32_t>(in);
+    const int columns = detail::read_field<std::int32_t>(in);
+    RESULT.SHAPE = {rows, columns};
+    RESULT.LEFT = detail::read_field<std::uint8_t>(in) != 0;
+
+    const std::uint64_t size = detail::read_field<std::uint64_t>(in);
+    const long padded_rows = (rows + detail::GEMM_MR - 1) / detail::GEMM_MR * detail::GEMM_MR;
+    const long padded_columns = (columns + detail::GEMM_NR - 1) / detail::GEMM_NR * detail::GEMM_NR;
+
+    if (rows < 0 || columns < 0 ||
+        size != static_cast<std::uint64_t>(RESULT.LEFT ? padded_rows * columns : padded_columns * rows))
+        throw SerializationError();
+
+    RESULT.PACKED.resize(size);
+    if (!in.read(reinterpret_cast<char*>(RESULT.PACKED.data()), size * sizeof(DType)))
+        throw SerializationError();
+
+    return RESULT;
+}
+
+template <typename DType>
+PackedMatrix<DType> load_packed(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return load_packed<DType>(in);
+}
+
+/*
+ * The function that does C = alpha * op(A) B + beta * C with the packed B
+ *
+ * It is gemm without the packing of B, see gemm. If op(A) has one row,
+ * the packed B is streamed once like in gemv.
+ *
+ * Matrix::PackedMatrix<float> PW(W);
+ * Matrix::gemm(1.0f, X, PW, 1.0f, Y);   // Y += X W
+ *
+ * @param alpha the scale of the product
+ * @param A the first matrix, op(A) has the shape (N, K)
+ * @param B the packed right operand with the shape (K, M)
+ * @param beta the scale of the old content of C
+ * @param C the result matrix with the shape (N, M)
+ * @param transpose_a uses A^T instead of A if it is true
+ * @retval None
+ */
+template <typename DType>
+void gemm(const DType alpha, const Matrix<DType>& A, const PackedMatrix<DType>& B,
+          const DType beta, Matrix<DType>& C, const bool transpose_a) {
+    detail::TraceSpan trace("gemm", A, B, C);
+
+    auto a_shape = A.get_shape();
+    auto b_shape = B.get_shape();
+    auto c_shape = C.get_shape();
+
+    assert((a_shape.size() == 2 && c_shape.size() == 2) && "The matrices must be two dimensional!");
+    assert(!B.is_left() && "The packed matrix is not packed as the right operand!");
+
+    int m = transpose_a ? a_shape[1] : a_shape[0];
+    int k = transpose_a ? a_shape[0] : a_shape[1];
+    int n = b_shape[1];
+
+    assert((k == b_shape[0]) && "The matrix multiplication is impossible");
+    assert((c_shape[0] == m && c_shape[1] == n) && "The shape of the output matrix is wrong!");
+
+    trace.set_flops(2.0 * m * n * k);
+
+    // one row of A is contiguous in A and in A^T
+    if (m == 1) {
+        detail::gemv_packed_b(k, n, alpha, A.data(), B.data(), beta, C.data());
+        return;
+    }
+
+    detail::gemm_blocked<DType, DType>(m, n, k, alpha, A.data(), a_shape[1], transpose_a,
+                                       nullptr, n, false, beta, C.data(), n, nullptr, B.data());
+}
+
+/*
+ * The function that does C = alpha * A op(B) + beta * C with the packed A
+ *
+ * @param alpha the scale of the product
+ * @param A the packed left operand with the shape (N, K)
+ * @param B the second matrix, op(B) has the shape (K, M)
+ * @param beta the scale of the old content of C
+ * @param C the result matrix with the shape (N, M)
+ * @param transpose_b uses B^T instead of B if it is true
+ * @retval None
+ */
+template <typename DType>
+void gemm(const DType alpha, const PackedMatrix<DType>& A, const Matrix<DType>& B,
+          const DType beta, Matrix<DType>& C, const bool transpose_b) {
+    detail::TraceSpan trace("gemm", A, B, C);
+
+    auto a_shape = A.get_shape();
+    auto b_shape = B.get_shape();
+    auto c_shape = C.get_shape();
+
+    assert((b_shape.size() == 2 && c_shape.size() == 2) && "The matrices must be two dimensional!");
+    assert(A.is_left() && "The packed matrix is not packed as the left operand!");
+
+    int m = a_shape[0];
+    int k = a_shape[1];
+    int n = transpose_b ? b_shape[0] : b_shape[1];
+
+    assert((k == (transpose_b ? b_shape[1] : b_shape[0])) && "The matrix multiplication is impossible");
+    assert((c_shape[0] == m && c_shape[1] == n) && "The shape of the output matrix is wrong!");
+
+    trace.set_flops(2.0 * m * n * k);
+
+    detail::gemm_blocked<DType, DType>(m, n, k, alpha, nullptr, k, false,
+                                       B.data(), b_shape[1], transpose_b, beta, C.data(), n, A.data(), nullptr);
+}
+
+/*
+ * The function that multiplies the matrix with the packed matrix
+ *
+ * Matrix::PackedMatrix<double> PW(W);
+ * for (auto& X : batches)
+ *     Y.push_back(Matrix::dot(X, PW));   // W is not packed again
+ *
+ * @param A the first matrix with the shape (N, K)
+ * @param B the packed right operand with the shape (K, M)
+ * @retval the matrix with the shape (N, M)
+ */
+template <typename DType>
+Matrix<DType> dot(const Matrix<DType>& A, const PackedMatrix<DType>& B) {
+    detail::TraceSpan trace("dot", A, B);
+    trace.set_flops(2.0 * A.get_shape()[0] * A.get_shape()[1] * B.get_shape()[1]);
+
+    Matrix<DType> AB(A.get_shape()[0], B.get_shape()[1]);
+    gemm<DType>(1, A, B, 0, AB);
+    return AB;
+}
+
+/*
+ * The function that multiplies the packed matrix with the matrix
+ *
+ * @param A the packed left operand with the shape (N, K)
+ * @param B the second matrix with the shape (K, M)
+ * @retval the matrix with the shape (N, M)
+ */
+template <typename DType>
+Matrix<DType> dot(const PackedMatrix<DType>& A, const Matrix<DType>& B) {
+    detail::TraceSpan trace("dot", A, B);
+    trace.set_flops(2.0 * A.get_shape()[0] * A.get_shape()[1] * B.get_shape()[1]);
+
+    Matrix<DType> AB(A.get_shape()[0], B.get_shape()[1]);
+    gemm<DType>(1, A, B, 0, AB);
+    return AB;
+}
+
+} // end of namespace
+
+#endif // end of _PACKED_CPP_
@@ -0,0 +1,94 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#ifndef _PACKED_H_
+#define _PACKED_H_
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "matrix.h"
+
+namespace Matrix {
+
+/*
+ * The constant operand of gemm, packed once into the cache blocks of gemm.
+ *
+ * gemm packs both of its operands into the layout of its kernel on every call.
+ * For the weights that are multiplied with many different activations, the
+ * packing can be done once: the PackedMatrix holds op(W) in the packed layout of
+ * the left operand (A) or of the right operand (B), and dot and gemm read it
+ * directly. It can be saved and loaded in the packed form.
+ */
+template <typename DType>
+class PackedMatrix {
+
+template <typename T>
+friend PackedMatrix<T> load_packed(std::istream&);
+
+public:
+
+    PackedMatrix<DType>(const Matrix<DType>&, const bool = false, const bool = false);
+
+    std::vector<int> get_shape() const;
+    bool is_left() const;
+    long get_packed_size() const;
+    const DType* data() const;
+
+    void save(std::ostream&) const;
+    void save(const std::string&) const;
+
+private:
+    PackedMatrix<DType>() = default;
+
+    std::vector<int> SHAPE;
+    bool LEFT;
+    std::vector<DType> PACKED;
+};
+
+template <typename DType>
+PackedMatrix<DType> load_packed(std::istream&);
+
+template <typename DType>
+PackedMatrix<DType> load_packed(const std::string&);
+
+template <typename DType>
+Matrix<DType> dot(const Matrix<DType>&, const PackedMatrix<DType>&);
+
+template <typename DType>
+Matrix<DType> dot(const PackedMatrix<DType>&, const Matrix<DType>&);
+
+template <typename DType>
+void gemm(const DType, const Matrix<DType>&, const PackedMatrix<DType>&, const DType, Matrix<DType>&,
+          const bool = false);
+
+template <typename DType>
+void gemm(const DType, const PackedMatrix<DType>&, const Matrix<DType>&, const DType, Matrix<DType>&,
+          const bool = false);
+
+} // end of namespace
+
+#include "packed.cpp"
+#endif // end of _PACKED_H_
@@ -0,0 +1,245 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#ifndef _PARALLEL_CPP_
+#define _PARALLEL_CPP_
+
+#include "parallel.h"
+
+#include <cstdlib>   // for std::getenv, std::atoi
+#include <algorithm> // for std::min, std::max
+#include <new>       // for the placement new
+#include <pthread.h> // for pthread_atfork
+
+namespace Matrix {
+
+namespace detail {
+
+// true while the current thread runs a chunk, so nested parallel_for calls stay serial
+inline bool& in_parallel_region() {
+    thread_local bool flag = false;
+    return flag;
+}
+
+} // end of namespace detail
+
+inline ThreadPool::ThreadPool()
+: NUM_THREADS(1), BODY(nullptr), END(0), GRAIN(1), NEXT(0), ACTIVE(0),
+  GENERATION(0), STOPPING(false)
+{
+    int n = static_cast<int>(std::thread::hardware_concurrency());
+
+    const char* env = std::getenv("ATRIX_NUM_THREADS");
+    if (env != nullptr && std::atoi(env) > 0)
+        n = std::atoi(env);
+
+    start(std::max(n, 1));
+
+    pthread_atfork(&ThreadPool::prepare_fork, &ThreadPool::after_fork_in_parent,
+                   &ThreadPool::after_fork_in_child);
+}
+
+inline ThreadPool::~ThreadPool() {
+    stop();
+}
+
+/*
+ * The fork handlers. No job runs and no worker holds a lock while the
+ * process forks, so the parent goes on as before. The child has only the
+ * forking thread: the std::thread objects of the missing workers can be
+ * neither joined nor destroyed, so they are leaked, and the locks and the
+ * condition variables that the workers waited on are made new.
+ */
+inline void ThreadPool::prepare_fork() {
+    ThreadPool& pool = instance();
+    pool.SUBMIT_MUTEX.lock();
+    pool.STATE_MUTEX.lock();
+}
+
+inline void ThreadPool::after_fork_in_parent() {
+    ThreadPool& pool = instance();
+    pool.STATE_MUTEX.unlock();
+    pool.SUBMIT_MUTEX.unlock();
+}
+
+inline void ThreadPool::after_fork_in_child() {
+    ThreadPool& pool = instance();
+
+    new std::vector<std::thread>(std::move(pool.WORKERS));
+    pool.WORKERS.clear();
+
+    new (&pool.SUBMIT_MUTEX) std::mutex();
+    new (&pool.STATE_MUTEX) std::mutex();
+    new (&pool.WAKE_UP) std::condition_variable();
+    new (&pool.DONE) std::condition_variable();
+
+    pool.NUM_THREADS = 1;
+    pool.BODY = nullptr;
+    pool.ACTIVE = 0;
+    pool.STOPPING = false;
+}
+
+inline ThreadPool& ThreadPool::instance() {
+    static ThreadPool pool;
+    return pool;
+}
+
+inline int ThreadPool::get_num_threads() const {
+    return NUM_THREADS;
+}
+
+inline void ThreadPool::set_num_threads(int n) {
+    std::lock_guard<std::mutex> submit(SUBMIT_MUTEX);
+
+    stop();
+    start(std::max(n, 1));
+}
+
+inline void ThreadPool::start(int n) {
+    NUM_THREADS = n;
+    STOPPING = false;
+
+    for (int i = 1; i < n; i++)
+        WORKERS.emplace_back(&ThreadPool::worker_loop, this, GENERATION);
+}
+
+inline void ThreadPool::stop() {
+    {
+        std::lock_guard<std::mutex> lock(STATE_MUTEX);
+        STOPPING = true;
+    }
+    WAKE_UP.notify_all();
+
+    for (auto& worker : WORKERS)
+        worker.join();
+
+    WORKERS.clear();
+}
+
+inline void ThreadPool::run_chunks() {
+    detail::in_parallel_region() = true;
+
+    while (true) {
+        long first = NEXT.fetch_add(GRAIN);
+        if (first >= END)
+            break;
+        (*BODY)(first, std::min(first + GRAIN, END));
+    }
+
+    detail::in_parallel_region() = false;
+}
+
+// seen is the generation when the worker was started, no job runs at that time
+inline void ThreadPool::worker_loop(unsigned long seen) {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(STATE_MUTEX);
+            WAKE_UP.wait(lock, [&] { return STOPPING || GENERATION != seen; });
+            if (STOPPING)
+                return;
+            seen = GENERATION;
+        }
+
+        run_chunks();
+
+        {
+            std::lock_guard<std::mutex> lock(STATE_MUTEX);
+            if (--ACTIVE == 0)
+                DONE.notify_one();
+        }
+    }
+}
+
+/*
+ * The method that runs body over the range [begin, end) on the pool
+ *
+ * The range is cut into chunks of at least grain iterations and body is
+ * called as body(chunk_begin, chunk_end) for each of them. If the range is
+ * not bigger than grain, the pool has one thread or the call is nested in
+ * another parallel_for, body(begin, end) is called on the current thread.
+ * body must not throw and must not fork. The pool of a forked child
+ * process is serial until set_num_threads is called in it.
+ *
+ * Matrix::parallel_for(0, N, 4096, [&](long first, long last) {
+ *     for (long i = first; i < last; i++)
+ *         y[i] += x[i];
+ * });
+ *
+ * @param begin the first iteration
+ * @param end the end of the range
+ * @param grain the minimum number of iterations of one chunk
+ * @param body the function that runs one chunk
+ * @retval None
+ */
+inline void ThreadPool::parallel_for(long begin, long end, long grain,
+                                     const std::function<void(long, long)>& body) {
+    if (end <= begin)
+        return;
+
+    grain = std::max(grain, 1L);
+
+    if (NUM_THREADS <= 1 || end - begin <= grain || detail::in_parallel_region()) {
+        body(begin, end);
+        return;
+    }
+
+    std::lock_guard<std::mutex> submit(SUBMIT_MUTEX);
+
+    {
+        // a few chunks per thread keep the load balanced without too much overhead
+        long chunk = (end - begin + 4L * NUM_THREADS - 1) / (4L * NUM_THREADS);
+
+        std::lock_guard<std::mutex> lock(STATE_MUTEX);
+        BODY = &body;
+        END = end;
+        GRAIN = std::max(grain, chunk);
+        NEXT = begin;
+        ACTIVE = static_cast<int>(WORKERS.size());
+        GENERATION++;
+    }
+    WAKE_UP.notify_all();
+
+    run_chunks();
+
+    std::unique_lock<std::mutex> lock(STATE_MUTEX);
+    DONE.wait(lock, [&] { return ACTIVE == 0; });
+    BODY = nullptr;
+}
+
+inline int get_num_threads() {
+    return ThreadPool::instance().get_num_threads();
+}
+
+inline void set_num_threads(int n) {
+    ThreadPool::instance().set_num_threads(n);
+}
+
+inline void parallel_for(long begin, long end, long grain,
+                         const std::function<void(long, long)>& body) {
+    ThreadPool::instance().parallel_for(begin, end, grain, body);
+}
+
+} // end of namespace
+
+#endif // end of _PARALLEL_CPP_
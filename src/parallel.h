@@ -0,0 +1,99 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#ifndef _PARALLEL_H_
+#define _PARALLEL_H_
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+
+namespace Matrix {
+
+/*
+ * The pool of worker threads shared by all kernels of the library.
+ *
+ * The number of threads is std::thread::hardware_concurrency() by default,
+ * it can be changed by the ATRIX_NUM_THREADS environment variable or by
+ * set_num_threads. The calling thread takes part in the work, so a pool
+ * of N threads starts N - 1 workers.
+ *
+ * The workers are not copied by fork(), so the child process gets a serial
+ * pool of one thread, set_num_threads starts the workers in the child again.
+ * fork() must not be called from inside a parallel_for body.
+ */
+class ThreadPool {
+public:
+    static ThreadPool& instance();
+
+    int get_num_threads() const;
+    void set_num_threads(int);
+
+    void parallel_for(long, long, long, const std::function<void(long, long)>&);
+
+    ~ThreadPool();
+
+private:
+    ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void start(int);
+    void stop();
+    void worker_loop(unsigned long);
+    void run_chunks();
+
+    static void prepare_fork();
+    static void after_fork_in_parent();
+    static void after_fork_in_child();
+
+    std::vector<std::thread> WORKERS;
+    int NUM_THREADS;
+
+    std::mutex SUBMIT_MUTEX;
+    std::mutex STATE_MUTEX;
+    std::condition_variable WAKE_UP;
+    std::condition_variable DONE;
+
+    const std::function<void(long, long)>* BODY;
+    long END;
+    long GRAIN;
+    std::atomic<long> NEXT;
+    int ACTIVE;
+    unsigned long GENERATION;
+    bool STOPPING;
+};
+
+int get_num_threads();
+void set_num_threads(int);
+
+void parallel_for(long, long, long, const std::function<void(long, long)>&);
+
+} // end of namespace
+
+#include "parallel.cpp"
+#endif // end of _PARALLEL_H_
@@ -0,0 +1,469 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#ifndef _QUANTIZE_CPP_
+#define _QUANTIZE_CPP_
+
+#include "matrix.h"
+#include "quantize.h"
+
+#include <algorithm> // for std::min, std::max
+#include <cmath>     // for std::nearbyint
+#include <assert.h>  // for assert
+
+#if (defined(__AVX512VNNI__) && defined(__AVX512BW__)) || defined(__AVX2__)
+#include <immintrin.h> // for the int8 dot kernels
+#elif defined(__SSE2__)
+#include <emmintrin.h> // for the int8 dot kernel of the baseline x86-64
+#endif
+
+namespace Matrix {
+
+namespace detail {
+
+/*
+ * The value added to the elements of A before the kernel, and taken back with
+ * the column sums of B after it. The VNNI instruction multiplies unsigned bytes
+ * with signed bytes, so A is moved from [-128, 127] to [0, 255] for it.
+ */
+#if defined(__AVX512VNNI__) && defined(__AVX512BW__)
+constexpr std::int32_t INT8_A_OFFSET = 128;
+#else
+constexpr std::int32_t INT8_A_OFFSET = 0;
+#endif
+
+// the bytes of the columns of B (rows of B^T) that are reused for every row of A
+constexpr long INT8_PANEL_BYTES = 1L << 17;
+
+// the channel of the element (i, j) of a matrix with the given axis
+inline long channel_of(const int axis, const long i, const long j) {
+    return axis == 0 ? i : (axis == 1 ? j : 0);
+}
+
+/*
+ * The smallest and the largest elements of every channel. Zero is always in
+ * the range, so it has an exact code.
+ */
+template <typename DType>
+void channel_ranges(const Matrix<DType>& A, const int axis, std::vector<float>& lo, std::vector<float>& hi) {
+    const DType* a = A.data();
+
+    if (axis == -1) {
+        const long size = A.get_matrix_size();
+        const long chunks = (size + PARALLEL_MIN_WORK - 1) / PARALLEL_MIN_WORK;
+        std::vector<float> chunk_lo(chunks, 0.0f), chunk_hi(chunks, 0.0f);
+
+        parallel_for(0, chunks, 1, [&](long first, long last) {
+            for (long c = first; c < last; c++) {
+                const long end = std::min(size, (c + 1) * PARALLEL_MIN_WORK);
+                for (long p = c * PARALLEL_MIN_WORK; p < end; p++) {
+                    const float x = static_cast<float>(a[p]);
+                    chunk_lo[c] = std::min(chunk_lo[c], x);
+                    chunk_hi[c] = std::max(chunk_hi[c], x);
+                }
+            }
+        });
+
+        lo[0] = *std::min_element(chunk_lo.begin(), chunk_lo.end());
+        hi[0] = *std::max_element(chunk_hi.begin(), chunk_hi.end());
+        return;
+    }
+
+    const long N = A.get_shape()[0];
+    const long M = A.get_shape()[1];
+
+    if (axis == 0) {
+        elementwise_for(N, [&](long first, long last) {
+            for (long i = first; i < last; i++) {
+                for (long j = 0; j < M; j++) {
+                    const float x = static_cast<float>(a[i * M + j]);
+                    lo[i] = std::min(lo[i], x);
+                    hi[i] = std::max(hi[i], x);
+                }
+            }
+        }, M);
+    } else {
+        // every thread takes some columns and goes down the rows
+        elementwise_for(M, [&](long first, long last) {
+            for (long i = 0; i < N; i++) {
+                for (long j = first; j < last; j++) {
+                    const float x = static_cast<float>(a[i * M + j]);
+                    lo[j] = std::min(lo[j], x);
+                    hi[j] = std::max(hi[j], x);
+                }
+            }
+        }, N);
+    }
+}
+
+inline std::int8_t quantize_value(const float x, const float inverse_scale, const std::int32_t zero_point) {
+    const float q = std::nearbyint(x * inverse_scale) + zero_point;
+    return static_cast<std::int8_t>(std::min(127.0f, std::max(-128.0f, q)));
+}
+
+// the channel values of a matrix, one for every row or column
+template <typename T>
+std::vector<T> expand_channels(const std::vector<T>& values, const long count) {
+    return values.size() == 1 ? std::vector<T>(count, values[0]) : values;
+}
+
+#if defined(__SSE2__) && !(defined(__AVX512VNNI__) && defined(__AVX512BW__))
+inline std::int32_t horizontal_sum(__m128i s) {
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4e));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xb1));
+    return _mm_cvtsi128_si32(s);
+}
+#endif
+
+#if defined(__AVX2__) && !(defined(__AVX512VNNI__) && defined(__AVX512BW__))
+inline std::int32_t horizontal_sum(const __m256i x) {
+    return horizontal_sum(_mm_add_epi32(_mm256_castsi256_si128(x), _mm256_extracti128_si256(x, 1)));
+}
+#endif
+
+/*
+ * out[c] = sum of a[p] * b[c * k + p] for p < k and c < COLUMNS
+ *
+ * a is a row of A (moved by INT8_A_OFFSET) and b is COLUMNS rows of B^T.
+ * The row of A is loaded once for all the columns. The VNNI kernel does
+ * 64 multiply-adds of bytes in one instruction, the AVX2 and SSE2 ones widen
+ * the bytes to 16 bits and do 16 of them with pmaddwd. All of them are exact.
+ */
+template <int COLUMNS>
+void int8_dot(const std::int8_t* a, const std::int8_t* b, const long k, std::int32_t* out) {
+    long p = 0;
+
+#if defined(__AVX512VNNI__) && defined(__AVX512BW__)
+    __m512i acc[COLUMNS];
+    for (int c = 0; c < COLUMNS; c++)
+        acc[c] = _mm512_setzero_si512();
+
+    for (; p + 64 <= k; p += 64) {
+        const __m512i va = _mm512_loadu_si512(a + p);
+        for (int c = 0; c < COLUMNS; c++)
+            acc[c] = _mm512_dpbusd_epi32(acc[c], va, _mm512_loadu_si512(b + c * k + p));
+    }
+
+    if (p < k) {
+        const __mmask64 mask = _cvtu64_mask64(~0ULL >> (64 - (k - p)));
+        const __m512i va = _mm512_maskz_loadu_epi8(mask, a + p);
+        for (int c = 0; c < COLUMNS; c++)
+            acc[c] = _mm512_dpbusd_epi32(acc[c], va, _mm512_maskz_loadu_epi8(mask, b + c * k + p));
+        p = k;
+    }
+
+    for (int c = 0; c < COLUMNS; c++)
+        out[c] = _mm512_reduce_add_epi32(acc[c]);
+#elif defined(__AVX2__)
+    __m256i acc[COLUMNS];
+    for (int c = 0; c < COLUMNS; c++)
+        acc[c] = _mm256_setzero_si256();
+
+    for (; p + 16 <= k; p += 16) {
+        const __m256i va = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + p)));
+        for (int c = 0; c < COLUMNS; c++) {
+            const __m256i vb = _mm256_cvtepi8_epi16(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + c * k + p)));
+            acc[c] = _mm256_add_epi32(acc[c], _mm256_madd_epi16(va, vb));
+        }
+    }
+
+    for (int c = 0; c < COLUMNS; c++)
+        out[c] = horizontal_sum(acc[c]);
+#elif defined(__SSE2__)
+    __m128i acc[COLUMNS];
+    for (int c = 0; c < COLUMNS; c++)
+        acc[c] = _mm_setzero_si128();
+
+    // the bytes are widened to 16 bits by unpacking them to the upper half and shifting back
+    for (; p + 16 <= k; p += 16) {
+        const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + p));
+        const __m128i va_lo = _mm_srai_epi16(_mm_unpacklo_epi8(va, va), 8);
+        const __m128i va_hi = _mm_srai_epi16(_mm_unpackhi_epi8(va, va), 8);
+        for (int c = 0; c < COLUMNS; c++) {
+            const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + c * k + p));
+            acc[c] = _mm_add_epi32(acc[c], _mm_madd_epi16(va_lo, _mm_srai_epi16(_mm_unpacklo_epi8(vb, vb), 8)));
+            acc[c] = _mm_add_epi32(acc[c], _mm_madd_epi16(va_hi, _mm_srai_epi16(_mm_unpackhi_epi8(vb, vb), 8)));
+        }
+    }
+
+    for (int c = 0; c < COLUMNS; c++)
+        out[c] = horizontal_sum(acc[c]);
+#else
+    for (int c = 0; c < COLUMNS; c++)
+        out[c] = 0;
+#endif
+
+    for (; p < k; p++) {
+        for (int c = 0; c < COLUMNS; c++)
+            out[c] += static_cast<std::int32_t>(a[p]) * b[c * k + p];
+    }
+}
+
+} // end of namespace detail
+
+/*
+ * The function that quantizes the matrix to int8
+ *
+ * The scale of every channel is found from the range of its elements (zero is
+ * always in the range). The symmetric quantization maps [-max|x|, max|x|] to
+ * [-127, 127] with the zero point 0, it suits the weights. The asymmetric one
+ * maps [min x, max x] to [-128, 127] with its own zero point, it suits the
+ * activations that are mostly on one side of zero, like the outputs of ReLU.
+ * The values are rounded to the nearest even and saturated.
+ *
+ * Matrix::Matrix<float> W(1024, 1024);
+ * Matrix::QuantizedMatrix QW = Matrix::quantize(W, 1);     // a scale for every output column
+ * Matrix::QuantizedMatrix QX = Matrix::quantize(X, 0, false);
+ *
+ * @param A the matrix, it must be two dimensional unless axis is -1
+ * @param axis -1 for one scale, 0 for a scale for every row, 1 for a scale for every column
+ * @param symmetric uses the zero point 0 if it is true
+ * @retval the quantized matrix
+ */
+template <typename DType>
+QuantizedMatrix quantize(const Matrix<DType>& A, const int axis, const bool symmetric) {
+    auto shape = A.get_shape();
+
+    assert((axis >= -1 && axis <= 1) && "The axis of the quantization must be -1, 0 or 1!");
+    assert((axis == -1 || shape.size() == 2) &&
+        "The matrix must be two dimensional for the quantization of the channels!");
+
+    const long channels = axis == -1 ? 1 : shape[axis];
+
+    std::vector<float> lo(channels, 0.0f), hi(channels, 0.0f);
+    detail::channel_ranges(A, axis, lo, hi);
+
+    QuantizedMatrix RESULT{detail::matrix_with_shape<std::int8_t>(shape),
+                           std::vector<float>(channels), std::vector<std::int32_t>(channels), axis};
+
+    std::vector<float> inverse_scales(channels);
+
+    for (long c = 0; c < channels; c++) {
+        float scale;
+        std::int32_t zero_point = 0;
+
+        if (symmetric) {
+            scale = std::max(-lo[c], hi[c]) / 127.0f;
+        } else {
+            scale = (hi[c] - lo[c]) / 255.0f;
+            if (scale > 0.0f)
+                zero_point = static_cast<std::int32_t>(std::nearbyint(-128.0f - lo[c] / scale));
+            zero_point = std::min(127, std::max(-128, zero_point));
+        }
+
+        // the channels of zeros get any scale
+        if (!(scale > 0.0f))
+            scale = 1.0f;
+
+        RESULT.scales[c] = scale;
+        RESULT.zero_points[c] = zero_point;
+        inverse_scales[c] = 1.0f / scale;
+    }
+
+    const DType* a = A.data();
+    std::int8_t* q = RESULT.values.data();
+    const long N = axis == -1 ? 1 : shape[0];
+    const long M = A.get_matrix_size() / std::max(1L, N);
+
+    detail::elementwise_for(axis == -1 ? A.get_matrix_size() : N, [&](long first, long last) {
+        if (axis == -1) {
+            for (long p = first; p < last; p++)
+                q[p] = detail::quantize_value(static_cast<float>(a[p]), inverse_scales[0], RESULT.zero_points[0]);
+            return;
+        }
+
+        for (long i = first; i < last; i++) {
+            for (long j = 0; j < M; j++) {
+                const long c = detail::channel_of(axis, i, j);
+                q[i * M + j] = detail::quantize_value(static_cast<float>(a[i * M + j]), inverse_scales[c],
+                                                      RESULT.zero_points[c]);
+            }
+        }
+    }, axis == -1 ? 1 : M);
+
+    return RESULT;
+}
+
+/*
+ * The function that turns the quantized matrix back to real numbers
+ *
+ * Every element becomes (q - zero_point) * scale of its channel.
+ *
+ * Matrix::Matrix<float> W2 = Matrix::dequantize(Matrix::quantize(W, 1));
+ * Matrix::Matrix<double> W3 = Matrix::dequantize<double>(QW);
+ *
+ * @param Q the quantized matrix
+ * @retval the matrix with the shape of Q.values
+ */
+template <typename DType>
+Matrix<DType> dequantize(const QuantizedMatrix& Q) {
+    auto shape = Q.values.get_shape();
+    Matrix<DType> RESULT = detail::matrix_with_shape<DType>(shape);
+
+    const std::int8_t* q = Q.values.data();
+    DType* r = RESULT.data();
+    const long size = Q.values.get_matrix_size();
+    const long M = Q.axis == -1 ? size : shape[1];
+
+    detail::elementwise_for(size, [&](long first, long last) {
+        for (long p = first; p < last; p++) {
+            const long c = detail::channel_of(Q.axis, p / M, p % M);
+            r[p] = static_cast<DType>((q[p] - Q.zero_points[c]) * Q.scales[c]);
+        }
+    });
+
+    return RESULT;
+}
+
+/*
+ * The function that multiplies two quantized matrices
+ *
+ * The products of the int8 values are accumulated exactly in int32, with the
+ * VNNI instructions if they are enabled (-mavx512vnni) and with the AVX2 or
+ * SSE2 ones otherwise. The zero points are taken out with the row sums of A and the
+ * column sums of B, and the result is scaled to float at the end:
+ *
+ *     C(i, j) = sa(i) sb(j) (sum of (qa(i, k) - za(i)) (qb(k, j) - zb(j)))
+ *
+ * so A must have one scale or a scale for every row, and B one scale or a
+ * scale for every column. The inner dimension is at most 65536, so the int32
+ * sums do not overflow.
+ *
+ * Matrix::QuantizedMatrix QW = Matrix::quantize(W, 1);
+ * Matrix::Matrix<float> Y = Matrix::dot(Matrix::quantize(X, 0, false), QW);
+ *
+ * @param A the first matrix with the shape (N, K) and the axis -1 or 0
+ * @param B the second matrix with the shape (K, M) and the axis -1 or 1
+ * @retval the float matrix with the shape (N, M)
+ */
+inline Matrix<float> dot(const QuantizedMatrix& A, const QuantizedMatrix& B) {
+    detail::TraceSpan trace("dot", A.values, B.values);
+
+    auto a_shape = A.values.get_shape();
+    auto b_shape = B.values.get_shape();
+
+    assert((a_shape.size() == 2 && b_shape.size() == 2) &&
+        "The matrices must be two dimensional!");
+    assert((a_shape[1] == b_shape[0]) && "The matrix multiplication is impossible");
+    assert((A.axis != 1 && B.axis != 0) &&
+        "The scales must not change along the inner dimension!");
+    assert((a_shape[1] <= (1L << 16)) && "The inner dimension is too large for the int32 sums!");
+
+    const long N = a_shape[0];
+    const long K = a_shape[1];
+    const long M = b_shape[1];
+
+    trace.set_flops(2.0 * N * K * M);
+
+    // the rows of A moved for the kernel, and the columns of B as the rows of B^T
+    std::vector<std::int8_t> packed_a(N * K);
+    std::vector<std::int8_t> packed_b(M * K);
+    std::vector<std::int32_t> row_sums(N, 0);
+    std::vector<std::int32_t> column_sums(M, 0);
+
+    const std::int8_t* a = A.values.data();
+    const std::int8_t* b = B.values.data();
+
+    detail::elementwise_for(N, [&](long first, long last) {
+        for (long i = first; i < last; i++) {
+            for (long k = 0; k < K; k++) {
+                row_sums[i] += a[i * K + k];
+                packed_a[i * K + k] = static_cast<std::int8_t>(a[i * K + k] ^ (detail::INT8_A_OFFSET ? 0x80 : 0));
+            }
+        }
+    }, K);
+
+    detail::elementwise_for(M, [&](long first, long last) {
+        for (long k = 0; k < K; k++) {
+            for (long j = first; j < last; j++) {
+                column_sums[j] += b[k * M + j];
+                packed_b[j * K + k] = b[k * M + j];
+            }
+        }
+    }, K);
+
+    std::vector<float> a_scales = detail::expand_channels(A.scales, N);
+    std::vector<float> b_scales = detail::expand_channels(B.scales, M);
+    std::vector<std::int32_t> a_zero_points = detail::expand_channels(A.zero_points, N);
+    std::vector<std::int32_t> b_zero_points = detail::expand_channels(B.zero_points, M);
+
+    Matrix<float> RESULT(a_shape[0], b_shape[1]);
+    float* c = RESULT.data();
+
+    auto store = [&](const long i, const long j, const std::int32_t sum) {
+        const std::int64_t za = a_zero_points[i];
+        const std::int64_t zb = b_zero_points[j];
+        const std::int64_t exact = static_cast<std::int64_t>(sum) - detail::INT8_A_OFFSET * column_sums[j]
+                                 - zb * row_sums[i] - za * column_sums[j] + K * za * zb;
+        c[i * M + j] = a_scales[i] * b_scales[j] * static_cast<float>(exact);
+    };
+
+    // the columns of B are taken in panels that stay in the cache for all the rows of A
+    const long panel = std::max(4L, (detail::INT8_PANEL_BYTES / std::max(1L, K)) & ~3L);
+
+    detail::elementwise_for(N, [&](long first, long last) {
+        std::int32_t sums[4];
+
+        for (long j0 = 0; j0 < M; j0 += panel) {
+            const long j1 = std::min(M, j0 + panel);
+
+            for (long i = first; i < last; i++) {
+                const std::int8_t* row = packed_a.data() + i * K;
+                long j = j0;
+
+                for (; j + 4 <= j1; j += 4) {
+                    detail::int8_dot<4>(row, packed_b.data() + j * K, K, sums);
+                    for (int t = 0; t < 4; t++)
+                        store(i, j + t, sums[t]);
+                }
+
+                for (; j < j1; j++) {
+                    detail::int8_dot<1>(row, packed_b.data() + j * K, K, sums);
+                    store(i, j, sums[0]);
+                }
+            }
+        }
+    }, K * M);
+
+    return RESULT;
+}
+
+/*
+ * The function that multiplies a float matrix with a quantized matrix
+ *
+ * A is quantized with a scale and a zero point for every row first, it is
+ * the dynamic quantization of the activations for the int8 weights.
+ *
+ * @param A the float matrix with the shape (N, K)
+ * @param B the quantized matrix with the shape (K, M) and the axis -1 or 1
+ * @retval the float matrix with the shape (N, M)
+ */
+inline Matrix<float> dot(const Matrix<float>& A, const QuantizedMatrix& B) {
+    return dot(quantize(A, 0, false), B);
+}
+
+} // end of namespace
+
+#endif // end of _QUANTIZE_CPP_
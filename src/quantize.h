@@ -0,0 +1,62 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#ifndef _QUANTIZE_H_
+#define _QUANTIZE_H_
+
+#include <cstdint>
+#include <vector>
+#include "matrix.h"
+
+namespace Matrix {
+
+/*
+ * The int8 matrix with the scales and the zero points of its channels.
+ *
+ * The element x of the real matrix is stored as q = round(x / scale) + zero_point,
+ * so x is about (q - zero_point) * scale. The axis tells which elements
+ * share a scale: -1 is one scale for the whole matrix, 0 is one scale for every
+ * row and 1 is one scale for every column.
+ */
+struct QuantizedMatrix {
+    Matrix<std::int8_t> values;
+    std::vector<float> scales;
+    std::vector<std::int32_t> zero_points;
+    int axis;
+};
+
+template <typename DType>
+QuantizedMatrix quantize(const Matrix<DType>&, const int = -1, const bool = true);
+
+template <typename DType = float>
+Matrix<DType> dequantize(const QuantizedMatrix&);
+
+Matrix<float> dot(const QuantizedMatrix&, const QuantizedMatrix&);
+
+Matrix<float> dot(const Matrix<float>&, const QuantizedMatrix&);
+
+} // end of namespace
+
+#include "quantize.cpp"
+#endif // end of _QUANTIZE_H_
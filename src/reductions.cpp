@@ -0,0 +1,740 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#ifndef _REDUCTIONS_CPP_
+#define _REDUCTIONS_CPP_
+
+#include "matrix.h"
+#include "reductions.h"
+#include "parallel.h"
+
+#include <vector>    // for std::vector
+#include <cmath>     // for std::sqrt, std::pow, std::abs
+#include <limits>    // for std::numeric_limits
+#include <algorithm> // for std::min
+#include <assert.h>  // for assert
+
+namespace Matrix {
+
+namespace detail {
+
+// the contiguous blocks of this many elements are summed directly, the longer
+// ranges are halved, so the rounding error grows with log(n) instead of n
+constexpr long PAIRWISE_BLOCK = 128;
+
+// the same for the sums of the rows of a block of columns
+constexpr long STRIDED_PAIRWISE_BLOCK = 64;
+
+// the full reductions are cut into the chunks of this size whatever the number
+// of threads is, so the results don't depend on the number of threads
+constexpr long REDUCTION_CHUNK = 1L << 16;
+
+// the number of columns reduced together when the axis is not the last one
+constexpr int REDUCTION_WIDTH = 256;
+
+// the sum of f(x[i]) for the contiguous x by pairwise summation,
+// every block is summed in SIMD_LANES independent accumulators
+template <typename DType, typename F>
+DType pairwise_sum(const DType* x, const long n, F f) {
+    constexpr int L = SIMD_LANES;
+
+    if (n <= PAIRWISE_BLOCK) {
+        DType acc[L] = {};
+        long i = 0;
+
+        for (; i + L <= n; i += L)
+            for (int l = 0; l < L; l++)
+                acc[l] += f(x[i + l]);
+
+        DType s = 0;
+        for (int l = 0; l < L; l++)
+            s += acc[l];
+
+        for (; i < n; i++)
+            s += f(x[i]);
+
+        return s;
+    }
+
+    long half = n / 2;
+    half -= half % L;
+
+    return pairwise_sum(x, half, f) + pairwise_sum(x + half, n - half, f);
+}
+
+// out[i] = the sum of f(x[k * stride + i], i) over k for i < width by pairwise
+// summation over k, scratch must have room for 64 * width elements
+template <typename DType, typename F>
+void pairwise_sum_strided(const DType* x, const long length, const long stride, const int width,
+                          DType* out, DType* scratch, F f) {
+
+    if (length <= STRIDED_PAIRWISE_BLOCK) {
+        for (int i = 0; i < width; i++)
+            out[i] = 0;
+
+        for (long k = 0; k < length; k++) {
+            const DType* row = x + k * stride;
+            for (int i = 0; i < width; i++)
+                out[i] += f(row[i], i);
+        }
+
+        return;
+    }
+
+    long half = length / 2;
+
+    pairwise_sum_strided(x, half, stride, width, out, scratch + width, f);
+    pairwise_sum_strided(x + half * stride, length - half, stride, width, scratch, scratch + width, f);
+
+    for (int i = 0; i < width; i++)
+        out[i] += scratch[i];
+}
+
+// pick(...pick(f(x[0]), f(x[1]))..., f(x[n - 1])) for the contiguous x where pick
+// is an associative choice like min or max, in SIMD_LANES independent lanes
+template <typename DType, typename F, typename Pick>
+DType lanes_reduce(const DType* x, const long n, F f, Pick pick) {
+    constexpr int L = SIMD_LANES;
+
+    DType result = f(x[0]);
+    long i = 0;
+
+    if (n >= L) {
+        DType acc[L];
+        for (int l = 0; l < L; l++)
+            acc[l] = f(x[l]);
+
+        for (i = L; i + L <= n; i += L)
+            for (int l = 0; l < L; l++)
+                acc[l] = pick(acc[l], f(x[i + l]));
+
+        result = acc[0];
+        for (int l = 1; l < L; l++)
+            result = pick(result, acc[l]);
+    }
+
+    for (; i < n; i++)
+        result = pick(result, f(x[i]));
+
+    return result;
+}
+
+// the sum of f(x[i]) over the whole buffer, the chunks run on the thread pool
+template <typename DType, typename F>
+DType full_sum(const DType* x, const long n, F f) {
+    if (n <= REDUCTION_CHUNK)
+        return pairwise_sum(x, n, f);
+
+    long chunks = (n + REDUCTION_CHUNK - 1) / REDUCTION_CHUNK;
+    std::vector<DType> partial(chunks);
+
+    parallel_for(0, chunks, 1, [&](long first, long last) {
+        for (long c = first; c < last; c++)
+            partial[c] = pairwise_sum(x + c * REDUCTION_CHUNK,
+                                      std::min(REDUCTION_CHUNK, n - c * REDUCTION_CHUNK), f);
+    });
+
+    return pairwise_sum(partial.data(), chunks, [](const DType v) { return v; });
+}
+
+// lanes_reduce over the whole buffer, the chunks run on the thread pool
+template <typename DType, typename F, typename Pick>
+DType full_reduce(const DType* x, const long n, F f, Pick pick) {
+    if (n <= REDUCTION_CHUNK)
+        return lanes_reduce(x, n, f, pick);
+
+    long chunks = (n + REDUCTION_CHUNK - 1) / REDUCTION_CHUNK;
+    std::vector<DType> partial(chunks);
+
+    parallel_for(0, chunks, 1, [&](long first, long last) {
+        for (long c = first; c < last; c++)
+            partial[c] = lanes_reduce(x + c * REDUCTION_CHUNK,
+                                      std::min(REDUCTION_CHUNK, n - c * REDUCTION_CHUNK), f, pick);
+    });
+
+    return lanes_reduce(partial.data(), chunks, [](const DType v) { return v; }, pick);
+}
+
+/*
+ * The driver of the reductions along one axis.
+ *
+ * The matrix is seen as (outer, length, inner) where length is the size of
+ * the axis. If the axis is the last one (inner is 1), every output element
+ * is line(x, length, index) of a contiguous line. Otherwise the columns are
+ * reduced in blocks of REDUCTION_WIDTH by
+ * strided(x, length, inner, width, out, index, scratch) where the rows of
+ * the block are inner elements apart and index is the flat index of out[0].
+ * The output drops the axis, or keeps it with the size 1 if keepdims is true.
+ */
+template <typename OutType, typename DType, typename Line, typename Strided>
+Matrix<OutType> reduce_axis(const Matrix<DType>& A, int axis, const bool keepdims,
+                            Line line, Strided strided) {
+
+    auto shape = A.get_shape();
+    const int ndim = shape.size();
+
+    if (axis < 0)
+        axis += ndim;
+
+    assert((axis >= 0 && axis < ndim) &&
+        "Invalid axis!");
+
+    long outer = 1;
+    long inner = 1;
+    const long length = shape[axis];
+
+    for (int d = 0; d < axis; d++)
+        outer *= shape[d];
+    for (int d = axis + 1; d < ndim; d++)
+        inner *= shape[d];
+
+    std::vector<int> out_shape;
+    for (int d = 0; d < ndim; d++) {
+        if (d != axis)
+            out_shape.push_back(shape[d]);
+        else if (keepdims)
+            out_shape.push_back(1);
+    }
+
+    if (out_shape.size() == 0)
+        out_shape.push_back(1);
+
+    Matrix<OutType> RESULT = matrix_with_shape<OutType>(out_shape);
+
+    const DType* a = A.data();
+    OutType* out = RESULT.data();
+
+    if (inner == 1) {
+        parallel_for(0, outer, std::max(1L, PARALLEL_MIN_WORK / length), [&](long first, long last) {
+            for (long o = first; o < last; o++)
+                out[o] = line(a + o * length, length, o);
+        });
+
+        return RESULT;
+    }
+
+    const long blocks = (inner + REDUCTION_WIDTH - 1) / REDUCTION_WIDTH;
+
+    parallel_for(0, outer * blocks, std::max(1L, PARALLEL_MIN_WORK / (length * REDUCTION_WIDTH)),
+        [&](long first, long last) {
+            std::vector<DType> scratch(64 * REDUCTION_WIDTH);
+
+            for (long item = first; item < last; item++) {
+                long o = item / blocks;
+                long i0 = (item % blocks) * REDUCTION_WIDTH;
+                int width = std::min<long>(REDUCTION_WIDTH, inner - i0);
+
+                strided(a + o * length * inner + i0, length, inner, width,
+                        out + o * inner + i0, o * inner + i0, scratch.data());
+            }
+        });
+
+    return RESULT;
+}
+
+// the lambdas shared by the reductions
+template <typename DType>
+struct Identity {
+    DType operator()(const DType v) const { return v; }
+};
+
+template <typename DType>
+struct Smaller {
+    DType operator()(const DType x, const DType y) const { return (y < x) ? y : x; }
+};
+
+template <typename DType>
+struct Larger {
+    DType operator()(const DType x, const DType y) const { return (y > x) ? y : x; }
+};
+
+// the picks of argmin and argmax, a NaN wins over every number like in numpy
+template <typename DType>
+struct SmallerOrNaN {
+    DType operator()(const DType x, const DType y) const { return (y < x || y != y) ? y : x; }
+};
+
+template <typename DType>
+struct LargerOrNaN {
+    DType operator()(const DType x, const DType y) const { return (y > x || y != y) ? y : x; }
+};
+
+// the reductions of min, max, argmin and argmax only differ in the comparison
+template <typename DType, typename Pick>
+Matrix<DType> pick_axis(const Matrix<DType>& A, const int axis, const bool keepdims, Pick pick) {
+    return reduce_axis<DType>(A, axis, keepdims,
+        [&](const DType* x, long length, long) {
+            return lanes_reduce(x, length, Identity<DType>(), pick);
+        },
+        [&](const DType* x, long length, long stride, int width, DType* out, long, DType*) {
+            for (int i = 0; i < width; i++)
+                out[i] = x[i];
+
+            for (long k = 1; k < length; k++) {
+                const DType* row = x + k * stride;
+                for (int i = 0; i < width; i++)
+                    out[i] = pick(out[i], row[i]);
+            }
+        });
+}
+
+// the first index of the element equal to value among the n elements of x,
+// a NaN value matches the first NaN, n if there is no such element
+template <typename DType>
+long first_index_of(const DType* x, const long n, const DType value) {
+    const bool nan = value != value;
+
+    for (long i = 0; i < n; i++)
+        if (x[i] == value || (nan && x[i] != x[i]))
+            return i;
+
+    return n;
+}
+
+// the first index of the element picked by pick, better(v, best) is true if v wins
+template <typename DType, typename Pick, typename Better>
+Matrix<int> arg_axis(const Matrix<DType>& A, const int axis, const bool keepdims,
+                     Pick pick, Better better) {
+    return reduce_axis<int>(A, axis, keepdims,
+        [&](const DType* x, long length, long) {
+            return first_index_of(x, length, lanes_reduce(x, length, Identity<DType>(), pick));
+        },
+        [&](const DType* x, long length, long stride, int width, int* out, long, DType* best) {
+            for (int i = 0; i < width; i++) {
+                best[i] = x[i];
+                out[i] = 0;
+            }
+
+            for (long k = 1; k < length; k++) {
+                const DType* row = x + k * stride;
+                for (int i = 0; i < width; i++) {
+                    bool wins = better(row[i], best[i]);
+                    best[i] = wins ? row[i] : best[i];
+                    out[i] = wins ? static_cast<int>(k) : out[i];
+                }
+            }
+        });
+}
+
+} // end of namespace detail
+
+/*
+ * The function that returns the sum of all elements of the matrix
+ *
+ * The elements are added by pairwise summation, so the rounding error grows
+ * slowly with the size of the matrix. The large matrices are summed by the
+ * threads of the pool, and the result doesn't depend on the number of threads.
+ *
+ * Matrix::Matrix<double> A(2, 3);   // [[0, 1, 2], [3, 4, 5]]
+ * double s = Matrix::sum(A);        // 15
+ *
+ * @param A the matrix
+ * @retval the sum of the elements
+ */
+template <typename DType>
+DType sum(const Matrix<DType>& A) {
+    detail::TraceSpan trace("sum", A);
+    trace.set_flops(A.get_matrix_size());
+
+    return detail::full_sum(A.data(), A.get_matrix_size(), detail::Identity<DType>());
+}
+
+/*
+ * The function that sums the matrix along the axis
+ *
+ * The axis can be negative to count from the last dimension. The axis is
+ * removed from the shape of the result, or it is kept with the size 1 if
+ * keepdims is true, so that the result can be broadcast against the matrix.
+ *
+ * Matrix::Matrix<double> A(2, 3);   // [[0, 1, 2], [3, 4, 5]]
+ *
+ * Matrix::sum(A, 0);         // [3, 5, 7] with the shape (3)
+ * Matrix::sum(A, 1, true);   // [[3], [12]] with the shape (2, 1)
+ *
+ * @param A the matrix
+ * @param axis the axis that is summed
+ * @param keepdims keeps the axis with the size 1 if it is true
+ * @retval the sums along the axis
+ */
+template <typename DType>
+Matrix<DType> sum(const Matrix<DType>& A, const int axis, const bool keepdims) {
+    MATRIX_ACCOUNT_SCOPE("sum");
+    detail::TraceSpan trace("sum", A);
+    trace.set_flops(A.get_matrix_size());
+
+    return detail::reduce_axis<DType>(A, axis, keepdims,
+        [](const DType* x, long length, long) {
+            return detail::pairwise_sum(x, length, detail::Identity<DType>());
+        },
+        [](const DType* x, long length, long stride, int width, DType* out, long, DType* scratch) {
+            detail::pairwise_sum_strided(x, length, stride, width, out, scratch,
+                [](const DType v, int) { return v; });
+        });
+}
+
+/*
+ * The function that returns the mean of all elements of the matrix
+ *
+ * @param A the matrix
+ * @retval the mean of the elements
+ */
+template <typename DType>
+DType mean(const Matrix<DType>& A) {
+    detail::TraceSpan trace("mean", A);
+    trace.set_flops(A.get_matrix_size());
+
+    return sum(A) / static_cast<DType>(A.get_matrix_size());
+}
+
+/*
+ * The function that returns the means along the axis
+ *
+ * The axis and keepdims work as in sum.
+ *
+ * @param A the matrix
+ * @param axis the axis that is averaged
+ * @param keepdims keeps the axis with the size 1 if it is true
+ * @retval the means along the axis
+ */
+template <typename DType>
+Matrix<DType> mean(const Matrix<DType>& A, const int axis, const bool keepdims) {
+    MATRIX_ACCOUNT_SCOPE("mean");
+    detail::TraceSpan trace("mean", A);
+    trace.set_flops(A.get_matrix_size());
+
+    Matrix<DType> RESULT = sum(A, axis, keepdims);
+
+    auto shape = A.get_shape();
+    RESULT /= static_cast<DType>(shape[(axis < 0) ? axis + shape.size() : axis]);
+
+    return RESULT;
+}
+
+/*
+ * The function that returns the smallest element of the matrix
+ *
+ * @param A the matrix
+ * @retval the smallest element
+ */
+template <typename DType>
+DType min(const Matrix<DType>& A) {
+    detail::TraceSpan trace("min", A);
+
+    return detail::full_reduce(A.data(), A.get_matrix_size(),
+                               detail::Identity<DType>(), detail::Smaller<DType>());
+}
+
+/*
+ * The function that returns the smallest elements along the axis
+ *
+ * The axis and keepdims work as in sum.
+ *
+ * @param A the matrix
+ * @param axis the axis that is reduced
+ * @param keepdims keeps the axis with the size 1 if it is true
+ * @retval the smallest elements along the axis
+ */
+template <typename DType>
+Matrix<DType> min(const Matrix<DType>& A, const int axis, const bool keepdims) {
+    MATRIX_ACCOUNT_SCOPE("min");
+    detail::TraceSpan trace("min", A);
+
+    return detail::pick_axis(A, axis, keepdims, detail::Smaller<DType>());
+}
+
+/*
+ * The function that returns the largest element of the matrix
+ *
+ * @param A the matrix
+ * @retval the largest element
+ */
+template <typename DType>
+DType max(const Matrix<DType>& A) {
+    detail::TraceSpan trace("max", A);
+
+    return detail::full_reduce(A.data(), A.get_matrix_size(),
+                               detail::Identity<DType>(), detail::Larger<DType>());
+}
+
+/*
+ * The function that returns the largest elements along the axis
+ *
+ * The axis and keepdims work as in sum.
+ *
+ * @param A the matrix
+ * @param axis the axis that is reduced
+ * @param keepdims keeps the axis with the size 1 if it is true
+ * @retval the largest elements along the axis
+ */
+template <typename DType>
+Matrix<DType> max(const Matrix<DType>& A, const int axis, const bool keepdims) {
+    MATRIX_ACCOUNT_SCOPE("max");
+    detail::TraceSpan trace("max", A);
+
+    return detail::pick_axis(A, axis, keepdims, detail::Larger<DType>());
+}
+
+/*
+ * The function that returns the flat index of the smallest element
+ *
+ * If the smallest value appears more than once, the first index is returned.
+ * A NaN wins over every number, so the index of the first NaN is returned
+ * if there is any.
+ *
+ * Matrix::Matrix<double> A(2, 3);
+ * int i = Matrix::argmin(A);   // 0
+ *
+ * @param A the matrix
+ * @retval the index of the smallest element in the row-major order
+ */
+template <typename DType>
+int argmin(const Matrix<DType>& A) {
+    detail::TraceSpan trace("argmin", A);
+
+    const DType value = detail::full_reduce(A.data(), A.get_matrix_size(),
+                                            detail::Identity<DType>(), detail::SmallerOrNaN<DType>());
+
+    return static_cast<int>(detail::first_index_of(A.data(), A.get_matrix_size(), value));
+}
+
+/*
+ * The function that returns the indexes of the smallest elements along the axis
+ *
+ * The axis and keepdims work as in sum. The indexes are along the axis,
+ * a NaN wins as in argmin.
+ *
+ * @param A the matrix
+ * @param axis the axis that is reduced
+ * @param keepdims keeps the axis with the size 1 if it is true
+ * @retval the indexes of the smallest elements along the axis
+ */
+template <typename DType>
+Matrix<int> argmin(const Matrix<DType>& A, const int axis, const bool keepdims) {
+    detail::TraceSpan trace("argmin", A);
+
+    return detail::arg_axis(A, axis, keepdims, detail::SmallerOrNaN<DType>(),
+        [](const DType v, const DType best) { return v < best || (v != v && best == best); });
+}
+
+/*
+ * The function that returns the flat index of the largest element
+ *
+ * If the largest value appears more than once, the first index is returned.
+ * A NaN wins over every number, so the index of the first NaN is returned
+ * if there is any.
+ *
+ * Matrix::Matrix<double> A(2, 3);
+ * int i = Matrix::argmax(A);   // 5
+ *
+ * @param A the matrix
+ * @retval the index of the largest element in the row-major order
+ */
+template <typename DType>
+int argmax(const Matrix<DType>& A) {
+    detail::TraceSpan trace("argmax", A);
+
+    const DType value = detail::full_reduce(A.data(), A.get_matrix_size(),
+                                            detail::Identity<DType>(), detail::LargerOrNaN<DType>());
+
+    return static_cast<int>(detail::first_index_of(A.data(), A.get_matrix_size(), value));
+}
+
+/*
+ * The function that returns the indexes of the largest elements along the axis
+ *
+ * The axis and keepdims work as in sum. The indexes are along the axis,
+ * a NaN wins as in argmax.
+ *
+ * @param A the matrix
+ * @param axis the axis that is reduced
+ * @param keepdims keeps the axis with the size 1 if it is true
+ * @retval the indexes of the largest elements along the axis
+ */
+template <typename DType>
+Matrix<int> argmax(const Matrix<DType>& A, const int axis, const bool keepdims) {
+    detail::TraceSpan trace("argmax", A);
+
+    return detail::arg_axis(A, axis, keepdims, detail::LargerOrNaN<DType>(),
+        [](const DType v, const DType best) { return v > best || (v != v && best == best); });
+}
+
+/*
+ * The function that returns the variance of all elements of the matrix
+ *
+ * It is the population variance, the mean of the squared deviations from
+ * the mean. It is computed in two passes, which is accurate also when the
+ * mean is large compared to the deviations.
+ *
+ * @param A the matrix
+ * @retval the variance of the elements
+ */
+template <typename DType>
+DType variance(const Matrix<DType>& A) {
+    detail::TraceSpan trace("variance", A);
+
+    const DType m = mean(A);
+
+    return detail::full_sum(A.data(), A.get_matrix_size(),
+        [m](const DType v) { return (v - m) * (v - m); })
+        / static_cast<DType>(A.get_matrix_size());
+}
+
+/*
+ * The function that returns the variances along the axis
+ *
+ * The axis and keepdims work as in sum.
+ *
+ * @param A the matrix
+ * @param axis the axis that is reduced
+ * @param keepdims keeps the axis with the size 1 if it is true
+ * @retval the variances along the axis
+ */
+template <typename DType>
+Matrix<DType> variance(const Matrix<DType>& A, const int axis, const bool keepdims) {
+    MATRIX_ACCOUNT_SCOPE("variance");
+    detail::TraceSpan trace("variance", A);
+
+    const Matrix<DType> means = mean(A, axis, keepdims);
+    const DType* m = means.data();
+
+    return detail::reduce_axis<DType>(A, axis, keepdims,
+        [m](const DType* x, long length, long index) {
+            const DType mu = m[index];
+            return detail::pairwise_sum(x, length,
+                [mu](const DType v) { return (v - mu) * (v - mu); }) / static_cast<DType>(length);
+        },
+        [m](const DType* x, long length, long stride, int width, DType* out, long index, DType* scratch) {
+            const DType* mu = m + index;
+            detail::pairwise_sum_strided(x, length, stride, width, out, scratch,
+                [mu](const DType v, int i) { return (v - mu[i]) * (v - mu[i]); });
+
+            for (int i = 0; i < width; i++)
+                out[i] /= static_cast<DType>(length);
+        });
+}
+
+/*
+ * The function that returns the norm of all elements of the matrix
+ *
+ * ord is the order p of the norm (sum |x|^p)^(1/p). The default 2 is the
+ * Frobenius norm, 1 is the sum of the absolute values and INFINITY is the
+ * largest absolute value.
+ *
+ * Matrix::Matrix<double> A(1, 3);     // [[0, 1, 2]]
+ * double n = Matrix::norm(A);         // sqrt(5)
+ * double m = Matrix::norm(A, INFINITY);   // 2
+ *
+ * @param A the matrix
+ * @param ord the order of the norm
+ * @retval the norm of the elements
+ */
+template <typename DType>
+DType norm(const Matrix<DType>& A, const double ord) {
+    detail::TraceSpan trace("norm", A);
+
+    assert((ord > 0) &&
+        "The order of the norm must be positive!");
+
+    const DType* a = A.data();
+    const long n = A.get_matrix_size();
+
+    if (ord == std::numeric_limits<double>::infinity())
+        return detail::full_reduce(a, n, [](const DType v) { return std::abs(v); },
+                                   detail::Larger<DType>());
+
+    if (ord == 1)
+        return detail::full_sum(a, n, [](const DType v) { return std::abs(v); });
+
+    if (ord == 2)
+        return std::sqrt(detail::full_sum(a, n, [](const DType v) { return v * v; }));
+
+    return std::pow(detail::full_sum(a, n,
+        [ord](const DType v) { return static_cast<DType>(std::pow(std::abs(v), ord)); }), 1 / ord);
+}
+
+/*
+ * The function that returns the norms along the axis
+ *
+ * ord works as in norm of all elements, the axis and keepdims work as in sum.
+ *
+ * Matrix::Matrix<double> X(100, 3);
+ * auto row_norms = Matrix::norm(X, 2, 1, true);   // the shape (100, 1)
+ *
+ * @param A the matrix
+ * @param ord the order of the norm
+ * @param axis the axis that is reduced
+ * @param keepdims keeps the axis with the size 1 if it is true
+ * @retval the norms along the axis
+ */
+template <typename DType>
+Matrix<DType> norm(const Matrix<DType>& A, const double ord, const int axis, const bool keepdims) {
+    MATRIX_ACCOUNT_SCOPE("norm");
+    detail::TraceSpan trace("norm", A);
+
+    assert((ord > 0) &&
+        "The order of the norm must be positive!");
+
+    if (ord == std::numeric_limits<double>::infinity()) {
+        return detail::reduce_axis<DType>(A, axis, keepdims,
+            [](const DType* x, long length, long) {
+                return detail::lanes_reduce(x, length, [](const DType v) { return std::abs(v); },
+                                            detail::Larger<DType>());
+            },
+            [](const DType* x, long length, long stride, int width, DType* out, long, DType*) {
+                for (int i = 0; i < width; i++)
+                    out[i] = std::abs(x[i]);
+
+                for (long k = 1; k < length; k++) {
+                    const DType* row = x + k * stride;
+                    for (int i = 0; i < width; i++)
+                        out[i] = (std::abs(row[i]) > out[i]) ? std::abs(row[i]) : out[i];
+                }
+            });
+    }
+
+    // the sums of |x|^p, then the p-th root of every element
+    auto power = [ord](const DType v) {
+        DType a = std::abs(v);
+        return (ord == 1) ? a : (ord == 2) ? a * a : static_cast<DType>(std::pow(a, ord));
+    };
+
+    Matrix<DType> RESULT = detail::reduce_axis<DType>(A, axis, keepdims,
+        [power](const DType* x, long length, long) {
+            return detail::pairwise_sum(x, length, power);
+        },
+        [power](const DType* x, long length, long stride, int width, DType* out, long, DType* scratch) {
+            detail::pairwise_sum_strided(x, length, stride, width, out, scratch,
+                [power](const DType v, int) { return power(v); });
+        });
+
+    DType* r = RESULT.data();
+    for (int i = 0; i < RESULT.get_matrix_size(); i++)
+        r[i] = (ord == 1) ? r[i] : (ord == 2) ? std::sqrt(r[i]) : std::pow(r[i], 1 / ord);
+
+    return RESULT;
+}
+
+} // end of namespace
+
+#endif // end of _REDUCTIONS_CPP_
@@ -0,0 +1,84 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#ifndef _REDUCTIONS_H_
+#define _REDUCTIONS_H_
+
+#include <vector>
+#include "matrix.h"
+
+namespace Matrix {
+
+template <typename DType>
+DType sum(const Matrix<DType>&);
+
+template <typename DType>
+Matrix<DType> sum(const Matrix<DType>&, const int, const bool = false);
+
+template <typename DType>
+DType mean(const Matrix<DType>&);
+
+template <typename DType>
+Matrix<DType> mean(const Matrix<DType>&, const int, const bool = false);
+
+template <typename DType>
+DType min(const Matrix<DType>&);
+
+template <typename DType>
+Matrix<DType> min(const Matrix<DType>&, const int, const bool = false);
+
+template <typename DType>
+DType max(const Matrix<DType>&);
+
+template <typename DType>
+Matrix<DType> max(const Matrix<DType>&, const int, const bool = false);
+
+template <typename DType>
+int argmin(const Matrix<DType>&);
+
+template <typename DType>
+Matrix<int> argmin(const Matrix<DType>&, const int, const bool = false);
+
+template <typename DType>
+int argmax(const Matrix<DType>&);
+
+template <typename DType>
+Matrix<int> argmax(const Matrix<DType>&, const int, const bool = false);
+
+template <typename DType>
+DType variance(const Matrix<DType>&);
+
+template <typename DType>
+Matrix<DType> variance(const Matrix<DType>&, const int, const bool = false);
+
+template <typename DType>
+DType norm(const Matrix<DType>&, const double = 2);
+
+template <typename DType>
+Matrix<DType> norm(const Matrix<DType>&, const double, const int, const bool = false);
+
+} // end of namespace
+
+#include "reductions.cpp"
+#endif // end of _REDUCTIONS_H_
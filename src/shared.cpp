@@ -0,0 +1,388 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#ifndef _SHARED_CPP_
+#define _SHARED_CPP_
+
+#include "matrix.h"
+#include "shared.h"
+#include "npy.h"
+#include "mapped.h"
+#include "errors.h"
+
+#include <algorithm>   // for std::copy, std::find
+#include <atomic>      // for std::atomic
+#include <cstdint>     // for std::uint32_t, std::uint64_t, std::uintptr_t
+#include <cstring>     // for std::memcpy, std::strncmp
+#include <mutex>       // for std::mutex
+#include <new>         // for the placement new
+#include <vector>      // for std::vector
+#include <fcntl.h>     // for O_CREAT
+#include <pthread.h>   // for pthread_atfork
+#include <sys/mman.h>  // for shm_open, mmap, madvise
+#include <sys/stat.h>  // for fstat
+#include <unistd.h>    // for ftruncate, close
+
+namespace Matrix {
+
+namespace detail {
+
+static_assert(ATOMIC_LONG_LOCK_FREE == 2,
+    "The reference count in the shared memory needs the lock-free atomics!");
+
+constexpr char SHARED_MAGIC[8] = {'A', 'T', 'R', 'I', 'X', 'S', 'H', 'M'};
+constexpr std::uint32_t SHARED_VERSION = 1;
+constexpr int SHARED_MAX_DIMS = 32;
+
+// the data of the segments on the huge pages starts at and ends on this boundary
+constexpr std::size_t HUGE_PAGE_SIZE = std::size_t(2) << 20;
+
+/*
+ * The header at the start of the segment. The elements start at data, a
+ * page boundary. ready is set by the creator when the header and the
+ * elements can be used, references counts the attached matrices of all
+ * processes; the last one that is destroyed removes the segment.
+ */
+struct SharedHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t ndim;
+    char type[8];
+    std::uint64_t data;
+    std::uint64_t length;
+    std::uint32_t huge_pages;
+    std::atomic<std::uint32_t> ready;
+    std::atomic<long> references;
+    std::int32_t shape[SHARED_MAX_DIMS];
+};
+
+// the names of POSIX shared memory start with one slash
+inline std::string shared_name(const std::string& name) {
+    return (!name.empty() && name[0] == '/') ? name : "/" + name;
+}
+
+inline void advise_huge_pages(void* base, const std::size_t length) {
+#ifdef MADV_HUGEPAGE
+    madvise(base, length, MADV_HUGEPAGE);
+#else
+    (void) base;
+    (void) length;
+#endif
+}
+
+/*
+ * Maps the whole segment, on the huge pages at the address aligned to
+ * HUGE_PAGE_SIZE. mmap only aligns to the pages, so the aligned range is
+ * cut out of a larger reservation. Returns MAP_FAILED on the errors.
+ */
+inline void* map_segment(const int fd, const std::size_t length, const bool huge_pages) {
+    if (!huge_pages)
+        return mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    const std::size_t reserved = length + HUGE_PAGE_SIZE;
+    void* reservation = mmap(nullptr, reserved, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (reservation == MAP_FAILED)
+        return MAP_FAILED;
+
+    char* first = static_cast<char*>(reservation);
+    char* aligned = reinterpret_cast<char*>(
+        (reinterpret_cast<std::uintptr_t>(first) + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE);
+
+    void* base = mmap(aligned, length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+    if (base == MAP_FAILED) {
+        munmap(reservation, reserved);
+        return MAP_FAILED;
+    }
+
+    // the parts of the reservation around the segment
+    if (aligned > first)
+        munmap(first, aligned - first);
+    if (first + reserved > aligned + length)
+        munmap(aligned + length, first + reserved - (aligned + length));
+
+    advise_huge_pages(base, length);
+
+    return base;
+}
+
+// maps the header of the segment, the segment must be ready
+inline SharedHeader* map_shared_header(const int fd) {
+    struct stat status;
+    if (fstat(fd, &status) != 0 || static_cast<std::size_t>(status.st_size) < sizeof(SharedHeader))
+        throw SharedMemoryError();
+
+    void* base = mmap(nullptr, sizeof(SharedHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED)
+        throw SharedMemoryError();
+
+    SharedHeader* header = static_cast<SharedHeader*>(base);
+    if (std::memcmp(header->magic, SHARED_MAGIC, sizeof(SHARED_MAGIC)) != 0 ||
+        header->version != SHARED_VERSION || header->ready.load(std::memory_order_acquire) != 1 ||
+        static_cast<std::size_t>(status.st_size) < header->length) {
+        munmap(base, sizeof(SharedHeader));
+        throw SharedMemoryError();
+    }
+
+    return header;
+}
+
+/*
+ * The headers of the live shared matrices of this process, one for every
+ * matrix. A forked child inherits the matrices of the parent and destroys
+ * them like its own, so the child handler of fork() takes one more
+ * reference for every one of them.
+ */
+struct SharedMappings {
+    std::mutex MUTEX;
+    std::vector<SharedHeader*> HEADERS;
+
+    SharedMappings() {
+        pthread_atfork(&SharedMappings::prepare_fork, &SharedMappings::after_fork_in_parent,
+                       &SharedMappings::after_fork_in_child);
+    }
+
+    static SharedMappings& instance() {
+        static SharedMappings mappings;
+        return mappings;
+    }
+
+    static void prepare_fork() {
+        instance().MUTEX.lock();
+    }
+
+    static void after_fork_in_parent() {
+        instance().MUTEX.unlock();
+    }
+
+    static void after_fork_in_child() {
+        SharedMappings& mappings = instance();
+        for (SharedHeader* header : mappings.HEADERS)
+            header->references.fetch_add(1, std::memory_order_relaxed);
+        mappings.MUTEX.unlock();
+    }
+};
+
+// the matrix of the mapped segment that drops its reference when it is destroyed
+template <typename DType>
+Matrix<DType> shared_matrix(void* base, const std::string& name) {
+    SharedHeader* header = static_cast<SharedHeader*>(base);
+    const std::size_t length = header->length;
+
+    std::vector<int> shape(header->shape, header->shape + header->ndim);
+    DType* data = reinterpret_cast<DType*>(static_cast<char*>(base) + header->data);
+
+    SharedMappings& mappings = SharedMappings::instance();
+    {
+        std::lock_guard<std::mutex> lock(mappings.MUTEX);
+        mappings.HEADERS.push_back(header);
+    }
+
+    return adopt<DType>(data, shape, [base, length, name](DType*) {
+        SharedHeader* header = static_cast<SharedHeader*>(base);
+
+        SharedMappings& mappings = SharedMappings::instance();
+        {
+            std::lock_guard<std::mutex> lock(mappings.MUTEX);
+            mappings.HEADERS.erase(std::find(mappings.HEADERS.begin(), mappings.HEADERS.end(), header));
+        }
+
+        if (header->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            shm_unlink(name.c_str());
+        munmap(base, length);
+    });
+}
+
+} // end of namespace detail
+
+/*
+ * The function that creates the matrix in the named POSIX shared memory segment
+ *
+ * The segment has a small header with the element type and the shape, and
+ * the elements from the next page boundary on. The other processes attach
+ * the same elements by attach_shared without copying them. The segment is
+ * removed when the last matrix of all processes that use it is destroyed.
+ * The elements are zeros.
+ *
+ * A forked child holds its own reference to every shared matrix it inherits,
+ * which is dropped when the copy of the child is destroyed. A child that ends
+ * by _exit or exec without destroying its copies leaves their references
+ * behind, and the segment is then not removed until remove_shared is called.
+ *
+ * With the huge pages the elements are aligned to 2 MB and the kernel is
+ * asked to back the segment by the transparent huge pages, which needs
+ * shmem_enabled of the transparent huge pages to be advise or always.
+ *
+ * Matrix::Matrix<float> W = Matrix::create_shared<float>("weights", {8192, 8192}, true);
+ * fill(W);
+ * // in the other processes
+ * Matrix::Matrix<float> W = Matrix::attach_shared<float>("weights");
+ *
+ * @param name the name of the segment
+ * @param shape the shape of the matrix
+ * @param huge_pages backs the segment by the huge pages if it is true
+ * @retval the matrix in the segment
+ * @throw SharedMemoryError if the segment already exists or it could not be created
+ */
+template <typename DType>
+Matrix<DType> create_shared(const std::string& name, const std::vector<int>& shape, const bool huge_pages) {
+    assert(shape.size() > 0 && shape.size() <= static_cast<std::size_t>(detail::SHARED_MAX_DIMS) &&
+        "The shared matrix must have from 1 to 32 dimensions!");
+
+    std::size_t size = sizeof(DType);
+    for (auto dim : shape) {
+        assert(dim > 0 &&
+            "The dimensions of matrix cannot nonpozitive");
+        size *= dim;
+    }
+
+    const std::size_t alignment = huge_pages ? detail::HUGE_PAGE_SIZE : detail::page_size();
+    const std::size_t data = (sizeof(detail::SharedHeader) + alignment - 1) / alignment * alignment;
+    const std::size_t length = (data + size + alignment - 1) / alignment * alignment;
+
+    const std::string path = detail::shared_name(name);
+    int fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+        throw SharedMemoryError();
+
+    void* base = MAP_FAILED;
+    if (ftruncate(fd, length) == 0)
+        base = detail::map_segment(fd, length, huge_pages);
+    close(fd);
+
+    if (base == MAP_FAILED) {
+        shm_unlink(path.c_str());
+        throw SharedMemoryError();
+    }
+
+    // the new segment is zeros, the header is written before it is ready
+    detail::SharedHeader* header = new (base) detail::SharedHeader();
+    std::memcpy(header->magic, detail::SHARED_MAGIC, sizeof(detail::SHARED_MAGIC));
+    header->version = detail::SHARED_VERSION;
+    header->ndim = shape.size();
+    std::strncpy(header->type, detail::npy_type<DType>().c_str(), sizeof(header->type) - 1);
+    header->data = data;
+    header->length = length;
+    header->huge_pages = huge_pages;
+    header->references.store(1, std::memory_order_relaxed);
+    std::copy(shape.begin(), shape.end(), header->shape);
+    header->ready.store(1, std::memory_order_release);
+
+    return detail::shared_matrix<DType>(base, path);
+}
+
+/*
+ * The function that attaches the matrix in the shared memory segment
+ *
+ * The matrix is the same memory as the matrices of the segment in the other
+ * processes, the changes of the elements are seen by all of them.
+ *
+ * @param name the name of the segment
+ * @retval the matrix in the segment
+ * @throw SharedMemoryError if there is no such segment, it is not ready or it is not a matrix of DType
+ */
+template <typename DType>
+Matrix<DType> attach_shared(const std::string& name) {
+    const std::string path = detail::shared_name(name);
+    int fd = shm_open(path.c_str(), O_RDWR, 0);
+    if (fd < 0)
+        throw SharedMemoryError();
+
+    detail::SharedHeader* header;
+    try {
+        header = detail::map_shared_header(fd);
+    } catch (...) {
+        close(fd);
+        throw;
+    }
+
+    const std::size_t length = header->length;
+    const bool huge_pages = header->huge_pages;
+    const bool matches = std::strncmp(header->type, detail::npy_type<DType>().c_str(), sizeof(header->type)) == 0 &&
+                         header->ndim >= 1 && header->ndim <= static_cast<std::uint32_t>(detail::SHARED_MAX_DIMS);
+    munmap(header, sizeof(detail::SharedHeader));
+
+    if (!matches) {
+        close(fd);
+        throw SharedMemoryError();
+    }
+
+    void* base = detail::map_segment(fd, length, huge_pages);
+    close(fd);
+
+    if (base == MAP_FAILED)
+        throw SharedMemoryError();
+
+    header = static_cast<detail::SharedHeader*>(base);
+
+    // the segment whose last matrix is being destroyed is not attached again
+    long references = header->references.load(std::memory_order_relaxed);
+    do {
+        if (references <= 0) {
+            munmap(base, length);
+            throw SharedMemoryError();
+        }
+    } while (!header->references.compare_exchange_weak(references, references + 1, std::memory_order_acq_rel));
+
+    return detail::shared_matrix<DType>(base, path);
+}
+
+/*
+ * The function that returns the number of the matrices of all processes
+ * that use the segment
+ *
+ * @param name the name of the segment
+ * @retval the number of the references, 0 if there is no such segment
+ */
+inline long shared_references(const std::string& name) {
+    int fd = shm_open(detail::shared_name(name).c_str(), O_RDWR, 0);
+    if (fd < 0)
+        return 0;
+
+    long references = 0;
+    try {
+        detail::SharedHeader* header = detail::map_shared_header(fd);
+        references = header->references.load(std::memory_order_acquire);
+        munmap(header, sizeof(detail::SharedHeader));
+    } catch (...) {
+    }
+
+    close(fd);
+    return references;
+}
+
+/*
+ * The function that removes the name of the segment, like the matrices of
+ * a crashed process that were never destroyed. The processes that use the
+ * segment keep using it, the new ones can not attach it.
+ *
+ * @param name the name of the segment
+ * @retval None
+ */
+inline void remove_shared(const std::string& name) {
+    shm_unlink(detail::shared_name(name).c_str());
+}
+
+} // end of namespace
+
+#endif // end of _SHARED_CPP_
@@ -0,0 +1,422 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#ifndef _SOFTMAX_CPP_
+#define _SOFTMAX_CPP_
+
+#include "matrix.h"
+#include "softmax.h"
+#include "reductions.h"
+#include "parallel.h"
+
+#include <cmath>       // for std::exp, std::log
+#include <limits>      // for std::numeric_limits
+#include <type_traits> // for std::is_floating_point
+#include <assert.h>    // for assert
+
+namespace Matrix {
+
+namespace detail {
+
+// the lines are processed in the blocks of this many elements, a block is
+// still in L1 when it is read again for its exps after its maximum
+constexpr long SOFTMAX_BLOCK = 2048;
+
+/*
+ * Merges the pair (m2, s2) into (m, s) where m is the largest element of
+ * some elements and s the sum of their exp(x - m), the online normalizer of
+ * M. Milakov and N. Gimelshein, "Online normalizer calculation for softmax".
+ * The sum with the smaller maximum is rescaled. The elements -inf add
+ * nothing, the pair of them is (-inf, 0).
+ */
+template <typename DType>
+inline void online_merge(DType& m, DType& s, const DType m2, const DType s2) {
+    if (m2 > m) {
+        s = s * std::exp(m - m2) + s2;
+        m = m2;
+    } else if (m2 != -std::numeric_limits<DType>::infinity()) {
+        s += s2 * std::exp(m2 - m);
+    }
+}
+
+// the number subtracted before exp, it keeps exp(x - shift) <= 1; the lines
+// of -inf are shifted by 0 and give exp(x) = 0
+template <typename DType>
+inline DType exp_shift(const DType m) {
+    return (m == -std::numeric_limits<DType>::infinity()) ? DType(0) : m;
+}
+
+// the sum of exp(x[i] - shift) in SIMD_LANES lanes, the exps are stored in out if it is given
+template <typename DType>
+DType exp_sum(const DType* x, const long n, const DType shift, DType* out) {
+    constexpr int L = SIMD_LANES;
+
+    DType acc[L] = {};
+    long i = 0;
+
+    for (; i + L <= n; i += L) {
+        for (int l = 0; l < L; l++) {
+            const DType e = std::exp(x[i + l] - shift);
+            if (out)
+                out[i + l] = e;
+            acc[l] += e;
+        }
+    }
+
+    DType s = 0;
+    for (int l = 0; l < L; l++)
+        s += acc[l];
+
+    for (; i < n; i++) {
+        const DType e = std::exp(x[i] - shift);
+        if (out)
+            out[i] = e;
+        s += e;
+    }
+
+    return s;
+}
+
+/*
+ * The largest element m of the contiguous x and the sum s of exp(x - m) in
+ * one pass over the memory. The maximum of every block is found first, then
+ * the block is read again from the cache for its exps, and the pair of the
+ * block is merged into (m, s). So every element needs one exp, and the line
+ * is not read a second time for the maximum alone. If out is given, the exps
+ * of every block are stored there, shifted by the maximum of the block that
+ * is stored in maxima.
+ */
+template <typename DType>
+void online_exp_sum(const DType* x, const long n, DType& m, DType& s,
+                    DType* out = nullptr, DType* maxima = nullptr) {
+
+    m = -std::numeric_limits<DType>::infinity();
+    s = 0;
+
+    for (long b = 0; b * SOFTMAX_BLOCK < n; b++) {
+        const long first = b * SOFTMAX_BLOCK;
+        const long count = std::min(SOFTMAX_BLOCK, n - first);
+
+        const DType block_max = lanes_reduce(x + first, count, Identity<DType>(), Larger<DType>());
+        const DType shift = exp_shift(block_max);
+        const DType block_sum = exp_sum(x + first, count, shift, out ? out + first : nullptr);
+
+        if (maxima)
+            maxima[b] = block_max;
+
+        online_merge(m, s, block_max, block_sum);
+    }
+}
+
+/*
+ * The softmax of the contiguous x of length n. The exps of the blocks are
+ * stored in out by online_exp_sum, then every block is rescaled from its own
+ * maximum to the maximum of the line and normalized. So x is read once and
+ * out is written twice, instead of reading x twice more in three passes.
+ * The blocks of -inf get the scale exp(-inf) = 0 next to the finite blocks,
+ * whatever the maximum of the line is.
+ */
+template <typename DType>
+void softmax_line(const DType* x, DType* out, const long n) {
+    std::vector<DType> maxima((n + SOFTMAX_BLOCK - 1) / SOFTMAX_BLOCK);
+
+    DType m, s;
+    online_exp_sum(x, n, m, s, out, maxima.data());
+
+    const DType shift = exp_shift(m);
+
+    for (long b = 0; b < static_cast<long>(maxima.size()); b++) {
+        const DType scale = std::exp(maxima[b] - shift) / s;
+        DType* block = out + b * SOFTMAX_BLOCK;
+        const long count = std::min(SOFTMAX_BLOCK, n - b * SOFTMAX_BLOCK);
+
+        for (long i = 0; i < count; i++)
+            block[i] *= scale;
+    }
+}
+
+// the log-softmax of the contiguous x of length n, x - logsumexp(x)
+template <typename DType>
+void log_softmax_line(const DType* x, DType* out, const long n) {
+    DType m, s;
+    online_exp_sum(x, n, m, s);
+
+    const DType lse = exp_shift(m) + std::log(s);
+    for (long i = 0; i < n; i++)
+        out[i] = x[i] - lse;
+}
+
+/*
+ * The maximum m[i] and the sum s[i] of exp(x - m[i]) of the columns i < width
+ * of the block whose length rows are stride elements apart. The rows are
+ * read whole, so the inner loops are over the contiguous columns. If exps is
+ * not null, the exps are stored there with the same layout.
+ */
+template <typename DType>
+void block_exp_sum(const DType* x, const long length, const long stride, const int width,
+                   DType* m, DType* s, DType* exps) {
+
+    for (int i = 0; i < width; i++)
+        m[i] = x[i];
+
+    for (long k = 1; k < length; k++) {
+        const DType* row = x + k * stride;
+        for (int i = 0; i < width; i++)
+            m[i] = (row[i] > m[i]) ? row[i] : m[i];
+    }
+
+    for (int i = 0; i < width; i++) {
+        m[i] = exp_shift(m[i]);
+        s[i] = 0;
+    }
+
+    for (long k = 0; k < length; k++) {
+        const DType* row = x + k * stride;
+        for (int i = 0; i < width; i++) {
+            const DType e = std::exp(row[i] - m[i]);
+            if (exps)
+                exps[k * stride + i] = e;
+            s[i] += e;
+        }
+    }
+}
+
+/*
+ * The driver of the functions that map the lines along one axis to lines of
+ * the same length, like softmax. The matrix is seen as (outer, length, inner)
+ * as in reduce_axis. If the axis is the last one, line(x, out, length) maps
+ * every contiguous line. Otherwise block(x, out, length, inner, width, m, s)
+ * maps the blocks of REDUCTION_WIDTH columns, m and s are scratch for width
+ * elements each.
+ */
+template <typename DType, typename Line, typename Block>
+Matrix<DType> map_axis(const Matrix<DType>& A, int axis, Line line, Block block) {
+    auto shape = A.get_shape();
+    const int ndim = shape.size();
+
+    if (axis < 0)
+        axis += ndim;
+
+    assert((axis >= 0 && axis < ndim) &&
+        "Invalid axis!");
+
+    long outer = 1;
+    long inner = 1;
+    const long length = shape[axis];
+
+    for (int d = 0; d < axis; d++)
+        outer *= shape[d];
+    for (int d = axis + 1; d < ndim; d++)
+        inner *= shape[d];
+
+    Matrix<DType> RESULT = matrix_with_shape<DType>(shape);
+
+    const DType* a = A.data();
+    DType* out = RESULT.data();
+
+    if (inner == 1) {
+        parallel_for(0, outer, std::max(1L, PARALLEL_MIN_WORK / length), [&](long first, long last) {
+            for (long o = first; o < last; o++)
+                line(a + o * length, out + o * length, length);
+        });
+
+        return RESULT;
+    }
+
+    const long blocks = (inner + REDUCTION_WIDTH - 1) / REDUCTION_WIDTH;
+
+    parallel_for(0, outer * blocks, std::max(1L, PARALLEL_MIN_WORK / (length * REDUCTION_WIDTH)),
+        [&](long first, long last) {
+            std::vector<DType> scratch(2 * REDUCTION_WIDTH);
+
+            for (long item = first; item < last; item++) {
+                long offset = (item / blocks) * length * inner + (item % blocks) * REDUCTION_WIDTH;
+                int width = std::min<long>(REDUCTION_WIDTH, inner - (item % blocks) * REDUCTION_WIDTH);
+
+                block(a + offset, out + offset, length, inner, width,
+                      scratch.data(), scratch.data() + REDUCTION_WIDTH);
+            }
+        });
+
+    return RESULT;
+}
+
+} // end of namespace detail
+
+/*
+ * The function that returns the softmax along the axis
+ *
+ * softmax(x)_i = exp(x_i) / sum_j exp(x_j) over every line along the axis.
+ * The largest element of the line is subtracted before exp, so the large
+ * logits don't overflow. The lines are done block by block with the online
+ * normalizer: the exps are computed once against the maximum of their block,
+ * stored in the result, and rescaled to the maximum of the line in place at
+ * the end. So the input is read once, and no temporary matrix is made. The
+ * lines run on the thread pool.
+ *
+ * Matrix::Matrix<double> logits(64, 1000);
+ * Matrix::Matrix<double> P = Matrix::softmax(logits);   // every row sums to 1
+ *
+ * @param A the matrix of the floating point type
+ * @param axis the axis of the lines, the last one by default
+ * @retval the matrix with the shape of A
+ */
+template <typename DType>
+Matrix<DType> softmax(const Matrix<DType>& A, const int axis) {
+    MATRIX_ACCOUNT_SCOPE("softmax");
+    detail::TraceSpan trace("softmax", A);
+
+    assert((std::is_floating_point<DType>::value) &&
+        "DType must be a floating point type!");
+
+    return detail::map_axis(A, axis,
+        [](const DType* x, DType* out, long length) {
+            detail::softmax_line(x, out, length);
+        },
+        [](const DType* x, DType* out, long length, long stride, int width, DType* m, DType* s) {
+            detail::block_exp_sum(x, length, stride, width, m, s, out);
+
+            for (int i = 0; i < width; i++)
+                s[i] = 1 / s[i];
+
+            for (long k = 0; k < length; k++)
+                for (int i = 0; i < width; i++)
+                    out[k * stride + i] *= s[i];
+        });
+}
+
+/*
+ * The function that returns the logarithm of softmax along the axis
+ *
+ * log_softmax(x)_i = x_i - logsumexp(x) is computed directly, it is exact
+ * where log(softmax(x)) underflows to -inf. The line is read once for its
+ * log-sum-exp with the online normalizer and once for the result.
+ *
+ * Matrix::Matrix<double> log_p = Matrix::log_softmax(logits);
+ *
+ * @param A the matrix of the floating point type
+ * @param axis the axis of the lines, the last one by default
+ * @retval the matrix with the shape of A
+ */
+template <typename DType>
+Matrix<DType> log_softmax(const Matrix<DType>& A, const int axis) {
+    MATRIX_ACCOUNT_SCOPE("log_softmax");
+    detail::TraceSpan trace("log_softmax", A);
+
+    assert((std::is_floating_point<DType>::value) &&
+        "DType must be a floating point type!");
+
+    return detail::map_axis(A, axis,
+        [](const DType* x, DType* out, long length) {
+            detail::log_softmax_line(x, out, length);
+        },
+        [](const DType* x, DType* out, long length, long stride, int width, DType* m, DType* s) {
+            detail::block_exp_sum<DType>(x, length, stride, width, m, s, nullptr);
+
+            for (int i = 0; i < width; i++)
+                m[i] += std::log(s[i]);
+
+            for (long k = 0; k < length; k++)
+                for (int i = 0; i < width; i++)
+                    out[k * stride + i] = x[k * stride + i] - m[i];
+        });
+}
+
+/*
+ * The function that returns log(sum(exp(A))) of all elements without overflow
+ *
+ * The maximum and the sum of the exps are found in one pass with the online
+ * normalizer (see softmax), in the fixed chunks of the reductions, so the result
+ * doesn't depend on the number of threads.
+ *
+ * Matrix::Matrix<double> A(1, 2);   // [[0, 1]]
+ * double l = Matrix::logsumexp(A);  // log(1 + e)
+ *
+ * @param A the matrix of the floating point type
+ * @retval the log-sum-exp of the elements
+ */
+template <typename DType>
+DType logsumexp(const Matrix<DType>& A) {
+    detail::TraceSpan trace("logsumexp", A);
+
+    assert((std::is_floating_point<DType>::value) &&
+        "DType must be a floating point type!");
+
+    const DType* a = A.data();
+    const long n = A.get_matrix_size();
+    const long chunks = (n + detail::REDUCTION_CHUNK - 1) / detail::REDUCTION_CHUNK;
+
+    std::vector<DType> m(chunks), s(chunks);
+
+    parallel_for(0, chunks, 1, [&](long first, long last) {
+        for (long c = first; c < last; c++)
+            detail::online_exp_sum(a + c * detail::REDUCTION_CHUNK,
+                                   std::min(detail::REDUCTION_CHUNK, n - c * detail::REDUCTION_CHUNK),
+                                   m[c], s[c]);
+    });
+
+    for (long c = 1; c < chunks; c++)
+        detail::online_merge(m[0], s[0], m[c], s[c]);
+
+    return detail::exp_shift(m[0]) + std::log(s[0]);
+}
+
+/*
+ * The function that returns the log-sum-exp along the axis
+ *
+ * The axis and keepdims work as in sum.
+ *
+ * Matrix::Matrix<double> logits(64, 1000);
+ * auto normalizers = Matrix::logsumexp(logits, 1, true);   // the shape (64, 1)
+ *
+ * @param A the matrix of the floating point type
+ * @param axis the axis that is reduced
+ * @param keepdims keeps the axis with the size 1 if it is true
+ * @retval the log-sum-exps along the axis
+ */
+template <typename DType>
+Matrix<DType> logsumexp(const Matrix<DType>& A, const int axis, const bool keepdims) {
+    MATRIX_ACCOUNT_SCOPE("logsumexp");
+    detail::TraceSpan trace("logsumexp", A);
+
+    assert((std::is_floating_point<DType>::value) &&
+        "DType must be a floating point type!");
+
+    return detail::reduce_axis<DType>(A, axis, keepdims,
+        [](const DType* x, long length, long) {
+            DType m, s;
+            detail::online_exp_sum(x, length, m, s);
+            return detail::exp_shift(m) + std::log(s);
+        },
+        [](const DType* x, long length, long stride, int width, DType* out, long, DType* scratch) {
+            detail::block_exp_sum<DType>(x, length, stride, width, out, scratch, nullptr);
+
+            for (int i = 0; i < width; i++)
+                out[i] += std::log(scratch[i]);
+        });
+}
+
+} // end of namespace
+
+#endif // end of _SOFTMAX_CPP_
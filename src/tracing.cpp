@@ -0,0 +1,266 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#ifndef _TRACING_CPP_
+#define _TRACING_CPP_
+
+#include "tracing.h"
+#include "errors.h"
+
+#include <algorithm> // for std::max, std::min
+#include <atomic>    // for std::atomic_thread_fence
+#include <chrono>    // for std::chrono::steady_clock
+#include <fstream>   // for std::ofstream
+#include <memory>    // for std::shared_ptr
+#include <mutex>     // for std::mutex
+#include <unistd.h>  // for getpid
+
+namespace Matrix {
+
+namespace detail {
+
+// constant initialized, so checking it costs one load and one branch
+inline std::atomic<bool>& tracing_flag() {
+    static std::atomic<bool> flag(false);
+    return flag;
+}
+
+inline long trace_clock() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*
+ * The ring buffer of one thread. Only the owner thread writes the events
+ * and HEAD, the export reads the events below HEAD, so no lock is taken
+ * while the spans are recorded.
+ */
+struct TraceBuffer {
+    explicit TraceBuffer(const int thread)
+    : THREAD(thread), EVENTS(TRACE_CAPACITY), HEAD(0), TAIL(0)
+    {
+    }
+
+    const int THREAD;
+    std::vector<TraceEvent> EVENTS;
+    std::atomic<long> HEAD; // the number of the events written
+    std::atomic<long> TAIL; // the first event after the last clear_trace
+};
+
+struct TraceRegistry {
+    std::mutex MUTEX; // guards BUFFERS, taken once per thread and by the export
+    std::vector<std::shared_ptr<TraceBuffer>> BUFFERS;
+};
+
+// never destroyed, the buffers outlive their threads until the export
+inline TraceRegistry& trace_registry() {
+    static TraceRegistry* registry = new TraceRegistry();
+    return *registry;
+}
+
+inline TraceBuffer& thread_trace_buffer() {
+    thread_local std::shared_ptr<TraceBuffer> buffer;
+
+    if (!buffer) {
+        TraceRegistry& registry = trace_registry();
+        std::lock_guard<std::mutex> lock(registry.MUTEX);
+
+        buffer = std::make_shared<TraceBuffer>(static_cast<int>(registry.BUFFERS.size()) + 1);
+        registry.BUFFERS.push_back(buffer);
+    }
+
+    return *buffer;
+}
+
+inline void TraceSpan::begin(const char* name) {
+    EVENT.name = name;
+    EVENT.flops = 0;
+    EVENT.operands = 0;
+    EVENT.start = trace_clock();
+}
+
+inline void TraceSpan::end() {
+    EVENT.end = trace_clock();
+
+    TraceBuffer& buffer = thread_trace_buffer();
+    const long head = buffer.HEAD.load(std::memory_order_relaxed);
+
+    buffer.EVENTS[head % TRACE_CAPACITY] = EVENT;
+    buffer.HEAD.store(head + 1, std::memory_order_release);
+}
+
+inline void TraceSpan::add_operand(const std::vector<int>& shape) {
+    if (EVENT.operands == TRACE_OPERANDS)
+        return;
+
+    const int operand = EVENT.operands++;
+    EVENT.ndims[operand] = shape.size();
+    for (int i = 0; i < std::min<int>(shape.size(), TRACE_DIMS); i++)
+        EVENT.shape[operand][i] = shape[i];
+}
+
+struct ThreadEvent {
+    int thread;
+    TraceEvent event;
+};
+
+// the events of all threads, the ones overwritten during the copy are dropped
+inline std::vector<ThreadEvent> collect_trace() {
+    TraceRegistry& registry = trace_registry();
+    std::lock_guard<std::mutex> lock(registry.MUTEX);
+
+    std::vector<ThreadEvent> events;
+    for (auto& buffer : registry.BUFFERS) {
+        const long head = buffer->HEAD.load(std::memory_order_acquire);
+        const long first = std::max(buffer->TAIL.load(std::memory_order_relaxed), head - TRACE_CAPACITY);
+        const std::size_t begin = events.size();
+
+        for (long i = first; i < head; i++)
+            events.push_back({buffer->THREAD, buffer->EVENTS[i % TRACE_CAPACITY]});
+
+        // the copies are read before HEAD again, the event at HEAD may be half
+        // written over the oldest one, so it is dropped with the overwritten ones
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const long overwritten = buffer->HEAD.load(std::memory_order_relaxed) + 1 - TRACE_CAPACITY - first;
+        if (overwritten > 0)
+            events.erase(events.begin() + begin, events.begin() + begin + std::min<long>(overwritten, head - first));
+    }
+
+    return events;
+}
+
+inline void write_trace_shape(std::ostream& out, const TraceEvent& event, const int operand) {
+    out << "(";
+    for (int i = 0; i < std::min(event.ndims[operand], TRACE_DIMS); i++)
+        out << (i ? ", " : "") << event.shape[operand][i];
+    if (event.ndims[operand] > TRACE_DIMS)
+        out << ", ...";
+    out << ")";
+}
+
+} // end of namespace detail
+
+/*
+ * The functions that turn the tracing on and off at runtime, it is off by
+ * default. The spans that are open while it is switched are recorded as
+ * they started.
+ *
+ * Matrix::set_tracing(true);
+ * Matrix::Matrix<double> C = Matrix::dot(A, B);
+ * Matrix::export_chrome_trace("trace.json");
+ *
+ * @param enabled records the spans if it is true
+ * @retval None
+ */
+inline void set_tracing(const bool enabled) {
+    detail::tracing_flag().store(enabled, std::memory_order_relaxed);
+}
+
+inline bool get_tracing() {
+    return detail::tracing_flag().load(std::memory_order_relaxed);
+}
+
+/*
+ * The function that drops the spans recorded so far by all threads.
+ */
+inline void clear_trace() {
+    detail::TraceRegistry& registry = detail::trace_registry();
+    std::lock_guard<std::mutex> lock(registry.MUTEX);
+
+    for (auto& buffer : registry.BUFFERS)
+        buffer->TAIL.store(buffer->HEAD.load(std::memory_order_acquire), std::memory_order_relaxed);
+}
+
+/*
+ * The function that writes the recorded spans in the Chrome trace event
+ * format, which chrome://tracing and Perfetto open
+ *
+ * Every span is the complete event ("ph": "X") of its thread with the
+ * operand shapes, and the FLOP count and rate when the operation reports
+ * them, as the arguments. The times are in microseconds from the first
+ * span. The spans are kept, the export can be repeated.
+ *
+ * @param out the stream to write to
+ * @retval None
+ * @throw SerializationError if the trace could not be written
+ */
+inline void export_chrome_trace(std::ostream& out) {
+    std::vector<detail::ThreadEvent> events = detail::collect_trace();
+
+    long origin = 0;
+    if (!events.empty()) {
+        origin = events[0].event.start;
+        for (auto& e : events)
+            origin = std::min(origin, e.event.start);
+    }
+
+    const std::ios::fmtflags flags = out.flags();
+    const std::streamsize precision = out.precision();
+    out.setf(std::ios::fixed, std::ios::floatfield);
+    out.precision(3);
+
+    const int pid = getpid();
+
+    out << "{\"traceEvents\": [";
+    for (std::size_t i = 0; i < events.size(); i++) {
+        const detail::TraceEvent& event = events[i].event;
+        const double duration = (event.end - event.start) / 1e3;
+
+        out << (i ? ",\n" : "\n")
+            << "{\"name\": \"" << event.name << "\", \"cat\": \"atrix\", \"ph\": \"X\""
+            << ", \"ts\": " << (event.start - origin) / 1e3
+            << ", \"dur\": " << duration
+            << ", \"pid\": " << pid
+            << ", \"tid\": " << events[i].thread
+            << ", \"args\": {\"shapes\": \"";
+        for (int operand = 0; operand < event.operands; operand++) {
+            out << (operand ? " " : "");
+            detail::write_trace_shape(out, event, operand);
+        }
+        out << "\"";
+
+        if (event.flops > 0) {
+            out << ", \"flops\": " << event.flops;
+            if (duration > 0)
+                out << ", \"GFLOP/s\": " << event.flops / (duration * 1e3);
+        }
+        out << "}}";
+    }
+    out << "\n], \"displayTimeUnit\": \"ns\"}\n";
+
+    out.flags(flags);
+    out.precision(precision);
+
+    if (!out)
+        throw SerializationError();
+}
+
+inline void export_chrome_trace(const std::string& path) {
+    std::ofstream out(path);
+    export_chrome_trace(out);
+}
+
+} // end of namespace Matrix
+
+#endif // end of _TRACING_CPP_
@@ -0,0 +1,131 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#ifndef _TRACING_H_
+#define _TRACING_H_
+
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace Matrix {
+
+/*
+ * The tracing records the spans of the public operations, like dot, the
+ * decompositions, the element-wise operators and the I/O, with their start
+ * and end, thread, operand shapes and FLOP count. Every thread writes its
+ * spans into its own ring buffer without locks, the oldest spans are
+ * overwritten when the buffer is full. The tracing is off by default, an
+ * operation checks one flag then.
+ */
+
+namespace detail {
+
+// the spans kept per thread
+constexpr long TRACE_CAPACITY = 1L << 16;
+
+// the operands whose shapes are kept, and their dimensions
+constexpr int TRACE_OPERANDS = 3;
+constexpr int TRACE_DIMS = 4;
+
+struct TraceEvent {
+    const char* name;
+    long start;   // nanoseconds of the steady clock
+    long end;
+    double flops;
+    int operands;
+    int ndims[TRACE_OPERANDS];
+    int shape[TRACE_OPERANDS][TRACE_DIMS];
+};
+
+inline std::atomic<bool>& tracing_flag();
+
+/*
+ * The span of one operation, recorded into the ring buffer of the thread
+ * when it is destroyed. The shapes of the operands are kept, anything with
+ * get_shape() can be an operand.
+ *
+ * detail::TraceSpan trace("dot", A, B);
+ * trace.set_flops(2.0 * M * N * K);
+ */
+class TraceSpan {
+public:
+    template <typename... Operands>
+    explicit TraceSpan(const char* name, const Operands&... operands)
+    : ACTIVE(tracing_flag().load(std::memory_order_relaxed))
+    {
+        if (ACTIVE) {
+            begin(name);
+            int unused[] = {0, (add_operand(operands.get_shape()), 0)...};
+            (void) unused;
+        }
+    }
+
+    ~TraceSpan() {
+        if (ACTIVE)
+            end();
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    // the operands that are known only later, like the loaded matrix
+    template <typename Operand>
+    void add(const Operand& operand) {
+        if (ACTIVE)
+            add_operand(operand.get_shape());
+    }
+
+    void set_flops(const double flops) {
+        if (ACTIVE)
+            EVENT.flops = flops;
+    }
+
+private:
+    void begin(const char*);
+    void end();
+    void add_operand(const std::vector<int>&);
+
+    bool ACTIVE;
+    TraceEvent EVENT;
+};
+
+} // end of namespace detail
+
+void set_tracing(const bool);
+
+bool get_tracing();
+
+void clear_trace();
+
+void export_chrome_trace(std::ostream&);
+
+void export_chrome_trace(const std::string&);
+
+} // end of namespace Matrix
+
+#include "tracing.cpp"
+
+#endif // end of _TRACING_H_
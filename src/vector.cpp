@@ -63,6 +63,7 @@ Vector<DType>::Vector(Matrix<DType> A)
 
 template <typename DType>
 double vector_dot(const Vector<DType> u, const Vector<DType> v) {
+    MATRIX_ACCOUNT_SCOPE("vector_dot");
 
     auto u_shape = u.get_shape();
     auto v_shape = v.get_shape();
@@ -83,6 +84,8 @@ double vector_dot(const Vector<DType> u, const Vector<DType> v) {
 
 template <typename DType>
 std::vector<Vector<DType>> to_column_vectors(const Matrix<DType> A) {
+    MATRIX_ACCOUNT_SCOPE("to_column_vectors");
+
     // assert 0 <= K < N
 
     auto __shape = A.get_shape();
@@ -103,6 +106,8 @@ std::vector<Vector<DType>> to_column_vectors(const Matrix<DType> A) {
 
 template <typename DType>
 std::vector<Vector<DType>> to_row_vectors(const Matrix<DType> A) {
+    MATRIX_ACCOUNT_SCOPE("to_row_vectors");
+
     // assert 0 <= K < N
 
     auto __shape = A.get_shape();
@@ -123,6 +128,8 @@ std::vector<Vector<DType>> to_row_vectors(const Matrix<DType> A) {
 
 template <typename DType>
 Matrix<DType> from_column_vectors(const std::vector<Vector<DType>> column_vectors) {
+    MATRIX_ACCOUNT_SCOPE("from_column_vectors");
+
     // assert vector shapes are same format and column_vectors is not empty
     int N = column_vectors[0].get_matrix_size();
     int M = column_vectors.size();
@@ -137,6 +144,8 @@ Matrix<DType> from_column_vectors(const std::vector<Vector<DType>> column_vector
 
 template <typename DType>
 Matrix<DType> from_row_vectors(const std::vector<Vector<DType>> row_vectors) {
+    MATRIX_ACCOUNT_SCOPE("from_row_vectors");
+
     // assert vector shapes are same format and row_vectors is not empty
     int N = row_vectors.size();
     int M = row_vectors[0].get_matrix_size();
@@ -0,0 +1,192 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+#define MATRIX_ACCOUNTING
+
+#include <gtest/gtest.h>
+#include <sstream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <atrix/matrix.h>
+#include <atrix/accounting.h>
+#include <atrix/epilogue.h>
+#include <atrix/linalg/algorithms.h>
+
+TEST(ACCOUNTING, ENABLED) {
+    EXPECT_TRUE(Matrix::accounting_enabled());
+}
+
+TEST(ACCOUNTING, CONSTRUCT_AND_FREE) {
+    Matrix::reset_allocation_stats();
+
+    {
+        Matrix::Matrix<double> A(10, 10);
+
+        auto stats = Matrix::get_allocation_stats()["construct"];
+        EXPECT_EQ(stats.allocations, 1);
+        EXPECT_EQ(stats.bytes_allocated, 800);
+        EXPECT_EQ(stats.copies, 0);
+        EXPECT_EQ(stats.live_bytes, 800);
+    }
+
+    auto stats = Matrix::get_allocation_stats()["construct"];
+    EXPECT_EQ(stats.live_bytes, 0);
+    EXPECT_EQ(stats.peak_bytes, 800);
+
+    auto total = Matrix::get_total_allocation_stats();
+    EXPECT_EQ(total.allocations, 1);
+    EXPECT_EQ(total.live_bytes, 0);
+    EXPECT_EQ(total.peak_bytes, 800);
+}
+
+TEST(ACCOUNTING, COPIES_AND_MOVES) {
+    Matrix::Matrix<float> A(4, 8);
+    Matrix::reset_allocation_stats();
+
+    Matrix::Matrix<float> B(A);
+    Matrix::Matrix<float> C(1);
+    C = B;
+    Matrix::Matrix<float> D(std::move(B));
+    C = std::move(D);
+
+    auto copy = Matrix::get_allocation_stats()["copy"];
+    EXPECT_EQ(copy.copies, 2);
+    EXPECT_EQ(copy.bytes_copied, 2 * 32 * 4);
+    EXPECT_EQ(copy.allocations, 2);
+
+    // the moves do not allocate, the storage of B lives on in C
+    auto total = Matrix::get_total_allocation_stats();
+    EXPECT_EQ(total.allocations, 3);
+    EXPECT_EQ(total.live_bytes, 2 * 32 * 4);
+}
+
+TEST(ACCOUNTING, OPERATION_SCOPES) {
+    Matrix::Matrix<double> A = Matrix::identity<double>(16);
+    Matrix::Matrix<double> b = Matrix::ones<double>(1, 16);
+    Matrix::reset_allocation_stats();
+
+    Matrix::Matrix<double> T = Matrix::transpoze(A);
+    Matrix::Matrix<double> I = Matrix::inv(A);
+    Matrix::Matrix<double> Y = Matrix::dense(A, A, b, Matrix::Activation::RELU);
+
+    auto stats = Matrix::get_allocation_stats();
+
+    EXPECT_EQ(stats["dense"].allocations, 1);
+    EXPECT_EQ(stats["dense"].copies, 0);
+
+    EXPECT_EQ(stats["transpoze"].allocations, 1);
+    EXPECT_EQ(stats["transpoze"].copies, 0);
+
+    // the outermost scope is charged for the LUP decomposition inside of inv
+    EXPECT_GT(stats["inv"].copies, 0);
+    EXPECT_EQ(stats.count("LUP"), 0u);
+
+    // the argument passed by value is copied by the caller
+    EXPECT_EQ(stats["copy"].copies, 1);
+    EXPECT_EQ(stats["copy"].bytes_copied, 16 * 16 * 8);
+}
+
+TEST(ACCOUNTING, USER_SCOPE) {
+    Matrix::Matrix<double> A(8, 8);
+    Matrix::reset_allocation_stats();
+
+    {
+        Matrix::AccountingScope scope("layer");
+        Matrix::Matrix<double> B = Matrix::dot(A, A) + A;
+    }
+
+    auto stats = Matrix::get_allocation_stats();
+    EXPECT_EQ(stats["layer"].allocations, 2);
+    EXPECT_EQ(stats["layer"].live_bytes, 0);
+    EXPECT_EQ(stats["dot"].allocations, 0);
+}
+
+TEST(ACCOUNTING, RESET_KEEPS_LIVE_BYTES) {
+    Matrix::Matrix<double> A(100);
+    Matrix::Matrix<double> B(100);
+    B = Matrix::Matrix<double>(1);
+
+    Matrix::reset_allocation_stats();
+
+    auto total = Matrix::get_total_allocation_stats();
+    EXPECT_EQ(total.allocations, 0);
+    EXPECT_EQ(total.live_bytes, 808);
+    EXPECT_EQ(total.peak_bytes, 808);
+}
+
+TEST(ACCOUNTING, RELEASE_AND_BORROW) {
+    Matrix::reset_allocation_stats();
+
+    Matrix::Matrix<double> A(64);
+    double* buffer = A.release();
+    EXPECT_EQ(Matrix::get_total_allocation_stats().live_bytes, 0);
+
+    {
+        Matrix::Matrix<double> B = Matrix::borrow(buffer, {8, 8});
+        EXPECT_EQ(Matrix::get_total_allocation_stats().live_bytes, 0);
+    }
+
+    // the adopted storage is not allocated by the library
+    Matrix::Matrix<double> C = Matrix::adopt(buffer, {64});
+    EXPECT_EQ(Matrix::get_total_allocation_stats().live_bytes, 0);
+    EXPECT_EQ(Matrix::get_total_allocation_stats().bytes_copied, 0);
+
+    // and neither wrapping allocates, only A did
+    EXPECT_EQ(Matrix::get_total_allocation_stats().allocations, 1);
+    EXPECT_EQ(Matrix::get_allocation_stats()["construct"].allocations, 1);
+}
+
+TEST(ACCOUNTING, THREADS) {
+    Matrix::reset_allocation_stats();
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([]() {
+            for (int i = 0; i < 100; i++) {
+                Matrix::Matrix<double> A(16);
+                Matrix::Matrix<double> B(A);
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    auto total = Matrix::get_total_allocation_stats();
+    EXPECT_EQ(total.allocations, 800);
+    EXPECT_EQ(total.copies, 400);
+    EXPECT_EQ(total.live_bytes, 0);
+    EXPECT_LE(total.peak_bytes, 8 * 16 * 8);
+}
+
+TEST(ACCOUNTING, PRINT) {
+    Matrix::reset_allocation_stats();
+    Matrix::Matrix<double> A = Matrix::zeros<double>(4, 4);
+
+    std::ostringstream out;
+    Matrix::print_allocation_stats(out);
+
+    EXPECT_NE(out.str().find("zeros"), std::string::npos);
+    EXPECT_NE(out.str().find("total"), std::string::npos);
+}
@@ -0,0 +1,145 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <atrix/matrix.h>
+#include <atrix/csv.h>
+#include <atrix/parallel.h>
+#include <atrix/errors.h>
+
+static std::string write_file(const std::string& name, const std::string& text) {
+    const std::string path = ::testing::TempDir() + "csv_test_" + name;
+    std::ofstream out(path, std::ios::binary);
+    out << text;
+    return path;
+}
+
+TEST(CSV, LOAD) {
+    const std::string path = write_file("load.csv", "1,2.5,-3\n4, 5e2 ,+6\r\n\n\"7\",8,9.25");
+
+    Matrix::Matrix<double> A = Matrix::load_csv<double>(path);
+    ASSERT_EQ(A.get_shape(), std::vector<int>({3, 3}));
+
+    const double expected[9] = {1, 2.5, -3, 4, 500, 6, 7, 8, 9.25};
+    for (int i = 0; i < 9; i++)
+        EXPECT_EQ(A.data()[i], expected[i]);
+
+    Matrix::Matrix<int> B = Matrix::load_csv<int>(write_file("ints.tsv", "1\t-2\n30\t40\n"),
+                                                  Matrix::CsvOptions('\t'));
+    ASSERT_EQ(B.get_shape(), std::vector<int>({2, 2}));
+    EXPECT_EQ(B(0, 1), -2);
+    EXPECT_EQ(B(1, 0), 30);
+
+    std::remove(path.c_str());
+}
+
+TEST(CSV, COLUMNS) {
+    const std::string path = write_file("columns.csv", "id, \"age\" ,income,score\n1,20,1000,0.5\n2,30,2000,\n");
+
+    Matrix::CsvOptions options(',', true);
+    Matrix::Matrix<float> A = Matrix::load_csv<float>(path, options);
+    ASSERT_EQ(A.get_shape(), std::vector<int>({2, 4}));
+    EXPECT_TRUE(std::isnan(A(1, 3)));
+
+    options.names = {"income", "age"};
+    Matrix::Matrix<float> B = Matrix::load_csv<float>(path, options);
+    ASSERT_EQ(B.get_shape(), std::vector<int>({2, 2}));
+    EXPECT_EQ(B(0, 0), 1000.0f);
+    EXPECT_EQ(B(1, 1), 30.0f);
+
+    options.names.clear();
+    options.columns = {3, 0};
+    Matrix::Matrix<float> C = Matrix::load_csv<float>(path, options);
+    EXPECT_EQ(C(0, 0), 0.5f);
+    EXPECT_EQ(C(1, 1), 2.0f);
+
+    options.columns.clear();
+    options.names = {"height"};
+    EXPECT_THROW(Matrix::load_csv<float>(path, options), Matrix::ParseError);
+
+    std::remove(path.c_str());
+}
+
+TEST(CSV, ERRORS) {
+    EXPECT_THROW(Matrix::load_csv<double>(write_file("e1.csv", "1,2\n3,x\n")), Matrix::ParseError);
+    EXPECT_THROW(Matrix::load_csv<double>(write_file("e2.csv", "1,2\n3\n")), Matrix::ParseError);
+    EXPECT_THROW(Matrix::load_csv<double>(write_file("e3.csv", "1,2\n3,4,5\n")), Matrix::ParseError);
+    EXPECT_THROW(Matrix::load_csv<int>(write_file("e4.csv", "1,2.5\n")), Matrix::ParseError);
+    EXPECT_THROW(Matrix::load_csv<int>(write_file("e5.csv", "1,\n")), Matrix::ParseError);
+    EXPECT_THROW(Matrix::load_csv<double>(write_file("e6.csv", "\n\n")), Matrix::ParseError);
+    EXPECT_THROW(Matrix::load_csv<double>(::testing::TempDir() + "csv_test_missing.csv"),
+                 Matrix::SerializationError);
+
+    for (auto name : {"e1.csv", "e2.csv", "e3.csv", "e4.csv", "e5.csv", "e6.csv"})
+        std::remove((::testing::TempDir() + "csv_test_" + name).c_str());
+}
+
+TEST(CSV, PARALLEL_AND_STREAMING) {
+    // a few MB, so that the lines are cut into many chunks
+    const int rows = 200000;
+    std::ostringstream text;
+    text << "a,b,c\n";
+    for (int i = 0; i < rows; i++)
+        text << i << "," << std::to_string(0.25 * i) << "," << -i << ((i % 1000 == 0) ? "\n\n" : "\n");
+    const std::string path = write_file("large.csv", text.str());
+
+    Matrix::set_num_threads(4);
+    Matrix::Matrix<double> A = Matrix::load_csv<double>(path, Matrix::CsvOptions(',', true));
+    Matrix::set_num_threads(1);
+
+    ASSERT_EQ(A.get_shape(), std::vector<int>({rows, 3}));
+    for (int i = 0; i < rows; i++) {
+        ASSERT_EQ(A(i, 0), i);
+        ASSERT_EQ(A(i, 1), 0.25 * i);
+        ASSERT_EQ(A(i, 2), -i);
+    }
+
+    Matrix::CsvOptions options(',', true);
+    options.names = {"c", "a"};
+    Matrix::CsvReader<double> reader(path, 30000, options);
+    EXPECT_EQ(reader.get_header(), std::vector<std::string>({"a", "b", "c"}));
+    EXPECT_EQ(reader.get_columns(), 2);
+
+    int seen = 0;
+    while (reader.has_next()) {
+        Matrix::Matrix<double> batch = reader.next();
+        const int count = batch.get_shape()[0];
+        EXPECT_EQ(count, std::min(30000, rows - seen));
+
+        for (int i = 0; i < count; i++) {
+            ASSERT_EQ(batch(i, 0), -(seen + i));
+            ASSERT_EQ(batch(i, 1), seen + i);
+        }
+        seen += count;
+    }
+    EXPECT_EQ(seen, rows);
+
+    std::remove(path.c_str());
+}
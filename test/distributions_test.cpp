@@ -0,0 +1,139 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#include <gtest/gtest.h>
+#include <vector>
+#include <cmath>
+
+#include <atrix/matrix.h>
+#include <atrix/generator.h>
+#include <atrix/distributions.h>
+#include <atrix/reductions.h>
+
+TEST(GENERATOR, PHILOX) {
+    // the known answer of Philox4x32-10 for the zero key and the zero counter
+    Matrix::Generator gen(0);
+    std::uint32_t bits[4];
+    gen.block(0, 0, bits);
+
+    EXPECT_EQ(bits[0], 0x6627e8d5u);
+    EXPECT_EQ(bits[1], 0xe169c58du);
+    EXPECT_EQ(bits[2], 0xbc57ac4cu);
+    EXPECT_EQ(bits[3], 0x9b00dbd8u);
+
+    EXPECT_EQ(gen.advance(10), 0u);
+    EXPECT_EQ(gen.advance(10), 10u);
+    EXPECT_EQ(gen.get_offset(), 20u);
+
+    gen.seed(5);
+    EXPECT_EQ(gen.get_offset(), 0u);
+}
+
+TEST(DISTRIBUTIONS, REPRODUCIBLE) {
+    Matrix::Generator first(42);
+    Matrix::Generator second(42);
+
+    Matrix::Matrix<double> A(300, 301);
+    Matrix::Matrix<double> B(300, 301);
+
+    Matrix::normal(A, 0.0, 1.0, first);
+
+    Matrix::set_num_threads(4);
+    Matrix::normal(B, 0.0, 1.0, second);
+    Matrix::set_num_threads(1);
+
+    for (int i = 0; i < 300; i++)
+        for (int j = 0; j < 301; j++)
+            EXPECT_EQ(A(i, j), B(i, j));
+
+    // the generator moved on, the next fill is different
+    Matrix::normal(B, 0.0, 1.0, second);
+    EXPECT_NE(A(0, 0), B(0, 0));
+
+    // jumping back gives the first fill again
+    second.set_offset(0);
+    Matrix::normal(B, 0.0, 1.0, second);
+    EXPECT_EQ(A(299, 300), B(299, 300));
+
+    // the calls of random in a row are not the same anymore
+    Matrix::Matrix<double> R1 = Matrix::random<double>(4, 4);
+    Matrix::Matrix<double> R2 = Matrix::random<double>(4, 4);
+    EXPECT_NE(R1(0, 0), R2(0, 0));
+    EXPECT_GE(Matrix::min(R1), 0);
+    EXPECT_LE(Matrix::max(R1), RAND_MAX);
+}
+
+TEST(DISTRIBUTIONS, MOMENTS) {
+    Matrix::Generator gen(7);
+    Matrix::Matrix<double> A(1000, 1000);
+
+    Matrix::uniform(A, -1.0, 3.0, gen);
+    EXPECT_GE(Matrix::min(A), -1.0);
+    EXPECT_LT(Matrix::max(A), 3.0);
+    EXPECT_NEAR(Matrix::mean(A), 1.0, 0.01);
+    EXPECT_NEAR(Matrix::variance(A), 16.0 / 12, 0.01);
+
+    Matrix::normal(A, 2.0, 3.0, gen);
+    EXPECT_NEAR(Matrix::mean(A), 2.0, 0.01);
+    EXPECT_NEAR(Matrix::variance(A), 9.0, 0.05);
+
+    Matrix::bernoulli(A, 0.25, gen);
+    EXPECT_NEAR(Matrix::mean(A), 0.25, 0.005);
+    EXPECT_EQ(Matrix::sum(A), Matrix::norm(A, 1));
+
+    // the standard normal truncated at 2 has the variance 0.774
+    Matrix::truncated_normal(A, 0.0, 1.0, 2.0, gen);
+    EXPECT_GE(Matrix::min(A), -2.0);
+    EXPECT_LE(Matrix::max(A), 2.0);
+    EXPECT_NEAR(Matrix::mean(A), 0.0, 0.01);
+    EXPECT_NEAR(Matrix::variance(A), 0.774, 0.01);
+
+    Matrix::Matrix<float> F(100, 100);
+    Matrix::uniform(F, 0.0f, 1.0f, gen);
+    EXPECT_LT(Matrix::max(F), 1.0f);
+}
+
+TEST(DISTRIBUTIONS, UNIFORM_BOUNDS) {
+    Matrix::Generator gen(11);
+
+    // every integer of [-3, 3) equally often, the negative ones are not rounded toward zero
+    Matrix::Matrix<int> A(600, 1000);
+    Matrix::uniform(A, -3, 3, gen);
+
+    std::vector<int> counts(6, 0);
+    for (int i = 0; i < A.get_matrix_size(); i++) {
+        ASSERT_GE(A.data()[i], -3);
+        ASSERT_LT(A.data()[i], 3);
+        counts[A.data()[i] + 3]++;
+    }
+    for (int c : counts)
+        EXPECT_NEAR(c, 100000, 2000);
+
+    // the largest uniform number of float is 1 - 2^-24, 2 - 2^-24 is rounded up to 2
+    const double largest = 1.0 - 1.0 / 16777216.0;
+    EXPECT_LT(Matrix::detail::uniform_value(1.0f, 2.0f, 1.0, largest), 2.0f);
+    EXPECT_EQ(Matrix::detail::uniform_value(1.0f, 2.0f, 1.0, 0.0), 1.0f);
+    EXPECT_EQ(Matrix::detail::uniform_value(-3, 3, 6.0, largest), 2);
+    EXPECT_EQ(Matrix::detail::uniform_value(-3, 3, 6.0, 0.0), -3);
+}
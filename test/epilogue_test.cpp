@@ -0,0 +1,123 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+#include <atrix/matrix.h>
+#include <atrix/epilogue.h>
+#include <atrix/distributions.h>
+
+TEST(EPILOGUE, GEMM) {
+    Matrix::Generator gen(5);
+
+    // the sizes go past the register tile and the cache blocks of gemm
+    for (auto shape : std::vector<std::vector<int>>({{1, 1, 1}, {5, 3, 9}, {130, 300, 70}})) {
+        const int n = shape[0], k = shape[1], m = shape[2];
+
+        Matrix::Matrix<double> X(n, k);
+        Matrix::Matrix<double> W(k, m);
+        Matrix::Matrix<double> C0(n, m);
+        Matrix::Matrix<double> column_bias(1, m);
+        Matrix::Matrix<double> row_scale(n, 1);
+        Matrix::uniform(X, -1.0, 1.0, gen);
+        Matrix::uniform(W, -1.0, 1.0, gen);
+        Matrix::uniform(C0, -1.0, 1.0, gen);
+        Matrix::uniform(column_bias, -1.0, 1.0, gen);
+        Matrix::uniform(row_scale, 0.5, 2.0, gen);
+
+        // the plain gemm, then the epilogue element by element
+        Matrix::Matrix<double> V = C0;
+        Matrix::gemm(0.5, X, W, 2.0, V);
+
+        for (auto activation : {Matrix::Activation::IDENTITY, Matrix::Activation::RELU,
+                                Matrix::Activation::SIGMOID, Matrix::Activation::TANH,
+                                Matrix::Activation::EXP}) {
+            Matrix::Matrix<double> C = C0;
+            Matrix::gemm(0.5, X, W, 2.0, C, Matrix::Epilogue<double>(activation, &column_bias, &row_scale));
+
+            for (int i = 0; i < n; i++) {
+                for (int j = 0; j < m; j++) {
+                    double v = row_scale(i, 0) * V(i, j) + column_bias(0, j);
+                    switch (activation) {
+                    case Matrix::Activation::IDENTITY: break;
+                    case Matrix::Activation::RELU:     v = std::max(v, 0.0); break;
+                    case Matrix::Activation::SIGMOID:  v = 1 / (1 + std::exp(-v)); break;
+                    case Matrix::Activation::TANH:     v = std::tanh(v); break;
+                    case Matrix::Activation::EXP:      v = std::exp(v); break;
+                    }
+                    EXPECT_NEAR(C(i, j), v, 1e-12 * (1 + std::fabs(v)));
+                }
+            }
+        }
+
+        // the transposed operands and the bias of every element
+        Matrix::Matrix<double> C = C0;
+        Matrix::Matrix<double> XT = Matrix::transpoze(X);
+        Matrix::Matrix<double> WT = Matrix::transpoze(W);
+        Matrix::gemm(1.0, XT, WT, 0.0, C, Matrix::Epilogue<double>(Matrix::Activation::IDENTITY, &C0), true, true);
+
+        Matrix::Matrix<double> EXPECTED = Matrix::dot(X, W) + C0;
+        for (int i = 0; i < n; i++)
+            for (int j = 0; j < m; j++)
+                EXPECT_NEAR(C(i, j), EXPECTED(i, j), 1e-12);
+    }
+
+    // without the product the epilogue is applied to beta * C
+    Matrix::Matrix<double> A(3, 2);
+    Matrix::Matrix<double> B(2, 4);
+    Matrix::Matrix<double> C = Matrix::ones<double>(3, 4);
+    Matrix::gemm(0.0, A, B, -2.0, C, Matrix::Epilogue<double>(Matrix::Activation::RELU));
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 4; j++)
+            EXPECT_EQ(C(i, j), 0.0);
+}
+
+TEST(EPILOGUE, DENSE) {
+    Matrix::Generator gen(9);
+    Matrix::Matrix<double> X(40, 30);
+    Matrix::Matrix<double> W(30, 20);
+    Matrix::Matrix<double> b(1, 20);
+    Matrix::uniform(X, -1.0, 1.0, gen);
+    Matrix::uniform(W, -1.0, 1.0, gen);
+    Matrix::uniform(b, -1.0, 1.0, gen);
+
+    // the fused layer and the three passes of the unfused one
+    Matrix::Matrix<double> Y = Matrix::dense(X, W, b, Matrix::Activation::SIGMOID);
+    Matrix::Matrix<double> EXPECTED = Matrix::sigmoid(Matrix::dot(X, W) + b);
+
+    EXPECT_EQ(Y.get_shape(), std::vector<int>({40, 20}));
+    for (int i = 0; i < 40; i++)
+        for (int j = 0; j < 20; j++)
+            EXPECT_NEAR(Y(i, j), EXPECTED(i, j), 1e-14);
+
+    Matrix::Matrix<float> XF(4, 3);
+    Matrix::Matrix<float> WF(3, 2);
+    Matrix::Matrix<float> R = Matrix::dense(XF, WF, Matrix::Activation::RELU);
+    Matrix::Matrix<float> RF = Matrix::dot(XF, WF);
+    for (int i = 0; i < 4; i++)
+        for (int j = 0; j < 2; j++)
+            EXPECT_EQ(R(i, j), std::max(RF(i, j), 0.0f));
+}
@@ -0,0 +1,120 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#include <gtest/gtest.h>
+#include <vector>
+#include <cmath>
+#include <limits>
+
+#include <atrix/matrix.h>
+#include <atrix/half.h>
+#include <atrix/distributions.h>
+
+TEST(HALF, FLOAT16) {
+    // every half except NaN survives the round trip through float
+    for (int bits = 0; bits < 0x10000; bits++) {
+        Matrix::float16 h = Matrix::float16::from_bits(bits);
+        if ((bits & 0x7c00) == 0x7c00 && (bits & 0x3ff) != 0)
+            EXPECT_TRUE(std::isnan(float(h)));
+        else
+            EXPECT_EQ(Matrix::float16(float(h)).bits, bits);
+    }
+
+    EXPECT_EQ(float(Matrix::float16::from_bits(0x7bff)), 65504.0f);
+    EXPECT_EQ(float(Matrix::float16::from_bits(0x0001)), std::ldexp(1.0f, -24));
+
+    // the ties are rounded to the even mantissa
+    EXPECT_EQ(Matrix::float16(1.0f + std::ldexp(1.0f, -11)).bits, 0x3c00);
+    EXPECT_EQ(Matrix::float16(1.0f + 3 * std::ldexp(1.0f, -11)).bits, 0x3c02);
+    EXPECT_EQ(Matrix::float16(65519.0f).bits, 0x7bff);
+    EXPECT_EQ(Matrix::float16(65520.0f).bits, 0x7c00);
+    EXPECT_EQ(Matrix::float16(-1e10f).bits, 0xfc00);
+
+    Matrix::float16 x = 1.5f;
+    x += 2.0f;
+    x *= 2.0f;
+    EXPECT_EQ(float(x), 7.0f);
+}
+
+TEST(HALF, BFLOAT16) {
+    EXPECT_EQ(Matrix::bfloat16(1.0f).bits, 0x3f80);
+    EXPECT_NEAR(float(Matrix::bfloat16(3.0e38f)), 3.0e38f, 3.0e38f * std::ldexp(1.0f, -8));
+
+    // the ties are rounded to the even mantissa
+    EXPECT_EQ(Matrix::bfloat16(1.0f + std::ldexp(1.0f, -8)).bits, 0x3f80);
+    EXPECT_EQ(Matrix::bfloat16(1.0f + 3 * std::ldexp(1.0f, -8)).bits, 0x3f82);
+    EXPECT_TRUE(std::isnan(float(Matrix::bfloat16(std::numeric_limits<float>::quiet_NaN()))));
+}
+
+TEST(HALF, ASTYPE) {
+    Matrix::Matrix<float> A(300, 300);
+    A /= 1000.0f;
+
+    Matrix::Matrix<Matrix::float16> H = Matrix::astype<Matrix::float16>(A);
+    Matrix::Matrix<Matrix::bfloat16> B = Matrix::astype<Matrix::bfloat16>(H);
+    Matrix::Matrix<double> D = Matrix::astype<double>(H);
+    Matrix::Matrix<float> F = Matrix::astype<float>(B);
+
+    EXPECT_EQ(H.get_shape(), std::vector<int>({300, 300}));
+    for (int i = 0; i < 300; i++) {
+        for (int j = 0; j < 300; j++) {
+            EXPECT_EQ(H(i, j).bits, Matrix::float16(A(i, j)).bits);
+            EXPECT_EQ(D(i, j), float(H(i, j)));
+            EXPECT_EQ(F(i, j), float(Matrix::bfloat16(float(H(i, j)))));
+            EXPECT_NEAR(D(i, j), A(i, j), A(i, j) * 1e-3);
+        }
+    }
+}
+
+TEST(HALF, GEMM) {
+    Matrix::Generator gen(3);
+    Matrix::Matrix<double> A(70, 300);
+    Matrix::Matrix<double> B(300, 50);
+    Matrix::uniform(A, -1.0, 1.0, gen);
+    Matrix::uniform(B, -1.0, 1.0, gen);
+
+    // the exact product of the rounded operands
+    Matrix::Matrix<double> A16 = Matrix::astype<double>(Matrix::astype<Matrix::float16>(A));
+    Matrix::Matrix<double> B16 = Matrix::astype<double>(Matrix::astype<Matrix::float16>(B));
+    Matrix::Matrix<double> expected = Matrix::dot(A16, B16);
+
+    Matrix::Matrix<float> C = Matrix::dot(Matrix::astype<Matrix::float16>(A),
+                                          Matrix::astype<Matrix::float16>(B));
+
+    // the float accumulation of 300 products
+    for (int i = 0; i < 70; i++)
+        for (int j = 0; j < 50; j++)
+            EXPECT_NEAR(C(i, j), expected(i, j), 1e-4);
+
+    // the transposed bfloat16 operands
+    Matrix::Matrix<Matrix::bfloat16> At = Matrix::astype<Matrix::bfloat16>(Matrix::transpoze(A));
+    Matrix::Matrix<Matrix::bfloat16> Bt = Matrix::astype<Matrix::bfloat16>(Matrix::transpoze(B));
+    Matrix::Matrix<float> D(70, 50);
+    Matrix::gemm(1.0f, At, Bt, 0.0f, D, true, true);
+
+    Matrix::Matrix<double> exact = Matrix::dot(A, B);
+    for (int i = 0; i < 70; i++)
+        for (int j = 0; j < 50; j++)
+            EXPECT_NEAR(D(i, j), exact(i, j), 0.1);
+}
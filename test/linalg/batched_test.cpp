@@ -0,0 +1,143 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#include <gtest/gtest.h>
+#include <vector>
+#include <random>
+#include <cmath>
+
+#include <atrix/matrix.h>
+#include <atrix/linalg/batched.h>
+
+// fills the slices with diagonally dominant matrices, so they are invertible
+Matrix::Matrix<double> random_batch(int batch, int n, unsigned int seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+    Matrix::Matrix<double> A(batch, n, n);
+    for (int b = 0; b < batch; b++)
+        for (int i = 0; i < n; i++)
+            for (int j = 0; j < n; j++)
+                A(b, i, j) = dist(gen) + ((i == j) ? n : 0);
+
+    return A;
+}
+
+// the largest |A_b X_b - B_b| over all slices, B is the identity if it is nullptr
+double max_residual(const Matrix::Matrix<double>& A, const Matrix::Matrix<double>& X,
+                    const Matrix::Matrix<double>* B, int nrhs) {
+    auto __shape = A.get_shape();
+    int batch = __shape[0];
+    int n = __shape[1];
+
+    const double* x = X.data();
+    double worst = 0;
+
+    for (int b = 0; b < batch; b++)
+        for (int i = 0; i < n; i++)
+            for (int c = 0; c < nrhs; c++) {
+                double sum = 0;
+                for (int k = 0; k < n; k++)
+                    sum += A(b, i, k) * x[(b * n + k) * nrhs + c];
+                double expected = (B == nullptr) ? (i == c) : B->data()[(b * n + i) * nrhs + c];
+                worst = std::max(worst, std::abs(sum - expected));
+            }
+
+    return worst;
+}
+
+TEST(BATCHED, INV) {
+    for (int n : {1, 2, 3, 4, 5, 8, 13, 16, 20}) {
+        Matrix::Matrix<double> A = random_batch(11, n, n);
+        std::vector<bool> singular;
+
+        Matrix::Matrix<double> invA = Matrix::batched_inv(A, singular);
+
+        EXPECT_EQ(invA.get_shape(), std::vector<int>({11, n, n}));
+        EXPECT_EQ(singular, std::vector<bool>(11, false));
+        EXPECT_LT(max_residual(A, invA, nullptr, n), 1e-12) << "n = " << n;
+    }
+}
+
+TEST(BATCHED, DET) {
+    for (int n : {1, 2, 3, 4, 5, 8, 16, 20}) {
+        // the permuted upper triangular slices have the known determinants
+        Matrix::Matrix<double> A = Matrix::zeros<double>(3, n, n);
+        for (int b = 0; b < 3; b++)
+            for (int i = 0; i < n; i++)
+                for (int j = i; j < n; j++)
+                    A(b, i, j) = (i == j) ? (b + 2) : 0.5;
+
+        if (n > 1)
+            for (int j = 0; j < n; j++)
+                std::swap(A(1, 0, j), A(1, n - 1, j));
+
+        Matrix::Matrix<double> D = Matrix::batched_det(A);
+
+        EXPECT_EQ(D.get_shape(), std::vector<int>({3}));
+        EXPECT_NEAR(D(0), std::pow(2.0, n), 1e-9 * std::pow(2.0, n));
+        EXPECT_NEAR(D(1), ((n > 1) ? -1 : 1) * std::pow(3.0, n), 1e-9 * std::pow(3.0, n));
+        EXPECT_NEAR(D(2), std::pow(4.0, n), 1e-9 * std::pow(4.0, n));
+    }
+}
+
+TEST(BATCHED, SOLVE) {
+    for (int n : {2, 3, 4, 6, 16, 18}) {
+        Matrix::Matrix<double> A = random_batch(9, n, 7 * n);
+        Matrix::Matrix<double> B(9, n, 3);
+        Matrix::Matrix<double> b(9, n);
+        std::vector<bool> singular;
+
+        Matrix::Matrix<double> X = Matrix::batched_solve(A, B, singular);
+        EXPECT_EQ(X.get_shape(), std::vector<int>({9, n, 3}));
+        EXPECT_LT(max_residual(A, X, &B, 3), 1e-9) << "n = " << n;
+
+        Matrix::Matrix<double> x = Matrix::batched_solve(A, b, singular);
+        EXPECT_EQ(x.get_shape(), std::vector<int>({9, n}));
+        EXPECT_LT(max_residual(A, x, &b, 1), 1e-9) << "n = " << n;
+    }
+}
+
+TEST(BATCHED, SINGULAR) {
+    for (int n : {3, 4, 7, 17}) {
+        Matrix::Matrix<double> A = random_batch(10, n, n);
+        for (int j = 0; j < n; j++)
+            A(4, 1, j) = 0;
+
+        std::vector<bool> singular;
+        Matrix::Matrix<double> invA = Matrix::batched_inv(A, singular);
+        Matrix::Matrix<double> D = Matrix::batched_det(A);
+
+        for (int b = 0; b < 10; b++)
+            EXPECT_EQ(singular[b], b == 4) << "n = " << n;
+
+        EXPECT_EQ(D(4), 0);
+        for (int i = 0; i < n; i++)
+            for (int j = 0; j < n; j++)
+                EXPECT_EQ(invA(4, i, j), 0);
+
+        // the other slices are not affected by the singular one
+        EXPECT_TRUE(std::isfinite(invA(5, 0, 0)));
+    }
+}
@@ -0,0 +1,158 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+#include <atrix/matrix.h>
+#include <atrix/mapped.h>
+#include <atrix/npy.h>
+#include <atrix/reductions.h>
+#include <atrix/linalg/algorithms.h>
+#include <atrix/errors.h>
+
+static std::string temp_path(const std::string& name) {
+    return ::testing::TempDir() + "mapped_test_" + name;
+}
+
+TEST(MAPPED, PAGE_ALIGNED) {
+    const std::string path = temp_path("aligned.npy");
+    const long page = sysconf(_SC_PAGESIZE);
+
+    Matrix::Matrix<float> A(100, 300);
+    Matrix::save_mappable(path, A);
+
+    // the header is one page and the file is still a .npy file
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    EXPECT_EQ(static_cast<long>(file.tellg()), page + 100 * 300 * 4);
+
+    Matrix::Matrix<float> B = Matrix::load<float>(path);
+    Matrix::Matrix<float> M = Matrix::open_mapped<float>(path, Matrix::Mapping::READ_ONLY);
+
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(M.data()) % page, 0u);
+    ASSERT_EQ(M.get_shape(), A.get_shape());
+    for (int i = 0; i < A.get_matrix_size(); i++) {
+        ASSERT_EQ(B.data()[i], A.data()[i]);
+        ASSERT_EQ(M.data()[i], A.data()[i]);
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST(MAPPED, OPERATIONS) {
+    const std::string path = temp_path("operations.npy");
+
+    Matrix::Matrix<double> A(4, 4);
+    for (int i = 0; i < 4; i++)
+        A(i, i) += 10.0;
+    Matrix::save(path, A);
+
+    // the matrix of the usual .npy file works with the usual operations
+    Matrix::Matrix<double> M = Matrix::open_mapped<double>(path, Matrix::Mapping::READ_ONLY,
+                                                          Matrix::Advice::SEQUENTIAL);
+    Matrix::advise(M, Matrix::Advice::RANDOM);
+
+    Matrix::Matrix<double> P = Matrix::dot(M, M);
+    Matrix::Matrix<double> Q = Matrix::dot(A, A);
+    for (int i = 0; i < 16; i++)
+        EXPECT_EQ(P.data()[i], Q.data()[i]);
+
+    EXPECT_EQ(Matrix::sum(M), Matrix::sum(A));
+    EXPECT_NEAR(Matrix::det(M), Matrix::det(A), 1e-9 * std::abs(Matrix::det(A)));
+
+    Matrix::Matrix<double> S = M + A;
+    EXPECT_EQ(S(3, 2), 2 * A(3, 2));
+
+    // the copies are the usual matrices
+    Matrix::Matrix<double> C(M);
+    C(0, 0) = -1.0;
+    EXPECT_EQ(M(0, 0), A(0, 0));
+
+    // the assigned mapped matrix lets the file go
+    M = C;
+    EXPECT_EQ(M(0, 0), -1.0);
+
+    std::remove(path.c_str());
+}
+
+TEST(MAPPED, COPY_ON_WRITE) {
+    const std::string path = temp_path("private.npy");
+
+    Matrix::Matrix<int> A(1000);
+    Matrix::save_mappable(path, A);
+
+    {
+        Matrix::Matrix<int> M = Matrix::open_mapped<int>(path);
+        M *= 2;
+        EXPECT_EQ(M(999), 2 * 999);
+    }
+
+    Matrix::Matrix<int> B = Matrix::load<int>(path);
+    EXPECT_EQ(B(999), 999);
+
+    std::remove(path.c_str());
+}
+
+TEST(MAPPED, WRITE_BACK) {
+    const std::string path = temp_path("shared.npy");
+
+    Matrix::Matrix<double> A(64, 64);
+    Matrix::save_mappable(path, A);
+
+    Matrix::Matrix<double> M = Matrix::open_mapped<double>(path, Matrix::Mapping::WRITE_BACK);
+    Matrix::Matrix<double> N = Matrix::open_mapped<double>(path, Matrix::Mapping::READ_ONLY);
+
+    M(10, 20) = -0.5;
+    M += 1.0;
+    Matrix::sync(M);
+
+    // the other mapping of the file sees the same pages
+    EXPECT_EQ(N(10, 20), 0.5);
+
+    Matrix::Matrix<double> B = Matrix::load<double>(path);
+    EXPECT_EQ(B(10, 20), 0.5);
+    EXPECT_EQ(B(63, 63), 64.0 * 64.0);
+
+    std::remove(path.c_str());
+}
+
+TEST(MAPPED, ERRORS) {
+    const std::string path = temp_path("errors.npy");
+
+    Matrix::Matrix<float> A(16, 16);
+    Matrix::save(path, A);
+
+    EXPECT_THROW(Matrix::open_mapped<double>(path), Matrix::SerializationError);
+    EXPECT_THROW(Matrix::open_mapped<float>(temp_path("missing.npy")), Matrix::SerializationError);
+
+    // the file that ends in the data
+    truncate(path.c_str(), 128 + 16 * 16 * 4 - 4);
+    EXPECT_THROW(Matrix::open_mapped<float>(path), Matrix::SerializationError);
+
+    std::remove(path.c_str());
+}
@@ -24,6 +24,8 @@
 
 #include <gtest/gtest.h>
 #include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
 
 #include <atrix/matrix.h>
 
@@ -198,6 +200,131 @@ TEST(MATRIX, OPERATOR_MULTIPLY) {
                 is_equal(X, {0, 1, 2, 3, 4, 5, 6, 7, 8}, {3, 3})); 
 }
 
+TEST(MATRIX, BROADCASTING) {
+
+    Matrix::Matrix<double> X(2, 3);
+    Matrix::Matrix<double> row(1, 3);
+    Matrix::Matrix<double> column(2, 1);
+    Matrix::Matrix<double> flat(3);
+
+    X += row;
+    EXPECT_TRUE(is_equal(X, {0, 2, 4, 3, 5, 7}, {2, 3}));
+
+    X -= flat;
+    EXPECT_TRUE(is_equal(X, {0, 1, 2, 3, 4, 5}, {2, 3}));
+
+    X *= column;
+    EXPECT_TRUE(is_equal(X, {0, 0, 0, 3, 4, 5}, {2, 3}));
+
+    // both operands are stretched
+    Matrix::Matrix<double> Y = column + row;
+    EXPECT_TRUE(is_equal(Y, {0, 1, 2, 1, 2, 3}, {2, 3}));
+
+    Matrix::Matrix<double> Z = row - X;
+    EXPECT_TRUE(is_equal(Z, {0, 1, 2, -3, -3, -3}, {2, 3}));
+
+    // the missing leading dimensions and the size 1 dimensions in the middle
+    Matrix::Matrix<double> T(2, 3, 4);
+    Matrix::Matrix<double> S(2, 1, 4);
+    Matrix::Matrix<double> R = T * S;
+
+    EXPECT_EQ(R.get_shape(), std::vector<int>({2, 3, 4}));
+    for (int i = 0; i < 2; i++)
+        for (int j = 0; j < 3; j++)
+            for (int k = 0; k < 4; k++)
+                EXPECT_EQ(R(i, j, k), T(i, j, k) * S(i, 0, k));
+
+    Matrix::Matrix<double> U = S + column;
+    EXPECT_EQ(U.get_shape(), std::vector<int>({2, 2, 4}));
+    for (int i = 0; i < 2; i++)
+        for (int j = 0; j < 2; j++)
+            for (int k = 0; k < 4; k++)
+                EXPECT_EQ(U(i, j, k), S(i, 0, k) + column(j, 0));
+}
+
+TEST(MATRIX, PARALLEL) {
+
+    // large enough for the chunks of the thread pool
+    Matrix::Matrix<double> A(300, 500);
+    Matrix::Matrix<double> row(500);
+    Matrix::Matrix<double> column(300, 1);
+    A /= 1000;
+
+    Matrix::Matrix<double> sum = A + row;
+    Matrix::Matrix<double> product = A * column;
+    Matrix::Matrix<double> scaled = A * 2.0;
+    Matrix::Matrix<double> activated = Matrix::tanh(A);
+    Matrix::Matrix<double> Z = Matrix::zeros<double>(300, 500);
+
+    Matrix::set_num_threads(4);
+
+    Matrix::Matrix<double> B(300, 500);
+    B /= 1000;
+    EXPECT_TRUE(is_equal(B, std::vector<double>(A.data(), A.data() + A.get_matrix_size()), {300, 500}));
+
+    Matrix::Matrix<double> parallel_sum = B + row;
+    Matrix::Matrix<double> parallel_product = B * column;
+    Matrix::Matrix<double> parallel_scaled = B * 2.0;
+    Matrix::Matrix<double> parallel_activated = Matrix::tanh(B);
+    Matrix::Matrix<double> O = Matrix::ones<double>(300, 500);
+
+    Matrix::set_num_threads(1);
+
+    for (int i = 0; i < 300; i++) {
+        for (int j = 0; j < 500; j++) {
+            EXPECT_EQ(parallel_sum(i, j), sum(i, j));
+            EXPECT_EQ(parallel_product(i, j), product(i, j));
+            EXPECT_EQ(parallel_scaled(i, j), scaled(i, j));
+            EXPECT_EQ(parallel_activated(i, j), activated(i, j));
+            EXPECT_EQ(Z(i, j), 0);
+            EXPECT_EQ(O(i, j), 1);
+        }
+    }
+}
+
+TEST(MATRIX, PARALLEL_AFTER_FORK) {
+
+    Matrix::Matrix<double> A(300, 500);
+    A /= 1000;
+
+    // the workers of the parent are running when the process forks
+    Matrix::set_num_threads(4);
+    Matrix::Matrix<double> expected = Matrix::tanh(A);
+
+    pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+
+    if (pid == 0) {
+        // a deadlock of the pool kills the child instead of the test
+        alarm(10);
+
+        bool ok = Matrix::get_num_threads() == 1;
+
+        Matrix::Matrix<double> serial = Matrix::tanh(A);
+        Matrix::set_num_threads(4);
+        Matrix::Matrix<double> parallel = Matrix::tanh(A);
+
+        for (int i = 0; i < 300; i++)
+            for (int j = 0; j < 500; j++)
+                ok = ok && serial(i, j) == expected(i, j) && parallel(i, j) == expected(i, j);
+
+        _exit(ok ? 0 : 1);
+    }
+
+    int status = 0;
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    EXPECT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+
+    // the pool of the parent still works
+    Matrix::Matrix<double> again = Matrix::tanh(A);
+    Matrix::set_num_threads(1);
+
+    for (int i = 0; i < 300; i++)
+        for (int j = 0; j < 500; j++)
+            EXPECT_EQ(again(i, j), expected(i, j));
+}
+
 TEST(MATRIX_FUNCTIONS, DOT) {
 
     Matrix::Matrix<double> A(3, 3);
@@ -211,6 +338,126 @@ TEST(MATRIX_FUNCTIONS, DOT) {
     Matrix::Matrix<double> C = Matrix::dot(A, A);
     EXPECT_TRUE(is_equal(C, {15, 18, 21, 42, 54, 66, 69, 90, 111}, {3, 3}));
 
+    Matrix::Matrix<double> y(1, 3);
+    Matrix::Matrix<double> d = Matrix::dot(y, A);
+    EXPECT_TRUE(is_equal(d, {15, 18, 21}, {1, 3}));
+}
+
+TEST(MATRIX_FUNCTIONS, GEMV) {
+
+    Matrix::Matrix<double> A(3, 2);
+    Matrix::Matrix<double> x(2, 1);
+    Matrix::Matrix<double> y = Matrix::ones<double>(3, 1);
+
+    // y = 2 A x + 3 y
+    Matrix::gemv(2.0, A, x, 3.0, y);
+    EXPECT_TRUE(is_equal(y, {5, 9, 13}, {3, 1}));
+
+    // z = A^T y, the old content of z is not used
+    Matrix::Matrix<double> z(1, 2);
+    Matrix::gemv(1.0, A, y, 0.0, z, true);
+    EXPECT_TRUE(is_equal(z, {70, 97}, {1, 2}));
+
+    // the large matrices are multiplied by the thread pool
+    Matrix::set_num_threads(4);
+
+    Matrix::Matrix<double> B(1000, 301);
+    Matrix::Matrix<double> u(301, 1);
+    Matrix::Matrix<double> v(1000, 1);
+    Matrix::Matrix<double> w(1, 301);
+    Matrix::gemv(1.0, B, u, 0.0, v);
+    Matrix::gemv(0.5, B, v, 0.0, w, true);
+
+    for (int i = 0; i < 1000; i++) {
+        double expected = 0;
+        for (int j = 0; j < 301; j++)
+            expected += B(i, j) * u(j, 0);
+        EXPECT_DOUBLE_EQ(v(i, 0), expected);
+    }
+
+    for (int j = 0; j < 301; j++) {
+        double expected = 0;
+        for (int i = 0; i < 1000; i++)
+            expected += 0.5 * B(i, j) * v(i, 0);
+        EXPECT_NEAR(w(0, j), expected, 1e-12 * std::abs(expected));
+    }
+
+    Matrix::set_num_threads(1);
+}
+
+TEST(MATRIX_FUNCTIONS, GEMM) {
+
+    Matrix::Matrix<double> A(3, 2);
+    Matrix::Matrix<double> B(2, 3);
+    Matrix::Matrix<double> C = Matrix::ones<double>(2, 2);
+
+    // C = A^T B^T + 2 C
+    Matrix::gemm(1.0, A, B, 2.0, C, true, true);
+    EXPECT_TRUE(is_equal(C, {12, 30, 15, 42}, {2, 2}));
+
+    // the blocked kernel is checked against the naive loops for every combination of flags
+    Matrix::set_num_threads(4);
+
+    const int N = 150, K = 300, M = 70;
+    for (int flags = 0; flags < 4; flags++) {
+        bool ta = flags & 1;
+        bool tb = flags & 2;
+
+        Matrix::Matrix<double> X = ta ? Matrix::Matrix<double>(K, N) : Matrix::Matrix<double>(N, K);
+        Matrix::Matrix<double> Y = tb ? Matrix::Matrix<double>(M, K) : Matrix::Matrix<double>(K, M);
+        X /= 1000;
+        Matrix::Matrix<double> Z = Matrix::ones<double>(N, M);
+
+        Matrix::gemm(0.5, X, Y, -1.0, Z, ta, tb);
+
+        for (int i = 0; i < N; i++)
+            for (int j = 0; j < M; j++) {
+                double expected = -1;
+                for (int p = 0; p < K; p++)
+                    expected += 0.5 * (ta ? X(p, i) : X(i, p)) * (tb ? Y(j, p) : Y(p, j));
+                EXPECT_NEAR(Z(i, j), expected, 1e-9 * std::abs(expected));
+            }
+    }
+
+    Matrix::set_num_threads(1);
+}
+
+TEST(MATRIX_FUNCTIONS, SYRK) {
+
+    Matrix::Matrix<double> A(2, 3);
+    Matrix::Matrix<double> G(2, 2);
+
+    // G = A A^T
+    Matrix::syrk(1.0, A, 0.0, G);
+    EXPECT_TRUE(is_equal(G, {5, 14, 14, 50}, {2, 2}));
+
+    // only the lower triangle is accumulated without mirroring
+    Matrix::Matrix<double> H = Matrix::ones<double>(3, 3);
+    Matrix::syrk(1.0, A, 1.0, H, true, false);
+    EXPECT_TRUE(is_equal(H, {10, 1, 1, 13, 18, 1, 16, 23, 30}, {3, 3}));
+
+    Matrix::set_num_threads(4);
+
+    for (bool transpose : {false, true}) {
+        Matrix::Matrix<double> X(300, 170);
+        X /= 1000;
+
+        int n = transpose ? 170 : 300;
+        Matrix::Matrix<double> S = Matrix::ones<double>(n, n);
+        Matrix::Matrix<double> R = Matrix::ones<double>(n, n);
+
+        Matrix::syrk(2.0, X, 0.5, S, transpose);
+        Matrix::gemm(2.0, X, X, 0.5, R, transpose, !transpose);
+
+        double worst = 0;
+        for (int i = 0; i < n; i++)
+            for (int j = 0; j < n; j++)
+                worst = std::max(worst, std::abs(S(i, j) - R(i, j)));
+
+        EXPECT_LT(worst, 1e-9);
+    }
+
+    Matrix::set_num_threads(1);
 }
 
 TEST(MATRIX_FUNCTIONS, ZEROS) {
@@ -281,6 +528,82 @@ TEST(MATRIX_FUNCTIONS, SCALE_ROW) {
     EXPECT_TRUE(is_equal(A, {0, 1, 2, 3, 4, 5, 12, 14, 16}, {3, 3}));
 }
 
+TEST(MATRIX_FUNCTIONS, COLUMN_OPERATIONS) {
+
+    Matrix::Matrix<double> A(3, 3);
+
+    Matrix::swap_columns(A, 0, 2);
+    EXPECT_TRUE(is_equal(A, {2, 1, 0, 5, 4, 3, 8, 7, 6}, {3, 3}));
+
+    Matrix::replace_columns(A, 1, 0, -1.0);
+    EXPECT_TRUE(is_equal(A, {1, 1, 0, 1, 4, 3, 1, 7, 6}, {3, 3}));
+
+    Matrix::scale_column(A, 2, 0.5);
+    EXPECT_TRUE(is_equal(A, {1, 1, 0, 1, 4, 1.5, 1, 7, 3}, {3, 3}));
+}
+
+TEST(MATRIX_FUNCTIONS, RANK1_UPDATE) {
+
+    Matrix::Matrix<double> A(3, 3);
+    std::vector<double> x = {1, 2};
+
+    // the rows 1 and 2 minus x times the row 0 from the column 1
+    Matrix::rank1_update(A, 1, 1, x.data(), A.data() + 1, -1.0);
+    EXPECT_TRUE(is_equal(A, {0, 1, 2, 3, 3, 3, 6, 5, 4}, {3, 3}));
+
+    // the long rows are cut into chunks for the threads
+    Matrix::set_num_threads(4);
+
+    Matrix::Matrix<double> B(4, 100000);
+    Matrix::swap_rows(B, 1, 3);
+    Matrix::replace_rows(B, 0, 2, 2.0);
+    Matrix::scale_row(B, 0, -1.0);
+    Matrix::swap_columns(B, 0, 99999);
+
+    Matrix::set_num_threads(1);
+
+    for (int j = 1; j < 99999; j++) {
+        EXPECT_EQ(B(0, j), -j);
+        EXPECT_EQ(B(1, j), 300000 + j);
+        EXPECT_EQ(B(2, j), 200000 + 3 * j);
+        EXPECT_EQ(B(3, j), 100000 + j);
+    }
+    EXPECT_EQ(B(1, 0), 399999);
+    EXPECT_EQ(B(1, 99999), 300000);
+}
+
+TEST(MATRIX_FUNCTIONS, TRANSPOZE) {
+
+    Matrix::Matrix<double> A(2, 3);
+    Matrix::Matrix<double> B = Matrix::transpoze(A);
+    EXPECT_TRUE(is_equal(B, {0, 3, 1, 4, 2, 5}, {3, 2}));
+
+    Matrix::set_num_threads(4);
+
+    for (auto shape : std::vector<std::vector<int>>({{1, 9}, {9, 1}, {37, 70}, {300, 263}, {128, 128}})) {
+        int N = shape[0];
+        int M = shape[1];
+
+        Matrix::Matrix<double> X(N, M);
+        Matrix::Matrix<double> Y = Matrix::transpoze(X);
+
+        Matrix::Matrix<double> Z(X);
+        Matrix::transpoze_inplace(Z);
+
+        EXPECT_EQ(Y.get_shape(), std::vector<int>({M, N}));
+        EXPECT_EQ(Z.get_shape(), std::vector<int>({M, N}));
+
+        bool same = true;
+        for (int i = 0; i < N; i++)
+            for (int j = 0; j < M; j++)
+                same = same && (Y(j, i) == X(i, j)) && (Z(j, i) == X(i, j));
+
+        EXPECT_TRUE(same) << N << " x " << M;
+    }
+
+    Matrix::set_num_threads(1);
+}
+
 TEST(MATRIX_FUNCTIONS, EXP) {
 
     Matrix::Matrix<double> A(3, 3);
@@ -315,4 +638,92 @@ TEST(MATRIX_FUNCTIONS, SIGMOID) {
     };
 
     EXPECT_TRUE(function_tester(B, A, sigmoid_test));
-}
\ No newline at end of file
+}
+
+TEST(MATRIX_FUNCTIONS, BORROW) {
+    float buffer[6] = {1, 2, 3, 4, 5, 6};
+
+    {
+        Matrix::Matrix<float> A = Matrix::borrow(buffer, {2, 3});
+        EXPECT_EQ(A.data(), buffer);
+        EXPECT_EQ(A.get_shape(), std::vector<int>({2, 3}));
+        EXPECT_EQ(A(1, 0), 4);
+
+        A(0, 1) = -2;
+        A *= 2;
+
+        // the copy is the usual matrix
+        Matrix::Matrix<float> B(A);
+        EXPECT_NE(B.data(), buffer);
+        B(0, 0) = 100;
+    }
+
+    // the buffer is not freed and it has the changes
+    EXPECT_EQ(buffer[0], 2);
+    EXPECT_EQ(buffer[1], -4);
+    EXPECT_EQ(buffer[5], 12);
+}
+
+TEST(MATRIX_FUNCTIONS, ADOPT_AND_RELEASE) {
+    int freed = 0;
+    double* buffer = new double[12];
+    for (int i = 0; i < 12; i++)
+        buffer[i] = i;
+
+    {
+        Matrix::Matrix<double> A = Matrix::adopt<double>(buffer, {3, 4}, [&freed](double* p) {
+            freed++;
+            delete[] p;
+        });
+        EXPECT_EQ(A.data(), buffer);
+        EXPECT_EQ(A(2, 3), 11);
+
+        // the move takes the buffer over, it is freed once
+        Matrix::Matrix<double> B(std::move(A));
+        EXPECT_EQ(B.data(), buffer);
+        EXPECT_EQ(A.data(), nullptr);
+
+        Matrix::Matrix<double> C(2, 2);
+        C = std::move(B);
+        EXPECT_EQ(C.data(), buffer);
+        EXPECT_EQ(freed, 0);
+    }
+    EXPECT_EQ(freed, 1);
+
+    // without the deleter the buffer is freed by delete[]
+    Matrix::Matrix<int> D = Matrix::adopt(new int[4](), {4});
+    EXPECT_EQ(D(3), 0);
+
+    // the released buffer is not freed by the matrix
+    Matrix::Matrix<float> E(2, 5);
+    const float* storage = E.data();
+    float* released = E.release();
+    EXPECT_EQ(released, storage);
+    EXPECT_EQ(released[9], 9);
+    EXPECT_EQ(E.data(), nullptr);
+    EXPECT_EQ(E.get_matrix_size(), 0);
+    delete[] released;
+
+    // the released adopted buffer is freed by the deleter handed out with it
+    double* other = new double[2]();
+    Matrix::Matrix<double> F = Matrix::adopt<double>(other, {2}, [&freed](double* p) {
+        freed++;
+        delete[] p;
+    });
+    std::function<void(double*)> deleter;
+    EXPECT_EQ(F.release(deleter), other);
+    EXPECT_EQ(F.data(), nullptr);
+    EXPECT_EQ(freed, 1);
+    deleter(other);
+    EXPECT_EQ(freed, 2);
+
+    // the deleter of the library storage is delete[], the borrowed buffer is not freed
+    std::function<void(float*)> library_deleter, borrow_deleter;
+    Matrix::Matrix<float> G(3, 3);
+    float* owned = G.release(library_deleter);
+    Matrix::Matrix<float> H = Matrix::borrow(owned, {9});
+    EXPECT_EQ(H.release(borrow_deleter), owned);
+    borrow_deleter(owned);
+    EXPECT_EQ(owned[8], 8);
+    library_deleter(owned);
+}
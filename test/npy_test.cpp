@@ -0,0 +1,226 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+#include <atrix/matrix.h>
+#include <atrix/npy.h>
+#include <atrix/half.h>
+#include <atrix/errors.h>
+
+template <typename DType>
+static void expect_same(const Matrix::Matrix<DType>& A, const Matrix::Matrix<DType>& B) {
+    ASSERT_EQ(A.get_shape(), B.get_shape());
+    for (int i = 0; i < A.get_matrix_size(); i++)
+        EXPECT_EQ(A.data()[i], B.data()[i]) << "at " << i;
+}
+
+template <typename DType>
+static Matrix::Matrix<DType> round_trip(const Matrix::Matrix<DType>& A) {
+    std::stringstream stream;
+    Matrix::save(stream, A);
+    return Matrix::load<DType>(stream);
+}
+
+// the .npy file of the header dictionary and the raw bytes of the elements
+static std::string npy_file(const std::string& dict, const std::string& data) {
+    std::string header = dict;
+    while ((10 + header.size() + 1) % 64 != 0)
+        header += ' ';
+    header += '\n';
+
+    std::string file("\x93NUMPY\x01\x00", 8);
+    file += char(header.size() & 0xff);
+    file += char(header.size() >> 8);
+    return file + header + data;
+}
+
+TEST(NPY, ROUND_TRIP) {
+    Matrix::Matrix<double> A(3, 4, 5);
+    A(1, 2, 3) = -0.125;
+    expect_same(A, round_trip(A));
+
+    Matrix::Matrix<float> B(1000);
+    B(999) = 3.5e-7f;
+    expect_same(B, round_trip(B));
+
+    Matrix::Matrix<int> C(7, 9);
+    C(6, 8) = -123456;
+    expect_same(C, round_trip(C));
+
+    Matrix::Matrix<int8_t> D(2, 2, 2, 2);
+    D(1, 1, 1, 1) = -128;
+    expect_same(D, round_trip(D));
+
+    Matrix::Matrix<uint16_t> E(3, 33);
+    expect_same(E, round_trip(E));
+
+    Matrix::Matrix<bool> F(4, 4);
+    F(0, 0) = true;
+    F(3, 3) = false;
+    expect_same(F, round_trip(F));
+
+    Matrix::Matrix<Matrix::float16> G(5, 6);
+    G(4, 5) = Matrix::float16(-2.5f);
+    expect_same(G, round_trip(G));
+}
+
+TEST(NPY, HEADER) {
+    Matrix::Matrix<float> A(3, 4);
+    std::stringstream stream;
+    Matrix::save(stream, A);
+    const std::string file = stream.str();
+
+    // the header of numpy.save, padded so that the data starts at a multiple of 64 bytes
+    ASSERT_EQ(file.size(), 128u + 12 * sizeof(float));
+    EXPECT_EQ(file.substr(0, 8), std::string("\x93NUMPY\x01\x00", 8));
+    EXPECT_EQ((unsigned char) file[8] + 10, 128);
+    EXPECT_EQ(file[127], '\n');
+    EXPECT_EQ(file.substr(10, 52), "{'descr': '<f4', 'fortran_order': False, 'shape': (3");
+    EXPECT_NE(file.find("'shape': (3, 4), }"), std::string::npos);
+
+    Matrix::Matrix<int8_t> B(5);
+    std::stringstream one;
+    Matrix::save(one, B);
+    EXPECT_NE(one.str().find("'descr': '|i1'"), std::string::npos);
+    EXPECT_NE(one.str().find("'shape': (5,), }"), std::string::npos);
+}
+
+TEST(NPY, FOREIGN_LAYOUTS) {
+    // the (2, 3) matrix [[0, 1, 2], [3, 4, 5]] in the column-major order
+    const short column_major[6] = {0, 3, 1, 4, 2, 5};
+    std::stringstream fortran(npy_file("{'descr': '<i2', 'fortran_order': True, 'shape': (2, 3), }",
+                                       std::string(reinterpret_cast<const char*>(column_major), sizeof(column_major))));
+    Matrix::Matrix<short> A = Matrix::load<short>(fortran);
+    ASSERT_EQ(A.get_shape(), std::vector<int>({2, 3}));
+    for (int i = 0; i < 6; i++)
+        EXPECT_EQ(A.data()[i], i);
+
+    // the (2, 2, 2) matrix in the column-major order
+    const short cube[8] = {0, 4, 2, 6, 1, 5, 3, 7};
+    std::stringstream fortran3(npy_file("{'descr': '<i2', 'fortran_order': True, 'shape': (2, 2, 2), }",
+                                        std::string(reinterpret_cast<const char*>(cube), sizeof(cube))));
+    Matrix::Matrix<short> B = Matrix::load<short>(fortran3);
+    for (int i = 0; i < 8; i++)
+        EXPECT_EQ(B.data()[i], i);
+
+    // the big endian 1.0 and -2.0
+    const std::string big("\x3f\xf0\x00\x00\x00\x00\x00\x00\xc0\x00\x00\x00\x00\x00\x00\x00", 16);
+    std::stringstream swapped(npy_file("{'descr': '>f8', 'fortran_order': False, 'shape': (2,), }", big));
+    Matrix::Matrix<double> C = Matrix::load<double>(swapped);
+    EXPECT_EQ(C(0), 1.0);
+    EXPECT_EQ(C(1), -2.0);
+
+    // the zero dimensional array
+    const float scalar = 4.5f;
+    std::stringstream zero(npy_file("{'descr': '<f4', 'fortran_order': False, 'shape': (), }",
+                                    std::string(reinterpret_cast<const char*>(&scalar), sizeof(scalar))));
+    Matrix::Matrix<float> D = Matrix::load<float>(zero);
+    EXPECT_EQ(D.get_shape(), std::vector<int>({1}));
+    EXPECT_EQ(D(0), 4.5f);
+}
+
+TEST(NPY, ERRORS) {
+    Matrix::Matrix<float> A(4, 4);
+    std::stringstream stream;
+    Matrix::save(stream, A);
+    const std::string file = stream.str();
+
+    // the other element type
+    std::stringstream other(file);
+    EXPECT_THROW(Matrix::load<double>(other), Matrix::SerializationError);
+
+    // the file that ends in the data
+    std::stringstream truncated(file.substr(0, file.size() - 1));
+    EXPECT_THROW(Matrix::load<float>(truncated), Matrix::SerializationError);
+
+    // the bad magic
+    std::string bad = file;
+    bad[1] = 'M';
+    std::stringstream magic(bad);
+    EXPECT_THROW(Matrix::load<float>(magic), Matrix::SerializationError);
+
+    // the empty dimension
+    std::stringstream empty(npy_file("{'descr': '<f4', 'fortran_order': False, 'shape': (0, 3), }", ""));
+    EXPECT_THROW(Matrix::load<float>(empty), Matrix::SerializationError);
+
+    // the dimensions that are not plain numbers, or too large for int
+    for (const char* shape : {"(3L, 4L)", "(x, 3)", "(-3, 4)", "(4294967296,)", "(99999999999999999999999,)"}) {
+        std::stringstream malformed(npy_file(std::string("{'descr': '<f4', 'fortran_order': False, 'shape': ")
+                                             + shape + ", }", ""));
+        EXPECT_THROW(Matrix::load<float>(malformed), Matrix::SerializationError) << shape;
+    }
+
+    // the header without fortran_order
+    std::stringstream unordered(npy_file("{'descr': '<f4', 'shape': (1,), }", std::string(4, '\0')));
+    EXPECT_THROW(Matrix::load<float>(unordered), Matrix::SerializationError);
+
+    EXPECT_THROW(Matrix::load<float>("/nonexistent/matrix.npy"), Matrix::SerializationError);
+}
+
+TEST(NPY, FILES) {
+    const std::string path = ::testing::TempDir() + "npy_test.npy";
+
+    Matrix::Matrix<double> A(64, 65);
+    A(63, 64) = 1e300;
+    Matrix::save(path, A);
+    expect_same(A, Matrix::load<double>(path));
+
+    std::remove(path.c_str());
+}
+
+TEST(NPY, ARCHIVE) {
+    const std::string path = ::testing::TempDir() + "npy_test.npz";
+
+    Matrix::Matrix<float> W(30, 20);
+    Matrix::Matrix<float> b(20);
+    Matrix::Matrix<int> steps(1);
+    W(29, 19) = -1.5f;
+    steps(0) = 1000;
+
+    {
+        Matrix::ArchiveWriter archive(path);
+        archive.add("W", W);
+        archive.add("b", b);
+        archive.add("steps", steps);
+    }
+
+    Matrix::ArchiveReader archive(path);
+    EXPECT_EQ(archive.names(), std::vector<std::string>({"W", "b", "steps"}));
+    EXPECT_TRUE(archive.contains("b"));
+    EXPECT_FALSE(archive.contains("c"));
+
+    // in any order
+    expect_same(steps, archive.get<int>("steps"));
+    expect_same(W, archive.get<float>("W"));
+    expect_same(b, archive.get<float>("b"));
+
+    EXPECT_THROW(archive.get<float>("c"), Matrix::SerializationError);
+    EXPECT_THROW(archive.get<double>("W"), Matrix::SerializationError);
+
+    std::remove(path.c_str());
+}
@@ -0,0 +1,132 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+#include <atrix/matrix.h>
+#include <atrix/outofcore.h>
+#include <atrix/npy.h>
+#include <atrix/reductions.h>
+#include <atrix/distributions.h>
+#include <atrix/errors.h>
+
+static std::string temp_path(const std::string& name) {
+    return ::testing::TempDir() + "outofcore_test_" + name;
+}
+
+template <typename DType>
+static void expect_near(const Matrix::Matrix<DType>& A, const Matrix::Matrix<DType>& B, const double tolerance) {
+    ASSERT_EQ(A.get_shape(), B.get_shape());
+    for (int i = 0; i < A.get_matrix_size(); i++)
+        ASSERT_NEAR(A.data()[i], B.data()[i], tolerance) << "at " << i;
+}
+
+TEST(OUTOFCORE, TILES) {
+    const std::string path = temp_path("tiles.npy");
+
+    Matrix::Matrix<int> A(7, 9);
+    Matrix::save(path, A);
+
+    Matrix::FileMatrix<int> F(path, true);
+    EXPECT_EQ(F.get_shape(), A.get_shape());
+    EXPECT_EQ(F.get_matrix_size(), 63);
+
+    int tile[6];
+    F.read_tile(2, 2, 4, 3, tile);
+    for (int i = 0; i < 2; i++)
+        for (int j = 0; j < 3; j++)
+            EXPECT_EQ(tile[i * 3 + j], A(2 + i, 4 + j));
+
+    const int values[4] = {-1, -2, -3, -4};
+    F.write_tile(5, 2, 7, 2, values);
+    Matrix::Matrix<int> B = Matrix::load<int>(path);
+    EXPECT_EQ(B(5, 7), -1);
+    EXPECT_EQ(B(6, 8), -4);
+    EXPECT_EQ(B(5, 6), A(5, 6));
+
+    EXPECT_THROW(Matrix::FileMatrix<float> G(path), Matrix::SerializationError);
+    std::remove(path.c_str());
+}
+
+TEST(OUTOFCORE, DOT) {
+    Matrix::Generator gen(5);
+    const std::size_t budget = Matrix::get_memory_budget();
+
+    // the budgets of many uneven tiles and of one tile
+    for (std::size_t bytes : {std::size_t(1) << 12, std::size_t(50000), std::size_t(1) << 24}) {
+        Matrix::set_memory_budget(bytes);
+
+        Matrix::Matrix<double> A(70, 130);
+        Matrix::Matrix<double> B(130, 90);
+        Matrix::normal(A, 0.0, 1.0, gen);
+        Matrix::normal(B, 0.0, 1.0, gen);
+        Matrix::save(temp_path("A.npy"), A);
+        Matrix::save(temp_path("B.npy"), B);
+
+        {
+            Matrix::FileMatrix<double> FA(temp_path("A.npy"));
+            Matrix::FileMatrix<double> FB(temp_path("B.npy"));
+            Matrix::FileMatrix<double> FC(temp_path("C.npy"), {70, 90});
+            Matrix::dot(FA, FB, FC);
+        }
+
+        expect_near(Matrix::load<double>(temp_path("C.npy")), Matrix::dot(A, B), 1e-10);
+    }
+
+    Matrix::set_memory_budget(budget);
+    for (auto name : {"A.npy", "B.npy", "C.npy"})
+        std::remove(temp_path(name).c_str());
+}
+
+TEST(OUTOFCORE, REDUCTIONS) {
+    Matrix::Generator gen(9);
+    const std::size_t budget = Matrix::get_memory_budget();
+    const std::string path = temp_path("reductions.npy");
+
+    Matrix::Matrix<double> A(333, 47);
+    Matrix::normal(A, 1.0, 2.0, gen);
+    Matrix::save(path, A);
+
+    // the chunks of a few rows
+    Matrix::set_memory_budget(47 * 8 * 2 * 5);
+    Matrix::FileMatrix<double> F(path);
+
+    EXPECT_NEAR(Matrix::sum(F), Matrix::sum(A), 1e-9);
+    EXPECT_NEAR(Matrix::mean(F), Matrix::mean(A), 1e-12);
+    EXPECT_EQ(Matrix::min(F), Matrix::min(A));
+    EXPECT_EQ(Matrix::max(F), Matrix::max(A));
+
+    for (int axis : {0, 1, -1}) {
+        expect_near(Matrix::sum(F, axis), Matrix::sum(A, axis), 1e-10);
+        expect_near(Matrix::mean(F, axis, true), Matrix::mean(A, axis, true), 1e-12);
+        expect_near(Matrix::min(F, axis), Matrix::min(A, axis), 0);
+        expect_near(Matrix::max(F, axis), Matrix::max(A, axis), 0);
+    }
+
+    Matrix::set_memory_budget(budget);
+    std::remove(path.c_str());
+}
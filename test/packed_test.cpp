@@ -0,0 +1,124 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#include <gtest/gtest.h>
+#include <sstream>
+#include <vector>
+
+#include <atrix/matrix.h>
+#include <atrix/packed.h>
+#include <atrix/errors.h>
+#include <atrix/distributions.h>
+
+// the packed operands go through the same kernel in the same order, so the results are equal
+template <typename DType>
+void expect_equal(const Matrix::Matrix<DType>& A, const Matrix::Matrix<DType>& B) {
+    ASSERT_EQ(A.get_shape(), B.get_shape());
+    for (int i = 0; i < A.get_matrix_size(); i++)
+        EXPECT_EQ(A.data()[i], B.data()[i]);
+}
+
+TEST(PACKED, DOT) {
+    Matrix::Generator gen(3);
+
+    // the sizes go past the register tile and the cache blocks of gemm
+    for (auto shape : std::vector<std::vector<int>>({{1, 1, 1}, {1, 300, 70}, {3, 5, 7}, {33, 300, 70}, {130, 17, 2100}})) {
+        const int n = shape[0], k = shape[1], m = shape[2];
+
+        Matrix::Matrix<double> X(n, k);
+        Matrix::Matrix<double> W(k, m);
+        Matrix::Matrix<double> WT(m, k);
+        Matrix::uniform(X, -1.0, 1.0, gen);
+        Matrix::uniform(W, -1.0, 1.0, gen);
+        Matrix::uniform(WT, -1.0, 1.0, gen);
+
+        Matrix::Matrix<double> XW(n, m);
+        Matrix::gemm(1.0, X, W, 0.0, XW);
+
+        Matrix::PackedMatrix<double> PW(W);
+        EXPECT_EQ(PW.get_shape(), std::vector<int>({k, m}));
+        EXPECT_FALSE(PW.is_left());
+        expect_equal(Matrix::dot(X, PW), XW);
+
+        // the transposed weights
+        Matrix::Matrix<double> XWT(n, m);
+        Matrix::gemm(1.0, X, WT, 0.0, XWT, false, true);
+        expect_equal(Matrix::dot(X, Matrix::PackedMatrix<double>(WT, false, true)), XWT);
+
+        // the weights on the left
+        Matrix::Matrix<double> Y(m, k);
+        Matrix::uniform(Y, -1.0, 1.0, gen);
+        Matrix::Matrix<double> XY(n, m);
+        Matrix::gemm(1.0, X, Y, 0.0, XY, false, true);
+
+        Matrix::PackedMatrix<double> PX(X, true);
+        EXPECT_TRUE(PX.is_left());
+        expect_equal(Matrix::dot(PX, Matrix::transpoze(Y)), XY);
+
+        Matrix::Matrix<double> C = Matrix::ones<double>(n, m);
+        Matrix::Matrix<double> EXPECTED = Matrix::ones<double>(n, m);
+        Matrix::gemm(2.0, X, Y, 0.5, EXPECTED, false, true);
+        Matrix::gemm(2.0, PX, Y, 0.5, C, true);
+        expect_equal(C, EXPECTED);
+    }
+}
+
+TEST(PACKED, SERIALIZATION) {
+    Matrix::Matrix<float> W(300, 45);
+    Matrix::Matrix<float> X(9, 300);
+    Matrix::uniform(W, -1.0f, 1.0f);
+    Matrix::uniform(X, -1.0f, 1.0f);
+
+    for (bool left : {false, true}) {
+        Matrix::PackedMatrix<float> P = left ? Matrix::PackedMatrix<float>(W, true, true)
+                                             : Matrix::PackedMatrix<float>(W);
+
+        std::stringstream stream;
+        P.save(stream);
+        Matrix::PackedMatrix<float> Q = Matrix::load_packed<float>(stream);
+
+        EXPECT_EQ(Q.get_shape(), P.get_shape());
+        EXPECT_EQ(Q.is_left(), left);
+        ASSERT_EQ(Q.get_packed_size(), P.get_packed_size());
+        for (long i = 0; i < P.get_packed_size(); i++)
+            EXPECT_EQ(Q.data()[i], P.data()[i]);
+
+        if (left)
+            expect_equal(Matrix::dot(Q, Matrix::transpoze(X)), Matrix::dot(P, Matrix::transpoze(X)));
+        else
+            expect_equal(Matrix::dot(X, Q), Matrix::dot(X, P));
+
+        // another element type, and the stream that ends early
+        std::stringstream again;
+        P.save(again);
+        EXPECT_THROW(Matrix::load_packed<double>(again), Matrix::SerializationError);
+
+        std::string bytes = stream.str();
+        std::stringstream truncated(bytes.substr(0, bytes.size() / 2));
+        EXPECT_THROW(Matrix::load_packed<float>(truncated), Matrix::SerializationError);
+    }
+
+    std::stringstream garbage("not a packed matrix");
+    EXPECT_THROW(Matrix::load_packed<float>(garbage), Matrix::SerializationError);
+}
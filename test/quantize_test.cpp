@@ -0,0 +1,124 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#include <gtest/gtest.h>
+#include <vector>
+#include <cmath>
+#include <cstdint>
+
+#include <atrix/matrix.h>
+#include <atrix/quantize.h>
+#include <atrix/distributions.h>
+
+TEST(QUANTIZE, QUANTIZE) {
+    Matrix::Generator gen(7);
+    Matrix::Matrix<float> A(37, 53);
+    Matrix::uniform(A, -3.0f, 5.0f, gen);
+    A(3, 4) = 5.0f;
+
+    // one scale
+    Matrix::QuantizedMatrix Q = Matrix::quantize(A);
+    EXPECT_EQ(Q.values.get_shape(), A.get_shape());
+    EXPECT_EQ(Q.scales.size(), 1u);
+    EXPECT_FLOAT_EQ(Q.scales[0], 5.0f / 127.0f);
+    EXPECT_EQ(Q.zero_points[0], 0);
+    EXPECT_EQ(Q.values(3, 4), 127);
+
+    Matrix::Matrix<float> D = Matrix::dequantize(Q);
+    for (int i = 0; i < 37; i++)
+        for (int j = 0; j < 53; j++)
+            EXPECT_NEAR(D(i, j), A(i, j), Q.scales[0] / 2 * 1.0001f);
+
+    // a scale and a zero point for every row and for every column
+    for (int axis = 0; axis < 2; axis++) {
+        for (bool symmetric : {true, false}) {
+            Matrix::QuantizedMatrix QC = Matrix::quantize(A, axis, symmetric);
+            Matrix::Matrix<double> DC = Matrix::dequantize<double>(QC);
+
+            EXPECT_EQ(QC.scales.size(), size_t(A.get_shape()[axis]));
+            for (int i = 0; i < 37; i++) {
+                for (int j = 0; j < 53; j++) {
+                    const int c = axis == 0 ? i : j;
+                    EXPECT_NEAR(DC(i, j), A(i, j), QC.scales[c] / 2 * 1.0001f);
+                    if (symmetric) {
+                        EXPECT_GE(QC.values(i, j), -127);
+                    }
+                }
+            }
+        }
+    }
+
+    // zero is exact and the zero matrix gets a scale
+    Matrix::Matrix<float> Z = Matrix::zeros<float>(4, 4);
+    Z(1, 1) = 2.0f;
+    Z(2, 2) = 10.0f;
+    Matrix::QuantizedMatrix QZ = Matrix::quantize(Z, 0, false);
+    EXPECT_EQ(QZ.scales[0], 1.0f);
+    EXPECT_EQ(QZ.zero_points[1], -128);
+    EXPECT_EQ(QZ.values(1, 1), 127);
+    EXPECT_EQ(Matrix::dequantize(QZ)(1, 0), 0.0f);
+    EXPECT_FLOAT_EQ(Matrix::dequantize(QZ)(2, 2), 10.0f);
+}
+
+TEST(QUANTIZE, DOT) {
+    Matrix::Generator gen(11);
+
+    // the sizes go through the tails of the kernels
+    for (int size : {1, 7, 70, 129}) {
+        Matrix::Matrix<float> A(size + 2, size);
+        Matrix::Matrix<float> B(size, size + 3);
+        Matrix::uniform(A, -1.0f, 3.0f, gen);
+        Matrix::normal(B, 0.0f, 1.0f, gen);
+
+        for (int a_axis : {-1, 0}) {
+            for (int b_axis : {-1, 1}) {
+                Matrix::QuantizedMatrix QA = Matrix::quantize(A, a_axis, false);
+                Matrix::QuantizedMatrix QB = Matrix::quantize(B, b_axis, b_axis == -1);
+
+                // the integer products are exact, only the float scaling rounds
+                Matrix::Matrix<double> DA = Matrix::dequantize<double>(QA);
+                Matrix::Matrix<double> DB = Matrix::dequantize<double>(QB);
+                Matrix::Matrix<double> EXPECTED = Matrix::dot(DA, DB);
+                Matrix::Matrix<float> C = Matrix::dot(QA, QB);
+
+                EXPECT_EQ(C.get_shape(), std::vector<int>({size + 2, size + 3}));
+                for (int i = 0; i < size + 2; i++)
+                    for (int j = 0; j < size + 3; j++)
+                        EXPECT_NEAR(C(i, j), EXPECTED(i, j), 1e-5 * (1 + std::fabs(EXPECTED(i, j))));
+            }
+        }
+    }
+
+    // the dynamic quantization of the float activations is close to the float dot
+    Matrix::Matrix<float> X(16, 256);
+    Matrix::Matrix<float> W(256, 32);
+    Matrix::uniform(X, 0.0f, 1.0f, gen);
+    Matrix::normal(W, 0.0f, 0.1f, gen);
+
+    Matrix::Matrix<float> Y = Matrix::dot(X, Matrix::quantize(W, 1));
+    Matrix::Matrix<float> EXPECTED = Matrix::dot(X, W);
+    for (int i = 0; i < 16; i++)
+        for (int j = 0; j < 32; j++)
+            EXPECT_NEAR(Y(i, j), EXPECTED(i, j), 0.05);
+}
@@ -0,0 +1,163 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#include <gtest/gtest.h>
+#include <vector>
+#include <cmath>
+
+#include <atrix/matrix.h>
+#include <atrix/reductions.h>
+
+TEST(REDUCTIONS, FULL) {
+    Matrix::Matrix<double> A(2, 3);   // [[0, 1, 2], [3, 4, 5]]
+
+    EXPECT_DOUBLE_EQ(Matrix::sum(A), 15);
+    EXPECT_DOUBLE_EQ(Matrix::mean(A), 2.5);
+    EXPECT_DOUBLE_EQ(Matrix::min(A), 0);
+    EXPECT_DOUBLE_EQ(Matrix::max(A), 5);
+    EXPECT_EQ(Matrix::argmin(A), 0);
+    EXPECT_EQ(Matrix::argmax(A), 5);
+    EXPECT_DOUBLE_EQ(Matrix::variance(A), 17.5 / 6);
+    EXPECT_DOUBLE_EQ(Matrix::norm(A), std::sqrt(55.0));
+    EXPECT_DOUBLE_EQ(Matrix::norm(A, 1), 15);
+    EXPECT_DOUBLE_EQ(Matrix::norm(A, INFINITY), 5);
+    EXPECT_NEAR(Matrix::norm(A, 3), std::cbrt(225.0), 1e-12);
+
+    // the first index wins when the extreme value repeats
+    Matrix::Matrix<int> B(1, 5);
+    B(0, 0) = 1; B(0, 1) = 7; B(0, 2) = -2; B(0, 3) = 7; B(0, 4) = -2;
+    EXPECT_EQ(Matrix::argmax(B), 1);
+    EXPECT_EQ(Matrix::argmin(B), 2);
+}
+
+TEST(REDUCTIONS, AXIS) {
+    Matrix::Matrix<double> A(2, 3);   // [[0, 1, 2], [3, 4, 5]]
+
+    Matrix::Matrix<double> s0 = Matrix::sum(A, 0);
+    EXPECT_EQ(s0.get_shape(), std::vector<int>({3}));
+    EXPECT_EQ(s0(0), 3);
+    EXPECT_EQ(s0(1), 5);
+    EXPECT_EQ(s0(2), 7);
+
+    Matrix::Matrix<double> s1 = Matrix::sum(A, -1, true);
+    EXPECT_EQ(s1.get_shape(), std::vector<int>({2, 1}));
+    EXPECT_EQ(s1(0, 0), 3);
+    EXPECT_EQ(s1(1, 0), 12);
+
+    Matrix::Matrix<double> m = Matrix::mean(A, 1);
+    EXPECT_EQ(m(0), 1);
+    EXPECT_EQ(m(1), 4);
+
+    Matrix::Matrix<double> v = Matrix::variance(A, 0, true);
+    EXPECT_EQ(v.get_shape(), std::vector<int>({1, 3}));
+    for (int j = 0; j < 3; j++)
+        EXPECT_DOUBLE_EQ(v(0, j), 2.25);
+
+    Matrix::Matrix<int> am = Matrix::argmax(A, 0);
+    Matrix::Matrix<int> an = Matrix::argmin(A, 1);
+    for (int j = 0; j < 3; j++)
+        EXPECT_EQ(am(j), 1);
+    EXPECT_EQ(an(0), 0);
+    EXPECT_EQ(an(1), 0);
+
+    Matrix::Matrix<double> n = Matrix::norm(A, 2, 1, true);
+    EXPECT_DOUBLE_EQ(n(0, 0), std::sqrt(5.0));
+    EXPECT_DOUBLE_EQ(n(1, 0), std::sqrt(50.0));
+
+    // the middle axis of a 3d matrix, wider than one block of columns
+    Matrix::Matrix<double> C(3, 70, 300);
+    Matrix::Matrix<double> mx = Matrix::max(C, 1);
+    Matrix::Matrix<double> mn = Matrix::min(C, 1);
+    Matrix::Matrix<double> sc = Matrix::sum(C, 1);
+    EXPECT_EQ(mx.get_shape(), std::vector<int>({3, 300}));
+    for (int o = 0; o < 3; o++) {
+        for (int i = 0; i < 300; i++) {
+            double expected = 0;
+            for (int k = 0; k < 70; k++)
+                expected += C(o, k, i);
+
+            EXPECT_DOUBLE_EQ(sc(o, i), expected);
+            EXPECT_EQ(mx(o, i), C(o, 69, i));
+            EXPECT_EQ(mn(o, i), C(o, 0, i));
+        }
+    }
+}
+
+TEST(REDUCTIONS, ARG_NAN) {
+    // longer than the lanes, the first NaN wins over the extreme numbers
+    Matrix::Matrix<double> A(1, 40);
+    A(0, 3) = -100; A(0, 17) = NAN; A(0, 25) = 100; A(0, 30) = NAN;
+    EXPECT_EQ(Matrix::argmax(A), 17);
+    EXPECT_EQ(Matrix::argmin(A), 17);
+
+    A(0, 0) = NAN;
+    EXPECT_EQ(Matrix::argmax(A), 0);
+    EXPECT_EQ(Matrix::argmin(A), 0);
+
+    // a NaN in a later chunk of a large matrix
+    Matrix::Matrix<float> B(300, 1000);
+    B(299, 998) = NAN;
+    EXPECT_EQ(Matrix::argmax(B), 299 * 1000 + 998);
+    EXPECT_EQ(Matrix::argmin(B), 299 * 1000 + 998);
+
+    // along the contiguous axis and across the rows
+    Matrix::Matrix<double> C(3, 20);
+    C(1, 5) = NAN; C(1, 9) = NAN; C(2, 0) = NAN;
+    Matrix::Matrix<int> am1 = Matrix::argmax(C, 1);
+    Matrix::Matrix<int> an1 = Matrix::argmin(C, 1);
+    EXPECT_EQ(am1(0), 19); EXPECT_EQ(am1(1), 5); EXPECT_EQ(am1(2), 0);
+    EXPECT_EQ(an1(0), 0); EXPECT_EQ(an1(1), 5); EXPECT_EQ(an1(2), 0);
+
+    Matrix::Matrix<int> am0 = Matrix::argmax(C, 0);
+    Matrix::Matrix<int> an0 = Matrix::argmin(C, 0);
+    EXPECT_EQ(am0(0), 2); EXPECT_EQ(am0(5), 1); EXPECT_EQ(am0(9), 1); EXPECT_EQ(am0(1), 2);
+    EXPECT_EQ(an0(0), 2); EXPECT_EQ(an0(5), 1); EXPECT_EQ(an0(9), 1); EXPECT_EQ(an0(1), 0);
+}
+
+TEST(REDUCTIONS, THREADS) {
+    Matrix::Matrix<float> A(1000, 1000);
+    for (int i = 0; i < 1000; i++)
+        for (int j = 0; j < 1000; j++)
+            A(i, j) = std::sin(i * 1000.0f + j);
+
+    float serial = Matrix::sum(A);
+    Matrix::Matrix<float> serial_rows = Matrix::sum(A, 0);
+
+    Matrix::set_num_threads(4);
+    float parallel = Matrix::sum(A);
+    Matrix::Matrix<float> parallel_rows = Matrix::sum(A, 0);
+    Matrix::set_num_threads(1);
+
+    // the same chunks are summed in the same order whatever the number of threads is
+    EXPECT_EQ(serial, parallel);
+    for (int j = 0; j < 1000; j++)
+        EXPECT_EQ(serial_rows(j), parallel_rows(j));
+
+    // the pairwise summation keeps the float sum close to the double sum
+    double expected = 0;
+    for (int i = 0; i < 1000; i++)
+        for (int j = 0; j < 1000; j++)
+            expected += A(i, j);
+    EXPECT_NEAR(serial, expected, 1e-2);
+}
@@ -0,0 +1,207 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atrix/matrix.h>
+#include <atrix/shared.h>
+#include <atrix/reductions.h>
+#include <atrix/errors.h>
+
+static std::string segment_name(const std::string& name) {
+    return "atrix_shared_test_" + name + "_" + std::to_string(getpid());
+}
+
+// the line of /proc/self/maps of the address names the segment, so it is not a private copy
+static bool maps_segment(const void* address, const std::string& name) {
+    std::ifstream maps("/proc/self/maps");
+    const std::uintptr_t a = reinterpret_cast<std::uintptr_t>(address);
+    std::string line;
+
+    while (std::getline(maps, line)) {
+        unsigned long first, last;
+        if (std::sscanf(line.c_str(), "%lx-%lx", &first, &last) == 2 && first <= a && a < last)
+            return line.find("/dev/shm/" + name) != std::string::npos;
+    }
+
+    return false;
+}
+
+TEST(SHARED, CREATE_AND_ATTACH) {
+    const std::string name = segment_name("attach");
+
+    {
+        Matrix::Matrix<float> A = Matrix::create_shared<float>(name, {3, 5});
+        EXPECT_EQ(A.get_shape(), std::vector<int>({3, 5}));
+        EXPECT_EQ(A(2, 4), 0.0f);
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(A.data()) % sysconf(_SC_PAGESIZE), 0u);
+        EXPECT_EQ(Matrix::shared_references(name), 1);
+
+        A(1, 2) = 7.5f;
+
+        Matrix::Matrix<float> B = Matrix::attach_shared<float>(name);
+        EXPECT_EQ(B.get_shape(), A.get_shape());
+        EXPECT_NE(B.data(), A.data());
+        EXPECT_EQ(B(1, 2), 7.5f);
+        EXPECT_EQ(Matrix::shared_references(name), 2);
+
+        // the two mappings are the same memory
+        B(0, 0) = -1.0f;
+        EXPECT_EQ(A(0, 0), -1.0f);
+        EXPECT_TRUE(maps_segment(B.data(), name));
+
+        EXPECT_THROW(Matrix::attach_shared<double>(name), Matrix::SharedMemoryError);
+        EXPECT_THROW(Matrix::create_shared<float>(name, {2}), Matrix::SharedMemoryError);
+        EXPECT_EQ(Matrix::shared_references(name), 2);
+    }
+
+    // the last matrix removed the segment
+    EXPECT_EQ(Matrix::shared_references(name), 0);
+    EXPECT_THROW(Matrix::attach_shared<float>(name), Matrix::SharedMemoryError);
+}
+
+TEST(SHARED, HUGE_PAGES) {
+    const std::string name = segment_name("huge");
+
+    Matrix::Matrix<double> A = Matrix::create_shared<double>(name, {1000, 1000}, true);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(A.data()) % (std::uintptr_t(2) << 20), 0u);
+
+    A(999, 999) = 3.0;
+    Matrix::Matrix<double> B = Matrix::attach_shared<double>(name);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(B.data()) % (std::uintptr_t(2) << 20), 0u);
+    EXPECT_EQ(B(999, 999), 3.0);
+}
+
+TEST(SHARED, INHERITED_BY_FORK) {
+    const std::string name = segment_name("inherited");
+
+    Matrix::Matrix<int> A = Matrix::create_shared<int>(name, {16});
+
+    // the child destroys the inherited copy like a child that returns normally
+    pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+        int code = (Matrix::shared_references(name) != 2);
+        {
+            Matrix::Matrix<int> inherited = std::move(A);
+            inherited(3) = 42;
+        }
+        _exit(code);
+    }
+
+    int status = 0;
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+
+    // the segment of the parent is still there
+    EXPECT_EQ(A(3), 42);
+    EXPECT_EQ(Matrix::shared_references(name), 1);
+    EXPECT_EQ(Matrix::attach_shared<int>(name)(3), 42);
+
+    // the child that skips the destructors leaves its reference behind
+    pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0)
+        _exit(0);
+
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    EXPECT_EQ(Matrix::shared_references(name), 2);
+
+    A = Matrix::Matrix<int>(1);
+    EXPECT_EQ(Matrix::shared_references(name), 1);
+    Matrix::remove_shared(name);
+    EXPECT_EQ(Matrix::shared_references(name), 0);
+}
+
+TEST(SHARED, FORKED_WORKERS) {
+    const std::string name = segment_name("workers");
+    const int workers = 4;
+    const int rows = 2048, cols = 1024;
+
+    Matrix::Matrix<float> A = Matrix::create_shared<float>(name, {rows, cols});
+    for (int i = 0; i < rows; i++)
+        for (int j = 0; j < cols; j++)
+            A(i, j) = (i + j) % 7;
+
+    // the pool of the parent has started its workers before the fork
+    Matrix::set_num_threads(4);
+
+    // the workers write into the last rows, the other rows are checked
+    const float expected = Matrix::sum(Matrix::borrow(A.data(), {rows - workers, cols}));
+
+    std::vector<pid_t> children;
+    for (int w = 0; w < workers; w++) {
+        pid_t pid = fork();
+        ASSERT_GE(pid, 0);
+
+        if (pid == 0) {
+            // a deadlock of the inherited pool kills the worker instead of the test
+            alarm(10);
+
+            int code = 0;
+            {
+                Matrix::Matrix<float> W = Matrix::attach_shared<float>(name);
+
+                // the worker reads the elements of the parent in place
+                code |= (Matrix::sum(Matrix::borrow(W.data(), {rows - workers, cols})) != expected) << 0;
+                code |= (!maps_segment(W.data(), name)) << 1;
+
+                // the pool of the worker can run in parallel again
+                Matrix::set_num_threads(2);
+                code |= (Matrix::sum(Matrix::borrow(W.data(), {rows - workers, cols})) != expected) << 2;
+
+                // and its writes are seen by the parent
+                W(rows - 1 - w, 0) = 100 + w;
+            }
+
+            // the copy of the parent matrix holds a reference of the worker too
+            A = Matrix::Matrix<float>(1);
+            _exit(code);
+        }
+
+        children.push_back(pid);
+    }
+
+    for (pid_t pid : children) {
+        int status = 0;
+        ASSERT_EQ(waitpid(pid, &status, 0), pid);
+        ASSERT_TRUE(WIFEXITED(status));
+        EXPECT_EQ(WEXITSTATUS(status), 0);
+    }
+
+    Matrix::set_num_threads(1);
+
+    for (int w = 0; w < workers; w++)
+        EXPECT_EQ(A(rows - 1 - w, 0), 100 + w);
+
+    // every worker dropped its reference
+    EXPECT_EQ(Matrix::shared_references(name), 1);
+}
@@ -0,0 +1,181 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <atrix/matrix.h>
+#include <atrix/softmax.h>
+#include <atrix/distributions.h>
+
+// the softmax of the lines along the last axis of the (rows, length) matrix in long double
+static std::vector<long double> reference_logsumexp(const Matrix::Matrix<double>& A) {
+    const int rows = A.get_shape()[0];
+    const int length = A.get_shape()[1];
+    std::vector<long double> result(rows);
+
+    for (int i = 0; i < rows; i++) {
+        long double m = A(i, 0);
+        for (int j = 0; j < length; j++)
+            m = std::max<long double>(m, A(i, j));
+
+        long double s = 0;
+        for (int j = 0; j < length; j++)
+            s += std::exp(static_cast<long double>(A(i, j)) - m);
+
+        result[i] = m + std::log(s);
+    }
+
+    return result;
+}
+
+TEST(SOFTMAX, LAST_AXIS) {
+    Matrix::Generator gen(17);
+
+    // the rows of one block and of many blocks of the online normalizer
+    for (int length : {1, 7, 1000, 40000}) {
+        Matrix::Matrix<double> A(3, length);
+        Matrix::normal(A, 0.0, 10.0, gen);
+        A(0, 0) = 1000.0;   // exp overflows without the shift
+        A(1, length - 1) = -1000.0;
+
+        std::vector<long double> lse = reference_logsumexp(A);
+        Matrix::Matrix<double> P = Matrix::softmax(A);
+        Matrix::Matrix<double> L = Matrix::log_softmax(A);
+        Matrix::Matrix<double> LSE = Matrix::logsumexp(A, 1);
+        Matrix::Matrix<double> LSE_KEPT = Matrix::logsumexp(A, -1, true);
+
+        EXPECT_EQ(P.get_shape(), A.get_shape());
+        EXPECT_EQ(LSE.get_shape(), std::vector<int>({3}));
+        EXPECT_EQ(LSE_KEPT.get_shape(), std::vector<int>({3, 1}));
+
+        for (int i = 0; i < 3; i++) {
+            EXPECT_NEAR(LSE(i), lse[i], 1e-12 * std::fabs(lse[i]) + 1e-12);
+            EXPECT_EQ(LSE_KEPT(i, 0), LSE(i));
+
+            double total = 0;
+            for (int j = 0; j < length; j++) {
+                const long double expected = std::exp(A(i, j) - lse[i]);
+                EXPECT_NEAR(P(i, j), expected, 1e-12 * expected + 1e-300);
+                EXPECT_NEAR(L(i, j), A(i, j) - lse[i], 1e-12 * std::fabs(lse[i]) + 1e-12);
+                total += P(i, j);
+            }
+            EXPECT_NEAR(total, 1.0, 1e-12);
+        }
+    }
+}
+
+TEST(SOFTMAX, OTHER_AXES) {
+    Matrix::Generator gen(19);
+    Matrix::Matrix<double> A(4, 300, 5);
+    Matrix::normal(A, 0.0, 50.0, gen);
+
+    // every axis against the last axis of the transposed lines
+    for (int axis = 0; axis < 3; axis++) {
+        const std::vector<int> shape = A.get_shape();
+        const int length = shape[axis];
+        const int lines = A.get_matrix_size() / length;
+
+        Matrix::Matrix<double> LINES(lines, length);
+        std::vector<std::vector<int>> positions;
+        for (int a = 0; a < shape[0]; a++)
+            for (int b = 0; b < shape[1]; b++)
+                for (int c = 0; c < shape[2]; c++) {
+                    int index[3] = {a, b, c};
+                    if (index[axis] != 0)
+                        continue;
+                    for (int k = 0; k < length; k++) {
+                        index[axis] = k;
+                        LINES(int(positions.size()), k) = A(index[0], index[1], index[2]);
+                    }
+                    index[axis] = 0;
+                    positions.push_back({index[0], index[1], index[2]});
+                }
+
+        Matrix::Matrix<double> P = Matrix::softmax(A, axis);
+        Matrix::Matrix<double> L = Matrix::log_softmax(A, axis);
+        Matrix::Matrix<double> LSE = Matrix::logsumexp(A, axis, true);
+        Matrix::Matrix<double> P_LINES = Matrix::softmax(LINES);
+        Matrix::Matrix<double> L_LINES = Matrix::log_softmax(LINES);
+        Matrix::Matrix<double> LSE_LINES = Matrix::logsumexp(LINES, 1);
+
+        for (int line = 0; line < lines; line++) {
+            std::vector<int> index = positions[line];
+            EXPECT_NEAR(LSE(index[0], index[1], index[2]), LSE_LINES(line), 1e-12 * std::fabs(LSE_LINES(line)));
+
+            for (int k = 0; k < length; k++) {
+                index[axis] = k;
+                EXPECT_NEAR(P(index[0], index[1], index[2]), P_LINES(line, k), 1e-14);
+                EXPECT_NEAR(L(index[0], index[1], index[2]), L_LINES(line, k), 1e-10);
+            }
+        }
+    }
+}
+
+TEST(SOFTMAX, LOGSUMEXP) {
+    Matrix::Matrix<double> A(1, 2);
+    EXPECT_NEAR(Matrix::logsumexp(A), std::log(1 + std::exp(1.0)), 1e-15);
+
+    // the chunks of the full reduction
+    Matrix::Generator gen(23);
+    Matrix::Matrix<double> B(300, 1000);
+    Matrix::normal(B, 0.0, 3.0, gen);
+    B(150, 500) = 800.0;
+    Matrix::Matrix<double> FLAT = B;
+    Matrix::reshape(FLAT, {1, 300000});
+    EXPECT_NEAR(Matrix::logsumexp(B), reference_logsumexp(FLAT)[0], 1e-12 * 800);
+
+    // the lines of -inf
+    const double inf = std::numeric_limits<double>::infinity();
+    Matrix::Matrix<double> C(2, 3);
+    for (int j = 0; j < 3; j++)
+        C(0, j) = -inf;
+    C(1, 0) = -inf;
+    Matrix::Matrix<double> LSE = Matrix::logsumexp(C, 1);
+    Matrix::Matrix<double> P = Matrix::softmax(C);
+    EXPECT_EQ(LSE(0), -inf);
+    EXPECT_NEAR(LSE(1), std::log(std::exp(4.0) + std::exp(5.0)), 1e-14);
+    EXPECT_EQ(P(1, 0), 0.0);
+    EXPECT_TRUE(std::isnan(P(0, 0)));
+
+    // a masked block of -inf next to a block whose exps underflow without the shift
+    Matrix::Matrix<double> M(1, 4096);
+    Matrix::Matrix<float> MF(1, 4096);
+    for (int j = 0; j < 4096; j++) {
+        M(0, j) = (j < 2048) ? -inf : -1000.0;
+        MF(0, j) = (j < 2048) ? -std::numeric_limits<float>::infinity() : -100.0f;
+    }
+    Matrix::Matrix<double> PM = Matrix::softmax(M);
+    Matrix::Matrix<float> PMF = Matrix::softmax(MF);
+    for (int j = 0; j < 4096; j++) {
+        EXPECT_EQ(PM(0, j), (j < 2048) ? 0.0 : 1.0 / 2048) << j;
+        EXPECT_EQ(PMF(0, j), (j < 2048) ? 0.0f : 1.0f / 2048) << j;
+    }
+
+    Matrix::Matrix<float> F(2, 2);
+    Matrix::Matrix<float> PF = Matrix::softmax(F, 0);
+    EXPECT_NEAR(PF(0, 0), 1 / (1 + std::exp(2.0f)), 1e-7);
+}
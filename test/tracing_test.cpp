@@ -0,0 +1,272 @@
+/* 
+ * MIT License 
+ *  
+ * Copyright (c) 2022 CihatAltiparmak 
+ *  
+ * Permission is hereby granted, free of charge, to any person obtaining a copy 
+ * of this software and associated documentation files (the "Software"), to deal 
+ * in the Software without restriction, including without limitation the rights 
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+ * copies of the Software, and to permit persons to whom the Software is 
+ * furnished to do so, subject to the following conditions: 
+ * 
+ * The above copyright notice and this permission notice shall be included in all 
+ * copies or substantial portions of the Software. 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+ * SOFTWARE. 
+ */
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+#include <atrix/matrix.h>
+#include <atrix/tracing.h>
+#include <atrix/npy.h>
+#include <atrix/epilogue.h>
+#include <atrix/packed.h>
+#include <atrix/quantize.h>
+#include <atrix/reductions.h>
+#include <atrix/softmax.h>
+#include <atrix/outofcore.h>
+#include <atrix/linalg/algorithms.h>
+
+static std::string exported_trace() {
+    std::ostringstream out;
+    Matrix::export_chrome_trace(out);
+    return out.str();
+}
+
+static int count(const std::string& text, const std::string& pattern) {
+    int n = 0;
+    for (std::size_t i = text.find(pattern); i != std::string::npos; i = text.find(pattern, i + 1))
+        n++;
+    return n;
+}
+
+// turns the tracing on for one test, the spans are cleared before and after it
+struct TracingOn {
+    TracingOn() {
+        Matrix::clear_trace();
+        Matrix::set_tracing(true);
+    }
+
+    ~TracingOn() {
+        Matrix::set_tracing(false);
+        Matrix::clear_trace();
+    }
+};
+
+TEST(TRACING, OFF_BY_DEFAULT) {
+    EXPECT_FALSE(Matrix::get_tracing());
+
+    Matrix::Matrix<double> A(8, 8);
+    Matrix::Matrix<double> B = Matrix::dot(A, A);
+
+    EXPECT_EQ(count(exported_trace(), "\"ph\": \"X\""), 0);
+}
+
+TEST(TRACING, RECORDS_SPANS) {
+    TracingOn tracing;
+
+    Matrix::Matrix<double> A(8, 4);
+    Matrix::Matrix<double> B(4, 2);
+    Matrix::Matrix<double> C = Matrix::dot(A, B);
+
+    std::string trace = exported_trace();
+
+    // dot and the gemm inside of it
+    EXPECT_EQ(trace.find("{\"traceEvents\": ["), 0u);
+    EXPECT_EQ(count(trace, "\"ph\": \"X\""), 2);
+    EXPECT_NE(trace.find("\"name\": \"dot\""), std::string::npos);
+    EXPECT_NE(trace.find("\"name\": \"gemm\""), std::string::npos);
+    EXPECT_NE(trace.find("\"shapes\": \"(8, 4) (4, 2)\""), std::string::npos);
+    EXPECT_NE(trace.find("\"shapes\": \"(8, 4) (4, 2) (8, 2)\""), std::string::npos);
+    EXPECT_EQ(count(trace, "\"flops\": 128.000"), 2);
+    EXPECT_NE(trace.find("\"pid\": " + std::to_string(getpid())), std::string::npos);
+}
+
+TEST(TRACING, NESTED_SPANS) {
+    TracingOn tracing;
+
+    Matrix::Matrix<double> A = Matrix::identity<double>(8) * 2.0;
+    Matrix::clear_trace();
+
+    Matrix::Matrix<double> B = Matrix::inv(A);
+
+    std::string trace = exported_trace();
+    EXPECT_EQ(count(trace, "\"name\": \"inv\""), 1);
+    EXPECT_EQ(count(trace, "\"name\": \"LUP\""), 1);
+    EXPECT_EQ(count(trace, "\"name\": \"dot\""), 1);
+}
+
+TEST(TRACING, KERNELS) {
+    TracingOn tracing;
+
+    Matrix::Matrix<float> X(6, 4);
+    Matrix::Matrix<float> W(4, 3);
+    Matrix::Matrix<float> b(1, 3);
+    Matrix::Matrix<float> x(4, 1);
+    Matrix::Matrix<float> y(6, 1);
+    Matrix::Matrix<float> G(4, 4);
+    Matrix::PackedMatrix<float> PW(W);
+    Matrix::QuantizedMatrix QX = Matrix::quantize(X, 0, false);
+    Matrix::QuantizedMatrix QW = Matrix::quantize(W, 1);
+    Matrix::clear_trace();
+
+    Matrix::gemv(1.0f, X, x, 0.0f, y);
+    Matrix::syrk(1.0f, X, 0.0f, G, true);
+    Matrix::Matrix<float> H = Matrix::dense(X, W, b, Matrix::Activation::RELU);
+    Matrix::Matrix<float> P = Matrix::dot(X, PW);
+    Matrix::Matrix<float> Q = Matrix::dot(QX, QW);
+
+    std::string trace = exported_trace();
+    EXPECT_NE(trace.find("\"name\": \"gemv\", \"cat\": \"atrix\""), std::string::npos);
+    EXPECT_NE(trace.find("\"flops\": 48.000"), std::string::npos);
+    EXPECT_NE(trace.find("\"name\": \"syrk\""), std::string::npos);
+    EXPECT_NE(trace.find("\"flops\": 120.000"), std::string::npos);
+    EXPECT_NE(trace.find("\"shapes\": \"(6, 4) (4, 3) (1, 3)\""), std::string::npos);
+
+    // dense with the gemm of its epilogue, the packed dot with its gemm and the quantized dot
+    EXPECT_EQ(count(trace, "\"name\": \"dense\""), 1);
+    EXPECT_EQ(count(trace, "\"name\": \"gemm\""), 2);
+    EXPECT_EQ(count(trace, "\"name\": \"dot\""), 2);
+    EXPECT_EQ(count(trace, "\"flops\": 144.000"), 5);
+}
+
+TEST(TRACING, REDUCTIONS) {
+    TracingOn tracing;
+
+    const std::string path = "/tmp/atrix_tracing_test_" + std::to_string(getpid()) + "_reductions.npy";
+
+    Matrix::Matrix<double> A(5, 7);
+    Matrix::save(path, A);
+    Matrix::FileMatrix<double> F(path);
+    Matrix::clear_trace();
+
+    Matrix::sum(A);
+    Matrix::min(A);
+    Matrix::max(A);
+    Matrix::argmin(A);
+    Matrix::argmax(A);
+    Matrix::argmin(A, 0);
+    Matrix::argmax(A, 1);
+    Matrix::norm(A);
+    Matrix::logsumexp(A);
+    Matrix::sum(F);
+    Matrix::max(F, 0);
+    std::remove(path.c_str());
+
+    std::string trace = exported_trace();
+    for (const char* name : {"min", "max", "norm", "logsumexp", "sum (out of core)", "max (out of core)"})
+        EXPECT_NE(trace.find(std::string("\"name\": \"") + name + "\""), std::string::npos) << name;
+    EXPECT_EQ(count(trace, "\"name\": \"argmin\""), 2);
+    EXPECT_EQ(count(trace, "\"name\": \"argmax\""), 2);
+    EXPECT_EQ(count(trace, "\"name\": \"sum\", \"cat\": \"atrix\", \"ph\": \"X\""), 2);
+    EXPECT_NE(trace.find("\"shapes\": \"(5, 7)\""), std::string::npos);
+    EXPECT_NE(trace.find("\"flops\": 35.000"), std::string::npos);
+
+    // mean and variance of all elements are spans around the sums inside of them
+    Matrix::clear_trace();
+    Matrix::variance(A);
+    trace = exported_trace();
+    EXPECT_EQ(count(trace, "\"name\": \"variance\""), 1);
+    EXPECT_EQ(count(trace, "\"name\": \"mean\""), 1);
+    EXPECT_EQ(count(trace, "\"name\": \"sum\""), 1);
+}
+
+TEST(TRACING, THREADS) {
+    TracingOn tracing;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([]() {
+            Matrix::Matrix<float> A(16, 16);
+            for (int i = 0; i < 10; i++)
+                Matrix::Matrix<float> B = A * 2.0f;
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    std::string trace = exported_trace();
+    EXPECT_EQ(count(trace, "\"name\": \"operator*\""), 40);
+
+    // every thread has its own tid
+    std::vector<std::string> tids;
+    for (std::size_t i = trace.find("\"tid\": "); i != std::string::npos; i = trace.find("\"tid\": ", i + 1)) {
+        std::string tid = trace.substr(i, trace.find(',', i) - i);
+        if (std::find(tids.begin(), tids.end(), tid) == tids.end())
+            tids.push_back(tid);
+    }
+    EXPECT_EQ(tids.size(), 4u);
+}
+
+TEST(TRACING, RING_BUFFER_KEEPS_THE_LATEST) {
+    TracingOn tracing;
+
+    for (long i = 0; i < Matrix::detail::TRACE_CAPACITY + 10; i++)
+        Matrix::detail::TraceSpan trace("span");
+
+    // the oldest kept slot is the next one to be written, so it is not exported
+    EXPECT_EQ(count(exported_trace(), "\"name\": \"span\""), Matrix::detail::TRACE_CAPACITY - 1);
+}
+
+TEST(TRACING, SWITCHED_OFF_AND_CLEARED) {
+    TracingOn tracing;
+
+    Matrix::Matrix<double> A(4, 4);
+    Matrix::Matrix<double> B = A + 1.0;
+
+    Matrix::set_tracing(false);
+    Matrix::Matrix<double> C = A + 1.0;
+    EXPECT_EQ(count(exported_trace(), "\"name\": \"operator+\""), 1);
+
+    Matrix::clear_trace();
+    EXPECT_EQ(count(exported_trace(), "\"ph\": \"X\""), 0);
+}
+
+TEST(TRACING, INPUT_OUTPUT) {
+    TracingOn tracing;
+
+    const std::string path = "/tmp/atrix_tracing_test_" + std::to_string(getpid()) + ".npy";
+
+    Matrix::Matrix<float> A(3, 5);
+    Matrix::save(path, A);
+    Matrix::Matrix<float> B = Matrix::load<float>(path);
+    std::remove(path.c_str());
+
+    std::string trace = exported_trace();
+    EXPECT_NE(trace.find("\"name\": \"save\", \"cat\": \"atrix\""), std::string::npos);
+    EXPECT_NE(trace.find("\"name\": \"load\""), std::string::npos);
+    EXPECT_EQ(count(trace, "\"shapes\": \"(3, 5)\""), 2);
+}
+
+TEST(TRACING, EXPORT_TO_FILE) {
+    TracingOn tracing;
+
+    const std::string path = "/tmp/atrix_tracing_test_" + std::to_string(getpid()) + ".json";
+
+    Matrix::Matrix<double> A(4, 4);
+    Matrix::Matrix<double> B = Matrix::transpoze(A);
+    Matrix::export_chrome_trace(path);
+
+    std::ifstream in(path);
+    std::stringstream text;
+    text << in.rdbuf();
+    std::remove(path.c_str());
+
+    EXPECT_EQ(text.str(), exported_trace());
+    EXPECT_THROW(Matrix::export_chrome_trace("/nonexistent/trace.json"), Matrix::SerializationError);
+}